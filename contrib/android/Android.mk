@@ -2,15 +2,17 @@ LOCAL_PATH := $(call my-dir)/../..
 
 include $(CLEAR_VARS)
 LOCAL_MODULE := libdivecomputer
-LOCAL_CFLAGS := -DENABLE_LOGGING -DHAVE_VERSION_SUFFIX -DHAVE_PTHREAD_H -DHAVE_STRERROR_R -DHAVE_CLOCK_GETTIME -DHAVE_LOCALTIME_R -DHAVE_GMTIME_R -DHAVE_TIMEGM -DHAVE_STRUCT_TM_TM_GMTOFF
+LOCAL_CFLAGS := -DENABLE_LOGGING -DHAVE_VERSION_SUFFIX -DHAVE_PTHREAD_H -DHAVE_SYS_MMAN_H -DHAVE_MMAP -DHAVE_STRERROR_R -DHAVE_CLOCK_GETTIME -DHAVE_LOCALTIME_R -DHAVE_GMTIME_R -DHAVE_TIMEGM -DHAVE_STRUCT_TM_TM_GMTOFF
 LOCAL_C_INCLUDES := $(LOCAL_PATH)/include
 LOCAL_SRC_FILES := \
 	src/aes.c \
+	src/archive.c \
 	src/array.c \
 	src/atomics_cobalt.c \
 	src/atomics_cobalt_parser.c \
 	src/bluetooth.c \
 	src/buffer.c \
+	src/bufio.c \
 	src/checksum.c \
 	src/citizen_aqualand.c \
 	src/citizen_aqualand_parser.c \
@@ -32,6 +34,8 @@ LOCAL_SRC_FILES := \
 	src/deepsix_excursion_parser.c \
 	src/descriptor.c \
 	src/device.c \
+	src/download.c \
+	src/downloadmanager.c \
 	src/diverite_nitekq.c \
 	src/diverite_nitekq_parser.c \
 	src/divesoft_freedom.c \
@@ -71,6 +75,7 @@ LOCAL_SRC_FILES := \
 	src/oceans_s1_parser.c \
 	src/packet.c \
 	src/parser.c \
+	src/parsepool.c \
 	src/pelagic_i330r.c \
 	src/platform.c \
 	src/rbstream.c \
@@ -106,6 +111,7 @@ LOCAL_SRC_FILES := \
 	src/suunto_vyper_parser.c \
 	src/tecdiving_divecomputereu.c \
 	src/tecdiving_divecomputereu_parser.c \
+	src/thread.c \
 	src/timer.c \
 	src/usb.c \
 	src/usbhid.c \
@@ -39,8 +39,10 @@
 
 #ifdef _WIN32
 #define DC_TICKS_FORMAT "%I64d"
+#define DC_BYTES_FORMAT "%I64u"
 #else
 #define DC_TICKS_FORMAT "%lld"
+#define DC_BYTES_FORMAT "%llu"
 #endif
 
 #define C_ARRAY_SIZE(array) (sizeof (array) / sizeof *(array))
@@ -210,6 +212,24 @@ dctool_transport_default (dc_descriptor_t *descriptor)
 	return DC_TRANSPORT_NONE;
 }
 
+static void
+dctool_opstats_print (const char *name, const dc_iostream_opstats_t *stats)
+{
+	if (stats->count == 0)
+		return;
+
+	message ("Event: %s count=%u, timeouts=%u, errors=%u, bytes=" DC_BYTES_FORMAT ", time=%.3f ms\n",
+		name, stats->count, stats->timeouts, stats->errors,
+		stats->bytes, stats->elapsed / 1000.0);
+	message ("Event: %s latency=", name);
+	for (unsigned int i = 0; i < DC_IOSTREAM_HISTOGRAM_SIZE; ++i) {
+		if (stats->histogram[i] == 0)
+			continue;
+		message (" <%uus:%u", 1u << i, stats->histogram[i]);
+	}
+	message ("\n");
+}
+
 void
 dctool_event_cb (dc_device_t *device, dc_event_type_t event, const void *data, void *userdata)
 {
@@ -217,6 +237,8 @@ dctool_event_cb (dc_device_t *device, dc_event_type_t event, const void *data, v
 	const dc_event_devinfo_t *devinfo = (const dc_event_devinfo_t *) data;
 	const dc_event_clock_t *clock = (const dc_event_clock_t *) data;
 	const dc_event_vendor_t *vendor = (const dc_event_vendor_t *) data;
+	const dc_iostream_stats_t *stats = (const dc_iostream_stats_t *) data;
+	const dc_event_cache_t *cache = (const dc_event_cache_t *) data;
 
 	switch (event) {
 	case DC_EVENT_WAITING:
@@ -243,6 +265,16 @@ dctool_event_cb (dc_device_t *device, dc_event_type_t event, const void *data, v
 			message ("%02X", vendor->data[i]);
 		message ("\n");
 		break;
+	case DC_EVENT_STATS:
+		dctool_opstats_print ("read", &stats->read);
+		dctool_opstats_print ("write", &stats->write);
+		dctool_opstats_print ("poll", &stats->poll);
+		dctool_opstats_print ("sleep", &stats->sleep);
+		break;
+	case DC_EVENT_CACHE:
+		message ("Event: cache hits=%u, misses=%u\n",
+			cache->hits, cache->misses);
+		break;
 	default:
 		break;
 	}
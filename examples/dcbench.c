@@ -0,0 +1,817 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_GETOPT_H
+#include <getopt.h>
+#endif
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOGDI
+#include <windows.h>
+#else
+#include <time.h>
+#include <sys/time.h>
+#endif
+
+#include <libdivecomputer/context.h>
+#include <libdivecomputer/descriptor.h>
+#include <libdivecomputer/parser.h>
+#include <libdivecomputer/archive.h>
+
+#include "common.h"
+#include "utils.h"
+
+#define C_ARRAY_SIZE(array) (sizeof (array) / sizeof *(array))
+
+#define MAXFAMILIES 64
+#define BATCHSIZE   256
+
+/*
+ * Allocation counting
+ *
+ * With the GNU C library, the allocation functions are interposed to
+ * count the number of allocations made by the library. On other
+ * platforms, the allocation count is not available.
+ */
+#if defined(__GLIBC__)
+#define HAVE_ALLOCATION_COUNTER
+
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t nmemb, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+
+static unsigned long long g_allocations = 0;
+
+void *
+malloc (size_t size)
+{
+	g_allocations++;
+	return __libc_malloc (size);
+}
+
+void *
+calloc (size_t nmemb, size_t size)
+{
+	g_allocations++;
+	return __libc_calloc (nmemb, size);
+}
+
+void *
+realloc (void *ptr, size_t size)
+{
+	g_allocations++;
+	return __libc_realloc (ptr, size);
+}
+#endif
+
+typedef unsigned long long bench_usecs_t;
+
+typedef struct bench_stats_t {
+	dc_family_t family;
+	unsigned int model;
+	unsigned int dives;
+	unsigned int errors;
+	unsigned long long bytes;
+	unsigned long long samples;
+	unsigned long long fields;
+	unsigned long long allocations;
+	bench_usecs_t t_new;
+	bench_usecs_t t_fields;
+	bench_usecs_t t_samples;
+	dc_parser_t *parser;
+} bench_stats_t;
+
+typedef struct bench_t {
+	dc_context_t *context;
+	unsigned int iterations;
+	unsigned int reuse;
+	unsigned int batch;
+	unsigned int window;
+	unsigned int summary;
+	unsigned int count;
+	bench_stats_t stats[MAXFAMILIES];
+} bench_t;
+
+static bench_usecs_t
+bench_now (void)
+{
+#if defined (_WIN32)
+	LARGE_INTEGER now, frequency;
+	QueryPerformanceFrequency (&frequency);
+	QueryPerformanceCounter (&now);
+	return now.QuadPart * 1000000 / frequency.QuadPart;
+#elif defined (HAVE_CLOCK_GETTIME)
+	struct timespec now;
+	clock_gettime (CLOCK_MONOTONIC, &now);
+	return (bench_usecs_t) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+#else
+	struct timeval now;
+	gettimeofday (&now, NULL);
+	return (bench_usecs_t) now.tv_sec * 1000000 + now.tv_usec;
+#endif
+}
+
+static unsigned long long
+bench_allocations (void)
+{
+#ifdef HAVE_ALLOCATION_COUNTER
+	return g_allocations;
+#else
+	return 0;
+#endif
+}
+
+static bench_stats_t *
+bench_stats_find (bench_t *bench, dc_family_t family, unsigned int model)
+{
+	for (unsigned int i = 0; i < bench->count; ++i) {
+		if (bench->stats[i].family == family && bench->stats[i].model == model)
+			return bench->stats + i;
+	}
+
+	if (bench->count >= C_ARRAY_SIZE (bench->stats))
+		return NULL;
+
+	bench_stats_t *stats = bench->stats + bench->count++;
+	memset (stats, 0, sizeof (*stats));
+	stats->family = family;
+	stats->model = model;
+
+	return stats;
+}
+
+static void
+sample_cb (dc_sample_type_t type, const dc_sample_value_t *value, void *userdata)
+{
+	unsigned long long *nsamples = (unsigned long long *) userdata;
+
+	if (type == DC_SAMPLE_TIME)
+		(*nsamples)++;
+}
+
+static void
+batch_cb (dc_sample_batch_t *batch, void *userdata)
+{
+	unsigned long long *nsamples = (unsigned long long *) userdata;
+
+	*nsamples += batch->count;
+}
+
+/*
+ * Parse the samples with the sample batch api, with all columns
+ * enabled.
+ */
+static dc_status_t
+bench_batch (dc_parser_t *parser, unsigned long long *nsamples)
+{
+	static unsigned int types[BATCHSIZE], time[BATCHSIZE], tank[BATCHSIZE];
+	static unsigned int rbt[BATCHSIZE], heartbeat[BATCHSIZE], bearing[BATCHSIZE];
+	static unsigned int deco_type[BATCHSIZE], deco_time[BATCHSIZE], deco_tts[BATCHSIZE];
+	static unsigned int gasmix[BATCHSIZE];
+	static double depth[BATCHSIZE], pressure[BATCHSIZE], temperature[BATCHSIZE];
+	static double setpoint[BATCHSIZE], ppo2[BATCHSIZE], cns[BATCHSIZE], deco_depth[BATCHSIZE];
+
+	dc_sample_batch_t batch = {
+		BATCHSIZE, 0, types, time, depth, tank, pressure, temperature,
+		rbt, heartbeat, bearing, setpoint, ppo2, cns,
+		deco_type, deco_time, deco_depth, deco_tts, gasmix};
+
+	return dc_parser_samples_batch (parser, &batch, batch_cb, nsamples);
+}
+
+typedef struct bench_range_t {
+	unsigned long long nsamples;
+	unsigned int last;
+} bench_range_t;
+
+static void
+range_cb (dc_sample_type_t type, const dc_sample_value_t *value, void *userdata)
+{
+	bench_range_t *range = (bench_range_t *) userdata;
+
+	if (type == DC_SAMPLE_TIME) {
+		range->nsamples++;
+		if (range->last < value->time)
+			range->last = value->time;
+	}
+}
+
+/*
+ * Parse the samples with the sample range api. The first call builds
+ * the index and locates the last sample, and then the entire dive is
+ * visited again in consecutive time windows.
+ */
+static dc_status_t
+bench_range (dc_parser_t *parser, unsigned int window, unsigned long long *nsamples)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	bench_range_t range = {0, 0};
+
+	rc = dc_parser_samples_range (parser, 0, 0xFFFFFFFF, range_cb, &range);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	range.nsamples = 0;
+
+	unsigned int begin = 0;
+	while (begin <= range.last) {
+		unsigned int end = range.last - begin < window ? range.last + 1 : begin + window;
+		rc = dc_parser_samples_range (parser, begin, end, range_cb, &range);
+		if (rc != DC_STATUS_SUCCESS)
+			return rc;
+		begin = end;
+	}
+
+	*nsamples = range.nsamples;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static unsigned int
+bench_fields (dc_parser_t *parser)
+{
+	static const dc_field_type_t types[] = {
+		DC_FIELD_DIVETIME,
+		DC_FIELD_MAXDEPTH,
+		DC_FIELD_AVGDEPTH,
+		DC_FIELD_SALINITY,
+		DC_FIELD_ATMOSPHERIC,
+		DC_FIELD_TEMPERATURE_SURFACE,
+		DC_FIELD_TEMPERATURE_MINIMUM,
+		DC_FIELD_TEMPERATURE_MAXIMUM,
+		DC_FIELD_DIVEMODE,
+		DC_FIELD_DECOMODEL,
+	};
+
+	union {
+		unsigned int number;
+		double real;
+		dc_gasmix_t gasmix;
+		dc_tank_t tank;
+		dc_salinity_t salinity;
+		dc_divemode_t divemode;
+		dc_decomodel_t decomodel;
+	} value;
+
+	unsigned int nfields = 0;
+
+	for (unsigned int i = 0; i < C_ARRAY_SIZE (types); ++i) {
+		if (dc_parser_get_field (parser, types[i], 0, &value) == DC_STATUS_SUCCESS)
+			nfields++;
+	}
+
+	unsigned int ngasmixes = 0;
+	if (dc_parser_get_field (parser, DC_FIELD_GASMIX_COUNT, 0, &ngasmixes) == DC_STATUS_SUCCESS) {
+		nfields++;
+		for (unsigned int i = 0; i < ngasmixes; ++i) {
+			if (dc_parser_get_field (parser, DC_FIELD_GASMIX, i, &value) == DC_STATUS_SUCCESS)
+				nfields++;
+		}
+	}
+
+	unsigned int ntanks = 0;
+	if (dc_parser_get_field (parser, DC_FIELD_TANK_COUNT, 0, &ntanks) == DC_STATUS_SUCCESS) {
+		nfields++;
+		for (unsigned int i = 0; i < ntanks; ++i) {
+			if (dc_parser_get_field (parser, DC_FIELD_TANK, i, &value) == DC_STATUS_SUCCESS)
+				nfields++;
+		}
+	}
+
+	return nfields;
+}
+
+/*
+ * Retrieve all the fields with a single summary call. The fields are
+ * counted in the same way as with the individual field calls.
+ */
+static unsigned int
+bench_summary (dc_parser_t *parser)
+{
+	dc_summary_t summary;
+
+	if (dc_parser_get_summary (parser, &summary) != DC_STATUS_SUCCESS)
+		return 0;
+
+	unsigned int nfields = 0;
+	unsigned int mask = summary.fields & ~((1u << DC_FIELD_GASMIX) | (1u << DC_FIELD_TANK));
+	while (mask) {
+		nfields += mask & 1;
+		mask >>= 1;
+	}
+
+	if (summary.fields & (1u << DC_FIELD_GASMIX))
+		nfields += summary.ngasmixes;
+
+	if (summary.fields & (1u << DC_FIELD_TANK))
+		nfields += summary.ntanks;
+
+	return nfields;
+}
+
+static dc_status_t
+bench_dive (bench_t *bench, dc_descriptor_t *descriptor, const unsigned char data[], unsigned int size)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	dc_parser_t *parser = NULL;
+
+	bench_stats_t *stats = bench_stats_find (bench,
+		dc_descriptor_get_type (descriptor),
+		dc_descriptor_get_model (descriptor));
+	if (stats == NULL) {
+		ERROR ("Too many device families.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	for (unsigned int i = 0; i < bench->iterations; ++i) {
+		unsigned long long allocations = bench_allocations ();
+
+		// Create the parser, or re-use the existing one.
+		bench_usecs_t t0 = bench_now ();
+		if (bench->reuse && stats->parser) {
+			parser = stats->parser;
+			rc = dc_parser_reset (parser, data, size);
+		} else {
+			rc = dc_parser_new2 (&parser, bench->context, descriptor, data, size);
+		}
+		if (rc != DC_STATUS_SUCCESS) {
+			if (parser == stats->parser)
+				stats->parser = NULL;
+			dc_parser_destroy (parser);
+			stats->errors++;
+			return rc;
+		}
+
+		// Retrieve all the fields.
+		bench_usecs_t t1 = bench_now ();
+		unsigned int nfields = bench->summary ?
+			bench_summary (parser) : bench_fields (parser);
+
+		// Parse the samples.
+		bench_usecs_t t2 = bench_now ();
+		unsigned long long nsamples = 0;
+		if (bench->window) {
+			rc = bench_range (parser, bench->window, &nsamples);
+		} else if (bench->batch) {
+			rc = bench_batch (parser, &nsamples);
+		} else {
+			rc = dc_parser_samples_foreach (parser, sample_cb, &nsamples);
+		}
+		bench_usecs_t t3 = bench_now ();
+
+		if (bench->reuse) {
+			stats->parser = parser;
+		} else {
+			dc_parser_destroy (parser);
+		}
+
+		if (rc != DC_STATUS_SUCCESS) {
+			stats->errors++;
+			return rc;
+		}
+
+		stats->dives++;
+		stats->bytes += size;
+		stats->fields += nfields;
+		stats->samples += nsamples;
+		stats->allocations += bench_allocations () - allocations;
+		stats->t_new += t1 - t0;
+		stats->t_fields += t2 - t1;
+		stats->t_samples += t3 - t2;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+bench_file (bench_t *bench, dc_descriptor_t *descriptor, const char *filename)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+
+	dc_buffer_t *buffer = dctool_file_read (filename);
+	if (buffer == NULL) {
+		message ("Failed to open the input file '%s'.\n", filename);
+		return DC_STATUS_IO;
+	}
+
+	rc = bench_dive (bench, descriptor,
+		dc_buffer_get_data (buffer), dc_buffer_get_size (buffer));
+	if (rc != DC_STATUS_SUCCESS) {
+		message ("%s: %s\n", filename, dctool_errmsg (rc));
+	}
+
+	dc_buffer_free (buffer);
+
+	return rc;
+}
+
+static dc_status_t
+bench_descriptor (dc_descriptor_t **out, const char *name, unsigned int model, unsigned int have_model)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	dc_descriptor_t *descriptor = NULL;
+
+	dc_family_t family = dctool_family_type (name);
+	if (family == DC_FAMILY_NULL) {
+		message ("Unknown family type '%s'.\n", name);
+		return DC_STATUS_INVALIDARGS;
+	}
+
+	if (!have_model) {
+		model = dctool_family_model (family);
+	}
+
+	rc = dctool_descriptor_search (&descriptor, NULL, family, model);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	if (descriptor == NULL) {
+		message ("No supported device found: %s, 0x%X\n", name, model);
+		return DC_STATUS_INVALIDARGS;
+	}
+
+	*out = descriptor;
+
+	return DC_STATUS_SUCCESS;
+}
+
+/*
+ * Corpus file
+ *
+ * Each line contains the family type, an optional model number and the
+ * name of a raw dive file, as written by the dctool download command
+ * with the raw output format:
+ *
+ *   <family>[:<model>] <filename>
+ *
+ * Empty lines and lines starting with a '#' are ignored.
+ */
+static dc_status_t
+bench_corpus (bench_t *bench, const char *filename)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+
+	FILE *fp = fopen (filename, "r");
+	if (fp == NULL) {
+		message ("Failed to open the corpus file '%s'.\n", filename);
+		return DC_STATUS_IO;
+	}
+
+	char line[1024];
+	unsigned int lineno = 0;
+	while (fgets (line, sizeof (line), fp) != NULL) {
+		char family[64] = {0}, path[sizeof(line)] = {0};
+		unsigned int model = 0, have_model = 0;
+
+		lineno++;
+
+		// Remove the trailing newline.
+		line[strcspn (line, "\r\n")] = 0;
+
+		if (line[0] == 0 || line[0] == '#')
+			continue;
+
+		if (sscanf (line, "%63s %1023[^\n]", family, path) != 2) {
+			message ("%s:%u: Invalid corpus entry.\n", filename, lineno);
+			rc = DC_STATUS_DATAFORMAT;
+			break;
+		}
+
+		char *separator = strchr (family, ':');
+		if (separator) {
+			*separator = 0;
+			model = strtoul (separator + 1, NULL, 0);
+			have_model = 1;
+		}
+
+		dc_descriptor_t *descriptor = NULL;
+		rc = bench_descriptor (&descriptor, family, model, have_model);
+		if (rc != DC_STATUS_SUCCESS)
+			break;
+
+		// Parse errors are reported, but not fatal.
+		bench_file (bench, descriptor, path);
+		dc_descriptor_free (descriptor);
+	}
+
+	fclose (fp);
+
+	return rc;
+}
+
+/*
+ * Dive archive
+ *
+ * All dives are parsed directly from the archive mapping, as written by
+ * the dctool download command with the archive output format.
+ */
+static dc_status_t
+bench_archive (bench_t *bench, const char *filename)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	dc_archive_t *archive = NULL;
+	dc_descriptor_t *descriptor = NULL;
+	dc_family_t family = DC_FAMILY_NULL;
+	unsigned int model = 0;
+
+	rc = dc_archive_open (&archive, bench->context, filename);
+	if (rc != DC_STATUS_SUCCESS) {
+		message ("Failed to open the archive '%s'.\n", filename);
+		return rc;
+	}
+
+	unsigned int count = dc_archive_get_count (archive);
+	for (unsigned int i = 0; i < count; ++i) {
+		dc_archive_entry_t entry;
+		rc = dc_archive_get_entry (archive, i, &entry);
+		if (rc != DC_STATUS_SUCCESS) {
+			message ("%s: Invalid dive #%u.\n", filename, i);
+			break;
+		}
+
+		// Dives of the same device are usually stored together, so
+		// the descriptor lookup is only repeated when it changes.
+		if (i == 0 || family != entry.family || model != entry.model) {
+			dc_descriptor_free (descriptor);
+			descriptor = NULL;
+
+			family = entry.family;
+			model = entry.model;
+
+			rc = dctool_descriptor_search (&descriptor, NULL, family, model);
+			if (rc != DC_STATUS_SUCCESS)
+				break;
+		}
+
+		if (descriptor == NULL) {
+			message ("%s: No supported device found for dive #%u.\n", filename, i);
+			continue;
+		}
+
+		// Parse errors are reported, but not fatal.
+		rc = bench_dive (bench, descriptor, entry.data, entry.size);
+		if (rc != DC_STATUS_SUCCESS) {
+			message ("%s: Dive #%u: %s\n", filename, i, dctool_errmsg (rc));
+			rc = DC_STATUS_SUCCESS;
+		}
+	}
+
+	dc_descriptor_free (descriptor);
+	dc_archive_close (archive);
+
+	return rc;
+}
+
+static double
+bench_rate (unsigned long long count, bench_usecs_t usecs)
+{
+	if (usecs == 0)
+		return 0.0;
+
+	return count * 1000000.0 / usecs;
+}
+
+static void
+bench_report (bench_t *bench)
+{
+	printf ("%-14s %8s %7s %7s %10s %11s %11s %11s %12s %12s %11s\n",
+		"family", "model", "dives", "errors", "bytes",
+		"new[us]", "fields[us]", "samples[us]",
+		"samples/s", "bytes/s", "allocs/dive");
+
+	for (unsigned int i = 0; i < bench->count; ++i) {
+		const bench_stats_t *stats = bench->stats + i;
+		unsigned int dives = stats->dives ? stats->dives : 1;
+		const char *name = dctool_family_name (stats->family);
+
+		printf ("%-14s %#8x %7u %7u %10llu %11.1f %11.1f %11.1f %12.0f %12.0f ",
+			name ? name : "unknown", stats->model,
+			stats->dives, stats->errors, stats->bytes,
+			(double) stats->t_new / dives,
+			(double) stats->t_fields / dives,
+			(double) stats->t_samples / dives,
+			bench_rate (stats->samples, stats->t_samples),
+			bench_rate (stats->bytes, stats->t_samples));
+#ifdef HAVE_ALLOCATION_COUNTER
+		printf ("%11.1f\n", (double) stats->allocations / dives);
+#else
+		printf ("%11s\n", "n/a");
+#endif
+	}
+}
+
+static void
+usage (void)
+{
+	printf (
+		"Benchmark the libdivecomputer parsers\n"
+		"\n"
+		"Usage:\n"
+		"   dcbench [options] -f <family> <filename>...\n"
+		"   dcbench [options] -c <corpus>\n"
+		"   dcbench [options] -a <archive>\n"
+		"\n"
+		"Options:\n"
+#ifdef HAVE_GETOPT_LONG
+		"   -h, --help                  Show help message\n"
+		"   -f, --family <family>       Device family type\n"
+		"   -m, --model <model>         Device model number\n"
+		"   -c, --corpus <filename>     Corpus file\n"
+		"   -a, --archive <filename>    Dive archive\n"
+		"   -i, --iterations <count>    Number of iterations per dive\n"
+		"   -r, --reuse                 Re-use the parser for all dives\n"
+		"   -b, --batch                 Parse the samples in batches\n"
+		"   -w, --window <seconds>      Parse the samples in time windows\n"
+		"   -s, --summary               Retrieve the fields with a summary\n"
+#else
+		"   -h              Show help message\n"
+		"   -f <family>     Device family type\n"
+		"   -m <model>      Device model number\n"
+		"   -c <filename>   Corpus file\n"
+		"   -a <filename>   Dive archive\n"
+		"   -i <count>      Number of iterations per dive\n"
+		"   -r              Re-use the parser for all dives\n"
+		"   -b              Parse the samples in batches\n"
+		"   -w <seconds>    Parse the samples in time windows\n"
+		"   -s              Retrieve the fields with a summary\n"
+#endif
+		"\n"
+		"Each line of the corpus file contains the family type, an optional\n"
+		"model number and the name of a raw dive file:\n"
+		"\n"
+		"   <family>[:<model>] <filename>\n");
+}
+
+int
+main (int argc, char *argv[])
+{
+	int exitcode = EXIT_SUCCESS;
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_descriptor_t *descriptor = NULL;
+	bench_t bench = {0};
+
+	// Default option values.
+	unsigned int help = 0;
+	const char *family = NULL;
+	const char *corpus = NULL;
+	const char *archive = NULL;
+	unsigned int model = 0, have_model = 0;
+	unsigned int iterations = 1;
+	unsigned int reuse = 0;
+	unsigned int batch = 0;
+	unsigned int window = 0;
+	unsigned int summary = 0;
+
+	// Parse the command-line options.
+	int opt = 0;
+	const char *optstring = "hf:m:c:a:i:rbw:s";
+#ifdef HAVE_GETOPT_LONG
+	struct option options[] = {
+		{"help",        no_argument,       0, 'h'},
+		{"family",      required_argument, 0, 'f'},
+		{"model",       required_argument, 0, 'm'},
+		{"corpus",      required_argument, 0, 'c'},
+		{"archive",     required_argument, 0, 'a'},
+		{"iterations",  required_argument, 0, 'i'},
+		{"reuse",       no_argument,       0, 'r'},
+		{"batch",       no_argument,       0, 'b'},
+		{"window",      required_argument, 0, 'w'},
+		{"summary",     no_argument,       0, 's'},
+		{0,             0,                 0,  0 }
+	};
+	while ((opt = getopt_long (argc, argv, optstring, options, NULL)) != -1) {
+#else
+	while ((opt = getopt (argc, argv, optstring)) != -1) {
+#endif
+		switch (opt) {
+		case 'h':
+			help = 1;
+			break;
+		case 'f':
+			family = optarg;
+			break;
+		case 'm':
+			model = strtoul (optarg, NULL, 0);
+			have_model = 1;
+			break;
+		case 'c':
+			corpus = optarg;
+			break;
+		case 'a':
+			archive = optarg;
+			break;
+		case 'i':
+			iterations = strtoul (optarg, NULL, 0);
+			break;
+		case 'r':
+			reuse = 1;
+			break;
+		case 'b':
+			batch = 1;
+			break;
+		case 'w':
+			window = strtoul (optarg, NULL, 0);
+			break;
+		case 's':
+			summary = 1;
+			break;
+		default:
+			return EXIT_FAILURE;
+		}
+	}
+
+	argc -= optind;
+	argv += optind;
+
+	if (help || (corpus == NULL && archive == NULL && (family == NULL || argc == 0))) {
+		usage ();
+		return help ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	if (batch && window) {
+		message ("The batch and window options can't be combined.\n");
+		return EXIT_FAILURE;
+	}
+
+	bench.iterations = iterations ? iterations : 1;
+	bench.reuse = reuse;
+	bench.batch = batch;
+	bench.window = window * 1000;
+	bench.summary = summary;
+
+	// Initialize a library context.
+	status = dc_context_new (&bench.context);
+	if (status != DC_STATUS_SUCCESS) {
+		exitcode = EXIT_FAILURE;
+		goto cleanup;
+	}
+
+	dc_context_set_loglevel (bench.context, DC_LOGLEVEL_NONE);
+
+	if (corpus) {
+		status = bench_corpus (&bench, corpus);
+		if (status != DC_STATUS_SUCCESS) {
+			exitcode = EXIT_FAILURE;
+			goto cleanup;
+		}
+	}
+
+	if (archive) {
+		status = bench_archive (&bench, archive);
+		if (status != DC_STATUS_SUCCESS) {
+			exitcode = EXIT_FAILURE;
+			goto cleanup;
+		}
+	}
+
+	if (family) {
+		status = bench_descriptor (&descriptor, family, model, have_model);
+		if (status != DC_STATUS_SUCCESS) {
+			exitcode = EXIT_FAILURE;
+			goto cleanup;
+		}
+
+		for (int i = 0; i < argc; ++i) {
+			bench_file (&bench, descriptor, argv[i]);
+		}
+	}
+
+	bench_report (&bench);
+
+cleanup:
+	for (unsigned int i = 0; i < bench.count; ++i) {
+		dc_parser_destroy (bench.stats[i].parser);
+	}
+	dc_descriptor_free (descriptor);
+	dc_context_free (bench.context);
+	return exitcode;
+}
@@ -0,0 +1,316 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOGDI
+#include <windows.h>
+#else
+#include <time.h>
+#include <sys/time.h>
+#endif
+
+/*
+ * The checksum functions are internal to the library, and not exported
+ * from the shared library. Therefore they are compiled directly into
+ * this program.
+ */
+#include "checksum.c"
+
+#define C_ARRAY_SIZE(array) (sizeof (array) / sizeof *(array))
+
+#define MAXSIZE 65536
+
+typedef unsigned long long bench_usecs_t;
+
+typedef unsigned int (*bench_func_t) (const unsigned char data[], unsigned int size, unsigned int init);
+
+typedef enum bench_type_t {
+	BENCH_CRC,
+	BENCH_ADD,
+	BENCH_XOR,
+} bench_type_t;
+
+typedef struct bench_crc_t {
+	const char *name;
+	bench_func_t func;
+	bench_type_t type;
+	unsigned int width;
+	unsigned int poly;
+	unsigned int refin;
+	unsigned int fixed; /* Fixed init and xorout of 0xFFFFFFFF */
+} bench_crc_t;
+
+static unsigned int
+add_uint8 (const unsigned char data[], unsigned int size, unsigned int init)
+{
+	return checksum_add_uint8 (data, size, init);
+}
+
+static unsigned int
+add_uint16 (const unsigned char data[], unsigned int size, unsigned int init)
+{
+	return checksum_add_uint16 (data, size, init);
+}
+
+static unsigned int
+xor_uint8 (const unsigned char data[], unsigned int size, unsigned int init)
+{
+	return checksum_xor_uint8 (data, size, init);
+}
+
+static unsigned int
+crc16_ccitt (const unsigned char data[], unsigned int size, unsigned int init)
+{
+	return checksum_crc16_ccitt (data, size, init, 0x0000);
+}
+
+static unsigned int
+crc16r_ccitt (const unsigned char data[], unsigned int size, unsigned int init)
+{
+	return checksum_crc16r_ccitt (data, size, init, 0x0000);
+}
+
+static unsigned int
+crc16_ansi (const unsigned char data[], unsigned int size, unsigned int init)
+{
+	return checksum_crc16_ansi (data, size, init, 0x0000);
+}
+
+static unsigned int
+crc16r_ansi (const unsigned char data[], unsigned int size, unsigned int init)
+{
+	return checksum_crc16r_ansi (data, size, init, 0x0000);
+}
+
+static unsigned int
+crc32 (const unsigned char data[], unsigned int size, unsigned int init)
+{
+	return checksum_crc32 (data, size);
+}
+
+static unsigned int
+crc32r (const unsigned char data[], unsigned int size, unsigned int init)
+{
+	return checksum_crc32r (data, size);
+}
+
+static const bench_crc_t g_crcs[] = {
+	{"add_uint8",    add_uint8,    BENCH_ADD,  8, 0,          0, 0},
+	{"add_uint16",   add_uint16,   BENCH_ADD, 16, 0,          0, 0},
+	{"xor_uint8",    xor_uint8,    BENCH_XOR,  8, 0,          0, 0},
+	{"crc16_ccitt",  crc16_ccitt,  BENCH_CRC, 16, 0x1021,     0, 0},
+	{"crc16r_ccitt", crc16r_ccitt, BENCH_CRC, 16, 0x1021,     1, 0},
+	{"crc16_ansi",   crc16_ansi,   BENCH_CRC, 16, 0x8005,     0, 0},
+	{"crc16r_ansi",  crc16r_ansi,  BENCH_CRC, 16, 0x8005,     1, 0},
+	{"crc32",        crc32,        BENCH_CRC, 32, 0x04C11DB7, 0, 1},
+	{"crc32r",       crc32r,       BENCH_CRC, 32, 0x04C11DB7, 1, 1},
+};
+
+static bench_usecs_t
+bench_now (void)
+{
+#if defined (_WIN32)
+	LARGE_INTEGER now, frequency;
+	QueryPerformanceFrequency (&frequency);
+	QueryPerformanceCounter (&now);
+	return now.QuadPart * 1000000 / frequency.QuadPart;
+#elif defined (HAVE_CLOCK_GETTIME)
+	struct timespec now;
+	clock_gettime (CLOCK_MONOTONIC, &now);
+	return (bench_usecs_t) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+#else
+	struct timeval now;
+	gettimeofday (&now, NULL);
+	return (bench_usecs_t) now.tv_sec * 1000000 + now.tv_usec;
+#endif
+}
+
+static unsigned int
+reflect (unsigned int value, unsigned int width)
+{
+	unsigned int result = 0;
+
+	for (unsigned int i = 0; i < width; ++i) {
+		if (value & (1u << i))
+			result |= 1u << (width - 1 - i);
+	}
+
+	return result;
+}
+
+/*
+ * Byte-at-a-time reference implementation.
+ */
+static unsigned int
+reference_sum (const bench_crc_t *crc, const unsigned char data[], unsigned int size, unsigned int init)
+{
+	unsigned int mask = (1u << crc->width) - 1;
+	unsigned int value = init;
+
+	for (unsigned int i = 0; i < size; ++i) {
+		if (crc->type == BENCH_XOR)
+			value ^= data[i];
+		else
+			value += data[i];
+	}
+
+	return value & mask;
+}
+
+/*
+ * Bit-at-a-time reference implementation.
+ */
+static unsigned int
+reference_crc (const bench_crc_t *crc, const unsigned char data[], unsigned int size, unsigned int init)
+{
+	unsigned int topbit = 1u << (crc->width - 1);
+	unsigned int mask = crc->width == 32 ? 0xFFFFFFFF : (1u << crc->width) - 1;
+	unsigned int value = 0;
+
+	if (crc->fixed) {
+		init = 0xFFFFFFFF;
+	}
+
+	// The reflected algorithm processes a reflected register.
+	value = (crc->refin ? reflect (init, crc->width) : init) & mask;
+
+	for (unsigned int i = 0; i < size; ++i) {
+		unsigned int byte = crc->refin ? reflect (data[i], 8) : data[i];
+		value ^= byte << (crc->width - 8);
+		for (unsigned int j = 0; j < 8; ++j) {
+			if (value & topbit)
+				value = ((value << 1) ^ crc->poly) & mask;
+			else
+				value = (value << 1) & mask;
+		}
+	}
+
+	if (crc->refin)
+		value = reflect (value, crc->width);
+
+	if (crc->fixed)
+		value ^= 0xFFFFFFFF;
+
+	return value;
+}
+
+static unsigned int
+verify (const bench_crc_t *crc, const unsigned char data[])
+{
+	static const unsigned int sizes[] = {0, 1, 2, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 1000, 4099, 65536};
+	unsigned int errors = 0;
+
+	for (unsigned int i = 0; i < C_ARRAY_SIZE (sizes); ++i) {
+		for (unsigned int offset = 0; offset < 8; ++offset) {
+			unsigned int init = rand () & (crc->width == 32 ? 0xFFFFFFFF : (1u << crc->width) - 1);
+			unsigned int expected = crc->type == BENCH_CRC ?
+				reference_crc (crc, data + offset, sizes[i], init) :
+				reference_sum (crc, data + offset, sizes[i], init);
+			unsigned int actual = crc->func (data + offset, sizes[i], init);
+			if (actual != expected) {
+				printf ("%s: mismatch (size=%u, offset=%u, init=0x%X): 0x%08X != 0x%08X\n",
+					crc->name, sizes[i], offset, init, actual, expected);
+				errors++;
+			}
+		}
+	}
+
+	return errors;
+}
+
+static double
+bench (const bench_crc_t *crc, const unsigned char data[], unsigned int size)
+{
+	unsigned long long total = 0;
+	unsigned int dummy = 0;
+
+	bench_usecs_t begin = bench_now (), now = begin;
+	do {
+		for (unsigned int i = 0; i < 64; ++i) {
+			dummy ^= crc->func (data + (dummy & 7), size, dummy & 0xFF);
+		}
+		total += 64ull * size;
+		now = bench_now ();
+	} while (now - begin < 200000);
+
+	// Prevent the compiler from optimizing away the calls.
+	if (dummy == 0x12345678)
+		printf (" ");
+
+	return total / (double) (now - begin);
+}
+
+int
+main (int argc, char *argv[])
+{
+	static const unsigned int sizes[] = {16, 256, 4096, 65536};
+	unsigned int errors = 0;
+
+	unsigned char *data = (unsigned char *) malloc (MAXSIZE + 8);
+	if (data == NULL) {
+		printf ("Failed to allocate memory.\n");
+		return EXIT_FAILURE;
+	}
+
+	srand (0);
+	for (unsigned int i = 0; i < MAXSIZE + 8; ++i) {
+		data[i] = rand () & 0xFF;
+	}
+
+	// Verify all implementations against the reference.
+	for (unsigned int i = 0; i < C_ARRAY_SIZE (g_crcs); ++i) {
+		errors += verify (&g_crcs[i], data);
+	}
+
+	if (errors) {
+		printf ("Verification failed with %u errors.\n", errors);
+		free (data);
+		return EXIT_FAILURE;
+	}
+
+	// Measure the throughput.
+	printf ("%-14s", "MB/s");
+	for (unsigned int j = 0; j < C_ARRAY_SIZE (sizes); ++j) {
+		printf (" %10u", sizes[j]);
+	}
+	printf ("\n");
+
+	for (unsigned int i = 0; i < C_ARRAY_SIZE (g_crcs); ++i) {
+		printf ("%-14s", g_crcs[i].name);
+		for (unsigned int j = 0; j < C_ARRAY_SIZE (sizes); ++j) {
+			printf (" %10.1f", bench (&g_crcs[i], data, sizes[j]));
+		}
+		printf ("\n");
+	}
+
+	free (data);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,646 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_GETOPT_H
+#include <getopt.h>
+#endif
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOGDI
+#include <windows.h>
+#else
+#include <time.h>
+#include <sys/time.h>
+#endif
+
+#include <libdivecomputer/context.h>
+#include <libdivecomputer/descriptor.h>
+#include <libdivecomputer/device.h>
+#include <libdivecomputer/iostream.h>
+#include <libdivecomputer/downloadmanager.h>
+
+#include "common.h"
+#include "simulator.h"
+#include "utils.h"
+
+#define C_ARRAY_SIZE(array) (sizeof (array) / sizeof *(array))
+
+typedef unsigned long long bench_usecs_t;
+
+typedef enum bench_mode_t {
+	BENCH_DUMP,
+	BENCH_DOWNLOAD,
+} bench_mode_t;
+
+typedef struct bench_simulator_t {
+	const char *name;
+	dctool_simulator_t *(*create) (dc_buffer_t *image);
+} bench_simulator_t;
+
+typedef struct bench_link_t {
+	const char *name;
+	dctool_simulator_link_t link;
+} bench_link_t;
+
+typedef struct bench_result_t {
+	dc_status_t status;
+	unsigned int dives;
+	unsigned long long bytes;
+	unsigned long long elapsed;
+	bench_usecs_t cpu;
+	dc_iostream_stats_t stats;
+} bench_result_t;
+
+typedef struct bench_device_t {
+	const char *name;
+	const char *linkname;
+	dctool_simulator_t *simulator;
+	const dctool_simulator_link_t *link;
+	dc_descriptor_t *descriptor;
+	bench_result_t result;
+} bench_device_t;
+
+typedef struct bench_manager_t {
+	bench_device_t *devices;
+	bench_usecs_t start;
+} bench_manager_t;
+
+static const bench_simulator_t g_simulators[] = {
+	{"atom2",    dctool_oceanic_atom2_simulator_new},
+	{"predator", dctool_shearwater_predator_simulator_new},
+	{"vyper",    dctool_suunto_vyper_simulator_new},
+	{"ostc3",    dctool_hw_ostc3_simulator_new},
+	{"smart",    dctool_uwatec_smart_simulator_new},
+};
+
+/*
+ * Link models
+ *
+ * A serial cable is only limited by the baudrate of the backend. A usb
+ * serial adapter adds the latency of the usb polling interval. The
+ * rfcomm link models a bluetooth serial port, which is still a serial
+ * connection, but with a long latency and a low throughput. The ble
+ * link models a slow BLE connection with the same timing, but uses the
+ * BLE transport and packet framing of the device. It's only available
+ * for the simulators that support BLE.
+ */
+static const bench_link_t g_links[] = {
+	{"serial",    {0, 0, DC_TRANSPORT_NONE}},
+	{"usb",       {1000, 0, DC_TRANSPORT_NONE}},
+	{"rfcomm",    {20000, 20000, DC_TRANSPORT_NONE}},
+	{"ble",       {20000, 20000, DC_TRANSPORT_BLE}},
+};
+
+static bench_usecs_t
+bench_now (void)
+{
+#if defined (_WIN32)
+	LARGE_INTEGER now, frequency;
+	QueryPerformanceFrequency (&frequency);
+	QueryPerformanceCounter (&now);
+	return now.QuadPart * 1000000 / frequency.QuadPart;
+#elif defined (HAVE_CLOCK_GETTIME)
+	struct timespec now;
+	clock_gettime (CLOCK_MONOTONIC, &now);
+	return (bench_usecs_t) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+#else
+	struct timeval now;
+	gettimeofday (&now, NULL);
+	return (bench_usecs_t) now.tv_sec * 1000000 + now.tv_usec;
+#endif
+}
+
+static const bench_simulator_t *
+bench_simulator_find (const char *name)
+{
+	for (unsigned int i = 0; i < C_ARRAY_SIZE (g_simulators); ++i) {
+		if (strcmp (name, g_simulators[i].name) == 0)
+			return g_simulators + i;
+	}
+
+	return NULL;
+}
+
+static const bench_link_t *
+bench_link_find (const char *name)
+{
+	for (unsigned int i = 0; i < C_ARRAY_SIZE (g_links); ++i) {
+		if (strcmp (name, g_links[i].name) == 0)
+			return g_links + i;
+	}
+
+	return NULL;
+}
+
+static int
+bench_link_supported (dctool_simulator_t *simulator, const dctool_simulator_link_t *link)
+{
+	return link->transport == DC_TRANSPORT_NONE ||
+		(dctool_simulator_get_transports (simulator) & link->transport) != 0;
+}
+
+static int
+dive_cb (const unsigned char *data, unsigned int size, const unsigned char *fingerprint, unsigned int fsize, void *userdata)
+{
+	bench_result_t *result = (bench_result_t *) userdata;
+
+	result->dives++;
+	result->bytes += size;
+
+	return 1;
+}
+
+static dc_status_t
+bench_run (dc_context_t *context, dctool_simulator_t *simulator, const dctool_simulator_link_t *link, bench_mode_t mode, bench_result_t *result)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	dc_descriptor_t *descriptor = NULL;
+	dc_iostream_t *iostream = NULL;
+	dc_device_t *device = NULL;
+	dc_buffer_t *buffer = NULL;
+
+	memset (result, 0, sizeof (*result));
+
+	rc = dctool_descriptor_search (&descriptor, NULL,
+		dctool_simulator_get_family (simulator),
+		dctool_simulator_get_model (simulator));
+	if (rc != DC_STATUS_SUCCESS || descriptor == NULL) {
+		message ("No supported device found for the '%s' simulator.\n",
+			dctool_simulator_get_name (simulator));
+		rc = DC_STATUS_UNSUPPORTED;
+		goto cleanup;
+	}
+
+	buffer = dc_buffer_new (0);
+	if (buffer == NULL) {
+		rc = DC_STATUS_NOMEMORY;
+		goto cleanup;
+	}
+
+	bench_usecs_t t0 = bench_now ();
+
+	rc = dctool_simulator_open (simulator, &iostream, context, link);
+	if (rc != DC_STATUS_SUCCESS) {
+		message ("Failed to open the simulator.\n");
+		goto cleanup;
+	}
+
+	rc = dc_device_open (&device, context, descriptor, iostream);
+	if (rc == DC_STATUS_SUCCESS) {
+		if (mode == BENCH_DUMP) {
+			rc = dc_device_dump (device, buffer);
+			result->bytes = dc_buffer_get_size (buffer);
+		} else {
+			rc = dc_device_foreach (device, dive_cb, result);
+		}
+
+		dc_status_t status = dc_device_close (device);
+		if (rc == DC_STATUS_SUCCESS)
+			rc = status;
+	}
+
+	result->cpu = bench_now () - t0;
+	result->elapsed = dctool_simulator_get_elapsed (simulator);
+	dc_iostream_get_stats (iostream, &result->stats);
+
+cleanup:
+	result->status = rc;
+	dc_iostream_close (iostream);
+	dc_buffer_free (buffer);
+	dc_descriptor_free (descriptor);
+	return rc;
+}
+
+static void
+bench_report_header (void)
+{
+	printf ("%-10s %-10s %-8s %7s %10s %12s %10s %8s %8s %9s  %s\n",
+		"simulator", "link", "mode", "dives", "bytes",
+		"virtual[s]", "cpu[ms]", "reads", "writes", "timeouts",
+		"status");
+}
+
+static void
+bench_report (const char *simulator, const char *link, bench_mode_t mode, const bench_result_t *result)
+{
+	printf ("%-10s %-10s %-8s %7u %10llu %12.3f %10.1f %8u %8u %9u  %s\n",
+		simulator, link, mode == BENCH_DUMP ? "dump" : "download",
+		result->dives, result->bytes,
+		result->elapsed / 1000000.0,
+		result->cpu / 1000.0,
+		result->stats.read.count,
+		result->stats.write.count,
+		result->stats.read.timeouts,
+		dctool_errmsg (result->status));
+}
+
+static dc_status_t
+bench_manager_open (dc_iostream_t **iostream, dc_context_t *context, dc_descriptor_t *descriptor, void *userdata)
+{
+	bench_device_t *device = (bench_device_t *) userdata;
+
+	return dctool_simulator_open (device->simulator, iostream, context, device->link);
+}
+
+static void
+bench_manager_event (unsigned int id, dc_event_type_t event, const void *data, void *userdata)
+{
+	bench_manager_t *manager = (bench_manager_t *) userdata;
+
+	if (event == DC_EVENT_STATS)
+		manager->devices[id].result.stats = *(const dc_iostream_stats_t *) data;
+}
+
+static int
+bench_manager_dive (unsigned int id, const unsigned char *data, unsigned int size, const unsigned char *fingerprint, unsigned int fsize, void *userdata)
+{
+	bench_manager_t *manager = (bench_manager_t *) userdata;
+
+	return dive_cb (data, size, fingerprint, fsize, &manager->devices[id].result);
+}
+
+static void
+bench_manager_finish (unsigned int id, dc_status_t status, void *userdata)
+{
+	bench_manager_t *manager = (bench_manager_t *) userdata;
+	bench_device_t *device = manager->devices + id;
+
+	device->result.status = status;
+	device->result.cpu = bench_now () - manager->start;
+	device->result.elapsed = dctool_simulator_get_elapsed (device->simulator);
+}
+
+/*
+ * Download all simulated devices concurrently with a download manager.
+ * The cpu time of each device is the time until its download finished.
+ */
+static dc_status_t
+bench_manager_run (dc_context_t *context, bench_device_t devices[], unsigned int count, unsigned int nthreads)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	dc_download_manager_t *manager = NULL;
+	bench_manager_t bench = {devices, 0};
+
+	const dc_download_manager_cbs_t callbacks = {
+		bench_manager_event,
+		bench_manager_dive,
+		bench_manager_finish,
+	};
+
+	rc = dc_download_manager_new (&manager, context, nthreads);
+	if (rc != DC_STATUS_SUCCESS) {
+		message ("Failed to create the download manager.\n");
+		return rc;
+	}
+
+	dc_download_manager_set_events (manager, DC_EVENT_STATS);
+
+	for (unsigned int i = 0; i < count; ++i) {
+		memset (&devices[i].result, 0, sizeof (devices[i].result));
+		rc = dc_download_manager_add (manager, devices[i].descriptor, bench_manager_open, devices + i, NULL);
+		if (rc != DC_STATUS_SUCCESS) {
+			message ("Failed to add the device.\n");
+			goto cleanup;
+		}
+	}
+
+	bench.start = bench_now ();
+
+	rc = dc_download_manager_run (manager, &callbacks, &bench);
+
+	for (unsigned int i = 0; i < count; ++i) {
+		if (devices[i].result.status != DC_STATUS_SUCCESS)
+			rc = devices[i].result.status;
+	}
+
+cleanup:
+	dc_download_manager_free (manager);
+	return rc;
+}
+
+/*
+ * Download every selected simulator and link model combination at the
+ * same time. A simulator can only be opened once, so every combination
+ * gets its own simulator instance.
+ */
+static dc_status_t
+bench_manager_main (dc_context_t *context, dc_buffer_t *image, const char *simulator, const char *link, const dctool_simulator_link_t *custom, unsigned int nthreads)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	bench_device_t devices[C_ARRAY_SIZE (g_simulators) * (C_ARRAY_SIZE (g_links) + 1)];
+	unsigned int count = 0;
+
+	for (unsigned int i = 0; i < C_ARRAY_SIZE (g_simulators); ++i) {
+		if (simulator && strcmp (simulator, g_simulators[i].name) != 0)
+			continue;
+
+		for (unsigned int j = 0; j <= C_ARRAY_SIZE (g_links); ++j) {
+			bench_device_t *device = devices + count;
+			if (j < C_ARRAY_SIZE (g_links)) {
+				if (custom || (link && strcmp (link, g_links[j].name) != 0))
+					continue;
+				device->linkname = g_links[j].name;
+				device->link = &g_links[j].link;
+			} else {
+				if (custom == NULL)
+					continue;
+				device->linkname = "custom";
+				device->link = custom;
+			}
+
+			device->name = g_simulators[i].name;
+			device->descriptor = NULL;
+			device->simulator = g_simulators[i].create (image);
+			if (device->simulator == NULL) {
+				message ("Failed to create the '%s' simulator.\n", device->name);
+				rc = DC_STATUS_NOMEMORY;
+				goto cleanup;
+			}
+
+			if (!bench_link_supported (device->simulator, device->link)) {
+				if (simulator && link)
+					message ("The '%s' simulator doesn't support the '%s' link model.\n", device->name, link);
+				dctool_simulator_free (device->simulator);
+				continue;
+			}
+
+			count++;
+
+			rc = dctool_descriptor_search (&device->descriptor, NULL,
+				dctool_simulator_get_family (device->simulator),
+				dctool_simulator_get_model (device->simulator));
+			if (rc != DC_STATUS_SUCCESS || device->descriptor == NULL) {
+				message ("No supported device found for the '%s' simulator.\n", device->name);
+				rc = DC_STATUS_UNSUPPORTED;
+				goto cleanup;
+			}
+		}
+	}
+
+	rc = bench_manager_run (context, devices, count, nthreads);
+
+	for (unsigned int i = 0; i < count; ++i) {
+		bench_report (devices[i].name, devices[i].linkname, BENCH_DOWNLOAD, &devices[i].result);
+	}
+
+cleanup:
+	for (unsigned int i = 0; i < count; ++i) {
+		dc_descriptor_free (devices[i].descriptor);
+		dctool_simulator_free (devices[i].simulator);
+	}
+	return rc;
+}
+
+static void
+usage (void)
+{
+	printf (
+		"Benchmark the libdivecomputer downloads with simulated devices\n"
+		"\n"
+		"Usage:\n"
+		"   dcbench_download [options]\n"
+		"\n"
+		"Options:\n"
+#ifdef HAVE_GETOPT_LONG
+		"   -h, --help                  Show help message\n"
+		"   -s, --simulator <name>      Simulated device (default: all)\n"
+		"   -l, --link <name>           Link model (default: all)\n"
+		"   -L, --latency <us>          Custom link latency\n"
+		"   -B, --bandwidth <bytes/s>   Custom link bandwidth\n"
+		"   -m, --mode <mode>           Download mode (dump or download)\n"
+		"   -i, --image <filename>      Replay a memory dump\n"
+		"   -j, --threads <count>       Download concurrently with a download manager\n"
+#else
+		"   -h              Show help message\n"
+		"   -s <name>       Simulated device (default: all)\n"
+		"   -l <name>       Link model (default: all)\n"
+		"   -L <us>         Custom link latency\n"
+		"   -B <bytes/s>    Custom link bandwidth\n"
+		"   -m <mode>       Download mode (dump or download)\n"
+		"   -i <filename>   Replay a memory dump\n"
+		"   -j <count>      Download concurrently with a download manager\n"
+#endif
+		"\n"
+		"Supported simulators:\n"
+		"   atom2, predator, vyper, ostc3, smart\n"
+		"\n"
+		"Supported link models:\n"
+		"   serial, usb, rfcomm, ble\n"
+		"\n"
+		"All timing is simulated. The virtual time is the time the download\n"
+		"would take over the simulated link. A memory dump can only be\n"
+		"replayed with a single simulator. With the download manager, all\n"
+		"devices are downloaded at the same time, using the given number of\n"
+		"threads (or one thread per device if zero). The ble link model\n"
+		"is skipped for the simulators without BLE support.\n");
+}
+
+int
+main (int argc, char *argv[])
+{
+	int exitcode = EXIT_SUCCESS;
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_context_t *context = NULL;
+	dc_buffer_t *image = NULL;
+
+	// Default option values.
+	unsigned int help = 0;
+	const char *simulator = NULL;
+	const char *link = NULL;
+	const char *filename = NULL;
+	dctool_simulator_link_t custom = {0, 0, DC_TRANSPORT_NONE};
+	unsigned int have_custom = 0;
+	bench_mode_t mode = BENCH_DOWNLOAD;
+	unsigned int nthreads = 0;
+	unsigned int have_threads = 0;
+
+	// Parse the command-line options.
+	int opt = 0;
+	const char *optstring = "hs:l:L:B:m:i:j:";
+#ifdef HAVE_GETOPT_LONG
+	struct option options[] = {
+		{"help",        no_argument,       0, 'h'},
+		{"simulator",   required_argument, 0, 's'},
+		{"link",        required_argument, 0, 'l'},
+		{"latency",     required_argument, 0, 'L'},
+		{"bandwidth",   required_argument, 0, 'B'},
+		{"mode",        required_argument, 0, 'm'},
+		{"image",       required_argument, 0, 'i'},
+		{"threads",     required_argument, 0, 'j'},
+		{0,             0,                 0,  0 }
+	};
+	while ((opt = getopt_long (argc, argv, optstring, options, NULL)) != -1) {
+#else
+	while ((opt = getopt (argc, argv, optstring)) != -1) {
+#endif
+		switch (opt) {
+		case 'h':
+			help = 1;
+			break;
+		case 's':
+			simulator = optarg;
+			break;
+		case 'l':
+			link = optarg;
+			break;
+		case 'L':
+			custom.latency = strtoul (optarg, NULL, 0);
+			have_custom = 1;
+			break;
+		case 'B':
+			custom.bandwidth = strtoul (optarg, NULL, 0);
+			have_custom = 1;
+			break;
+		case 'm':
+			if (strcmp (optarg, "dump") == 0) {
+				mode = BENCH_DUMP;
+			} else if (strcmp (optarg, "download") == 0) {
+				mode = BENCH_DOWNLOAD;
+			} else {
+				message ("Unknown download mode '%s'.\n", optarg);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'i':
+			filename = optarg;
+			break;
+		case 'j':
+			nthreads = strtoul (optarg, NULL, 0);
+			have_threads = 1;
+			break;
+		default:
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (help) {
+		usage ();
+		return EXIT_SUCCESS;
+	}
+
+	if (simulator && bench_simulator_find (simulator) == NULL) {
+		message ("Unknown simulator '%s'.\n", simulator);
+		return EXIT_FAILURE;
+	}
+
+	if (link && bench_link_find (link) == NULL) {
+		message ("Unknown link model '%s'.\n", link);
+		return EXIT_FAILURE;
+	}
+
+	if (filename && simulator == NULL) {
+		message ("A memory dump requires a simulator.\n");
+		return EXIT_FAILURE;
+	}
+
+	if (have_threads && mode != BENCH_DOWNLOAD) {
+		message ("The download manager doesn't support the dump mode.\n");
+		return EXIT_FAILURE;
+	}
+
+	// Initialize a library context.
+	status = dc_context_new (&context);
+	if (status != DC_STATUS_SUCCESS) {
+		exitcode = EXIT_FAILURE;
+		goto cleanup;
+	}
+
+	dc_context_set_loglevel (context, DC_LOGLEVEL_NONE);
+
+	if (filename) {
+		image = dctool_file_read (filename);
+		if (image == NULL) {
+			message ("Failed to open the memory dump '%s'.\n", filename);
+			exitcode = EXIT_FAILURE;
+			goto cleanup;
+		}
+	}
+
+	bench_report_header ();
+
+	if (have_threads) {
+		status = bench_manager_main (context, image, simulator, link, have_custom ? &custom : NULL, nthreads);
+		if (status != DC_STATUS_SUCCESS)
+			exitcode = EXIT_FAILURE;
+		goto cleanup;
+	}
+
+	for (unsigned int i = 0; i < C_ARRAY_SIZE (g_simulators); ++i) {
+		if (simulator && strcmp (simulator, g_simulators[i].name) != 0)
+			continue;
+
+		dctool_simulator_t *sim = g_simulators[i].create (image);
+		if (sim == NULL) {
+			message ("Failed to create the '%s' simulator.\n", g_simulators[i].name);
+			exitcode = EXIT_FAILURE;
+			continue;
+		}
+
+		for (unsigned int j = 0; j <= C_ARRAY_SIZE (g_links); ++j) {
+			const char *name = NULL;
+			const dctool_simulator_link_t *model = NULL;
+			if (j < C_ARRAY_SIZE (g_links)) {
+				// The predefined link models are skipped if a custom
+				// link model is specified.
+				if (have_custom || (link && strcmp (link, g_links[j].name) != 0))
+					continue;
+				name = g_links[j].name;
+				model = &g_links[j].link;
+				if (!bench_link_supported (sim, model)) {
+					if (simulator && link) {
+						message ("The '%s' simulator doesn't support the '%s' link model.\n", g_simulators[i].name, link);
+						exitcode = EXIT_FAILURE;
+					}
+					continue;
+				}
+			} else {
+				if (!have_custom)
+					continue;
+				name = "custom";
+				model = &custom;
+			}
+
+			bench_result_t result;
+			if (bench_run (context, sim, model, mode, &result) != DC_STATUS_SUCCESS)
+				exitcode = EXIT_FAILURE;
+
+			bench_report (g_simulators[i].name, name, mode, &result);
+		}
+
+		dctool_simulator_free (sim);
+	}
+
+cleanup:
+	dc_buffer_free (image);
+	dc_context_free (context);
+	return exitcode;
+}
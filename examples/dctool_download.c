@@ -45,6 +45,8 @@
 
 typedef struct event_data_t {
 	const char *cachedir;
+	const char *imagedir;
+	dc_buffer_t *image;
 	dc_event_devinfo_t devinfo;
 } event_data_t;
 
@@ -136,6 +138,32 @@ event_cb (dc_device_t *device, dc_event_type_t event, const void *data, void *us
 			dc_buffer_free (fingerprint);
 		}
 
+		// Load the memory image from the cache. If there is no image
+		// present in the cache, the buffer is left empty, and the
+		// entire memory will be downloaded.
+		if (eventdata->imagedir) {
+			char filename[1024] = {0};
+			dc_family_t family = DC_FAMILY_NULL;
+			dc_buffer_t *image = NULL;
+
+			// Generate the image filename.
+			family = dc_device_get_type (device);
+			snprintf (filename, sizeof (filename), "%s/%s-%08X.img",
+				eventdata->imagedir, dctool_family_name (family), devinfo->serial);
+
+			// Read the image file.
+			image = dctool_file_read (filename);
+
+			// Replace the contents of the image buffer.
+			dc_buffer_clear (eventdata->image);
+			dc_buffer_append (eventdata->image,
+				dc_buffer_get_data (image),
+				dc_buffer_get_size (image));
+
+			// Free the buffer again.
+			dc_buffer_free (image);
+		}
+
 		// Keep a copy of the event data. It will be used for generating
 		// the fingerprint filename again after a (successful) download.
 		eventdata->devinfo = *devinfo;
@@ -152,6 +180,7 @@ download (dc_context_t *context, dc_descriptor_t *descriptor, dc_transport_t tra
 	dc_iostream_t *iostream = NULL;
 	dc_device_t *device = NULL;
 	dc_buffer_t *ofingerprint = NULL;
+	dc_buffer_t *image = NULL;
 
 	// Open the I/O stream.
 	message ("Opening the I/O stream (%s, %s).\n",
@@ -181,9 +210,28 @@ download (dc_context_t *context, dc_descriptor_t *descriptor, dc_transport_t tra
 		eventdata.cachedir = cachedir;
 	}
 
+	// Register the memory image cache.
+	if (cachedir) {
+		image = dc_buffer_new (0);
+		if (image == NULL) {
+			ERROR ("Error allocating the memory image.");
+			rc = DC_STATUS_NOMEMORY;
+			goto cleanup;
+		}
+
+		rc = dc_device_set_image (device, image);
+		if (rc != DC_STATUS_SUCCESS) {
+			ERROR ("Error registering the memory image.");
+			goto cleanup;
+		}
+
+		eventdata.imagedir = cachedir;
+		eventdata.image = image;
+	}
+
 	// Register the event handler.
 	message ("Registering the event handler.\n");
-	int events = DC_EVENT_WAITING | DC_EVENT_PROGRESS | DC_EVENT_DEVINFO | DC_EVENT_CLOCK | DC_EVENT_VENDOR;
+	int events = DC_EVENT_WAITING | DC_EVENT_PROGRESS | DC_EVENT_DEVINFO | DC_EVENT_CLOCK | DC_EVENT_VENDOR | DC_EVENT_STATS | DC_EVENT_CACHE;
 	rc = dc_device_set_events (device, events, event_cb, &eventdata);
 	if (rc != DC_STATUS_SUCCESS) {
 		ERROR ("Error registering the event handler.");
@@ -237,7 +285,22 @@ download (dc_context_t *context, dc_descriptor_t *descriptor, dc_transport_t tra
 		dctool_file_write (filename, ofingerprint);
 	}
 
+	// Store the memory image.
+	if (image && dc_buffer_get_size (image)) {
+		char filename[1024] = {0};
+		dc_family_t family = DC_FAMILY_NULL;
+
+		// Generate the image filename.
+		family = dc_device_get_type (device);
+		snprintf (filename, sizeof (filename), "%s/%s-%08X.img",
+			cachedir, dctool_family_name (family), eventdata.devinfo.serial);
+
+		// Write the image file.
+		dctool_file_write (filename, image);
+	}
+
 cleanup:
+	dc_buffer_free (image);
 	dc_buffer_free (ofingerprint);
 	dc_device_close (device);
 	dc_iostream_close (iostream);
@@ -333,6 +396,10 @@ dctool_download_run (int argc, char *argv[], dc_context_t *context, dc_descripto
 		output = dctool_raw_output_new (filename);
 	} else if (strcasecmp(format, "xml") == 0) {
 		output = dctool_xml_output_new (filename, units);
+	} else if (strcasecmp(format, "archive") == 0) {
+		output = dctool_archive_output_new (context, filename,
+			dc_descriptor_get_type (descriptor),
+			dc_descriptor_get_model (descriptor));
 	} else {
 		message ("Unknown output format: %s\n", format);
 		exitcode = EXIT_FAILURE;
@@ -397,6 +464,11 @@ const dctool_command_t dctool_download = {
 	"      files, the filename is interpreted as a template and should\n"
 	"      contain one or more placeholders.\n"
 	"\n"
+	"   ARCHIVE\n"
+	"\n"
+	"      All dives are appended to a single (binary) dive archive, which\n"
+	"      can be re-parsed later on without access to the dive computer.\n"
+	"\n"
 	"Supported template placeholders:\n"
 	"\n"
 	"   %f   Fingerprint (hexadecimal format)\n"
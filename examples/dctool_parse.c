@@ -36,6 +36,7 @@
 #include <libdivecomputer/context.h>
 #include <libdivecomputer/descriptor.h>
 #include <libdivecomputer/parser.h>
+#include <libdivecomputer/parsepool.h>
 
 #include "dctool.h"
 #include "output.h"
@@ -81,6 +82,97 @@ cleanup:
 	return rc;
 }
 
+typedef struct parse_jobs_t {
+	dc_buffer_t **buffers;
+	dctool_output_t *output;
+	dctool_units_t units;
+	unsigned int devtime;
+	dc_ticks_t systime;
+} parse_jobs_t;
+
+static dc_status_t
+parse_jobs_process (dc_parser_t *parser, unsigned int index, dc_buffer_t *buffer, void *userdata)
+{
+	parse_jobs_t *jobs = (parse_jobs_t *) userdata;
+	dc_status_t rc = DC_STATUS_SUCCESS;
+
+	// Set the clock.
+	rc = dc_parser_set_clock (parser, jobs->devtime, jobs->systime);
+	if (rc != DC_STATUS_SUCCESS && rc != DC_STATUS_UNSUPPORTED) {
+		ERROR ("Error setting the clock.");
+		return rc;
+	}
+
+	// Render the dive into the buffer.
+	dctool_output_t *output = dctool_xml_output_new_buffer (buffer, jobs->units);
+	if (output == NULL) {
+		ERROR ("Failed to create the output.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	dctool_output_set_number (output, index);
+
+	rc = dctool_output_write (output, parser,
+		dc_buffer_get_data (jobs->buffers[index]),
+		dc_buffer_get_size (jobs->buffers[index]),
+		NULL, 0);
+	if (rc != DC_STATUS_SUCCESS) {
+		ERROR ("Error parsing the dive data.");
+	}
+
+	dctool_output_free (output);
+
+	return rc;
+}
+
+static dc_status_t
+parse_jobs_deliver (unsigned int index, dc_status_t status, const unsigned char data[], size_t size, void *userdata)
+{
+	parse_jobs_t *jobs = (parse_jobs_t *) userdata;
+
+	if (status != DC_STATUS_SUCCESS) {
+		message ("Error parsing dive #%u.\n", index + 1);
+		return status;
+	}
+
+	return dctool_xml_output_write_fragment (jobs->output, data, size);
+}
+
+static dc_status_t
+parse_jobs (unsigned int count, dc_context_t *context, dc_descriptor_t *descriptor, unsigned int njobs, parse_jobs_t *jobs)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	dc_parse_pool_t *pool = NULL;
+
+	// Create the pool.
+	message ("Creating the parser pool (%u threads).\n", njobs);
+	rc = dc_parse_pool_new (&pool, context, njobs);
+	if (rc != DC_STATUS_SUCCESS) {
+		ERROR ("Error creating the parser pool.");
+		goto cleanup;
+	}
+
+	for (unsigned int i = 0; i < count; ++i) {
+		rc = dc_parse_pool_add (pool, descriptor,
+			dc_buffer_get_data (jobs->buffers[i]), dc_buffer_get_size (jobs->buffers[i]));
+		if (rc != DC_STATUS_SUCCESS) {
+			ERROR ("Error adding the dive data.");
+			goto cleanup;
+		}
+	}
+
+	// Parse the dive data.
+	message ("Parsing the dive data.\n");
+	rc = dc_parse_pool_run (pool, parse_jobs_process, parse_jobs_deliver, jobs);
+	if (rc != DC_STATUS_SUCCESS) {
+		goto cleanup;
+	}
+
+cleanup:
+	dc_parse_pool_free (pool);
+	return rc;
+}
+
 static int
 dctool_parse_run (int argc, char *argv[], dc_context_t *context, dc_descriptor_t *descriptor)
 {
@@ -88,6 +180,7 @@ dctool_parse_run (int argc, char *argv[], dc_context_t *context, dc_descriptor_t
 	int exitcode = EXIT_SUCCESS;
 	dc_status_t status = DC_STATUS_SUCCESS;
 	dc_buffer_t *buffer = NULL;
+	dc_buffer_t **buffers = NULL;
 	dctool_output_t *output = NULL;
 	dctool_units_t units = DCTOOL_UNITS_METRIC;
 
@@ -96,10 +189,11 @@ dctool_parse_run (int argc, char *argv[], dc_context_t *context, dc_descriptor_t
 	const char *filename = NULL;
 	unsigned int devtime = 0;
 	dc_ticks_t systime = 0;
+	unsigned int njobs = 0;
 
 	// Parse the command-line options.
 	int opt = 0;
-	const char *optstring = "ho:d:s:u:";
+	const char *optstring = "ho:d:s:u:j:";
 #ifdef HAVE_GETOPT_LONG
 	struct option options[] = {
 		{"help",        no_argument,       0, 'h'},
@@ -107,6 +201,7 @@ dctool_parse_run (int argc, char *argv[], dc_context_t *context, dc_descriptor_t
 		{"devtime",     required_argument, 0, 'd'},
 		{"systime",     required_argument, 0, 's'},
 		{"units",       required_argument, 0, 'u'},
+		{"jobs",        required_argument, 0, 'j'},
 		{0,             0,                 0,  0 }
 	};
 	while ((opt = getopt_long (argc, argv, optstring, options, NULL)) != -1) {
@@ -132,6 +227,9 @@ dctool_parse_run (int argc, char *argv[], dc_context_t *context, dc_descriptor_t
 			if (strcmp (optarg, "imperial") == 0)
 				units = DCTOOL_UNITS_IMPERIAL;
 			break;
+		case 'j':
+			njobs = strtoul (optarg, NULL, 0);
+			break;
 		default:
 			return EXIT_FAILURE;
 		}
@@ -154,7 +252,35 @@ dctool_parse_run (int argc, char *argv[], dc_context_t *context, dc_descriptor_t
 		goto cleanup;
 	}
 
-	for (int i = 0; i < argc; ++i) {
+	if (njobs) {
+		// Read all input files.
+		buffers = (dc_buffer_t **) calloc (argc ? argc : 1, sizeof (dc_buffer_t *));
+		if (buffers == NULL) {
+			message ("Failed to allocate memory.\n");
+			exitcode = EXIT_FAILURE;
+			goto cleanup;
+		}
+
+		for (int i = 0; i < argc; ++i) {
+			buffers[i] = dctool_file_read (argv[i]);
+			if (buffers[i] == NULL) {
+				message ("Failed to open the input file.\n");
+				exitcode = EXIT_FAILURE;
+				goto cleanup;
+			}
+		}
+
+		// Parse the dives.
+		parse_jobs_t jobs = {buffers, output, units, devtime, systime};
+		status = parse_jobs (argc, context, descriptor, njobs, &jobs);
+		if (status != DC_STATUS_SUCCESS) {
+			message ("ERROR: %s\n", dctool_errmsg (status));
+			exitcode = EXIT_FAILURE;
+			goto cleanup;
+		}
+	}
+
+	for (int i = 0; i < argc && njobs == 0; ++i) {
 		// Read the input file.
 		buffer = dctool_file_read (argv[i]);
 		if (buffer == NULL) {
@@ -177,6 +303,12 @@ dctool_parse_run (int argc, char *argv[], dc_context_t *context, dc_descriptor_t
 	}
 
 cleanup:
+	if (buffers) {
+		for (int i = 0; i < argc; ++i) {
+			dc_buffer_free (buffers[i]);
+		}
+		free (buffers);
+	}
 	dc_buffer_free (buffer);
 	dctool_output_free (output);
 	return exitcode;
@@ -188,7 +320,7 @@ const dctool_command_t dctool_parse = {
 	"parse",
 	"Parse previously downloaded dives",
 	"Usage:\n"
-	"   dctool parse [options] <filename>\n"
+	"   dctool parse [options] <filename>...\n"
 	"\n"
 	"Options:\n"
 #ifdef HAVE_GETOPT_LONG
@@ -197,11 +329,13 @@ const dctool_command_t dctool_parse = {
 	"   -d, --devtime <timestamp>  Device time\n"
 	"   -s, --systime <timestamp>  System time\n"
 	"   -u, --units <units>        Set units (metric or imperial)\n"
+	"   -j, --jobs <count>         Number of parser threads\n"
 #else
 	"   -h              Show help message\n"
 	"   -o <filename>   Output filename\n"
 	"   -d <devtime>    Device time\n"
 	"   -s <systime>    System time\n"
 	"   -u <units>      Set units (metric or imperial)\n"
+	"   -j <count>      Number of parser threads\n"
 #endif
 };
@@ -61,6 +61,15 @@ dctool_output_write (dctool_output_t *output, dc_parser_t *parser, const unsigne
 	return output->vtable->write (output, parser, data, size, fingerprint, fsize);
 }
 
+void
+dctool_output_set_number (dctool_output_t *output, unsigned int number)
+{
+	if (output == NULL)
+		return;
+
+	output->number = number;
+}
+
 dc_status_t
 dctool_output_free (dctool_output_t *output)
 {
@@ -24,6 +24,7 @@
 
 #include <libdivecomputer/common.h>
 #include <libdivecomputer/parser.h>
+#include <libdivecomputer/buffer.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -39,12 +40,33 @@ typedef enum dctool_units_t {
 dctool_output_t *
 dctool_xml_output_new (const char *filename, dctool_units_t units);
 
+/*
+ * Create an xml output that renders the dives into a memory buffer,
+ * without the surrounding <device> element. The buffer contents can be
+ * written to a regular xml output with dctool_xml_output_write_fragment.
+ */
+dctool_output_t *
+dctool_xml_output_new_buffer (dc_buffer_t *buffer, dctool_units_t units);
+
+dc_status_t
+dctool_xml_output_write_fragment (dctool_output_t *output, const unsigned char data[], unsigned int size);
+
 dctool_output_t *
 dctool_raw_output_new (const char *template);
 
+dctool_output_t *
+dctool_archive_output_new (dc_context_t *context, const char *filename, dc_family_t family, unsigned int model);
+
 dc_status_t
 dctool_output_write (dctool_output_t *output, dc_parser_t *parser, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize);
 
+/*
+ * Set the number of the previous dive. The next dive will be numbered
+ * sequentially from there.
+ */
+void
+dctool_output_set_number (dctool_output_t *output, unsigned int number);
+
 dc_status_t
 dctool_output_free (dctool_output_t *output);
 
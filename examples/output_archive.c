@@ -0,0 +1,99 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+
+#include <libdivecomputer/archive.h>
+
+#include "output-private.h"
+#include "utils.h"
+
+static dc_status_t dctool_archive_output_write (dctool_output_t *output, dc_parser_t *parser, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize);
+static dc_status_t dctool_archive_output_free (dctool_output_t *output);
+
+typedef struct dctool_archive_output_t {
+	dctool_output_t base;
+	dc_archive_writer_t *writer;
+	dc_family_t family;
+	unsigned int model;
+} dctool_archive_output_t;
+
+static const dctool_output_vtable_t archive_vtable = {
+	sizeof(dctool_archive_output_t), /* size */
+	dctool_archive_output_write, /* write */
+	dctool_archive_output_free, /* free */
+};
+
+dctool_output_t *
+dctool_archive_output_new (dc_context_t *context, const char *filename, dc_family_t family, unsigned int model)
+{
+	dctool_archive_output_t *output = NULL;
+
+	if (filename == NULL)
+		goto error_exit;
+
+	// Allocate memory.
+	output = (dctool_archive_output_t *) dctool_output_allocate (&archive_vtable);
+	if (output == NULL) {
+		goto error_exit;
+	}
+
+	// Open the archive.
+	if (dc_archive_writer_open (&output->writer, context, filename) != DC_STATUS_SUCCESS) {
+		goto error_free;
+	}
+
+	output->family = family;
+	output->model = model;
+
+	return (dctool_output_t *) output;
+
+error_free:
+	dctool_output_deallocate ((dctool_output_t *) output);
+error_exit:
+	return NULL;
+}
+
+static dc_status_t
+dctool_archive_output_write (dctool_output_t *abstract, dc_parser_t *parser, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize)
+{
+	dctool_archive_output_t *output = (dctool_archive_output_t *) abstract;
+	dc_datetime_t dt = {0};
+
+	dc_archive_entry_t entry = {
+		output->family, output->model, -1,
+		fingerprint, fsize,
+		data, size};
+
+	if (dc_parser_get_datetime (parser, &dt) == DC_STATUS_SUCCESS) {
+		entry.datetime = dc_datetime_mktime (&dt);
+	}
+
+	return dc_archive_writer_append (output->writer, &entry);
+}
+
+static dc_status_t
+dctool_archive_output_free (dctool_output_t *abstract)
+{
+	dctool_archive_output_t *output = (dctool_archive_output_t *) abstract;
+
+	return dc_archive_writer_close (output->writer);
+}
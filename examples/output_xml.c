@@ -22,6 +22,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdarg.h>
 
 #include <libdivecomputer/units.h>
 
@@ -34,6 +35,7 @@ static dc_status_t dctool_xml_output_free (dctool_output_t *output);
 typedef struct dctool_xml_output_t {
 	dctool_output_t base;
 	FILE *ostream;
+	dc_buffer_t *buffer;
 	dctool_units_t units;
 } dctool_xml_output_t;
 
@@ -44,11 +46,47 @@ static const dctool_output_vtable_t xml_vtable = {
 };
 
 typedef struct sample_data_t {
-	FILE *ostream;
+	dctool_xml_output_t *output;
 	dctool_units_t units;
 	unsigned int nsamples;
 } sample_data_t;
 
+static void
+xml_printf (dctool_xml_output_t *output, const char *format, ...)
+{
+	va_list ap;
+
+	if (output->ostream) {
+		va_start (ap, format);
+		vfprintf (output->ostream, format, ap);
+		va_end (ap);
+	} else {
+		char line[256];
+
+		va_start (ap, format);
+		int n = vsnprintf (line, sizeof (line), format, ap);
+		va_end (ap);
+		if (n < 0)
+			return;
+
+		if ((size_t) n < sizeof (line)) {
+			dc_buffer_append (output->buffer, (const unsigned char *) line, n);
+			return;
+		}
+
+		// The line is too long for the stack buffer.
+		size_t offset = dc_buffer_get_size (output->buffer);
+		if (!dc_buffer_resize (output->buffer, offset + n + 1))
+			return;
+
+		va_start (ap, format);
+		vsnprintf ((char *) dc_buffer_get_data (output->buffer) + offset, n + 1, format, ap);
+		va_end (ap);
+
+		dc_buffer_resize (output->buffer, offset + n);
+	}
+}
+
 static double
 convert_depth (double value, dctool_units_t units)
 {
@@ -111,73 +149,73 @@ sample_cb (dc_sample_type_t type, const dc_sample_value_t *value, void *userdata
 		seconds = value->time / 1000;
 		milliseconds = value->time % 1000;
 		if (sampledata->nsamples++)
-			fprintf (sampledata->ostream, "</sample>\n");
-		fprintf (sampledata->ostream, "<sample>\n");
+			xml_printf (sampledata->output, "</sample>\n");
+		xml_printf (sampledata->output, "<sample>\n");
 		if (milliseconds) {
-			fprintf (sampledata->ostream, "   <time>%02u:%02u.%03u</time>\n", seconds / 60, seconds % 60, milliseconds);
+			xml_printf (sampledata->output, "   <time>%02u:%02u.%03u</time>\n", seconds / 60, seconds % 60, milliseconds);
 		} else {
-			fprintf (sampledata->ostream, "   <time>%02u:%02u</time>\n", seconds / 60, seconds % 60);
+			xml_printf (sampledata->output, "   <time>%02u:%02u</time>\n", seconds / 60, seconds % 60);
 		}
 		break;
 	case DC_SAMPLE_DEPTH:
-		fprintf (sampledata->ostream, "   <depth>%.2f</depth>\n",
+		xml_printf (sampledata->output, "   <depth>%.2f</depth>\n",
 			convert_depth(value->depth, sampledata->units));
 		break;
 	case DC_SAMPLE_PRESSURE:
-		fprintf (sampledata->ostream, "   <pressure tank=\"%u\">%.2f</pressure>\n",
+		xml_printf (sampledata->output, "   <pressure tank=\"%u\">%.2f</pressure>\n",
 			value->pressure.tank,
 			convert_pressure(value->pressure.value, sampledata->units));
 		break;
 	case DC_SAMPLE_TEMPERATURE:
-		fprintf (sampledata->ostream, "   <temperature>%.2f</temperature>\n",
+		xml_printf (sampledata->output, "   <temperature>%.2f</temperature>\n",
 			convert_temperature(value->temperature, sampledata->units));
 		break;
 	case DC_SAMPLE_EVENT:
 		if (value->event.type != SAMPLE_EVENT_GASCHANGE && value->event.type != SAMPLE_EVENT_GASCHANGE2) {
-			fprintf (sampledata->ostream, "   <event type=\"%u\" time=\"%u\" flags=\"%u\" value=\"%u\">%s</event>\n",
+			xml_printf (sampledata->output, "   <event type=\"%u\" time=\"%u\" flags=\"%u\" value=\"%u\">%s</event>\n",
 				value->event.type, value->event.time, value->event.flags, value->event.value, events[value->event.type]);
 		}
 		break;
 	case DC_SAMPLE_RBT:
-		fprintf (sampledata->ostream, "   <rbt>%u</rbt>\n", value->rbt);
+		xml_printf (sampledata->output, "   <rbt>%u</rbt>\n", value->rbt);
 		break;
 	case DC_SAMPLE_HEARTBEAT:
-		fprintf (sampledata->ostream, "   <heartbeat>%u</heartbeat>\n", value->heartbeat);
+		xml_printf (sampledata->output, "   <heartbeat>%u</heartbeat>\n", value->heartbeat);
 		break;
 	case DC_SAMPLE_BEARING:
-		fprintf (sampledata->ostream, "   <bearing>%u</bearing>\n", value->bearing);
+		xml_printf (sampledata->output, "   <bearing>%u</bearing>\n", value->bearing);
 		break;
 	case DC_SAMPLE_VENDOR:
-		fprintf (sampledata->ostream, "   <vendor type=\"%u\" size=\"%u\">", value->vendor.type, value->vendor.size);
+		xml_printf (sampledata->output, "   <vendor type=\"%u\" size=\"%u\">", value->vendor.type, value->vendor.size);
 		for (unsigned int i = 0; i < value->vendor.size; ++i)
-			fprintf (sampledata->ostream, "%02X", ((const unsigned char *) value->vendor.data)[i]);
-		fprintf (sampledata->ostream, "</vendor>\n");
+			xml_printf (sampledata->output, "%02X", ((const unsigned char *) value->vendor.data)[i]);
+		xml_printf (sampledata->output, "</vendor>\n");
 		break;
 	case DC_SAMPLE_SETPOINT:
-		fprintf (sampledata->ostream, "   <setpoint>%.2f</setpoint>\n", value->setpoint);
+		xml_printf (sampledata->output, "   <setpoint>%.2f</setpoint>\n", value->setpoint);
 		break;
 	case DC_SAMPLE_PPO2:
 		if (value->ppo2.sensor != DC_SENSOR_NONE) {
-			fprintf (sampledata->ostream, "   <ppo2 sensor=\"%u\">%.2f</ppo2>\n", value->ppo2.sensor, value->ppo2.value);
+			xml_printf (sampledata->output, "   <ppo2 sensor=\"%u\">%.2f</ppo2>\n", value->ppo2.sensor, value->ppo2.value);
 		} else {
-			fprintf (sampledata->ostream, "   <ppo2>%.2f</ppo2>\n", value->ppo2.value);
+			xml_printf (sampledata->output, "   <ppo2>%.2f</ppo2>\n", value->ppo2.value);
 		}
 		break;
 	case DC_SAMPLE_CNS:
-		fprintf (sampledata->ostream, "   <cns>%.1f</cns>\n", value->cns * 100.0);
+		xml_printf (sampledata->output, "   <cns>%.1f</cns>\n", value->cns * 100.0);
 		break;
 	case DC_SAMPLE_DECO:
-		fprintf (sampledata->ostream, "   <deco time=\"%u\" depth=\"%.2f\">%s</deco>\n",
+		xml_printf (sampledata->output, "   <deco time=\"%u\" depth=\"%.2f\">%s</deco>\n",
 			value->deco.time,
 			convert_depth(value->deco.depth, sampledata->units),
 			decostop[value->deco.type]);
 		if (value->deco.tts) {
-			fprintf (sampledata->ostream, "   <tts>%u</tts>\n",
+			xml_printf (sampledata->output, "   <tts>%u</tts>\n",
 				value->deco.tts);
 		}
 		break;
 	case DC_SAMPLE_GASMIX:
-		fprintf (sampledata->ostream, "   <gasmix>%u</gasmix>\n", value->gasmix);
+		xml_printf (sampledata->output, "   <gasmix>%u</gasmix>\n", value->gasmix);
 		break;
 	default:
 		break;
@@ -204,6 +242,7 @@ dctool_xml_output_new (const char *filename, dctool_units_t units)
 		goto error_free;
 	}
 
+	output->buffer = NULL;
 	output->units = units;
 
 	fprintf (output->ostream, "<device>\n");
@@ -216,6 +255,30 @@ error_exit:
 	return NULL;
 }
 
+dctool_output_t *
+dctool_xml_output_new_buffer (dc_buffer_t *buffer, dctool_units_t units)
+{
+	dctool_xml_output_t *output = NULL;
+
+	if (buffer == NULL)
+		goto error_exit;
+
+	// Allocate memory.
+	output = (dctool_xml_output_t *) dctool_output_allocate (&xml_vtable);
+	if (output == NULL) {
+		goto error_exit;
+	}
+
+	output->ostream = NULL;
+	output->buffer = buffer;
+	output->units = units;
+
+	return (dctool_output_t *) output;
+
+error_exit:
+	return NULL;
+}
+
 static dc_status_t
 dctool_xml_output_write (dctool_output_t *abstract, dc_parser_t *parser, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize)
 {
@@ -225,16 +288,16 @@ dctool_xml_output_write (dctool_output_t *abstract, dc_parser_t *parser, const u
 	// Initialize the sample data.
 	sample_data_t sampledata = {0};
 	sampledata.nsamples = 0;
-	sampledata.ostream = output->ostream;
+	sampledata.output = output;
 	sampledata.units = output->units;
 
-	fprintf (output->ostream, "<dive>\n<number>%u</number>\n<size>%u</size>\n", abstract->number, size);
+	xml_printf (output, "<dive>\n<number>%u</number>\n<size>%u</size>\n", abstract->number, size);
 
 	if (fingerprint) {
-		fprintf (output->ostream, "<fingerprint>");
+		xml_printf (output, "<fingerprint>");
 		for (unsigned int i = 0; i < fsize; ++i)
-			fprintf (output->ostream, "%02X", fingerprint[i]);
-		fprintf (output->ostream, "</fingerprint>\n");
+			xml_printf (output, "%02X", fingerprint[i]);
+		xml_printf (output, "</fingerprint>\n");
 	}
 
 	// Parse the datetime.
@@ -247,231 +310,143 @@ dctool_xml_output_write (dctool_output_t *abstract, dc_parser_t *parser, const u
 	}
 
 	if (dt.timezone == DC_TIMEZONE_NONE) {
-		fprintf (output->ostream, "<datetime>%04i-%02i-%02i %02i:%02i:%02i</datetime>\n",
+		xml_printf (output, "<datetime>%04i-%02i-%02i %02i:%02i:%02i</datetime>\n",
 			dt.year, dt.month, dt.day,
 			dt.hour, dt.minute, dt.second);
 	} else {
-		fprintf (output->ostream, "<datetime>%04i-%02i-%02i %02i:%02i:%02i %+03i:%02i</datetime>\n",
+		xml_printf (output, "<datetime>%04i-%02i-%02i %02i:%02i:%02i %+03i:%02i</datetime>\n",
 			dt.year, dt.month, dt.day,
 			dt.hour, dt.minute, dt.second,
 			dt.timezone / 3600, (abs(dt.timezone) % 3600) / 60);
 	}
 
-	// Parse the divetime.
-	message ("Parsing the divetime.\n");
-	unsigned int divetime = 0;
-	status = dc_parser_get_field (parser, DC_FIELD_DIVETIME, 0, &divetime);
+	// Parse the fields.
+	message ("Parsing the fields.\n");
+	dc_summary_t summary = {0};
+	status = dc_parser_get_summary (parser, &summary);
 	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
-		ERROR ("Error parsing the divetime.");
+		ERROR ("Error parsing the fields.");
 		goto cleanup;
 	}
 
-	fprintf (output->ostream, "<divetime>%02u:%02u</divetime>\n",
-		divetime / 60, divetime % 60);
-
-	// Parse the maxdepth.
-	message ("Parsing the maxdepth.\n");
-	double maxdepth = 0.0;
-	status = dc_parser_get_field (parser, DC_FIELD_MAXDEPTH, 0, &maxdepth);
-	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
-		ERROR ("Error parsing the maxdepth.");
-		goto cleanup;
-	}
+	xml_printf (output, "<divetime>%02u:%02u</divetime>\n",
+		summary.divetime / 60, summary.divetime % 60);
 
-	fprintf (output->ostream, "<maxdepth>%.2f</maxdepth>\n",
-		convert_depth(maxdepth, output->units));
+	xml_printf (output, "<maxdepth>%.2f</maxdepth>\n",
+		convert_depth(summary.maxdepth, output->units));
 
-	// Parse the avgdepth.
-	message ("Parsing the avgdepth.\n");
-	double avgdepth = 0.0;
-	status = dc_parser_get_field (parser, DC_FIELD_AVGDEPTH, 0, &avgdepth);
-	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
-		ERROR ("Error parsing the avgdepth.");
-		goto cleanup;
+	if (summary.fields & (1u << DC_FIELD_AVGDEPTH)) {
+		xml_printf (output, "<avgdepth>%.2f</avgdepth>\n",
+			convert_depth(summary.avgdepth, output->units));
 	}
 
-	if (status != DC_STATUS_UNSUPPORTED) {
-		fprintf (output->ostream, "<avgdepth>%.2f</avgdepth>\n",
-			convert_depth(avgdepth, output->units));
-	}
-
-	// Parse the temperature.
-	message ("Parsing the temperature.\n");
 	for (unsigned int i = 0; i < 3; ++i) {
 		dc_field_type_t fields[] = {DC_FIELD_TEMPERATURE_SURFACE,
 			DC_FIELD_TEMPERATURE_MINIMUM,
 			DC_FIELD_TEMPERATURE_MAXIMUM};
+		double temperatures[] = {summary.temperature_surface,
+			summary.temperature_minimum,
+			summary.temperature_maximum};
 		const char *names[] = {"surface", "minimum", "maximum"};
 
-		double temperature = 0.0;
-		status = dc_parser_get_field (parser, fields[i], 0, &temperature);
-		if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
-			ERROR ("Error parsing the temperature.");
-			goto cleanup;
-		}
-
-		if (status != DC_STATUS_UNSUPPORTED) {
-			fprintf (output->ostream, "<temperature type=\"%s\">%.1f</temperature>\n",
+		if (summary.fields & (1u << fields[i])) {
+			xml_printf (output, "<temperature type=\"%s\">%.1f</temperature>\n",
 				names[i],
-				convert_temperature(temperature, output->units));
+				convert_temperature(temperatures[i], output->units));
 		}
 	}
 
-	// Parse the gas mixes.
-	message ("Parsing the gas mixes.\n");
-	unsigned int ngases = 0;
-	status = dc_parser_get_field (parser, DC_FIELD_GASMIX_COUNT, 0, &ngases);
-	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
-		ERROR ("Error parsing the gas mix count.");
-		goto cleanup;
-	}
-
-	for (unsigned int i = 0; i < ngases; ++i) {
-		dc_gasmix_t gasmix = {0};
-		status = dc_parser_get_field (parser, DC_FIELD_GASMIX, i, &gasmix);
-		if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
-			ERROR ("Error parsing the gas mix.");
-			goto cleanup;
-		}
+	for (unsigned int i = 0; i < summary.ngasmixes; ++i) {
+		const dc_gasmix_t *gasmix = summary.gasmix + i;
 
-		fprintf (output->ostream,
+		xml_printf (output,
 			"<gasmix>\n"
 			"   <he>%.1f</he>\n"
 			"   <o2>%.1f</o2>\n"
 			"   <n2>%.1f</n2>\n",
-			gasmix.helium * 100.0,
-			gasmix.oxygen * 100.0,
-			gasmix.nitrogen * 100.0);
-		if (gasmix.usage) {
+			gasmix->helium * 100.0,
+			gasmix->oxygen * 100.0,
+			gasmix->nitrogen * 100.0);
+		if (gasmix->usage) {
 			const char *usage[] = {"none", "oxygen", "diluent", "sidemount"};
-			fprintf (output->ostream,
+			xml_printf (output,
 				"   <usage>%s</usage>\n",
-				usage[gasmix.usage]);
+				usage[gasmix->usage]);
 		}
-		fprintf (output->ostream,
+		xml_printf (output,
 			"</gasmix>\n");
 
 	}
 
-	// Parse the tanks.
-	message ("Parsing the tanks.\n");
-	unsigned int ntanks = 0;
-	status = dc_parser_get_field (parser, DC_FIELD_TANK_COUNT, 0, &ntanks);
-	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
-		ERROR ("Error parsing the tank count.");
-		goto cleanup;
-	}
-
-	for (unsigned int i = 0; i < ntanks; ++i) {
+	for (unsigned int i = 0; i < summary.ntanks; ++i) {
 		const char *names[] = {"none", "metric", "imperial"};
+		const dc_tank_t *tank = summary.tank + i;
 
-		dc_tank_t tank = {0};
-		status = dc_parser_get_field (parser, DC_FIELD_TANK, i, &tank);
-		if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
-			ERROR ("Error parsing the tank.");
-			goto cleanup;
-		}
-
-		fprintf (output->ostream, "<tank>\n");
-		if (tank.gasmix != DC_GASMIX_UNKNOWN) {
-			fprintf (output->ostream,
+		xml_printf (output, "<tank>\n");
+		if (tank->gasmix != DC_GASMIX_UNKNOWN) {
+			xml_printf (output,
 				"   <gasmix>%u</gasmix>\n",
-				tank.gasmix);
+				tank->gasmix);
 		}
-		if (tank.usage) {
+		if (tank->usage) {
 			const char *usage[] = {"none", "oxygen", "diluent", "sidemount"};
-			fprintf (output->ostream,
+			xml_printf (output,
 				"   <usage>%s</usage>\n",
-				usage[tank.usage]);
+				usage[tank->usage]);
 		}
-		if (tank.type != DC_TANKVOLUME_NONE) {
-			fprintf (output->ostream,
+		if (tank->type != DC_TANKVOLUME_NONE) {
+			xml_printf (output,
 				"   <type>%s</type>\n"
 				"   <volume>%.1f</volume>\n"
 				"   <workpressure>%.2f</workpressure>\n",
-				names[tank.type],
-				convert_volume(tank.volume, output->units),
-				convert_pressure(tank.workpressure, output->units));
+				names[tank->type],
+				convert_volume(tank->volume, output->units),
+				convert_pressure(tank->workpressure, output->units));
 		}
-		fprintf (output->ostream,
+		xml_printf (output,
 			"   <beginpressure>%.2f</beginpressure>\n"
 			"   <endpressure>%.2f</endpressure>\n"
 			"</tank>\n",
-			convert_pressure(tank.beginpressure, output->units),
-			convert_pressure(tank.endpressure, output->units));
-	}
-
-	// Parse the dive mode.
-	message ("Parsing the dive mode.\n");
-	dc_divemode_t divemode = DC_DIVEMODE_OC;
-	status = dc_parser_get_field (parser, DC_FIELD_DIVEMODE, 0, &divemode);
-	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
-		ERROR ("Error parsing the dive mode.");
-		goto cleanup;
+			convert_pressure(tank->beginpressure, output->units),
+			convert_pressure(tank->endpressure, output->units));
 	}
 
-	if (status != DC_STATUS_UNSUPPORTED) {
+	if (summary.fields & (1u << DC_FIELD_DIVEMODE)) {
 		const char *names[] = {"freedive", "gauge", "oc", "ccr", "scr"};
-		fprintf (output->ostream, "<divemode>%s</divemode>\n",
-			names[divemode]);
-	}
-
-	// Parse the deco model.
-	message ("Parsing the deco model.\n");
-	dc_decomodel_t decomodel = {DC_DECOMODEL_NONE};
-	status = dc_parser_get_field (parser, DC_FIELD_DECOMODEL, 0, &decomodel);
-	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
-		ERROR ("Error parsing the deco model.");
-		goto cleanup;
+		xml_printf (output, "<divemode>%s</divemode>\n",
+			names[summary.divemode]);
 	}
 
-	if (status != DC_STATUS_UNSUPPORTED) {
+	if (summary.fields & (1u << DC_FIELD_DECOMODEL)) {
+		const dc_decomodel_t *decomodel = &summary.decomodel;
 		const char *names[] = {"none", "buhlmann", "vpm", "rgbm", "dciem"};
-		fprintf (output->ostream, "<decomodel>%s</decomodel>\n",
-			names[decomodel.type]);
-		if (decomodel.type == DC_DECOMODEL_BUHLMANN &&
-			(decomodel.params.gf.low != 0 || decomodel.params.gf.high != 0)) {
-			fprintf (output->ostream, "<gf>%u/%u</gf>\n",
-				decomodel.params.gf.low, decomodel.params.gf.high);
+		xml_printf (output, "<decomodel>%s</decomodel>\n",
+			names[decomodel->type]);
+		if (decomodel->type == DC_DECOMODEL_BUHLMANN &&
+			(decomodel->params.gf.low != 0 || decomodel->params.gf.high != 0)) {
+			xml_printf (output, "<gf>%u/%u</gf>\n",
+				decomodel->params.gf.low, decomodel->params.gf.high);
 		}
-		if (decomodel.conservatism) {
-			fprintf (output->ostream, "<conservatism>%d</conservatism>\n",
-				decomodel.conservatism);
+		if (decomodel->conservatism) {
+			xml_printf (output, "<conservatism>%d</conservatism>\n",
+				decomodel->conservatism);
 		}
 	}
 
-	// Parse the salinity.
-	message ("Parsing the salinity.\n");
-	dc_salinity_t salinity = {DC_WATER_FRESH, 0.0};
-	status = dc_parser_get_field (parser, DC_FIELD_SALINITY, 0, &salinity);
-	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
-		ERROR ("Error parsing the salinity.");
-		goto cleanup;
-	}
-
-	if (status != DC_STATUS_UNSUPPORTED) {
+	if (summary.fields & (1u << DC_FIELD_SALINITY)) {
 		const char *names[] = {"fresh", "salt"};
-		if (salinity.density) {
-			fprintf (output->ostream, "<salinity density=\"%.1f\">%s</salinity>\n",
-				salinity.density, names[salinity.type]);
+		if (summary.salinity.density) {
+			xml_printf (output, "<salinity density=\"%.1f\">%s</salinity>\n",
+				summary.salinity.density, names[summary.salinity.type]);
 		} else {
-			fprintf (output->ostream, "<salinity>%s</salinity>\n",
-				names[salinity.type]);
+			xml_printf (output, "<salinity>%s</salinity>\n",
+				names[summary.salinity.type]);
 		}
 	}
 
-	// Parse the atmospheric pressure.
-	message ("Parsing the atmospheric pressure.\n");
-	double atmospheric = 0.0;
-	status = dc_parser_get_field (parser, DC_FIELD_ATMOSPHERIC, 0, &atmospheric);
-	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
-		ERROR ("Error parsing the atmospheric pressure.");
-		goto cleanup;
-	}
-
-	if (status != DC_STATUS_UNSUPPORTED) {
-		fprintf (output->ostream, "<atmospheric>%.5f</atmospheric>\n",
-			convert_pressure(atmospheric, output->units));
+	if (summary.fields & (1u << DC_FIELD_ATMOSPHERIC)) {
+		xml_printf (output, "<atmospheric>%.5f</atmospheric>\n",
+			convert_pressure(summary.atmospheric, output->units));
 	}
 
 	// Parse the sample data.
@@ -485,8 +460,8 @@ dctool_xml_output_write (dctool_output_t *abstract, dc_parser_t *parser, const u
 cleanup:
 
 	if (sampledata.nsamples)
-		fprintf (output->ostream, "</sample>\n");
-	fprintf (output->ostream, "</dive>\n");
+		xml_printf (output, "</sample>\n");
+	xml_printf (output, "</dive>\n");
 
 	return status;
 }
@@ -496,9 +471,28 @@ dctool_xml_output_free (dctool_output_t *abstract)
 {
 	dctool_xml_output_t *output = (dctool_xml_output_t *) abstract;
 
+	if (output->ostream == NULL)
+		return DC_STATUS_SUCCESS;
+
 	fprintf (output->ostream, "</device>\n");
 
 	fclose (output->ostream);
 
 	return DC_STATUS_SUCCESS;
 }
+
+dc_status_t
+dctool_xml_output_write_fragment (dctool_output_t *abstract, const unsigned char data[], unsigned int size)
+{
+	dctool_xml_output_t *output = (dctool_xml_output_t *) abstract;
+
+	if (output == NULL || abstract->vtable != &xml_vtable || output->ostream == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	if (size && fwrite (data, 1, size, output->ostream) != size)
+		return DC_STATUS_IO;
+
+	abstract->number++;
+
+	return DC_STATUS_SUCCESS;
+}
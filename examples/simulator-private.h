@@ -0,0 +1,131 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DCTOOL_SIMULATOR_PRIVATE_H
+#define DCTOOL_SIMULATOR_PRIVATE_H
+
+#include <libdivecomputer/common.h>
+#include <libdivecomputer/buffer.h>
+
+#include "simulator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+typedef struct dctool_simulator_vtable_t dctool_simulator_vtable_t;
+
+typedef unsigned long long dctool_nsecs_t;
+
+/*
+ * A contiguous range of bytes in the output queue, which the device
+ * started to transmit at the same time.
+ */
+typedef struct dctool_simulator_segment_t {
+	unsigned long long begin;
+	unsigned long long end;
+	dctool_nsecs_t start;
+} dctool_simulator_segment_t;
+
+struct dctool_simulator_t {
+	const dctool_simulator_vtable_t *vtable;
+	dc_buffer_t *memory;
+	dctool_simulator_link_t link;
+	dc_transport_t transport;
+	dc_iostream_t *iostream;
+	int timeout;
+	dctool_nsecs_t bytetime;
+	/* Virtual clock (nanoseconds). */
+	dctool_nsecs_t now;
+	dctool_nsecs_t devtime;
+	dctool_nsecs_t txbusy;
+	dctool_nsecs_t rxbusy;
+	/* Bytes received by the device, but not processed yet. */
+	dc_buffer_t *input;
+	/* Bytes sent by the device, but not read by the host yet. The
+	 * first byte in the buffer has the absolute position 'offset'. */
+	dc_buffer_t *output;
+	unsigned long long offset;
+	unsigned long long position;
+	dctool_simulator_segment_t *segments;
+	unsigned int nsegments;
+	unsigned int nallocated;
+};
+
+struct dctool_simulator_vtable_t {
+	size_t size;
+	const char *name;
+	dc_family_t family;
+	unsigned int model;
+	dc_transport_t transport;
+
+	/* Reset the protocol state. */
+	void (*reset) (dctool_simulator_t *simulator);
+
+	/* Process the data received by the device, and return the number of
+	 * bytes that were consumed. Zero means more data is needed. */
+	unsigned int (*process) (dctool_simulator_t *simulator, const unsigned char data[], unsigned int size);
+
+	dc_status_t (*free) (dctool_simulator_t *simulator);
+
+	/* The BLE packet framing, or NULL without BLE support. Every packet
+	 * written by the host is unpacked, and its payload is passed on to
+	 * the process function. Every answer is split into packets with at
+	 * most 'payload' data bytes, and a header created by the pack
+	 * function. Both functions return the size of the header. */
+	unsigned int payload;
+	unsigned int (*unpack) (dctool_simulator_t *simulator, const unsigned char packet[], unsigned int size, unsigned int *length);
+	unsigned int (*pack) (dctool_simulator_t *simulator, unsigned char header[], unsigned int index, unsigned int count, unsigned int length);
+
+	/* Handle an ioctl request, or NULL if there are none. */
+	dc_status_t (*ioctl) (dctool_simulator_t *simulator, unsigned int request, void *data, size_t size);
+};
+
+/*
+ * Allocate a simulator with a copy of the memory image, or an empty
+ * memory if there is no image.
+ */
+dctool_simulator_t *
+dctool_simulator_allocate (const dctool_simulator_vtable_t *vtable, dc_buffer_t *image);
+
+void
+dctool_simulator_deallocate (dctool_simulator_t *simulator);
+
+/*
+ * Send data from the device to the host. The device starts to transmit
+ * after the delay (in microseconds) has passed since it received the
+ * command, and after all previous answers have been transmitted. Over
+ * BLE, the data is sent in one or more packets.
+ */
+void
+dctool_simulator_reply (dctool_simulator_t *simulator, unsigned int delay, const unsigned char data[], unsigned int size);
+
+/*
+ * Pseudo random data for the synthetic memories. The same seed always
+ * generates the same data.
+ */
+unsigned int
+dctool_simulator_random (unsigned int *seed);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DCTOOL_SIMULATOR_PRIVATE_H */
@@ -0,0 +1,585 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include <libdivecomputer/custom.h>
+
+#include "simulator-private.h"
+
+#define NSECS_PER_USEC 1000ULL
+#define NSECS_PER_MSEC 1000000ULL
+#define NSECS_PER_SEC  1000000000ULL
+
+#define MAX(a,b)	(((a) > (b)) ? (a) : (b))
+
+#define MAXPACKET 256
+
+static dc_status_t dctool_simulator_set_timeout (void *userdata, int timeout);
+static dc_status_t dctool_simulator_get_available (void *userdata, size_t *value);
+static dc_status_t dctool_simulator_configure (void *userdata, unsigned int baudrate, unsigned int databits, dc_parity_t parity, dc_stopbits_t stopbits, dc_flowcontrol_t flowcontrol);
+static dc_status_t dctool_simulator_poll (void *userdata, int timeout);
+static dc_status_t dctool_simulator_read (void *userdata, void *data, size_t size, size_t *actual);
+static dc_status_t dctool_simulator_write (void *userdata, const void *data, size_t size, size_t *actual);
+static dc_status_t dctool_simulator_ioctl (void *userdata, unsigned int request, void *data, size_t size);
+static dc_status_t dctool_simulator_purge (void *userdata, dc_direction_t direction);
+static dc_status_t dctool_simulator_sleep (void *userdata, unsigned int milliseconds);
+static dc_status_t dctool_simulator_close (void *userdata);
+
+static const dc_custom_cbs_t dctool_simulator_callbacks = {
+	dctool_simulator_set_timeout, /* set_timeout */
+	NULL, /* set_break */
+	NULL, /* set_dtr */
+	NULL, /* set_rts */
+	NULL, /* get_lines */
+	dctool_simulator_get_available, /* get_available */
+	dctool_simulator_configure, /* configure */
+	dctool_simulator_poll, /* poll */
+	dctool_simulator_read, /* read */
+	dctool_simulator_write, /* write */
+	dctool_simulator_ioctl, /* ioctl */
+	NULL, /* flush */
+	dctool_simulator_purge, /* purge */
+	dctool_simulator_sleep, /* sleep */
+	dctool_simulator_close, /* close */
+};
+
+dctool_simulator_t *
+dctool_simulator_allocate (const dctool_simulator_vtable_t *vtable, dc_buffer_t *image)
+{
+	dctool_simulator_t *simulator = NULL;
+
+	assert(vtable != NULL);
+	assert(vtable->size >= sizeof(dctool_simulator_t));
+
+	// Allocate memory.
+	simulator = (dctool_simulator_t *) malloc (vtable->size);
+	if (simulator == NULL) {
+		return simulator;
+	}
+
+	memset (simulator, 0, vtable->size);
+	simulator->vtable = vtable;
+	simulator->timeout = -1;
+
+	simulator->memory = dc_buffer_new (0);
+	simulator->input = dc_buffer_new (0);
+	simulator->output = dc_buffer_new (0);
+	if (simulator->memory == NULL || simulator->input == NULL || simulator->output == NULL) {
+		goto error_free;
+	}
+
+	if (image && !dc_buffer_append (simulator->memory, dc_buffer_get_data (image), dc_buffer_get_size (image))) {
+		goto error_free;
+	}
+
+	return simulator;
+
+error_free:
+	dctool_simulator_deallocate (simulator);
+	return NULL;
+}
+
+void
+dctool_simulator_deallocate (dctool_simulator_t *simulator)
+{
+	if (simulator == NULL)
+		return;
+
+	free (simulator->segments);
+	dc_buffer_free (simulator->output);
+	dc_buffer_free (simulator->input);
+	dc_buffer_free (simulator->memory);
+	free (simulator);
+}
+
+unsigned int
+dctool_simulator_random (unsigned int *seed)
+{
+	*seed = *seed * 1103515245 + 12345;
+	return (*seed >> 16) & 0x7FFF;
+}
+
+/*
+ * Get the time at which the byte at the absolute position arrives at
+ * the host.
+ */
+static dctool_nsecs_t
+dctool_simulator_arrival (dctool_simulator_t *simulator, unsigned long long position)
+{
+	dctool_nsecs_t latency = simulator->link.latency * NSECS_PER_USEC;
+
+	for (unsigned int i = 0; i < simulator->nsegments; ++i) {
+		const dctool_simulator_segment_t *segment = simulator->segments + i;
+		if (position < segment->end) {
+			return segment->start + (position - segment->begin + 1) * simulator->bytetime + latency;
+		}
+	}
+
+	return simulator->now;
+}
+
+/*
+ * Get the number of unread bytes that have arrived at the host before
+ * the deadline.
+ */
+static size_t
+dctool_simulator_arrived (dctool_simulator_t *simulator, dctool_nsecs_t deadline)
+{
+	dctool_nsecs_t latency = simulator->link.latency * NSECS_PER_USEC;
+	size_t count = 0;
+
+	// The segments are transmitted one after the other, so the search
+	// can stop at the first segment that isn't complete.
+	for (unsigned int i = 0; i < simulator->nsegments; ++i) {
+		const dctool_simulator_segment_t *segment = simulator->segments + i;
+		if (segment->end <= simulator->position)
+			continue;
+
+		unsigned long long begin = MAX (segment->begin, simulator->position);
+		unsigned long long skip = begin - segment->begin;
+		unsigned long long length = segment->end - begin;
+
+		dctool_nsecs_t first = segment->start + latency;
+		if (deadline < first + (skip + 1) * simulator->bytetime)
+			break;
+
+		unsigned long long n = length;
+		if (simulator->bytetime) {
+			n = (deadline - first) / simulator->bytetime - skip;
+			if (n > length)
+				n = length;
+		}
+
+		count += n;
+		if (n < length)
+			break;
+	}
+
+	return count;
+}
+
+/*
+ * Remove the bytes that have been read by the host.
+ */
+static void
+dctool_simulator_consume (dctool_simulator_t *simulator, size_t size)
+{
+	simulator->position += size;
+
+	// The output buffer is emptied once everything has been read. Most
+	// protocols wait for the answer before sending the next command, so
+	// this happens frequently enough to keep the buffer small.
+	if (simulator->position == simulator->offset + dc_buffer_get_size (simulator->output)) {
+		dc_buffer_clear (simulator->output);
+		simulator->offset = simulator->position;
+		simulator->nsegments = 0;
+	}
+}
+
+/*
+ * Get the number of bytes left in the packet at the current position.
+ */
+static unsigned long long
+dctool_simulator_packet (dctool_simulator_t *simulator)
+{
+	for (unsigned int i = 0; i < simulator->nsegments; ++i) {
+		const dctool_simulator_segment_t *segment = simulator->segments + i;
+		if (simulator->position < segment->end) {
+			return segment->end - simulator->position;
+		}
+	}
+
+	return 0;
+}
+
+static void
+dctool_simulator_transmit (dctool_simulator_t *simulator, unsigned int delay, const unsigned char data[], unsigned int size)
+{
+	if (size == 0)
+		return;
+
+	if (simulator->nsegments >= simulator->nallocated) {
+		unsigned int nallocated = simulator->nallocated ? simulator->nallocated * 2 : 16;
+		dctool_simulator_segment_t *segments = (dctool_simulator_segment_t *) realloc (simulator->segments, nallocated * sizeof (dctool_simulator_segment_t));
+		if (segments == NULL)
+			return;
+		simulator->segments = segments;
+		simulator->nallocated = nallocated;
+	}
+
+	if (!dc_buffer_append (simulator->output, data, size))
+		return;
+
+	dctool_nsecs_t start = MAX (simulator->devtime + delay * NSECS_PER_USEC, simulator->rxbusy);
+
+	dctool_simulator_segment_t *segment = simulator->segments + simulator->nsegments++;
+	segment->begin = simulator->offset + dc_buffer_get_size (simulator->output) - size;
+	segment->end = segment->begin + size;
+	segment->start = start;
+
+	simulator->rxbusy = start + size * simulator->bytetime;
+}
+
+void
+dctool_simulator_reply (dctool_simulator_t *simulator, unsigned int delay, const unsigned char data[], unsigned int size)
+{
+	const dctool_simulator_vtable_t *vtable = simulator->vtable;
+
+	if (simulator->transport != DC_TRANSPORT_BLE) {
+		dctool_simulator_transmit (simulator, delay, data, size);
+		return;
+	}
+
+	// Every packet is a separate segment, such that the host receives
+	// exactly one packet with every read.
+	unsigned int count = (size + vtable->payload - 1) / vtable->payload;
+	for (unsigned int i = 0; i < count; ++i) {
+		unsigned char packet[MAXPACKET];
+		unsigned int length = size - i * vtable->payload;
+		if (length > vtable->payload)
+			length = vtable->payload;
+
+		unsigned int n = vtable->pack (simulator, packet, i, count, length);
+		assert (n + length <= sizeof (packet));
+		memcpy (packet + n, data + i * vtable->payload, length);
+
+		dctool_simulator_transmit (simulator, delay, packet, n + length);
+	}
+}
+
+const char *
+dctool_simulator_get_name (dctool_simulator_t *simulator)
+{
+	if (simulator == NULL)
+		return NULL;
+
+	return simulator->vtable->name;
+}
+
+dc_family_t
+dctool_simulator_get_family (dctool_simulator_t *simulator)
+{
+	if (simulator == NULL)
+		return DC_FAMILY_NULL;
+
+	return simulator->vtable->family;
+}
+
+unsigned int
+dctool_simulator_get_model (dctool_simulator_t *simulator)
+{
+	if (simulator == NULL)
+		return 0;
+
+	return simulator->vtable->model;
+}
+
+dc_transport_t
+dctool_simulator_get_transports (dctool_simulator_t *simulator)
+{
+	if (simulator == NULL)
+		return DC_TRANSPORT_NONE;
+
+	if (simulator->vtable->pack && simulator->vtable->unpack)
+		return simulator->vtable->transport | DC_TRANSPORT_BLE;
+
+	return simulator->vtable->transport;
+}
+
+dc_status_t
+dctool_simulator_open (dctool_simulator_t *simulator, dc_iostream_t **iostream, dc_context_t *context, const dctool_simulator_link_t *link)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (simulator == NULL || iostream == NULL || link == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	if (simulator->iostream)
+		return DC_STATUS_INVALIDARGS;
+
+	dc_transport_t transport = link->transport ? link->transport : simulator->vtable->transport;
+	if ((dctool_simulator_get_transports (simulator) & transport) != transport)
+		return DC_STATUS_UNSUPPORTED;
+
+	// Reset the link and the virtual clock.
+	simulator->link = *link;
+	simulator->transport = transport;
+	simulator->timeout = -1;
+	simulator->bytetime = link->bandwidth ? NSECS_PER_SEC / link->bandwidth : 0;
+	simulator->now = 0;
+	simulator->devtime = 0;
+	simulator->txbusy = 0;
+	simulator->rxbusy = 0;
+
+	// Discard any leftovers from a previous session.
+	dc_buffer_clear (simulator->input);
+	dc_buffer_clear (simulator->output);
+	simulator->offset = 0;
+	simulator->position = 0;
+	simulator->nsegments = 0;
+
+	if (simulator->vtable->reset) {
+		simulator->vtable->reset (simulator);
+	}
+
+	status = dc_custom_open (&simulator->iostream, context, transport, &dctool_simulator_callbacks, simulator);
+	if (status != DC_STATUS_SUCCESS) {
+		return status;
+	}
+
+	*iostream = simulator->iostream;
+
+	return DC_STATUS_SUCCESS;
+}
+
+unsigned long long
+dctool_simulator_get_elapsed (dctool_simulator_t *simulator)
+{
+	if (simulator == NULL)
+		return 0;
+
+	return simulator->now / NSECS_PER_USEC;
+}
+
+dc_status_t
+dctool_simulator_free (dctool_simulator_t *simulator)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (simulator == NULL)
+		return DC_STATUS_SUCCESS;
+
+	if (simulator->vtable->free) {
+		status = simulator->vtable->free (simulator);
+	}
+
+	dctool_simulator_deallocate (simulator);
+
+	return status;
+}
+
+static dc_status_t
+dctool_simulator_set_timeout (void *userdata, int timeout)
+{
+	dctool_simulator_t *simulator = (dctool_simulator_t *) userdata;
+
+	simulator->timeout = timeout;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dctool_simulator_get_available (void *userdata, size_t *value)
+{
+	dctool_simulator_t *simulator = (dctool_simulator_t *) userdata;
+
+	if (value)
+		*value = dctool_simulator_arrived (simulator, simulator->now);
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dctool_simulator_configure (void *userdata, unsigned int baudrate, unsigned int databits, dc_parity_t parity, dc_stopbits_t stopbits, dc_flowcontrol_t flowcontrol)
+{
+	dctool_simulator_t *simulator = (dctool_simulator_t *) userdata;
+
+	if (baudrate == 0)
+		return DC_STATUS_INVALIDARGS;
+
+	// There is no serial line over BLE.
+	if (simulator->transport == DC_TRANSPORT_BLE)
+		return DC_STATUS_SUCCESS;
+
+	// Number of bits per character, including the start and stop bits.
+	unsigned int nbits = 1 + databits + (parity != DC_PARITY_NONE) +
+		(stopbits == DC_STOPBITS_TWO ? 2 : 1);
+
+	// The slowest of the serial line and the link determines the time
+	// needed to transmit a byte.
+	dctool_nsecs_t serial = nbits * NSECS_PER_SEC / baudrate;
+	dctool_nsecs_t link = simulator->link.bandwidth ? NSECS_PER_SEC / simulator->link.bandwidth : 0;
+	simulator->bytetime = MAX (serial, link);
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dctool_simulator_poll (void *userdata, int timeout)
+{
+	dctool_simulator_t *simulator = (dctool_simulator_t *) userdata;
+	unsigned long long available = simulator->offset + dc_buffer_get_size (simulator->output) - simulator->position;
+
+	if (available) {
+		dctool_nsecs_t arrival = dctool_simulator_arrival (simulator, simulator->position);
+		if (timeout < 0 || arrival <= simulator->now + timeout * NSECS_PER_MSEC) {
+			simulator->now = MAX (simulator->now, arrival);
+			return DC_STATUS_SUCCESS;
+		}
+	}
+
+	if (timeout > 0)
+		simulator->now += timeout * NSECS_PER_MSEC;
+
+	return DC_STATUS_TIMEOUT;
+}
+
+static dc_status_t
+dctool_simulator_read (void *userdata, void *data, size_t size, size_t *actual)
+{
+	dctool_simulator_t *simulator = (dctool_simulator_t *) userdata;
+	dc_status_t status = DC_STATUS_SUCCESS;
+	unsigned long long available = simulator->offset + dc_buffer_get_size (simulator->output) - simulator->position;
+	size_t nbytes = 0;
+
+	// Over BLE, every read returns at most one packet.
+	if (simulator->transport == DC_TRANSPORT_BLE && available) {
+		available = dctool_simulator_packet (simulator);
+		if (size > available)
+			size = available;
+	}
+
+	// All answers are queued as soon as the device receives the command,
+	// so the arrival time of every byte is already known. The host only
+	// needs to wait for the last byte, or until the timeout expires.
+	if (available >= size) {
+		dctool_nsecs_t arrival = size ? dctool_simulator_arrival (simulator, simulator->position + size - 1) : simulator->now;
+		if (simulator->timeout < 0 || arrival <= simulator->now + simulator->timeout * NSECS_PER_MSEC) {
+			simulator->now = MAX (simulator->now, arrival);
+			nbytes = size;
+		}
+	}
+
+	if (nbytes < size) {
+		// Without a timeout, nothing more will ever arrive. Return the
+		// remaining data, instead of blocking forever.
+		dctool_nsecs_t deadline = simulator->now;
+		if (simulator->timeout >= 0) {
+			deadline += simulator->timeout * NSECS_PER_MSEC;
+		} else if (available) {
+			deadline = MAX (deadline, dctool_simulator_arrival (simulator, simulator->position + available - 1));
+		}
+
+		nbytes = dctool_simulator_arrived (simulator, deadline);
+		if (nbytes > size)
+			nbytes = size;
+
+		simulator->now = deadline;
+		status = DC_STATUS_TIMEOUT;
+	}
+
+	if (nbytes) {
+		const unsigned char *output = dc_buffer_get_data (simulator->output);
+		memcpy (data, output + (simulator->position - simulator->offset), nbytes);
+		dctool_simulator_consume (simulator, nbytes);
+	}
+
+	if (actual)
+		*actual = nbytes;
+
+	return status;
+}
+
+static dc_status_t
+dctool_simulator_write (void *userdata, const void *data, size_t size, size_t *actual)
+{
+	dctool_simulator_t *simulator = (dctool_simulator_t *) userdata;
+
+	// The data is transmitted in the background, and arrives at the
+	// device after the last byte has been transmitted.
+	dctool_nsecs_t start = MAX (simulator->now, simulator->txbusy);
+	simulator->txbusy = start + size * simulator->bytetime;
+	simulator->devtime = simulator->txbusy + simulator->link.latency * NSECS_PER_USEC;
+
+	if (simulator->transport == DC_TRANSPORT_BLE) {
+		// Only the payload of the packet is passed on.
+		unsigned int length = 0;
+		unsigned int n = simulator->vtable->unpack (simulator, data, size, &length);
+		if (!dc_buffer_append (simulator->input, (const unsigned char *) data + n, length))
+			return DC_STATUS_NOMEMORY;
+	} else {
+		if (!dc_buffer_append (simulator->input, data, size))
+			return DC_STATUS_NOMEMORY;
+	}
+
+	while (dc_buffer_get_size (simulator->input)) {
+		unsigned int n = simulator->vtable->process (simulator,
+			dc_buffer_get_data (simulator->input),
+			dc_buffer_get_size (simulator->input));
+		if (n == 0)
+			break;
+
+		dc_buffer_slice (simulator->input, n, dc_buffer_get_size (simulator->input) - n);
+	}
+
+	if (actual)
+		*actual = size;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dctool_simulator_ioctl (void *userdata, unsigned int request, void *data, size_t size)
+{
+	dctool_simulator_t *simulator = (dctool_simulator_t *) userdata;
+
+	if (simulator->vtable->ioctl == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	return simulator->vtable->ioctl (simulator, request, data, size);
+}
+
+static dc_status_t
+dctool_simulator_purge (void *userdata, dc_direction_t direction)
+{
+	dctool_simulator_t *simulator = (dctool_simulator_t *) userdata;
+
+	// Only the bytes that already arrived are discarded. Bytes that are
+	// still on their way arrive after the purge.
+	if (direction & DC_DIRECTION_INPUT) {
+		dctool_simulator_consume (simulator, dctool_simulator_arrived (simulator, simulator->now));
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dctool_simulator_sleep (void *userdata, unsigned int milliseconds)
+{
+	dctool_simulator_t *simulator = (dctool_simulator_t *) userdata;
+
+	simulator->now += milliseconds * NSECS_PER_MSEC;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dctool_simulator_close (void *userdata)
+{
+	dctool_simulator_t *simulator = (dctool_simulator_t *) userdata;
+
+	simulator->iostream = NULL;
+
+	return DC_STATUS_SUCCESS;
+}
@@ -0,0 +1,126 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DCTOOL_SIMULATOR_H
+#define DCTOOL_SIMULATOR_H
+
+#include <libdivecomputer/common.h>
+#include <libdivecomputer/context.h>
+#include <libdivecomputer/iostream.h>
+#include <libdivecomputer/buffer.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * A simulated dive computer.
+ *
+ * The simulator emulates the communication protocol of a dive computer
+ * on top of a custom I/O stream, backed by an emulated memory. The
+ * memory is either a replay of an existing memory dump, or synthetic
+ * data generated by the simulator.
+ *
+ * All timing is simulated with a virtual clock. The host advances the
+ * clock by sleeping, and by waiting for the bytes of the answer to
+ * arrive. Thus a download completes as fast as the cpu allows, while
+ * the elapsed virtual time is the time the download would take over
+ * the simulated link.
+ */
+typedef struct dctool_simulator_t dctool_simulator_t;
+
+/*
+ * The link model.
+ *
+ * Every transfer, in either direction, is delayed by the latency.
+ * Every byte takes the time needed to transmit it at the bandwidth,
+ * limited by the baudrate that is configured by the backend. With a
+ * zero bandwidth, only the baudrate is used.
+ *
+ * The transport is the native transport of the simulated device, or
+ * DC_TRANSPORT_BLE for a BLE connection. Over BLE, the data is sent in
+ * packets with the framing of the device, and the baudrate is ignored.
+ */
+typedef struct dctool_simulator_link_t {
+	unsigned int latency;   /* One-way latency (microseconds) */
+	unsigned int bandwidth; /* Bandwidth (bytes per second) */
+	dc_transport_t transport; /* Transport (DC_TRANSPORT_NONE for native) */
+} dctool_simulator_link_t;
+
+/*
+ * Create a simulator. The memory image is copied. Without a memory
+ * image, a synthetic memory is generated. NULL is returned if the
+ * memory image has an invalid size.
+ */
+dctool_simulator_t *
+dctool_oceanic_atom2_simulator_new (dc_buffer_t *image);
+
+dctool_simulator_t *
+dctool_shearwater_predator_simulator_new (dc_buffer_t *image);
+
+dctool_simulator_t *
+dctool_suunto_vyper_simulator_new (dc_buffer_t *image);
+
+dctool_simulator_t *
+dctool_hw_ostc3_simulator_new (dc_buffer_t *image);
+
+dctool_simulator_t *
+dctool_uwatec_smart_simulator_new (dc_buffer_t *image);
+
+const char *
+dctool_simulator_get_name (dctool_simulator_t *simulator);
+
+dc_family_t
+dctool_simulator_get_family (dctool_simulator_t *simulator);
+
+unsigned int
+dctool_simulator_get_model (dctool_simulator_t *simulator);
+
+/*
+ * Get the transports supported by the simulator.
+ */
+dc_transport_t
+dctool_simulator_get_transports (dctool_simulator_t *simulator);
+
+/*
+ * Open an I/O stream connected to the simulated device. The device
+ * and the virtual clock are reset first. Only one I/O stream can be
+ * open at the same time, and it should be closed before the simulator
+ * is freed. DC_STATUS_UNSUPPORTED is returned if the simulator doesn't
+ * support the transport of the link.
+ */
+dc_status_t
+dctool_simulator_open (dctool_simulator_t *simulator, dc_iostream_t **iostream, dc_context_t *context, const dctool_simulator_link_t *link);
+
+/*
+ * Get the virtual time (in microseconds) since the I/O stream was
+ * opened.
+ */
+unsigned long long
+dctool_simulator_get_elapsed (dctool_simulator_t *simulator);
+
+dc_status_t
+dctool_simulator_free (dctool_simulator_t *simulator);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DCTOOL_SIMULATOR_H */
@@ -0,0 +1,334 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "simulator-private.h"
+
+#define SZ_VERSION    64
+#define SZ_HARDWARE2  5
+#define SZ_MEMORY     0x400000
+
+#define RB_LOGBOOK_SIZE_COMPACT  16
+#define RB_LOGBOOK_SIZE_FULL     256
+#define RB_LOGBOOK_COUNT         256
+#define RB_LOGBOOK_BLOCK         0x1000
+
+#define RB_PROFILE_BEGIN 0x200000
+#define RB_PROFILE_END   SZ_MEMORY
+
+#define S_BLOCK_READ 0x20
+#define S_READY      0x4C
+#define READY        0x4D
+#define HARDWARE2    0x60
+#define HEADER       0x61
+#define DIVE         0x66
+#define IDENTITY     0x69
+#define COMPACT      0x6D
+#define S_INIT       0xAA
+#define INIT         0xBB
+#define EXIT         0xFF
+
+#define HDR_COMPACT_LENGTH   0
+#define HDR_COMPACT_SUMMARY  3
+#define HDR_COMPACT_NUMBER  13
+#define HDR_COMPACT_VERSION 15
+
+#define HDR_FULL_POINTERS    2
+#define HDR_FULL_VERSION     8
+#define HDR_FULL_LENGTH      9
+#define HDR_FULL_SUMMARY    12
+#define HDR_FULL_FIRMWARE   48
+#define HDR_FULL_NUMBER     80
+
+#define NDIVES 20
+#define SZ_PROFILE 0x4000
+
+typedef enum dctool_hw_ostc3_state_t {
+	OPEN,
+	DOWNLOAD,
+	SERVICE,
+} dctool_hw_ostc3_state_t;
+
+typedef struct dctool_hw_ostc3_simulator_t {
+	dctool_simulator_t base;
+	dctool_hw_ostc3_state_t state;
+	unsigned char pending;
+} dctool_hw_ostc3_simulator_t;
+
+static void dctool_hw_ostc3_simulator_reset (dctool_simulator_t *simulator);
+static unsigned int dctool_hw_ostc3_simulator_process (dctool_simulator_t *simulator, const unsigned char data[], unsigned int size);
+
+static const dctool_simulator_vtable_t hw_ostc3_simulator_vtable = {
+	sizeof (dctool_hw_ostc3_simulator_t),
+	"ostc3",
+	DC_FAMILY_HW_OSTC3,
+	0x0A, /* OSTC 3 */
+	DC_TRANSPORT_SERIAL,
+	dctool_hw_ostc3_simulator_reset, /* reset */
+	dctool_hw_ostc3_simulator_process, /* process */
+	NULL, /* free */
+	0, /* payload */
+	NULL, /* unpack */
+	NULL, /* pack */
+	NULL /* ioctl */
+};
+
+static void
+dctool_hw_ostc3_simulator_generate (unsigned char data[])
+{
+	unsigned int seed = 0x0A;
+
+	memset (data, 0xFF, SZ_MEMORY);
+
+	// Every logbook header occupies its own block, and points to the
+	// profile data in the ringbuffer. The profile starts with the same
+	// length as the header, and ends with an end of profile marker.
+	unsigned int address = RB_PROFILE_BEGIN;
+	for (unsigned int i = 0; i < NDIVES; ++i) {
+		unsigned char *header = data + i * RB_LOGBOOK_BLOCK;
+		unsigned char *profile = data + address;
+		unsigned int length = SZ_PROFILE + 3;
+		unsigned int end = address + SZ_PROFILE;
+		unsigned int number = i + 1;
+
+		for (unsigned int j = 0; j < RB_LOGBOOK_SIZE_FULL; ++j) {
+			header[j] = dctool_simulator_random (&seed);
+		}
+		header[0] = 0xFA;
+		header[1] = 0xFA;
+		header[HDR_FULL_POINTERS + 0] = (address      ) & 0xFF;
+		header[HDR_FULL_POINTERS + 1] = (address >>  8) & 0xFF;
+		header[HDR_FULL_POINTERS + 2] = (address >> 16) & 0xFF;
+		header[HDR_FULL_POINTERS + 3] = (end      ) & 0xFF;
+		header[HDR_FULL_POINTERS + 4] = (end >>  8) & 0xFF;
+		header[HDR_FULL_POINTERS + 5] = (end >> 16) & 0xFF;
+		header[HDR_FULL_VERSION] = 0x24;
+		header[HDR_FULL_LENGTH + 0] = (length      ) & 0xFF;
+		header[HDR_FULL_LENGTH + 1] = (length >>  8) & 0xFF;
+		header[HDR_FULL_LENGTH + 2] = (length >> 16) & 0xFF;
+		header[HDR_FULL_FIRMWARE + 0] = 3;
+		header[HDR_FULL_FIRMWARE + 1] = 0;
+		header[HDR_FULL_NUMBER + 0] = (number     ) & 0xFF;
+		header[HDR_FULL_NUMBER + 1] = (number >> 8) & 0xFF;
+		header[RB_LOGBOOK_SIZE_FULL - 2] = 0xFB;
+		header[RB_LOGBOOK_SIZE_FULL - 1] = 0xFB;
+
+		for (unsigned int j = 0; j < SZ_PROFILE; ++j) {
+			profile[j] = dctool_simulator_random (&seed);
+		}
+		profile[0] = (length      ) & 0xFF;
+		profile[1] = (length >>  8) & 0xFF;
+		profile[2] = (length >> 16) & 0xFF;
+		profile[SZ_PROFILE - 2] = 0xFD;
+		profile[SZ_PROFILE - 1] = 0xFD;
+
+		address = end;
+	}
+}
+
+dctool_simulator_t *
+dctool_hw_ostc3_simulator_new (dc_buffer_t *image)
+{
+	dctool_simulator_t *simulator = NULL;
+
+	if (image && dc_buffer_get_size (image) != SZ_MEMORY)
+		return NULL;
+
+	simulator = dctool_simulator_allocate (&hw_ostc3_simulator_vtable, image);
+	if (simulator == NULL)
+		return NULL;
+
+	if (image == NULL) {
+		if (!dc_buffer_resize (simulator->memory, SZ_MEMORY)) {
+			dctool_simulator_deallocate (simulator);
+			return NULL;
+		}
+
+		dctool_hw_ostc3_simulator_generate (dc_buffer_get_data (simulator->memory));
+	}
+
+	return simulator;
+}
+
+static void
+dctool_hw_ostc3_simulator_reset (dctool_simulator_t *abstract)
+{
+	dctool_hw_ostc3_simulator_t *simulator = (dctool_hw_ostc3_simulator_t *) abstract;
+
+	simulator->state = OPEN;
+	simulator->pending = 0;
+}
+
+static void
+dctool_hw_ostc3_simulator_memory (dctool_simulator_t *simulator, unsigned int address, unsigned int size)
+{
+	const unsigned char *memory = dc_buffer_get_data (simulator->memory);
+	unsigned char block[RB_LOGBOOK_BLOCK];
+
+	// Reading beyond the end of the memory returns erased flash.
+	while (size) {
+		unsigned int len = size < sizeof (block) ? size : sizeof (block);
+		for (unsigned int i = 0; i < len; ++i) {
+			block[i] = address + i < SZ_MEMORY ? memory[address + i] : 0xFF;
+		}
+
+		dctool_simulator_reply (simulator, 0, block, len);
+
+		address += len;
+		size -= len;
+	}
+}
+
+static void
+dctool_hw_ostc3_simulator_logbook (dctool_simulator_t *simulator, unsigned int compact)
+{
+	const unsigned char *memory = dc_buffer_get_data (simulator->memory);
+	unsigned char entry[RB_LOGBOOK_SIZE_FULL];
+
+	for (unsigned int i = 0; i < RB_LOGBOOK_COUNT; ++i) {
+		const unsigned char *header = memory + i * RB_LOGBOOK_BLOCK;
+
+		if (!compact) {
+			dctool_simulator_reply (simulator, 0, header, RB_LOGBOOK_SIZE_FULL);
+			continue;
+		}
+
+		memcpy (entry + HDR_COMPACT_LENGTH, header + HDR_FULL_LENGTH, 3);
+		memcpy (entry + HDR_COMPACT_SUMMARY, header + HDR_FULL_SUMMARY, 10);
+		memcpy (entry + HDR_COMPACT_NUMBER, header + HDR_FULL_NUMBER, 2);
+		entry[HDR_COMPACT_VERSION] = header[HDR_FULL_VERSION];
+		dctool_simulator_reply (simulator, 0, entry, RB_LOGBOOK_SIZE_COMPACT);
+	}
+}
+
+static void
+dctool_hw_ostc3_simulator_dive (dctool_simulator_t *simulator, unsigned int idx)
+{
+	const unsigned char *memory = dc_buffer_get_data (simulator->memory);
+	const unsigned char *header = memory + idx * RB_LOGBOOK_BLOCK;
+
+	dctool_simulator_reply (simulator, 0, header, RB_LOGBOOK_SIZE_FULL);
+
+	// The profile data is stored in a ringbuffer.
+	unsigned int address = header[HDR_FULL_POINTERS] | (header[HDR_FULL_POINTERS + 1] << 8) | (header[HDR_FULL_POINTERS + 2] << 16);
+	unsigned int length = header[HDR_FULL_LENGTH] | (header[HDR_FULL_LENGTH + 1] << 8) | (header[HDR_FULL_LENGTH + 2] << 16);
+	if (address < RB_PROFILE_BEGIN || address >= RB_PROFILE_END || length < 3)
+		return;
+
+	length -= 3;
+	while (length) {
+		unsigned int len = RB_PROFILE_END - address;
+		if (len > length)
+			len = length;
+
+		dctool_simulator_reply (simulator, 0, memory + address, len);
+
+		address += len;
+		if (address == RB_PROFILE_END)
+			address = RB_PROFILE_BEGIN;
+		length -= len;
+	}
+}
+
+static unsigned int
+dctool_hw_ostc3_simulator_process (dctool_simulator_t *abstract, const unsigned char data[], unsigned int size)
+{
+	dctool_hw_ostc3_simulator_t *simulator = (dctool_hw_ostc3_simulator_t *) abstract;
+	static const unsigned char version[SZ_VERSION] = {
+		0xD2, 0x04, 3, 0, 'O', 'S', 'T', 'C', ' ', '3'};
+	static const unsigned char hardware[SZ_HARDWARE2] = {
+		0x00, 0x0A, 0x00, 0x00, 0x0A};
+	static const unsigned char service[] = {
+		0x4B, 0xAB, 0xCD, 0xEF, S_READY};
+	const unsigned char ready[] = {simulator->state == SERVICE ? S_READY : READY};
+	unsigned int address = 0, length = 0;
+
+	// The parameters of a command are only sent after the echo.
+	if (simulator->pending == DIVE) {
+		dctool_hw_ostc3_simulator_dive (abstract, data[0]);
+		dctool_simulator_reply (abstract, 0, ready, sizeof (ready));
+		simulator->pending = 0;
+		return 1;
+	} else if (simulator->pending == S_BLOCK_READ) {
+		if (size < 6)
+			return 0;
+		address = (data[0] << 16) | (data[1] << 8) | data[2];
+		length = (data[3] << 16) | (data[4] << 8) | data[5];
+		dctool_hw_ostc3_simulator_memory (abstract, address, length);
+		dctool_simulator_reply (abstract, 0, ready, sizeof (ready));
+		simulator->pending = 0;
+		return 6;
+	}
+
+	if (simulator->state == OPEN) {
+		if (data[0] == INIT) {
+			simulator->state = DOWNLOAD;
+			dctool_simulator_reply (abstract, 0, data, 1);
+			dctool_simulator_reply (abstract, 0, ready, sizeof (ready));
+		} else if (data[0] == S_INIT) {
+			if (size < 4)
+				return 0;
+			if (data[1] == 0xAB && data[2] == 0xCD && data[3] == 0xEF) {
+				simulator->state = SERVICE;
+				dctool_simulator_reply (abstract, 0, service, sizeof (service));
+			}
+			return 4;
+		}
+
+		// Everything else is ignored until the download or service
+		// mode is activated.
+		return 1;
+	}
+
+	switch (data[0]) {
+	case HARDWARE2:
+		dctool_simulator_reply (abstract, 0, data, 1);
+		dctool_simulator_reply (abstract, 0, hardware, sizeof (hardware));
+		break;
+	case IDENTITY:
+		dctool_simulator_reply (abstract, 0, data, 1);
+		dctool_simulator_reply (abstract, 0, version, sizeof (version));
+		break;
+	case COMPACT:
+	case HEADER:
+		dctool_simulator_reply (abstract, 0, data, 1);
+		dctool_hw_ostc3_simulator_logbook (abstract, data[0] == COMPACT);
+		break;
+	case DIVE:
+	case S_BLOCK_READ:
+		dctool_simulator_reply (abstract, 0, data, 1);
+		simulator->pending = data[0];
+		return 1;
+	case EXIT:
+		// No ready byte after the exit command.
+		simulator->state = OPEN;
+		dctool_simulator_reply (abstract, 0, data, 1);
+		return 1;
+	default:
+		// Unsupported commands are answered with the ready byte only.
+		break;
+	}
+
+	dctool_simulator_reply (abstract, 0, ready, sizeof (ready));
+
+	return 1;
+}
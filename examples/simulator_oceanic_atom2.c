@@ -0,0 +1,295 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include <libdivecomputer/ble.h>
+
+#include "simulator-private.h"
+
+#define CMD_VERSION   0x84
+#define CMD_READ1     0xB1
+#define CMD_READ8     0xB4
+#define CMD_READ16    0xB8
+#define CMD_KEEPALIVE 0x91
+#define CMD_QUIT      0x6A
+#define CMD_HANDSHAKE 0xE5
+
+#define ACK 0x5A
+#define NAK 0xA5
+
+#define PAGESIZE 0x10
+#define SZ_MEMORY 0xFFF0
+
+#define CF_POINTERS      0x0040
+#define RB_LOGBOOK_BEGIN 0x0240
+#define RB_LOGBOOK_END   0x0A40
+#define RB_PROFILE_BEGIN 0x0A40
+#define RB_PROFILE_END   0xFFF0
+
+#define NDIVES 24
+#define NPAGES 160
+
+typedef struct dctool_oceanic_atom2_simulator_t {
+	dctool_simulator_t base;
+	unsigned char sequence;
+} dctool_oceanic_atom2_simulator_t;
+
+static void dctool_oceanic_atom2_simulator_reset (dctool_simulator_t *simulator);
+static unsigned int dctool_oceanic_atom2_simulator_process (dctool_simulator_t *simulator, const unsigned char data[], unsigned int size);
+static unsigned int dctool_oceanic_atom2_simulator_unpack (dctool_simulator_t *simulator, const unsigned char packet[], unsigned int size, unsigned int *length);
+static unsigned int dctool_oceanic_atom2_simulator_pack (dctool_simulator_t *simulator, unsigned char header[], unsigned int index, unsigned int count, unsigned int length);
+static dc_status_t dctool_oceanic_atom2_simulator_ioctl (dctool_simulator_t *simulator, unsigned int request, void *data, size_t size);
+
+static const dctool_simulator_vtable_t oceanic_atom2_simulator_vtable = {
+	sizeof (dctool_oceanic_atom2_simulator_t),
+	"atom2",
+	DC_FAMILY_OCEANIC_ATOM2,
+	0x4342, /* Atom 2.0 */
+	DC_TRANSPORT_SERIAL,
+	dctool_oceanic_atom2_simulator_reset, /* reset */
+	dctool_oceanic_atom2_simulator_process, /* process */
+	NULL, /* free */
+	16, /* payload */
+	dctool_oceanic_atom2_simulator_unpack, /* unpack */
+	dctool_oceanic_atom2_simulator_pack, /* pack */
+	dctool_oceanic_atom2_simulator_ioctl /* ioctl */
+};
+
+static void
+dctool_oceanic_atom2_simulator_generate (unsigned char data[])
+{
+	unsigned int seed = 0x4342;
+
+	memset (data, 0xFF, SZ_MEMORY);
+
+	// Device info.
+	for (unsigned int i = 0; i < CF_POINTERS; ++i) {
+		data[i] = dctool_simulator_random (&seed);
+	}
+
+	// Each dive has a logbook entry with the first and last page of
+	// its profile, packed as two 12 bit page numbers.
+	unsigned int address = RB_PROFILE_BEGIN;
+	for (unsigned int i = 0; i < NDIVES; ++i) {
+		unsigned char *entry = data + RB_LOGBOOK_BEGIN + i * 8;
+		unsigned int first = address / PAGESIZE;
+		unsigned int last = first + NPAGES - 1;
+
+		for (unsigned int j = 0; j < 5; ++j) {
+			entry[j] = dctool_simulator_random (&seed);
+		}
+		entry[0] = i;
+		entry[5] = first & 0xFF;
+		entry[6] = ((first >> 8) & 0x0F) | ((last & 0x0F) << 4);
+		entry[7] = (last >> 4) & 0xFF;
+
+		for (unsigned int j = 0; j < NPAGES * PAGESIZE; ++j) {
+			data[address + j] = dctool_simulator_random (&seed);
+		}
+
+		address += NPAGES * PAGESIZE;
+	}
+
+	// Ringbuffer pointers.
+	unsigned char *pointers = data + CF_POINTERS;
+	unsigned int logbook = RB_LOGBOOK_BEGIN + (NDIVES - 1) * 8;
+	memset (pointers, 0, PAGESIZE);
+	pointers[4] = RB_LOGBOOK_BEGIN & 0xFF;
+	pointers[5] = RB_LOGBOOK_BEGIN >> 8;
+	pointers[6] = logbook & 0xFF;
+	pointers[7] = logbook >> 8;
+	pointers[8] = RB_PROFILE_BEGIN & 0xFF;
+	pointers[9] = RB_PROFILE_BEGIN >> 8;
+	pointers[10] = address & 0xFF;
+	pointers[11] = address >> 8;
+}
+
+dctool_simulator_t *
+dctool_oceanic_atom2_simulator_new (dc_buffer_t *image)
+{
+	dctool_simulator_t *simulator = NULL;
+
+	if (image && dc_buffer_get_size (image) != SZ_MEMORY)
+		return NULL;
+
+	simulator = dctool_simulator_allocate (&oceanic_atom2_simulator_vtable, image);
+	if (simulator == NULL)
+		return NULL;
+
+	if (image == NULL) {
+		if (!dc_buffer_resize (simulator->memory, SZ_MEMORY)) {
+			dctool_simulator_deallocate (simulator);
+			return NULL;
+		}
+
+		dctool_oceanic_atom2_simulator_generate (dc_buffer_get_data (simulator->memory));
+	}
+
+	return simulator;
+}
+
+static void
+dctool_oceanic_atom2_simulator_reset (dctool_simulator_t *abstract)
+{
+	dctool_oceanic_atom2_simulator_t *simulator = (dctool_oceanic_atom2_simulator_t *) abstract;
+
+	simulator->sequence = 0;
+}
+
+/*
+ * The BLE packets have a four byte header: the start byte, a status byte
+ * with a flag for more packets and the packet number, the sequence number
+ * of the command, and the length of the data. The answers repeat the
+ * sequence number of the command.
+ */
+static unsigned int
+dctool_oceanic_atom2_simulator_unpack (dctool_simulator_t *abstract, const unsigned char packet[], unsigned int size, unsigned int *length)
+{
+	dctool_oceanic_atom2_simulator_t *simulator = (dctool_oceanic_atom2_simulator_t *) abstract;
+
+	if (size < 4 || packet[0] != 0xCD || (packet[1] & 0xC0) != 0x40 || packet[3] > size - 4) {
+		*length = 0;
+		return 0;
+	}
+
+	simulator->sequence = packet[2];
+	*length = packet[3];
+
+	return 4;
+}
+
+static unsigned int
+dctool_oceanic_atom2_simulator_pack (dctool_simulator_t *abstract, unsigned char header[], unsigned int index, unsigned int count, unsigned int length)
+{
+	dctool_oceanic_atom2_simulator_t *simulator = (dctool_oceanic_atom2_simulator_t *) abstract;
+
+	header[0] = 0xCD;
+	header[1] = 0xC0 | (index + 1 < count ? 0x20 : 0x00) | (index & 0x1F);
+	header[2] = simulator->sequence;
+	header[3] = length;
+
+	return 4;
+}
+
+static dc_status_t
+dctool_oceanic_atom2_simulator_ioctl (dctool_simulator_t *simulator, unsigned int request, void *data, size_t size)
+{
+	// The name contains the model number and the serial number, which
+	// the host uses for the handshake.
+	static const char name[] = "CB123456";
+
+	if (request != DC_IOCTL_BLE_GET_NAME)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (size < sizeof (name))
+		return DC_STATUS_INVALIDARGS;
+
+	memcpy (data, name, sizeof (name));
+
+	return DC_STATUS_SUCCESS;
+}
+
+static void
+dctool_oceanic_atom2_simulator_answer (dctool_simulator_t *simulator, const unsigned char data[], unsigned int size, unsigned int crc_size)
+{
+	unsigned char answer[1 + 16 * PAGESIZE + 2];
+
+	answer[0] = ACK;
+	memcpy (answer + 1, data, size);
+
+	unsigned int crc = 0;
+	for (unsigned int i = 0; i < size; ++i) {
+		crc += data[i];
+	}
+
+	answer[1 + size] = crc & 0xFF;
+	if (crc_size == 2) {
+		answer[1 + size + 1] = (crc >> 8) & 0xFF;
+	}
+
+	dctool_simulator_reply (simulator, 0, answer, 1 + size + crc_size);
+}
+
+static void
+dctool_oceanic_atom2_simulator_read (dctool_simulator_t *simulator, unsigned int address, unsigned int size, unsigned int crc_size)
+{
+	const unsigned char *memory = dc_buffer_get_data (simulator->memory);
+	unsigned int memsize = dc_buffer_get_size (simulator->memory);
+	unsigned char page[16 * PAGESIZE];
+
+	// Reading beyond the end of the memory returns erased flash.
+	for (unsigned int i = 0; i < size; ++i) {
+		page[i] = address + i < memsize ? memory[address + i] : 0xFF;
+	}
+
+	dctool_oceanic_atom2_simulator_answer (simulator, page, size, crc_size);
+}
+
+static unsigned int
+dctool_oceanic_atom2_simulator_process (dctool_simulator_t *simulator, const unsigned char data[], unsigned int size)
+{
+	static const unsigned char version[PAGESIZE] = {
+		'2', 'M', ' ', 'A', 'T', 'O', 'M', ' ',
+		'r', '1', 'A', ' ', '5', '1', '2', 'K'};
+	const unsigned char ack[] = {ACK};
+	const unsigned char nak[] = {NAK};
+	unsigned int address = 0;
+
+	switch (data[0]) {
+	case CMD_VERSION:
+		dctool_oceanic_atom2_simulator_answer (simulator, version, sizeof (version), 1);
+		return 1;
+	case CMD_READ1:
+	case CMD_READ8:
+	case CMD_READ16:
+		if (size < 3)
+			return 0;
+		// The page number is always in units of 16 bytes.
+		address = ((data[1] << 8) | data[2]) * PAGESIZE;
+		if (data[0] == CMD_READ1) {
+			dctool_oceanic_atom2_simulator_read (simulator, address, PAGESIZE, 1);
+		} else if (data[0] == CMD_READ8) {
+			dctool_oceanic_atom2_simulator_read (simulator, address, 8 * PAGESIZE, 1);
+		} else {
+			dctool_oceanic_atom2_simulator_read (simulator, address, 16 * PAGESIZE, 2);
+		}
+		return 3;
+	case CMD_KEEPALIVE:
+		if (size < 3)
+			return 0;
+		dctool_simulator_reply (simulator, 0, ack, sizeof (ack));
+		return 3;
+	case CMD_QUIT:
+		if (size < 4)
+			return 0;
+		dctool_simulator_reply (simulator, 0, nak, sizeof (nak));
+		return 4;
+	case CMD_HANDSHAKE:
+		if (size < 10)
+			return 0;
+		dctool_simulator_reply (simulator, 0, ack, sizeof (ack));
+		return 10;
+	default:
+		// Unknown commands are ignored, and the host times out.
+		return 1;
+	}
+}
@@ -0,0 +1,287 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "simulator-private.h"
+
+#define SZ_PACKET 254
+#define SZ_BLOCK  0x80
+#define SZ_MEMORY 0x20080
+
+#define RB_PROFILE_BEGIN 0
+#define RB_PROFILE_END   0x1F600
+
+#define END       0xC0
+#define ESC       0xDB
+#define ESC_END   0xDC
+#define ESC_ESC   0xDD
+
+#define NAK       0x7F
+
+#define ADDRESS   0xDD000000
+
+#define NDIVES  20
+#define NBLOCKS 48
+
+typedef struct dctool_shearwater_predator_simulator_t {
+	dctool_simulator_t base;
+	unsigned int address;
+	unsigned int size;
+	unsigned int block;
+} dctool_shearwater_predator_simulator_t;
+
+static void dctool_shearwater_predator_simulator_reset (dctool_simulator_t *simulator);
+static unsigned int dctool_shearwater_predator_simulator_process (dctool_simulator_t *simulator, const unsigned char data[], unsigned int size);
+static unsigned int dctool_shearwater_predator_simulator_unpack (dctool_simulator_t *simulator, const unsigned char packet[], unsigned int size, unsigned int *length);
+static unsigned int dctool_shearwater_predator_simulator_pack (dctool_simulator_t *simulator, unsigned char header[], unsigned int index, unsigned int count, unsigned int length);
+
+static const dctool_simulator_vtable_t shearwater_predator_simulator_vtable = {
+	sizeof (dctool_shearwater_predator_simulator_t),
+	"predator",
+	DC_FAMILY_SHEARWATER_PREDATOR,
+	2, /* Predator */
+	DC_TRANSPORT_SERIAL,
+	dctool_shearwater_predator_simulator_reset, /* reset */
+	dctool_shearwater_predator_simulator_process, /* process */
+	NULL, /* free */
+	30, /* payload */
+	dctool_shearwater_predator_simulator_unpack, /* unpack */
+	dctool_shearwater_predator_simulator_pack, /* pack */
+	NULL /* ioctl */
+};
+
+static void
+dctool_shearwater_predator_simulator_generate (unsigned char data[])
+{
+	unsigned int seed = 2;
+
+	memset (data, 0xFF, SZ_MEMORY);
+
+	// Every dive starts with a header block and ends with a footer
+	// block, both containing the internal dive number.
+	unsigned int offset = RB_PROFILE_BEGIN;
+	for (unsigned int i = 0; i < NDIVES; ++i) {
+		unsigned int number = i + 1;
+
+		for (unsigned int j = 0; j < NBLOCKS * SZ_BLOCK; ++j) {
+			data[offset + j] = dctool_simulator_random (&seed);
+		}
+
+		for (unsigned int j = 0; j < NBLOCKS; ++j) {
+			unsigned char *block = data + offset + j * SZ_BLOCK;
+			if (j == 0) {
+				block[0] = 0xFF;
+				block[1] = 0xFF;
+			} else if (j == NBLOCKS - 1) {
+				block[0] = 0xFF;
+				block[1] = 0xFE;
+			} else {
+				block[0] &= 0x7F;
+				continue;
+			}
+			block[2] = (number >> 8) & 0xFF;
+			block[3] = (number     ) & 0xFF;
+		}
+
+		offset += NBLOCKS * SZ_BLOCK;
+	}
+
+	// Device info.
+	unsigned char *info = data + SZ_MEMORY - SZ_BLOCK;
+	memset (info, 0, SZ_BLOCK);
+	info[0x02] = 0x00;
+	info[0x03] = 0x01;
+	info[0x04] = 0x23;
+	info[0x05] = 0x45;
+	info[0x0A] = 0x30;
+	info[0x0D] = 2;
+}
+
+dctool_simulator_t *
+dctool_shearwater_predator_simulator_new (dc_buffer_t *image)
+{
+	dctool_simulator_t *simulator = NULL;
+
+	if (image && dc_buffer_get_size (image) != SZ_MEMORY)
+		return NULL;
+
+	simulator = dctool_simulator_allocate (&shearwater_predator_simulator_vtable, image);
+	if (simulator == NULL)
+		return NULL;
+
+	if (image == NULL) {
+		if (!dc_buffer_resize (simulator->memory, SZ_MEMORY)) {
+			dctool_simulator_deallocate (simulator);
+			return NULL;
+		}
+
+		dctool_shearwater_predator_simulator_generate (dc_buffer_get_data (simulator->memory));
+	}
+
+	return simulator;
+}
+
+static void
+dctool_shearwater_predator_simulator_reset (dctool_simulator_t *abstract)
+{
+	dctool_shearwater_predator_simulator_t *simulator = (dctool_shearwater_predator_simulator_t *) abstract;
+
+	simulator->address = 0;
+	simulator->size = 0;
+	simulator->block = 0;
+}
+
+/*
+ * The BLE packets carry the SLIP frames, with a two byte header: the
+ * number of packets, and the index of the packet.
+ */
+static unsigned int
+dctool_shearwater_predator_simulator_unpack (dctool_simulator_t *simulator, const unsigned char packet[], unsigned int size, unsigned int *length)
+{
+	if (size < 2) {
+		*length = 0;
+		return 0;
+	}
+
+	*length = size - 2;
+
+	return 2;
+}
+
+static unsigned int
+dctool_shearwater_predator_simulator_pack (dctool_simulator_t *simulator, unsigned char header[], unsigned int index, unsigned int count, unsigned int length)
+{
+	header[0] = count;
+	header[1] = index;
+
+	return 2;
+}
+
+static void
+dctool_shearwater_predator_simulator_send (dctool_simulator_t *simulator, const unsigned char data[], unsigned int size)
+{
+	unsigned char packet[4 + SZ_PACKET];
+	unsigned char frame[2 * sizeof (packet) + 1];
+	unsigned int n = 0;
+
+	packet[0] = 0x01;
+	packet[1] = 0xFF;
+	packet[2] = size + 1;
+	packet[3] = 0x00;
+	memcpy (packet + 4, data, size);
+
+	// Encode the SLIP frame.
+	for (unsigned int i = 0; i < size + 4; ++i) {
+		if (packet[i] == END) {
+			frame[n++] = ESC;
+			frame[n++] = ESC_END;
+		} else if (packet[i] == ESC) {
+			frame[n++] = ESC;
+			frame[n++] = ESC_ESC;
+		} else {
+			frame[n++] = packet[i];
+		}
+	}
+	frame[n++] = END;
+
+	dctool_simulator_reply (simulator, 0, frame, n);
+}
+
+static void
+dctool_shearwater_predator_simulator_request (dctool_simulator_t *abstract, const unsigned char data[], unsigned int size)
+{
+	dctool_shearwater_predator_simulator_t *simulator = (dctool_shearwater_predator_simulator_t *) abstract;
+	const unsigned char *memory = dc_buffer_get_data (abstract->memory);
+	unsigned int memsize = dc_buffer_get_size (abstract->memory);
+	unsigned char answer[SZ_PACKET];
+
+	if (size >= 10 && data[0] == 0x35 && data[1] == 0x00 && data[2] == 0x34) {
+		// Init download. Only uncompressed downloads of the memory are
+		// supported.
+		unsigned int address = ((unsigned int) data[3] << 24) | (data[4] << 16) | (data[5] << 8) | data[6];
+		unsigned int length = (data[7] << 16) | (data[8] << 8) | data[9];
+		if (address >= ADDRESS && address - ADDRESS <= memsize && length <= memsize - (address - ADDRESS)) {
+			simulator->address = address - ADDRESS;
+			simulator->size = length;
+			simulator->block = 1;
+			answer[0] = 0x75;
+			answer[1] = 0x10;
+			answer[2] = 2 + SZ_BLOCK;
+			dctool_shearwater_predator_simulator_send (abstract, answer, 3);
+			return;
+		}
+	} else if (size == 2 && data[0] == 0x36 && simulator->block && data[1] == (simulator->block & 0xFF)) {
+		// Download block.
+		unsigned int length = simulator->size < SZ_BLOCK ? simulator->size : SZ_BLOCK;
+		answer[0] = 0x76;
+		answer[1] = data[1];
+		memcpy (answer + 2, memory + simulator->address, length);
+		dctool_shearwater_predator_simulator_send (abstract, answer, 2 + length);
+		simulator->address += length;
+		simulator->size -= length;
+		simulator->block++;
+		return;
+	} else if (size == 1 && data[0] == 0x37) {
+		// Quit download.
+		simulator->block = 0;
+		answer[0] = 0x77;
+		answer[1] = 0x00;
+		dctool_shearwater_predator_simulator_send (abstract, answer, 2);
+		return;
+	}
+
+	answer[0] = NAK;
+	answer[1] = data[0];
+	answer[2] = 0x11; /* Service not supported */
+	dctool_shearwater_predator_simulator_send (abstract, answer, 3);
+}
+
+static unsigned int
+dctool_shearwater_predator_simulator_process (dctool_simulator_t *simulator, const unsigned char data[], unsigned int size)
+{
+	unsigned char packet[4 + SZ_PACKET];
+	unsigned int n = 0;
+
+	// Wait for the end of the SLIP frame.
+	const unsigned char *end = (const unsigned char *) memchr (data, END, size);
+	if (end == NULL)
+		return 0;
+
+	// Decode the SLIP frame. Frames that are too large are dropped.
+	unsigned int length = end - data;
+	for (unsigned int i = 0; i < length; ++i) {
+		unsigned char c = data[i];
+		if (c == ESC && i + 1 < length) {
+			c = data[++i] == ESC_END ? END : ESC;
+		}
+		if (n < sizeof (packet))
+			packet[n] = c;
+		n++;
+	}
+
+	if (n >= 4 && n <= sizeof (packet) &&
+		packet[0] == 0xFF && packet[1] == 0x01 && packet[3] == 0x00 && packet[2] == n - 3) {
+		dctool_shearwater_predator_simulator_request (simulator, packet + 4, n - 4);
+	}
+
+	return length + 1;
+}
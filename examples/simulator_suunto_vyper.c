@@ -0,0 +1,274 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "simulator-private.h"
+
+#define SZ_MEMORY 0x2000
+#define SZ_PACKET 32
+
+#define HDR_DEVINFO_VYPER 0x24
+#define EOP               0x51
+#define RB_PROFILE_BEGIN  0x71
+#define RB_PROFILE_END    SZ_MEMORY
+#define PEEK              5
+
+#define MAXDIVES ((RB_PROFILE_END - RB_PROFILE_BEGIN) / PEEK)
+
+/*
+ * The dive computer needs about 600 ms before it starts to answer.
+ */
+#define DELAY 600000
+
+#define NDIVES 12
+#define SZ_DIVE 600
+
+typedef struct dctool_suunto_vyper_simulator_t {
+	dctool_simulator_t base;
+	unsigned int ndives;
+	unsigned int current;
+	unsigned int begin[MAXDIVES];
+	unsigned int length[MAXDIVES];
+} dctool_suunto_vyper_simulator_t;
+
+static void dctool_suunto_vyper_simulator_reset (dctool_simulator_t *simulator);
+static unsigned int dctool_suunto_vyper_simulator_process (dctool_simulator_t *simulator, const unsigned char data[], unsigned int size);
+
+static const dctool_simulator_vtable_t suunto_vyper_simulator_vtable = {
+	sizeof (dctool_suunto_vyper_simulator_t),
+	"vyper",
+	DC_FAMILY_SUUNTO_VYPER,
+	0x0A, /* Vyper */
+	DC_TRANSPORT_SERIAL,
+	dctool_suunto_vyper_simulator_reset, /* reset */
+	dctool_suunto_vyper_simulator_process, /* process */
+	NULL, /* free */
+	0, /* payload */
+	NULL, /* unpack */
+	NULL, /* pack */
+	NULL /* ioctl */
+};
+
+static unsigned char
+dctool_suunto_vyper_simulator_byte (unsigned int *seed)
+{
+	unsigned char value = 0;
+
+	// The markers can't appear inside the profile data.
+	do {
+		value = dctool_simulator_random (seed);
+	} while (value == 0x80 || value == 0x82);
+
+	return value;
+}
+
+static void
+dctool_suunto_vyper_simulator_generate (unsigned char data[])
+{
+	unsigned int seed = 0x0A;
+
+	memset (data, 0xFF, SZ_MEMORY);
+
+	// Device info.
+	data[HDR_DEVINFO_VYPER + 0] = 0x0A;
+	data[HDR_DEVINFO_VYPER + 1] = 0x10;
+	data[HDR_DEVINFO_VYPER + 2] = 12;
+	data[HDR_DEVINFO_VYPER + 3] = 34;
+	data[HDR_DEVINFO_VYPER + 4] = 56;
+	data[HDR_DEVINFO_VYPER + 5] = 78;
+
+	// The start of a dive is recognized by the end of dive marker of
+	// the previous dive, a few bytes earlier.
+	unsigned int offset = RB_PROFILE_BEGIN;
+	data[offset] = 0x80;
+	offset += PEEK;
+	for (unsigned int i = 0; i < NDIVES; ++i) {
+		for (unsigned int j = 0; j < SZ_DIVE; ++j) {
+			data[offset + j] = dctool_suunto_vyper_simulator_byte (&seed);
+		}
+		data[offset + SZ_DIVE - PEEK] = 0x80;
+		offset += SZ_DIVE;
+	}
+
+	// End of profile marker.
+	data[offset] = 0x82;
+	data[EOP + 0] = (offset >> 8) & 0xFF;
+	data[EOP + 1] = (offset     ) & 0xFF;
+}
+
+dctool_simulator_t *
+dctool_suunto_vyper_simulator_new (dc_buffer_t *image)
+{
+	dctool_simulator_t *simulator = NULL;
+
+	if (image && dc_buffer_get_size (image) != SZ_MEMORY)
+		return NULL;
+
+	simulator = dctool_simulator_allocate (&suunto_vyper_simulator_vtable, image);
+	if (simulator == NULL)
+		return NULL;
+
+	if (image == NULL) {
+		if (!dc_buffer_resize (simulator->memory, SZ_MEMORY)) {
+			dctool_simulator_deallocate (simulator);
+			return NULL;
+		}
+
+		dctool_suunto_vyper_simulator_generate (dc_buffer_get_data (simulator->memory));
+	}
+
+	return simulator;
+}
+
+static void
+dctool_suunto_vyper_simulator_reset (dctool_simulator_t *abstract)
+{
+	dctool_suunto_vyper_simulator_t *simulator = (dctool_suunto_vyper_simulator_t *) abstract;
+	const unsigned char *data = dc_buffer_get_data (abstract->memory);
+	const unsigned int length = RB_PROFILE_END - RB_PROFILE_BEGIN;
+
+	simulator->ndives = 0;
+	simulator->current = 0;
+
+	// Locate the dives in the profile ringbuffer, starting from the end
+	// of profile marker, and moving backwards to the older dives.
+	unsigned int eop = (data[EOP] << 8) | data[EOP + 1];
+	if (eop < RB_PROFILE_BEGIN || eop >= RB_PROFILE_END || data[eop] != 0x82)
+		return;
+
+	unsigned int current = eop;
+	unsigned int previous = eop;
+	for (unsigned int i = 0; i < length && simulator->ndives < MAXDIVES; ++i) {
+		if (current == RB_PROFILE_BEGIN)
+			current = RB_PROFILE_END;
+		current--;
+
+		if (data[current] == 0x82)
+			break;
+
+		unsigned int peek = current >= RB_PROFILE_BEGIN + PEEK ? current - PEEK : current + length - PEEK;
+		if (data[peek] == 0x80) {
+			simulator->begin[simulator->ndives] = current;
+			simulator->length[simulator->ndives] = previous >= current ? previous - current : previous + length - current;
+			simulator->ndives++;
+			previous = current;
+		}
+	}
+}
+
+static void
+dctool_suunto_vyper_simulator_send (dctool_simulator_t *simulator, unsigned int delay, unsigned char cmd, const unsigned char data[], unsigned int size)
+{
+	unsigned char packet[2 + SZ_PACKET + 1];
+
+	packet[0] = cmd;
+	packet[1] = size;
+	if (size) {
+		memcpy (packet + 2, data, size);
+	}
+
+	unsigned char crc = 0;
+	for (unsigned int i = 0; i < size + 2; ++i) {
+		crc ^= packet[i];
+	}
+	packet[size + 2] = crc;
+
+	dctool_simulator_reply (simulator, delay, packet, size + 3);
+}
+
+static void
+dctool_suunto_vyper_simulator_dive (dctool_simulator_t *abstract, unsigned char cmd)
+{
+	dctool_suunto_vyper_simulator_t *simulator = (dctool_suunto_vyper_simulator_t *) abstract;
+	const unsigned char *data = dc_buffer_get_data (abstract->memory);
+	unsigned char packet[SZ_PACKET];
+
+	if (cmd == 0x08)
+		simulator->current = 0;
+
+	// A null packet indicates there are no more dives.
+	if (simulator->current >= simulator->ndives) {
+		dctool_suunto_vyper_simulator_send (abstract, DELAY, cmd, NULL, 0);
+		return;
+	}
+
+	// The dive is sent backwards, starting with the last byte.
+	unsigned int begin = simulator->begin[simulator->current];
+	unsigned int length = simulator->length[simulator->current];
+	unsigned int offset = length;
+	while (offset) {
+		unsigned int len = offset < SZ_PACKET ? offset : SZ_PACKET;
+		for (unsigned int i = 0; i < len; ++i) {
+			unsigned int idx = begin + offset - 1 - i;
+			if (idx >= RB_PROFILE_END)
+				idx -= RB_PROFILE_END - RB_PROFILE_BEGIN;
+			packet[i] = data[idx];
+		}
+
+		dctool_suunto_vyper_simulator_send (abstract, offset == length ? DELAY : 0, cmd, packet, len);
+
+		offset -= len;
+	}
+
+	simulator->current++;
+}
+
+static unsigned int
+dctool_suunto_vyper_simulator_process (dctool_simulator_t *simulator, const unsigned char data[], unsigned int size)
+{
+	const unsigned char *memory = dc_buffer_get_data (simulator->memory);
+	unsigned char answer[4 + SZ_PACKET + 1];
+
+	switch (data[0]) {
+	case 0x05:
+		if (size < 5)
+			return 0;
+		{
+			// Read memory. The answer repeats the command.
+			unsigned int address = (data[1] << 8) | data[2];
+			unsigned int len = data[3];
+			if (len > SZ_PACKET || address + len > SZ_MEMORY)
+				return 5;
+
+			memcpy (answer, data, 4);
+			memcpy (answer + 4, memory + address, len);
+
+			unsigned char crc = 0;
+			for (unsigned int i = 0; i < len + 4; ++i) {
+				crc ^= answer[i];
+			}
+			answer[len + 4] = crc;
+
+			dctool_simulator_reply (simulator, DELAY, answer, len + 5);
+		}
+		return 5;
+	case 0x08:
+	case 0x09:
+		if (size < 3)
+			return 0;
+		dctool_suunto_vyper_simulator_dive (simulator, data[0]);
+		return 3;
+	default:
+		// Unknown commands are ignored, and the host times out.
+		return 1;
+	}
+}
@@ -0,0 +1,210 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "simulator-private.h"
+
+#define CMD_MODEL      0x10
+#define CMD_HARDWARE   0x11
+#define CMD_SOFTWARE   0x13
+#define CMD_SERIAL     0x14
+#define CMD_DEVTIME    0x1A
+#define CMD_HANDSHAKE1 0x1B
+#define CMD_HANDSHAKE2 0x1C
+#define CMD_DATA       0xC4
+#define CMD_SIZE       0xC6
+
+#define OK  0x01
+
+#define SZ_HEADER 12
+
+#define NDIVES 30
+#define SZ_DIVE 2048
+
+#define DEVTIME   0x12345600
+#define TIMESTAMP 0x10000000
+#define INTERVAL  86400
+
+static unsigned int dctool_uwatec_smart_simulator_process (dctool_simulator_t *simulator, const unsigned char data[], unsigned int size);
+
+static const dctool_simulator_vtable_t uwatec_smart_simulator_vtable = {
+	sizeof (dctool_simulator_t),
+	"smart",
+	DC_FAMILY_UWATEC_SMART,
+	0x10, /* Smart Pro */
+	DC_TRANSPORT_IRDA,
+	NULL, /* reset */
+	dctool_uwatec_smart_simulator_process, /* process */
+	NULL, /* free */
+	0, /* payload */
+	NULL, /* unpack */
+	NULL, /* pack */
+	NULL /* ioctl */
+};
+
+static void
+dctool_uwatec_smart_simulator_generate (unsigned char data[])
+{
+	unsigned int seed = 0x10;
+
+	// The dives are stored back to back, the oldest dive first. Every
+	// dive starts with a marker, the length and the timestamp. The
+	// profile data can't contain the start marker.
+	for (unsigned int i = 0; i < NDIVES; ++i) {
+		unsigned char *dive = data + i * SZ_DIVE;
+		unsigned int timestamp = TIMESTAMP + i * INTERVAL;
+
+		for (unsigned int j = SZ_HEADER; j < SZ_DIVE; ++j) {
+			do {
+				dive[j] = dctool_simulator_random (&seed);
+			} while (dive[j] == 0xA5);
+		}
+
+		dive[0] = 0xA5;
+		dive[1] = 0xA5;
+		dive[2] = 0x5A;
+		dive[3] = 0x5A;
+		dive[4] = (SZ_DIVE      ) & 0xFF;
+		dive[5] = (SZ_DIVE >>  8) & 0xFF;
+		dive[6] = (SZ_DIVE >> 16) & 0xFF;
+		dive[7] = (SZ_DIVE >> 24) & 0xFF;
+		dive[8]  = (timestamp      ) & 0xFF;
+		dive[9]  = (timestamp >>  8) & 0xFF;
+		dive[10] = (timestamp >> 16) & 0xFF;
+		dive[11] = (timestamp >> 24) & 0xFF;
+	}
+}
+
+dctool_simulator_t *
+dctool_uwatec_smart_simulator_new (dc_buffer_t *image)
+{
+	dctool_simulator_t *simulator = NULL;
+
+	simulator = dctool_simulator_allocate (&uwatec_smart_simulator_vtable, image);
+	if (simulator == NULL)
+		return NULL;
+
+	if (image == NULL) {
+		if (!dc_buffer_resize (simulator->memory, NDIVES * SZ_DIVE)) {
+			dctool_simulator_deallocate (simulator);
+			return NULL;
+		}
+
+		dctool_uwatec_smart_simulator_generate (dc_buffer_get_data (simulator->memory));
+	}
+
+	return simulator;
+}
+
+static unsigned int
+dctool_uwatec_smart_simulator_uint32 (const unsigned char data[])
+{
+	return data[0] | (data[1] << 8) | (data[2] << 16) | ((unsigned int) data[3] << 24);
+}
+
+static void
+dctool_uwatec_smart_simulator_answer (dctool_simulator_t *simulator, unsigned int value, unsigned int size)
+{
+	unsigned char answer[4];
+
+	for (unsigned int i = 0; i < size; ++i) {
+		answer[i] = (value >> (8 * i)) & 0xFF;
+	}
+
+	dctool_simulator_reply (simulator, 0, answer, size);
+}
+
+/*
+ * Locate the oldest dive that is newer than the timestamp. Only that
+ * part of the memory is sent to the host.
+ */
+static unsigned int
+dctool_uwatec_smart_simulator_offset (dctool_simulator_t *simulator, unsigned int timestamp)
+{
+	const unsigned char header[4] = {0xA5, 0xA5, 0x5A, 0x5A};
+	const unsigned char *data = dc_buffer_get_data (simulator->memory);
+	unsigned int size = dc_buffer_get_size (simulator->memory);
+
+	unsigned int offset = 0;
+	while (offset + SZ_HEADER <= size) {
+		unsigned int length = dctool_uwatec_smart_simulator_uint32 (data + offset + 4);
+		if (memcmp (data + offset, header, sizeof (header)) != 0 ||
+			length < SZ_HEADER || length > size - offset)
+			return 0;
+
+		if (dctool_uwatec_smart_simulator_uint32 (data + offset + 8) > timestamp)
+			return offset;
+
+		offset += length;
+	}
+
+	return size;
+}
+
+static unsigned int
+dctool_uwatec_smart_simulator_process (dctool_simulator_t *simulator, const unsigned char data[], unsigned int size)
+{
+	const unsigned char *memory = dc_buffer_get_data (simulator->memory);
+	unsigned int memsize = dc_buffer_get_size (simulator->memory);
+	unsigned int offset = 0;
+
+	switch (data[0]) {
+	case CMD_MODEL:
+		dctool_uwatec_smart_simulator_answer (simulator, 0x10, 1);
+		return 1;
+	case CMD_HARDWARE:
+		dctool_uwatec_smart_simulator_answer (simulator, 0x01, 1);
+		return 1;
+	case CMD_SOFTWARE:
+		dctool_uwatec_smart_simulator_answer (simulator, 0x24, 1);
+		return 1;
+	case CMD_SERIAL:
+		dctool_uwatec_smart_simulator_answer (simulator, 12345678, 4);
+		return 1;
+	case CMD_DEVTIME:
+		dctool_uwatec_smart_simulator_answer (simulator, DEVTIME, 4);
+		return 1;
+	case CMD_HANDSHAKE1:
+		dctool_uwatec_smart_simulator_answer (simulator, OK, 1);
+		return 1;
+	case CMD_HANDSHAKE2:
+		if (size < 5)
+			return 0;
+		dctool_uwatec_smart_simulator_answer (simulator, OK, 1);
+		return 5;
+	case CMD_SIZE:
+	case CMD_DATA:
+		if (size < 9)
+			return 0;
+		offset = dctool_uwatec_smart_simulator_offset (simulator, dctool_uwatec_smart_simulator_uint32 (data + 1));
+		if (data[0] == CMD_SIZE) {
+			dctool_uwatec_smart_simulator_answer (simulator, memsize - offset, 4);
+		} else {
+			dctool_uwatec_smart_simulator_answer (simulator, memsize - offset + 4, 4);
+			dctool_simulator_reply (simulator, 0, memory + offset, memsize - offset);
+		}
+		return 9;
+	default:
+		// Unknown commands are ignored, and the host times out.
+		return 1;
+	}
+}
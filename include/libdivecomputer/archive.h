@@ -0,0 +1,120 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_ARCHIVE_H
+#define DC_ARCHIVE_H
+
+#include "common.h"
+#include "context.h"
+#include "datetime.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Opaque object representing an opened (read-only) dive archive.
+ */
+typedef struct dc_archive_t dc_archive_t;
+
+/*
+ * Opaque object representing a dive archive opened for appending.
+ */
+typedef struct dc_archive_writer_t dc_archive_writer_t;
+
+/*
+ * A single dive stored in an archive.
+ *
+ * The datetime is the start of the dive (see dc_datetime_mktime), or
+ * -1 if it isn't available. When returned by dc_archive_get_entry, the
+ * fingerprint and data pointers point directly into the archive
+ * mapping. They remain valid until the archive is closed, and can be
+ * passed to dc_parser_new2 or dc_parser_reset as-is.
+ */
+typedef struct dc_archive_entry_t {
+	dc_family_t family;
+	unsigned int model;
+	dc_ticks_t datetime;
+	const unsigned char *fingerprint;
+	unsigned int fsize;
+	const unsigned char *data;
+	unsigned int size;
+} dc_archive_entry_t;
+
+/*
+ * Open a dive archive for reading.
+ *
+ * The archive is memory mapped whenever the platform supports it, and
+ * read into memory otherwise. If the archive contains a valid index,
+ * the dives are located without touching any of the dive records.
+ * Otherwise (for example after an interrupted write) the index is
+ * rebuilt by scanning the record headers.
+ */
+dc_status_t
+dc_archive_open (dc_archive_t **archive, dc_context_t *context, const char *filename);
+
+/*
+ * Get the number of dives in the archive.
+ */
+unsigned int
+dc_archive_get_count (dc_archive_t *archive);
+
+/*
+ * Get a dive from the archive.
+ */
+dc_status_t
+dc_archive_get_entry (dc_archive_t *archive, unsigned int index, dc_archive_entry_t *entry);
+
+/*
+ * Close the archive and release the mapping.
+ */
+dc_status_t
+dc_archive_close (dc_archive_t *archive);
+
+/*
+ * Open a dive archive for appending.
+ *
+ * A new archive is created if the file doesn't exist yet, or is empty.
+ * Existing dive records are never modified. Only a single writer is
+ * supported at the same time.
+ */
+dc_status_t
+dc_archive_writer_open (dc_archive_writer_t **writer, dc_context_t *context, const char *filename);
+
+/*
+ * Append a dive to the archive.
+ *
+ * If the record can't be written completely, it's discarded and the
+ * archive remains unchanged.
+ */
+dc_status_t
+dc_archive_writer_append (dc_archive_writer_t *writer, const dc_archive_entry_t *entry);
+
+/*
+ * Write the index and close the archive.
+ */
+dc_status_t
+dc_archive_writer_close (dc_archive_writer_t *writer);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_ARCHIVE_H */
@@ -26,6 +26,12 @@
 extern "C" {
 #endif /* __cplusplus */
 
+#if defined (_WIN32) && !defined (__GNUC__)
+typedef unsigned __int64 dc_usecs_t;
+#else
+typedef unsigned long long dc_usecs_t;
+#endif
+
 typedef enum dc_status_t {
 	DC_STATUS_SUCCESS = 0,
 	DC_STATUS_DONE = 1,
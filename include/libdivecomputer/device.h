@@ -38,7 +38,9 @@ typedef enum dc_event_type_t {
 	DC_EVENT_PROGRESS = (1 << 1),
 	DC_EVENT_DEVINFO = (1 << 2),
 	DC_EVENT_CLOCK = (1 << 3),
-	DC_EVENT_VENDOR = (1 << 4)
+	DC_EVENT_VENDOR = (1 << 4),
+	DC_EVENT_STATS = (1 << 5),
+	DC_EVENT_CACHE = (1 << 6)
 } dc_event_type_t;
 
 typedef struct dc_device_t dc_device_t;
@@ -64,6 +66,11 @@ typedef struct dc_event_vendor_t {
 	unsigned int size;
 } dc_event_vendor_t;
 
+typedef struct dc_event_cache_t {
+	unsigned int hits;
+	unsigned int misses;
+} dc_event_cache_t;
+
 typedef int (*dc_cancel_callback_t) (void *userdata);
 
 typedef void (*dc_event_callback_t) (dc_device_t *device, dc_event_type_t event, const void *data, void *userdata);
@@ -85,6 +92,9 @@ dc_device_set_events (dc_device_t *device, unsigned int events, dc_event_callbac
 dc_status_t
 dc_device_set_fingerprint (dc_device_t *device, const unsigned char data[], unsigned int size);
 
+dc_status_t
+dc_device_set_image (dc_device_t *device, dc_buffer_t *image);
+
 dc_status_t
 dc_device_read (dc_device_t *device, unsigned int address, unsigned char data[], unsigned int size);
 
@@ -0,0 +1,134 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_DOWNLOAD_H
+#define DC_DOWNLOAD_H
+
+#include "common.h"
+#include "device.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Opaque object representing an asynchronous download.
+ *
+ * A download runs dc_device_foreach on a worker thread, while the
+ * calling thread remains free for other work. While the download is
+ * running, the device and its context are used from the worker thread,
+ * and should not be used from any other thread until the download has
+ * finished. Use a separate context for parsing the dives in the
+ * meantime. The download replaces the event and cancel callbacks of
+ * the device.
+ *
+ * The callbacks are delivered in one of two ways:
+ *
+ * Without a notify function, all callbacks are called directly from
+ * the worker thread.
+ *
+ * With a notify function, the events and dives are queued instead,
+ * and the notify function is called from the worker thread as soon as
+ * the queue is no longer empty. The application (typically from its
+ * event loop) then calls dc_download_dispatch to deliver the queued
+ * callbacks on its own thread. Consecutive progress events are merged
+ * while they are waiting in the queue. Because the device may already
+ * be closed by the time a queued event is delivered, the device
+ * argument of the event callback is always NULL in this mode.
+ */
+typedef struct dc_download_t dc_download_t;
+
+/*
+ * Notify the application that there are callbacks waiting to be
+ * dispatched. This function is called from the worker thread, and
+ * should do nothing more than wake up the thread that will call
+ * dc_download_dispatch.
+ */
+typedef void (*dc_download_notify_t) (dc_download_t *download, void *userdata);
+
+/*
+ * Called exactly once, after the last dive and event, with the final
+ * status of the download.
+ */
+typedef void (*dc_download_finish_t) (dc_download_t *download, dc_status_t status, void *userdata);
+
+dc_status_t
+dc_download_new (dc_download_t **download, dc_device_t *device);
+
+dc_status_t
+dc_download_set_events (dc_download_t *download, unsigned int events, dc_event_callback_t callback, void *userdata);
+
+dc_status_t
+dc_download_set_notify (dc_download_t *download, dc_download_notify_t callback, void *userdata);
+
+/*
+ * Start downloading the dives.
+ *
+ * The dive callback follows the same contract as for dc_device_foreach.
+ * Returning zero stops the download. When the callbacks are queued,
+ * the download stops at the next dive, and any dives that are already
+ * queued are discarded.
+ *
+ * On platforms without thread support, the download runs to completion
+ * before this function returns, and the callbacks are delivered
+ * afterwards.
+ */
+dc_status_t
+dc_download_start (dc_download_t *download, dc_dive_callback_t callback, dc_download_finish_t finish, void *userdata);
+
+/*
+ * Deliver all queued callbacks on the calling thread.
+ */
+dc_status_t
+dc_download_dispatch (dc_download_t *download);
+
+/*
+ * Request the download to stop.
+ *
+ * This function can be called from any thread. The download stops as
+ * soon as the backend checks for cancellation, or at the latest before
+ * the next dive is reported, and the final status is DC_STATUS_CANCELLED.
+ * Dives that are still queued are discarded. If the download has
+ * already finished, only the queued dives are affected.
+ */
+dc_status_t
+dc_download_cancel (dc_download_t *download);
+
+/*
+ * Wait for the download to finish, and return its final status.
+ *
+ * When the callbacks are queued, they are dispatched on the calling
+ * thread while waiting.
+ */
+dc_status_t
+dc_download_wait (dc_download_t *download);
+
+/*
+ * Cancel the download if it is still running, wait for the worker
+ * thread, and release all resources. The device is not closed.
+ */
+dc_status_t
+dc_download_free (dc_download_t *download);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_DOWNLOAD_H */
@@ -0,0 +1,141 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_DOWNLOADMANAGER_H
+#define DC_DOWNLOADMANAGER_H
+
+#include "common.h"
+#include "context.h"
+#include "descriptor.h"
+#include "iostream.h"
+#include "device.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Opaque object representing a download manager.
+ *
+ * A download manager downloads the dives from multiple devices
+ * concurrently. Every device gets an identifier, which is simply its
+ * index in the order the devices were added to the manager. All
+ * callbacks are delivered from the thread running
+ * dc_download_manager_run, together with the identifier of the device.
+ */
+typedef struct dc_download_manager_t dc_download_manager_t;
+
+/*
+ * Open the I/O stream for a device.
+ *
+ * This function is called from a worker thread, with the context that
+ * should be used for the I/O stream.
+ */
+typedef dc_status_t (*dc_download_manager_open_t) (dc_iostream_t **iostream, dc_context_t *context, dc_descriptor_t *descriptor, void *userdata);
+
+typedef struct dc_download_manager_cbs_t {
+	void (*event) (unsigned int id, dc_event_type_t event, const void *data, void *userdata);
+	int (*dive) (unsigned int id, const unsigned char *data, unsigned int size, const unsigned char *fingerprint, unsigned int fsize, void *userdata);
+	void (*finish) (unsigned int id, dc_status_t status, void *userdata);
+} dc_download_manager_cbs_t;
+
+/*
+ * Create a new download manager.
+ *
+ * At most nthreads devices are downloaded at the same time. With zero
+ * threads, the devices are downloaded one after the other. Each device
+ * uses its own clone of the context, so the log function can be called
+ * from multiple threads simultaneously.
+ */
+dc_status_t
+dc_download_manager_new (dc_download_manager_t **manager, dc_context_t *context, unsigned int nthreads);
+
+/*
+ * Add a device, using a custom function to open its I/O stream.
+ *
+ * This can be used for transports that can't be enumerated, or for
+ * simulated devices created with dc_custom_open. The I/O stream is
+ * closed by the manager after the download. The descriptor is not
+ * copied, and should remain valid until the manager is freed.
+ */
+dc_status_t
+dc_download_manager_add (dc_download_manager_t *manager, dc_descriptor_t *descriptor, dc_download_manager_open_t open, void *userdata, unsigned int *id);
+
+/*
+ * Add all connected devices that match the descriptor.
+ *
+ * The devices are enumerated with the iterators of the usb hid, usb and
+ * serial transports, limited to the transports in the mask that are
+ * supported by the descriptor. Because most serial devices can't be
+ * identified before they are opened, the serial transport should only
+ * be included if all serial ports are known to have such a device
+ * connected. The number of devices that were added is returned in
+ * count. The descriptor is not copied, and should remain valid until
+ * the manager is freed.
+ */
+dc_status_t
+dc_download_manager_scan (dc_download_manager_t *manager, dc_descriptor_t *descriptor, unsigned int transports, unsigned int *count);
+
+/*
+ * Get the number of devices.
+ */
+unsigned int
+dc_download_manager_get_count (dc_download_manager_t *manager);
+
+/*
+ * Set the fingerprint of the most recent dive already downloaded from
+ * the device.
+ */
+dc_status_t
+dc_download_manager_set_fingerprint (dc_download_manager_t *manager, unsigned int id, const unsigned char data[], unsigned int size);
+
+/*
+ * Set the events that are passed to the event callback.
+ */
+dc_status_t
+dc_download_manager_set_events (dc_download_manager_t *manager, unsigned int events);
+
+/*
+ * Download the dives from all devices.
+ *
+ * The finish callback is called exactly once for every device, also
+ * if the device couldn't be opened. Returning zero from the dive
+ * callback only stops the download of that device.
+ */
+dc_status_t
+dc_download_manager_run (dc_download_manager_t *manager, const dc_download_manager_cbs_t *callbacks, void *userdata);
+
+/*
+ * Stop all downloads. Devices that haven't been started yet are
+ * finished with DC_STATUS_CANCELLED. This function can be called from
+ * any thread, also before dc_download_manager_run is called. A
+ * cancelled manager remains cancelled.
+ */
+dc_status_t
+dc_download_manager_cancel (dc_download_manager_t *manager);
+
+dc_status_t
+dc_download_manager_free (dc_download_manager_t *manager);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_DOWNLOADMANAGER_H */
@@ -83,6 +83,38 @@ typedef enum dc_line_t {
 	DC_LINE_RNG = 0x08, /**< Ring indicator */
 } dc_line_t;
 
+/**
+ * The number of buckets in the latency histograms.
+ */
+#define DC_IOSTREAM_HISTOGRAM_SIZE 24
+
+/**
+ * The statistics of a single type of operation.
+ *
+ * The latency histogram uses logarithmic buckets. Bucket n counts the
+ * calls that took at least 2^(n-1) and less than 2^n microseconds.
+ * The first bucket counts the calls that completed in less than one
+ * microsecond, and the last bucket also includes all slower calls.
+ */
+typedef struct dc_iostream_opstats_t {
+	unsigned int count;       /**< Number of calls */
+	unsigned int timeouts;    /**< Number of calls that timed out */
+	unsigned int errors;      /**< Number of calls that failed otherwise */
+	unsigned long long bytes; /**< Number of bytes transferred */
+	dc_usecs_t elapsed;       /**< Total duration in microseconds */
+	unsigned int histogram[DC_IOSTREAM_HISTOGRAM_SIZE]; /**< Latency histogram */
+} dc_iostream_opstats_t;
+
+/**
+ * The transfer statistics of an I/O stream.
+ */
+typedef struct dc_iostream_stats_t {
+	dc_iostream_opstats_t read;  /**< Read operations */
+	dc_iostream_opstats_t write; /**< Write operations */
+	dc_iostream_opstats_t poll;  /**< Poll operations */
+	dc_iostream_opstats_t sleep; /**< Sleep operations */
+} dc_iostream_stats_t;
+
 /**
  * Get the transport type.
  *
@@ -92,6 +124,20 @@ typedef enum dc_line_t {
 dc_transport_t
 dc_iostream_get_transport (dc_iostream_t *iostream);
 
+/**
+ * Get the transfer statistics.
+ *
+ * The statistics are accumulated from the moment the I/O stream is
+ * opened, and cover all read, write, poll and sleep operations.
+ *
+ * @param[in]   iostream  A valid I/O stream.
+ * @param[out]  stats     A location to store the statistics.
+ * @returns #DC_STATUS_SUCCESS on success, or another #dc_status_t code
+ * on failure.
+ */
+dc_status_t
+dc_iostream_get_stats (dc_iostream_t *iostream, dc_iostream_stats_t *stats);
+
 /**
  * Set the read timeout.
  *
@@ -35,6 +35,14 @@ oceanic_atom2_device_version (dc_device_t *device, unsigned char data[], unsigne
 dc_status_t
 oceanic_atom2_device_keepalive (dc_device_t *device);
 
+/*
+ * Set the number of memory pages kept in the cache (default 8, maximum
+ * 32). The cache avoids reading the same pages multiple times, for
+ * example when the logbook and the profile data share a page.
+ */
+dc_status_t
+oceanic_atom2_device_set_cache (dc_device_t *device, unsigned int npages);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
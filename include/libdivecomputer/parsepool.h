@@ -0,0 +1,94 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_PARSEPOOL_H
+#define DC_PARSEPOOL_H
+
+#include "common.h"
+#include "context.h"
+#include "descriptor.h"
+#include "buffer.h"
+#include "parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Opaque object representing a pool of parser threads.
+ */
+typedef struct dc_parse_pool_t dc_parse_pool_t;
+
+/*
+ * Process a single dive.
+ *
+ * This function is called from one of the worker threads, with a
+ * parser for the dive. Any output should be stored in the buffer, which
+ * is passed to the deliver function afterwards. The returned status is
+ * passed to the deliver function as well.
+ */
+typedef dc_status_t (*dc_parse_pool_process_t) (dc_parser_t *parser, unsigned int index, dc_buffer_t *output, void *userdata);
+
+/*
+ * Deliver the result of a single dive.
+ *
+ * This function is called from the thread running dc_parse_pool_run,
+ * exactly once for every job, in the order the jobs were added. If the
+ * parser couldn't be created, the status contains the error and the
+ * process function has not been called. Returning an error aborts the
+ * processing of all remaining jobs.
+ */
+typedef dc_status_t (*dc_parse_pool_deliver_t) (unsigned int index, dc_status_t status, const unsigned char data[], size_t size, void *userdata);
+
+/*
+ * Create a new pool with the specified number of worker threads.
+ *
+ * Each worker uses its own clone of the context, so the log function
+ * can be called from multiple threads simultaneously. With zero threads
+ * (or on platforms without thread support, or if no worker thread can
+ * be started), all jobs are processed sequentially from the calling
+ * thread.
+ */
+dc_status_t
+dc_parse_pool_new (dc_parse_pool_t **pool, dc_context_t *context, unsigned int nthreads);
+
+/*
+ * Add a job to the pool.
+ *
+ * The descriptor and the dive data are not copied, and should remain
+ * valid until dc_parse_pool_run returns.
+ */
+dc_status_t
+dc_parse_pool_add (dc_parse_pool_t *pool, dc_descriptor_t *descriptor, const unsigned char data[], size_t size);
+
+/*
+ * Process all jobs and remove them from the pool.
+ */
+dc_status_t
+dc_parse_pool_run (dc_parse_pool_t *pool, dc_parse_pool_process_t process, dc_parse_pool_deliver_t deliver, void *userdata);
+
+dc_status_t
+dc_parse_pool_free (dc_parse_pool_t *pool);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_PARSEPOOL_H */
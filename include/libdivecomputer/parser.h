@@ -275,6 +275,73 @@ typedef struct dc_parser_t dc_parser_t;
 
 typedef void (*dc_sample_callback_t) (dc_sample_type_t type, const dc_sample_value_t *value, void *userdata);
 
+/*
+ * Sample batch
+ *
+ * A sample batch is a set of caller provided arrays (columns), which
+ * are filled with up to capacity sample sets (rows) at a time. Each row
+ * corresponds with one DC_SAMPLE_TIME sample, and all the other samples
+ * that follow it. Columns that are not needed can be set to NULL.
+ *
+ * The types column contains a bitmask with the sample types present in
+ * each row ((1 << DC_SAMPLE_DEPTH), etc). The values of the missing
+ * sample types are undefined. If multiple tank pressures are reported
+ * in a single row, only the first one is stored. The ppo2 column
+ * contains the ppo2 value without a sensor index if available, and the
+ * average of the individual sensors otherwise. Events and vendor
+ * samples are not available in a sample batch.
+ */
+typedef struct dc_sample_batch_t {
+	unsigned int capacity;    /* Number of rows in each column */
+	unsigned int count;       /* Number of rows filled */
+	unsigned int *types;      /* Bitmask of the sample types */
+	unsigned int *time;       /* Milliseconds */
+	double *depth;
+	unsigned int *tank;
+	double *pressure;
+	double *temperature;
+	unsigned int *rbt;
+	unsigned int *heartbeat;
+	unsigned int *bearing;
+	double *setpoint;
+	double *ppo2;
+	double *cns;
+	unsigned int *deco_type;
+	unsigned int *deco_time;
+	double *deco_depth;
+	unsigned int *deco_tts;
+	unsigned int *gasmix;
+} dc_sample_batch_t;
+
+typedef void (*dc_sample_batch_callback_t) (dc_sample_batch_t *batch, void *userdata);
+
+/*
+ * Dive summary
+ *
+ * All the fields of a dive, with the same values as returned by
+ * dc_parser_get_field. The fields member contains a bitmask with the
+ * available fields ((1 << DC_FIELD_DIVETIME), etc). The values of the
+ * missing fields are zero. The gasmix and tank arrays are owned by the
+ * parser, and remain valid until the parser is reset or destroyed.
+ */
+typedef struct dc_summary_t {
+	unsigned int fields;
+	unsigned int divetime;
+	double maxdepth;
+	double avgdepth;
+	unsigned int ngasmixes;
+	const dc_gasmix_t *gasmix;
+	dc_salinity_t salinity;
+	double atmospheric;
+	double temperature_surface;
+	double temperature_minimum;
+	double temperature_maximum;
+	unsigned int ntanks;
+	const dc_tank_t *tank;
+	dc_divemode_t divemode;
+	dc_decomodel_t decomodel;
+} dc_summary_t;
+
 dc_status_t
 dc_parser_new (dc_parser_t **parser, dc_device_t *device, const unsigned char data[], size_t size);
 
@@ -284,6 +351,19 @@ dc_parser_new2 (dc_parser_t **parser, dc_context_t *context, dc_descriptor_t *de
 dc_family_t
 dc_parser_get_type (dc_parser_t *parser);
 
+/*
+ * Replace the dive data of an existing parser.
+ *
+ * All cached information about the previous dive is discarded, but the
+ * settings (clock, atmospheric pressure and water density) are
+ * preserved. This allows to re-use a single parser instance for many
+ * dives of the same device, without having to allocate a new parser
+ * for each dive. If the new dive data is rejected, the parser can only
+ * be reset again or destroyed.
+ */
+dc_status_t
+dc_parser_reset (dc_parser_t *parser, const unsigned char data[], size_t size);
+
 dc_status_t
 dc_parser_set_clock (dc_parser_t *parser, unsigned int devtime, dc_ticks_t systime);
 
@@ -299,9 +379,40 @@ dc_parser_get_datetime (dc_parser_t *parser, dc_datetime_t *datetime);
 dc_status_t
 dc_parser_get_field (dc_parser_t *parser, dc_field_type_t type, unsigned int flags, void *value);
 
+/*
+ * Get all the fields of the dive at once.
+ *
+ * The summary is computed only once, and cached in the parser until
+ * the dive data or one of the parser settings is changed.
+ */
+dc_status_t
+dc_parser_get_summary (dc_parser_t *parser, dc_summary_t *summary);
+
 dc_status_t
 dc_parser_samples_foreach (dc_parser_t *parser, dc_sample_callback_t callback, void *userdata);
 
+dc_status_t
+dc_parser_samples_batch (dc_parser_t *parser, dc_sample_batch_t *batch, dc_sample_batch_callback_t callback, void *userdata);
+
+/*
+ * Iterate over the samples within a time range.
+ *
+ * Only the sample sets (a DC_SAMPLE_TIME sample and all the samples
+ * that follow it) with a time in the range [begin, end) are reported.
+ * The times are in milliseconds. Samples reported before the first
+ * DC_SAMPLE_TIME sample belong to the first sample set.
+ *
+ * The first call decodes the entire dive, and keeps an index of the
+ * decoded samples in the parser. Subsequent calls only visit the
+ * requested range. The index holds a copy of every decoded sample
+ * (about 40 bytes each on 64-bit platforms), and is discarded when the
+ * dive data or one of the parser settings is changed. Note that
+ * samples which are only reported when they change (for example the
+ * gas mix) are not repeated at the start of the range.
+ */
+dc_status_t
+dc_parser_samples_range (dc_parser_t *parser, unsigned int begin, unsigned int end, dc_sample_callback_t callback, void *userdata);
+
 dc_status_t
 dc_parser_destroy (dc_parser_t *parser);
 
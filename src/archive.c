@@ -0,0 +1,707 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOGDI
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_MMAP)
+#define USE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
+#endif
+
+#include <libdivecomputer/archive.h>
+#include <libdivecomputer/buffer.h>
+
+#include "context-private.h"
+#include "array.h"
+#include "platform.h"
+
+/*
+ * Archives can be larger than 2GB, which doesn't fit into the long
+ * type of the standard fseek and ftell functions on all platforms.
+ */
+#ifdef _WIN32
+#define dc_archive_fseek _fseeki64
+#define dc_archive_ftell _ftelli64
+#else
+#define dc_archive_fseek fseeko
+#define dc_archive_ftell ftello
+#endif
+
+/*
+ * The archive consists of a file header, followed by a sequence of
+ * records. All integers are stored in little endian byte order.
+ *
+ * File header (16 bytes):
+ *   0  magic "DCAR"
+ *   4  version (uint32)
+ *   8  reserved (8 bytes)
+ *
+ * Record header (24 bytes), followed by the fingerprint and the data:
+ *   0  type (uint16)
+ *   2  fingerprint size (uint16)
+ *   4  family (uint32)
+ *   8  model (uint32)
+ *  12  data size (uint32)
+ *  16  datetime (int64)
+ *
+ * The index is stored as a regular record, with the offsets of all dive
+ * records (uint64) as its data, followed by a trailer (16 bytes):
+ *   0  offset of the index record (uint64)
+ *   8  number of dives (uint32)
+ *  12  magic "DCIX"
+ *
+ * The index is always the last record in the file. When new dives are
+ * appended, the old index is overwritten, and a new one is written
+ * once the archive is closed.
+ */
+#define ARCHIVE_VERSION 1
+
+#define SZ_HEADER  16
+#define SZ_RECORD  24
+#define SZ_OFFSET  8
+#define SZ_TRAILER 16
+
+#define RECORD_DIVE  1
+#define RECORD_INDEX 2
+
+static const unsigned char header_magic[4] = {'D', 'C', 'A', 'R'};
+static const unsigned char trailer_magic[4] = {'D', 'C', 'I', 'X'};
+
+struct dc_archive_t {
+	dc_context_t *context;
+	unsigned char *data;
+	size_t size;
+	/* Index (uint64 offsets) */
+	const unsigned char *index;
+	unsigned int count;
+	dc_buffer_t *buffer;
+	/* End of the last dive record. */
+	size_t end;
+#if defined(_WIN32)
+	HANDLE hFile;
+	HANDLE hMapping;
+#endif
+	int mapped;
+};
+
+struct dc_archive_writer_t {
+	dc_context_t *context;
+	FILE *fp;
+	unsigned long long offset;
+	dc_buffer_t *index;
+	/* The file position no longer matches the offset. */
+	unsigned int failed;
+};
+
+static dc_status_t
+dc_archive_map (dc_archive_t *archive, const char *filename)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	FILE *fp = NULL;
+	unsigned char *buffer = NULL;
+	long long size = 0;
+
+#if defined(_WIN32)
+	LARGE_INTEGER filesize;
+
+	archive->hFile = CreateFileA (filename, GENERIC_READ,
+		FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, NULL);
+	if (archive->hFile == INVALID_HANDLE_VALUE) {
+		DWORD errcode = GetLastError ();
+		SYSERROR (archive->context, errcode);
+		return errcode == ERROR_FILE_NOT_FOUND ? DC_STATUS_NODEVICE : DC_STATUS_IO;
+	}
+
+	if (!GetFileSizeEx (archive->hFile, &filesize)) {
+		SYSERROR (archive->context, GetLastError ());
+		return DC_STATUS_IO;
+	}
+
+	if (filesize.QuadPart < SZ_HEADER || (unsigned long long) filesize.QuadPart > (size_t) -1) {
+		ERROR (archive->context, "Invalid archive size (" DC_FORMAT_INT64 " bytes).", (long long) filesize.QuadPart);
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	archive->hMapping = CreateFileMapping (archive->hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (archive->hMapping != NULL) {
+		archive->data = (unsigned char *) MapViewOfFile (archive->hMapping, FILE_MAP_READ, 0, 0, 0);
+		if (archive->data != NULL) {
+			archive->size = filesize.QuadPart;
+			archive->mapped = 1;
+			return DC_STATUS_SUCCESS;
+		}
+	}
+
+	WARNING (archive->context, "Failed to map the archive (%lu).", GetLastError ());
+#elif defined(USE_MMAP)
+	struct stat st;
+
+	int fd = open (filename, O_RDONLY);
+	if (fd < 0) {
+		int errcode = errno;
+		SYSERROR (archive->context, errcode);
+		return errcode == ENOENT ? DC_STATUS_NODEVICE : DC_STATUS_IO;
+	}
+
+	if (fstat (fd, &st) != 0) {
+		SYSERROR (archive->context, errno);
+		close (fd);
+		return DC_STATUS_IO;
+	}
+
+	if (st.st_size < SZ_HEADER || (unsigned long long) st.st_size > (size_t) -1) {
+		ERROR (archive->context, "Invalid archive size (" DC_FORMAT_INT64 " bytes).", (long long) st.st_size);
+		close (fd);
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	void *mapping = mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close (fd);
+	if (mapping != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+		// Archives are typically processed from start to end.
+		madvise (mapping, st.st_size, MADV_SEQUENTIAL);
+#endif
+		archive->data = (unsigned char *) mapping;
+		archive->size = st.st_size;
+		archive->mapped = 1;
+		return DC_STATUS_SUCCESS;
+	}
+
+	WARNING (archive->context, "Failed to map the archive (%i).", errno);
+#endif
+
+	// Fall back to reading the entire file into memory.
+	fp = fopen (filename, "rb");
+	if (fp == NULL) {
+		int errcode = errno;
+		SYSERROR (archive->context, errcode);
+		return errcode == ENOENT ? DC_STATUS_NODEVICE : DC_STATUS_IO;
+	}
+
+	if (dc_archive_fseek (fp, 0, SEEK_END) != 0 || (size = dc_archive_ftell (fp)) < 0 || dc_archive_fseek (fp, 0, SEEK_SET) != 0) {
+		SYSERROR (archive->context, errno);
+		status = DC_STATUS_IO;
+		goto error_close;
+	}
+
+	if (size < SZ_HEADER || (unsigned long long) size > (size_t) -1) {
+		ERROR (archive->context, "Invalid archive size (" DC_FORMAT_INT64 " bytes).", size);
+		status = DC_STATUS_DATAFORMAT;
+		goto error_close;
+	}
+
+	buffer = (unsigned char *) malloc ((size_t) size);
+	if (buffer == NULL) {
+		ERROR (archive->context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_close;
+	}
+
+	if (fread (buffer, 1, (size_t) size, fp) != (size_t) size) {
+		ERROR (archive->context, "Failed to read the archive.");
+		status = DC_STATUS_IO;
+		goto error_free;
+	}
+
+	fclose (fp);
+
+	archive->data = buffer;
+	archive->size = size;
+	archive->mapped = 0;
+
+	return DC_STATUS_SUCCESS;
+
+error_free:
+	free (buffer);
+error_close:
+	fclose (fp);
+	return status;
+}
+
+static void
+dc_archive_unmap (dc_archive_t *archive)
+{
+#if defined(_WIN32)
+	if (archive->mapped)
+		UnmapViewOfFile (archive->data);
+	if (archive->hMapping != NULL)
+		CloseHandle (archive->hMapping);
+	if (archive->hFile != INVALID_HANDLE_VALUE)
+		CloseHandle (archive->hFile);
+#elif defined(USE_MMAP)
+	if (archive->mapped)
+		munmap (archive->data, archive->size);
+#endif
+	if (!archive->mapped)
+		free (archive->data);
+}
+
+/*
+ * Get the total length of the record at the specified offset, or zero
+ * if there is no valid record.
+ */
+static size_t
+dc_archive_record_length (dc_archive_t *archive, size_t offset, unsigned int *type)
+{
+	if (offset > archive->size || archive->size - offset < SZ_RECORD)
+		return 0;
+
+	const unsigned char *record = archive->data + offset;
+	size_t length = SZ_RECORD + array_uint16_le (record + 2) + (size_t) array_uint32_le (record + 12);
+	if (length > archive->size - offset)
+		return 0;
+
+	if (type)
+		*type = array_uint16_le (record);
+
+	return length;
+}
+
+static dc_status_t
+dc_archive_load_index (dc_archive_t *archive)
+{
+	if (archive->size < SZ_HEADER + SZ_RECORD + SZ_TRAILER)
+		return DC_STATUS_DATAFORMAT;
+
+	const unsigned char *trailer = archive->data + archive->size - SZ_TRAILER;
+	if (memcmp (trailer + 12, trailer_magic, sizeof (trailer_magic)) != 0)
+		return DC_STATUS_DATAFORMAT;
+
+	unsigned long long offset = array_uint64_le (trailer);
+	unsigned int count = array_uint32_le (trailer + 8);
+	if (offset < SZ_HEADER || offset > archive->size)
+		return DC_STATUS_DATAFORMAT;
+
+	// The index record should end exactly at the end of the file.
+	unsigned int type = 0;
+	size_t length = dc_archive_record_length (archive, offset, &type);
+	if (type != RECORD_INDEX || offset + length != archive->size ||
+		length != SZ_RECORD + (size_t) count * SZ_OFFSET + SZ_TRAILER)
+		return DC_STATUS_DATAFORMAT;
+
+	archive->index = archive->data + offset + SZ_RECORD;
+	archive->count = count;
+	archive->end = offset;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_archive_scan_index (dc_archive_t *archive)
+{
+	archive->buffer = dc_buffer_new (0);
+	if (archive->buffer == NULL) {
+		ERROR (archive->context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	size_t offset = SZ_HEADER;
+	while (offset < archive->size) {
+		unsigned int type = 0;
+		size_t length = dc_archive_record_length (archive, offset, &type);
+		if (length == 0 || (type != RECORD_DIVE && type != RECORD_INDEX)) {
+			WARNING (archive->context, "Ignoring trailing data at offset " DC_PRINTF_SIZE ".", offset);
+			break;
+		}
+
+		if (type == RECORD_DIVE) {
+			unsigned char value[SZ_OFFSET] = {0};
+			array_uint64_le_set (value, offset);
+			if (!dc_buffer_append (archive->buffer, value, sizeof (value))) {
+				ERROR (archive->context, "Failed to allocate memory.");
+				return DC_STATUS_NOMEMORY;
+			}
+
+			archive->end = offset + length;
+		}
+
+		offset += length;
+	}
+
+	archive->index = dc_buffer_get_data (archive->buffer);
+	archive->count = dc_buffer_get_size (archive->buffer) / SZ_OFFSET;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_archive_open (dc_archive_t **out, dc_context_t *context, const char *filename)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_archive_t *archive = NULL;
+
+	if (out == NULL || filename == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	// Allocate memory.
+	archive = (dc_archive_t *) malloc (sizeof (dc_archive_t));
+	if (archive == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	archive->context = context;
+	archive->data = NULL;
+	archive->size = 0;
+	archive->index = NULL;
+	archive->count = 0;
+	archive->buffer = NULL;
+	archive->end = SZ_HEADER;
+#if defined(_WIN32)
+	archive->hFile = INVALID_HANDLE_VALUE;
+	archive->hMapping = NULL;
+#endif
+	archive->mapped = 0;
+
+	status = dc_archive_map (archive, filename);
+	if (status != DC_STATUS_SUCCESS) {
+		goto error_unmap;
+	}
+
+	// Verify the file header.
+	if (memcmp (archive->data, header_magic, sizeof (header_magic)) != 0 ||
+		array_uint32_le (archive->data + 4) != ARCHIVE_VERSION) {
+		ERROR (archive->context, "Unsupported archive format.");
+		status = DC_STATUS_DATAFORMAT;
+		goto error_unmap;
+	}
+
+	// Use the stored index, or rebuild it if there is none.
+	status = dc_archive_load_index (archive);
+	if (status != DC_STATUS_SUCCESS) {
+		WARNING (archive->context, "No valid index found. Scanning the archive.");
+		status = dc_archive_scan_index (archive);
+		if (status != DC_STATUS_SUCCESS) {
+			goto error_unmap;
+		}
+	}
+
+	*out = archive;
+
+	return DC_STATUS_SUCCESS;
+
+error_unmap:
+	dc_buffer_free (archive->buffer);
+	dc_archive_unmap (archive);
+	free (archive);
+	return status;
+}
+
+unsigned int
+dc_archive_get_count (dc_archive_t *archive)
+{
+	if (archive == NULL)
+		return 0;
+
+	return archive->count;
+}
+
+dc_status_t
+dc_archive_get_entry (dc_archive_t *archive, unsigned int index, dc_archive_entry_t *entry)
+{
+	if (archive == NULL || entry == NULL || index >= archive->count)
+		return DC_STATUS_INVALIDARGS;
+
+	unsigned long long offset = array_uint64_le (archive->index + (size_t) index * SZ_OFFSET);
+
+	unsigned int type = 0;
+	if (offset > archive->size || dc_archive_record_length (archive, offset, &type) == 0 || type != RECORD_DIVE) {
+		ERROR (archive->context, "Invalid record at offset %llu.", offset);
+		return DC_STATUS_DATAFORMAT;
+	}
+
+	const unsigned char *record = archive->data + offset;
+	entry->fsize = array_uint16_le (record + 2);
+	entry->family = (dc_family_t) array_uint32_le (record + 4);
+	entry->model = array_uint32_le (record + 8);
+	entry->size = array_uint32_le (record + 12);
+	entry->datetime = (dc_ticks_t) array_uint64_le (record + 16);
+	entry->fingerprint = record + SZ_RECORD;
+	entry->data = entry->fingerprint + entry->fsize;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_archive_close (dc_archive_t *archive)
+{
+	if (archive == NULL)
+		return DC_STATUS_SUCCESS;
+
+	dc_buffer_free (archive->buffer);
+	dc_archive_unmap (archive);
+	free (archive);
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_archive_writer_write (dc_archive_writer_t *writer, const unsigned char data[], size_t size)
+{
+	if (size && fwrite (data, 1, size, writer->fp) != size) {
+		ERROR (writer->context, "Failed to write the archive.");
+		return DC_STATUS_IO;
+	}
+
+	writer->offset += size;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_archive_writer_open (dc_archive_writer_t **out, dc_context_t *context, const char *filename)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_archive_writer_t *writer = NULL;
+	dc_archive_t *archive = NULL;
+
+	if (out == NULL || filename == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	// Allocate memory.
+	writer = (dc_archive_writer_t *) malloc (sizeof (dc_archive_writer_t));
+	if (writer == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	writer->context = context;
+	writer->fp = NULL;
+	writer->offset = 0;
+	writer->failed = 0;
+
+	writer->index = dc_buffer_new (0);
+	if (writer->index == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+
+	writer->fp = fopen (filename, "r+b");
+	if (writer->fp == NULL) {
+		writer->fp = fopen (filename, "w+b");
+		if (writer->fp == NULL) {
+			SYSERROR (context, errno);
+			status = DC_STATUS_IO;
+			goto error_buffer_free;
+		}
+	}
+
+	// Get the size of the file.
+	long long size = 0;
+	if (dc_archive_fseek (writer->fp, 0, SEEK_END) != 0 ||
+		(size = dc_archive_ftell (writer->fp)) < 0 ||
+		dc_archive_fseek (writer->fp, 0, SEEK_SET) != 0) {
+		SYSERROR (context, errno);
+		status = DC_STATUS_IO;
+		goto error_close;
+	}
+
+	if (size == 0) {
+		// Create a new archive. An empty file is treated the same as
+		// a missing file.
+		unsigned char header[SZ_HEADER] = {0};
+		memcpy (header, header_magic, sizeof (header_magic));
+		array_uint32_le_set (header + 4, ARCHIVE_VERSION);
+		status = dc_archive_writer_write (writer, header, sizeof (header));
+		if (status != DC_STATUS_SUCCESS) {
+			goto error_close;
+		}
+	} else {
+		// Load the index of the existing archive.
+		status = dc_archive_open (&archive, context, filename);
+		if (status != DC_STATUS_SUCCESS) {
+			goto error_close;
+		}
+
+		if (!dc_buffer_append (writer->index, archive->index, (size_t) archive->count * SZ_OFFSET)) {
+			ERROR (context, "Failed to allocate memory.");
+			dc_archive_close (archive);
+			status = DC_STATUS_NOMEMORY;
+			goto error_close;
+		}
+
+		// New records are appended after the last dive, replacing
+		// the old index (or any incomplete record).
+		writer->offset = archive->end;
+
+		dc_archive_close (archive);
+
+		if (dc_archive_fseek (writer->fp, writer->offset, SEEK_SET) != 0) {
+			SYSERROR (context, errno);
+			status = DC_STATUS_IO;
+			goto error_close;
+		}
+	}
+
+	*out = writer;
+
+	return DC_STATUS_SUCCESS;
+
+error_close:
+	fclose (writer->fp);
+error_buffer_free:
+	dc_buffer_free (writer->index);
+error_free:
+	free (writer);
+	return status;
+}
+
+dc_status_t
+dc_archive_writer_append (dc_archive_writer_t *writer, const dc_archive_entry_t *entry)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (writer == NULL || entry == NULL ||
+		(entry->fingerprint == NULL && entry->fsize) ||
+		(entry->data == NULL && entry->size) ||
+		entry->fsize > 0xFFFF)
+		return DC_STATUS_INVALIDARGS;
+
+	if (writer->failed) {
+		ERROR (writer->context, "The archive is in an inconsistent state.");
+		return DC_STATUS_IO;
+	}
+
+	// The index entry is only added once the entire record is written.
+	unsigned long long begin = writer->offset;
+
+	unsigned char header[SZ_RECORD] = {0};
+	array_uint16_le_set (header + 0, RECORD_DIVE);
+	array_uint16_le_set (header + 2, entry->fsize);
+	array_uint32_le_set (header + 4, entry->family);
+	array_uint32_le_set (header + 8, entry->model);
+	array_uint32_le_set (header + 12, entry->size);
+	array_uint64_le_set (header + 16, entry->datetime);
+
+	status = dc_archive_writer_write (writer, header, sizeof (header));
+	if (status != DC_STATUS_SUCCESS)
+		goto error_rollback;
+
+	status = dc_archive_writer_write (writer, entry->fingerprint, entry->fsize);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_rollback;
+
+	status = dc_archive_writer_write (writer, entry->data, entry->size);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_rollback;
+
+	unsigned char offset[SZ_OFFSET] = {0};
+	array_uint64_le_set (offset, begin);
+	if (!dc_buffer_append (writer->index, offset, sizeof (offset))) {
+		ERROR (writer->context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_rollback;
+	}
+
+	return DC_STATUS_SUCCESS;
+
+error_rollback:
+	// Discard the incomplete record. The next record (or the index)
+	// overwrites it, and the file is truncated when it's closed.
+	writer->offset = begin;
+	if (dc_archive_fseek (writer->fp, begin, SEEK_SET) != 0) {
+		SYSERROR (writer->context, errno);
+		writer->failed = 1;
+	}
+	return status;
+}
+
+dc_status_t
+dc_archive_writer_close (dc_archive_writer_t *writer)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (writer == NULL)
+		return DC_STATUS_SUCCESS;
+
+	// Without a valid index, the archive is scanned when it's opened
+	// again. That's better than an index that doesn't match the file.
+	if (writer->failed) {
+		ERROR (writer->context, "The index is not written.");
+		fclose (writer->fp);
+		dc_buffer_free (writer->index);
+		free (writer);
+		return DC_STATUS_IO;
+	}
+
+	unsigned long long offset = writer->offset;
+	size_t size = dc_buffer_get_size (writer->index);
+
+	// Write the index record.
+	unsigned char header[SZ_RECORD] = {0};
+	array_uint16_le_set (header + 0, RECORD_INDEX);
+	array_uint32_le_set (header + 12, size + SZ_TRAILER);
+
+	unsigned char trailer[SZ_TRAILER] = {0};
+	array_uint64_le_set (trailer, offset);
+	array_uint32_le_set (trailer + 8, size / SZ_OFFSET);
+	memcpy (trailer + 12, trailer_magic, sizeof (trailer_magic));
+
+	status = dc_archive_writer_write (writer, header, sizeof (header));
+	if (status == DC_STATUS_SUCCESS)
+		status = dc_archive_writer_write (writer, dc_buffer_get_data (writer->index), size);
+	if (status == DC_STATUS_SUCCESS)
+		status = dc_archive_writer_write (writer, trailer, sizeof (trailer));
+
+	if (fflush (writer->fp) != 0) {
+		SYSERROR (writer->context, errno);
+		status = DC_STATUS_IO;
+	}
+
+	// Discard any leftovers from a previous (larger) index.
+	if (status == DC_STATUS_SUCCESS) {
+#ifdef _WIN32
+		int rc = _chsize_s (_fileno (writer->fp), writer->offset);
+#else
+		int rc = ftruncate (fileno (writer->fp), writer->offset);
+#endif
+		if (rc != 0) {
+			SYSERROR (writer->context, errno);
+			status = DC_STATUS_IO;
+		}
+	}
+
+	fclose (writer->fp);
+	dc_buffer_free (writer->index);
+	free (writer);
+
+	return status;
+}
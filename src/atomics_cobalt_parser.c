@@ -54,9 +54,12 @@ static const dc_parser_vtable_t atomics_cobalt_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	atomics_cobalt_parser_set_density, /* set_density */
+	NULL, /* reset */
 	atomics_cobalt_parser_get_datetime, /* datetime */
 	atomics_cobalt_parser_get_field, /* fields */
 	atomics_cobalt_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
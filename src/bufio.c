@@ -0,0 +1,502 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <stdlib.h> // malloc, free
+#include <string.h>
+
+#include "bufio.h"
+
+#include "iostream-private.h"
+#include "common-private.h"
+#include "context-private.h"
+
+/*
+ * The maximum time to wait for more data when reading ahead (in
+ * milliseconds). Longer waits return more data per read, but a device
+ * that stopped sending also delays the last read of its answer.
+ */
+#define READAHEAD 1
+
+static dc_status_t dc_bufio_set_timeout (dc_iostream_t *abstract, int timeout);
+static dc_status_t dc_bufio_set_break (dc_iostream_t *abstract, unsigned int value);
+static dc_status_t dc_bufio_set_dtr (dc_iostream_t *abstract, unsigned int value);
+static dc_status_t dc_bufio_set_rts (dc_iostream_t *abstract, unsigned int value);
+static dc_status_t dc_bufio_get_lines (dc_iostream_t *abstract, unsigned int *value);
+static dc_status_t dc_bufio_get_available (dc_iostream_t *abstract, size_t *value);
+static dc_status_t dc_bufio_configure (dc_iostream_t *abstract, unsigned int baudrate, unsigned int databits, dc_parity_t parity, dc_stopbits_t stopbits, dc_flowcontrol_t flowcontrol);
+static dc_status_t dc_bufio_poll (dc_iostream_t *abstract, int timeout);
+static dc_status_t dc_bufio_read (dc_iostream_t *abstract, void *data, size_t size, size_t *actual);
+static dc_status_t dc_bufio_write (dc_iostream_t *abstract, const void *data, size_t size, size_t *actual);
+static dc_status_t dc_bufio_ioctl (dc_iostream_t *abstract, unsigned int request, void *data, size_t size);
+static dc_status_t dc_bufio_flush (dc_iostream_t *abstract);
+static dc_status_t dc_bufio_purge (dc_iostream_t *abstract, dc_direction_t direction);
+static dc_status_t dc_bufio_sleep (dc_iostream_t *abstract, unsigned int milliseconds);
+static dc_status_t dc_bufio_close (dc_iostream_t *abstract);
+
+typedef struct dc_bufio_t {
+	/* Base class. */
+	dc_iostream_t base;
+	/* Internal state. */
+	dc_iostream_t *iostream;
+	unsigned char *ibuffer;
+	size_t isize;
+	size_t available;
+	size_t offset;
+	unsigned char *obuffer;
+	size_t osize;
+	size_t pending;
+	int timeout;
+	int readahead;
+	unsigned int shortened;
+} dc_bufio_t;
+
+static const dc_iostream_vtable_t dc_bufio_vtable = {
+	sizeof(dc_bufio_t),
+	dc_bufio_set_timeout, /* set_timeout */
+	dc_bufio_set_break, /* set_break */
+	dc_bufio_set_dtr, /* set_dtr */
+	dc_bufio_set_rts, /* set_rts */
+	dc_bufio_get_lines, /* get_lines */
+	dc_bufio_get_available, /* get_available */
+	dc_bufio_configure, /* configure */
+	dc_bufio_poll, /* poll */
+	dc_bufio_read, /* read */
+	dc_bufio_write, /* write */
+	dc_bufio_ioctl, /* ioctl */
+	dc_bufio_flush, /* flush */
+	dc_bufio_purge, /* purge */
+	dc_bufio_sleep, /* sleep */
+	dc_bufio_close, /* close */
+};
+
+dc_status_t
+dc_bufio_open (dc_iostream_t **out, dc_context_t *context, dc_iostream_t *base, size_t isize, size_t osize)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_bufio_t *bufio = NULL;
+	unsigned char *buffer = NULL;
+
+	if (out == NULL || base == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	// Allocate memory.
+	bufio = (dc_bufio_t *) dc_iostream_allocate (NULL, &dc_bufio_vtable, dc_iostream_get_transport(base));
+	if (bufio == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_exit;
+	}
+
+	// Allocate the input and output buffers.
+	if (isize + osize) {
+		buffer = (unsigned char *) malloc (isize + osize);
+		if (buffer == NULL) {
+			ERROR (context, "Failed to allocate memory.");
+			status = DC_STATUS_NOMEMORY;
+			goto error_free;
+		}
+	}
+
+	bufio->iostream = base;
+	bufio->ibuffer = buffer;
+	bufio->isize = isize;
+	bufio->available = 0;
+	bufio->offset = 0;
+	bufio->obuffer = buffer ? buffer + isize : NULL;
+	bufio->osize = osize;
+	bufio->pending = 0;
+	bufio->timeout = -1;
+	bufio->readahead = 0;
+	bufio->shortened = 0;
+
+	*out = (dc_iostream_t *) bufio;
+
+	return DC_STATUS_SUCCESS;
+
+error_free:
+	dc_iostream_deallocate ((dc_iostream_t *) bufio);
+error_exit:
+	return status;
+}
+
+/*
+ * Get the timeout for reading ahead. A caller that doesn't want to wait
+ * that long already gets its own timeout.
+ */
+static int
+dc_bufio_readahead (dc_bufio_t *bufio)
+{
+	if (bufio->timeout >= 0 && bufio->timeout < READAHEAD)
+		return bufio->timeout;
+
+	return READAHEAD;
+}
+
+/*
+ * Switch the base stream between the timeout of the caller and the
+ * shorter read-ahead timeout. The timeout is only changed when needed,
+ * because that can be a system call.
+ */
+static dc_status_t
+dc_bufio_shorten (dc_bufio_t *bufio, unsigned int value)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (bufio->shortened == value)
+		return DC_STATUS_SUCCESS;
+
+	status = dc_iostream_set_timeout (bufio->iostream, value ? dc_bufio_readahead (bufio) : bufio->timeout);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	bufio->shortened = value;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_bufio_drain (dc_bufio_t *bufio)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (bufio->pending == 0)
+		return DC_STATUS_SUCCESS;
+
+	// Writes use the timeout of the caller.
+	status = dc_bufio_shorten (bufio, 0);
+	if (status != DC_STATUS_SUCCESS) {
+		bufio->pending = 0;
+		return status;
+	}
+
+	// Send the pending data. On failure, the data is discarded, because
+	// there is no way to tell how much of it has been received.
+	status = dc_iostream_write (bufio->iostream, bufio->obuffer, bufio->pending, NULL);
+	bufio->pending = 0;
+
+	return status;
+}
+
+static dc_status_t
+dc_bufio_set_timeout (dc_iostream_t *abstract, int timeout)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_bufio_t *bufio = (dc_bufio_t *) abstract;
+
+	status = dc_iostream_set_timeout (bufio->iostream, timeout);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	// Without a known timeout, the base stream is never switched to the
+	// read-ahead timeout, because it can't be restored afterwards.
+	bufio->timeout = timeout;
+	bufio->readahead = 1;
+	bufio->shortened = 0;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_bufio_set_break (dc_iostream_t *abstract, unsigned int value)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_bufio_t *bufio = (dc_bufio_t *) abstract;
+
+	status = dc_bufio_drain (bufio);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	return dc_iostream_set_break (bufio->iostream, value);
+}
+
+static dc_status_t
+dc_bufio_set_dtr (dc_iostream_t *abstract, unsigned int value)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_bufio_t *bufio = (dc_bufio_t *) abstract;
+
+	status = dc_bufio_drain (bufio);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	return dc_iostream_set_dtr (bufio->iostream, value);
+}
+
+static dc_status_t
+dc_bufio_set_rts (dc_iostream_t *abstract, unsigned int value)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_bufio_t *bufio = (dc_bufio_t *) abstract;
+
+	status = dc_bufio_drain (bufio);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	return dc_iostream_set_rts (bufio->iostream, value);
+}
+
+static dc_status_t
+dc_bufio_get_lines (dc_iostream_t *abstract, unsigned int *value)
+{
+	dc_bufio_t *bufio = (dc_bufio_t *) abstract;
+
+	return dc_iostream_get_lines (bufio->iostream, value);
+}
+
+static dc_status_t
+dc_bufio_get_available (dc_iostream_t *abstract, size_t *value)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_bufio_t *bufio = (dc_bufio_t *) abstract;
+	size_t available = 0;
+
+	status = dc_iostream_get_available (bufio->iostream, &available);
+
+	if (value)
+		*value = bufio->available + available;
+
+	return status;
+}
+
+static dc_status_t
+dc_bufio_configure (dc_iostream_t *abstract, unsigned int baudrate, unsigned int databits, dc_parity_t parity, dc_stopbits_t stopbits, dc_flowcontrol_t flowcontrol)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_bufio_t *bufio = (dc_bufio_t *) abstract;
+
+	status = dc_bufio_drain (bufio);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	return dc_iostream_configure (bufio->iostream, baudrate, databits, parity, stopbits, flowcontrol);
+}
+
+static dc_status_t
+dc_bufio_poll (dc_iostream_t *abstract, int timeout)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_bufio_t *bufio = (dc_bufio_t *) abstract;
+
+	if (bufio->available)
+		return DC_STATUS_SUCCESS;
+
+	status = dc_bufio_drain (bufio);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	return dc_iostream_poll (bufio->iostream, timeout);
+}
+
+static dc_status_t
+dc_bufio_read (dc_iostream_t *abstract, void *data, size_t size, size_t *actual)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_bufio_t *bufio = (dc_bufio_t *) abstract;
+	size_t nbytes = 0;
+
+	// Send the pending data first, because the caller is most likely
+	// waiting for the answer.
+	status = dc_bufio_drain (bufio);
+	if (status != DC_STATUS_SUCCESS)
+		goto out;
+
+	// Copy the data from the input buffer.
+	if (bufio->available) {
+		size_t length = size;
+		if (length > bufio->available)
+			length = bufio->available;
+
+		memcpy (data, bufio->ibuffer + bufio->offset, length);
+		bufio->available -= length;
+		bufio->offset += length;
+
+		nbytes += length;
+	}
+
+	if (nbytes < size) {
+		// Get the remaining size.
+		size_t remaining = size - nbytes;
+
+		if (remaining >= bufio->isize) {
+			// Large reads bypass the input buffer.
+			size_t length = 0;
+			status = dc_bufio_shorten (bufio, 0);
+			if (status == DC_STATUS_SUCCESS)
+				status = dc_iostream_read (bufio->iostream, (unsigned char *) data + nbytes, remaining, &length);
+			nbytes += length;
+		} else {
+			size_t length = 0;
+
+			if (bufio->readahead) {
+				// Try to fill the entire input buffer, but only wait
+				// briefly for more data. A timeout is expected here.
+				status = dc_bufio_shorten (bufio, 1);
+				if (status == DC_STATUS_SUCCESS) {
+					status = dc_iostream_read (bufio->iostream, bufio->ibuffer, bufio->isize, &length);
+					if (status == DC_STATUS_TIMEOUT)
+						status = DC_STATUS_SUCCESS;
+				}
+			}
+
+			// Wait for the remainder of the requested amount, with the
+			// timeout of the caller.
+			if (status == DC_STATUS_SUCCESS && length < remaining) {
+				if (bufio->readahead && dc_bufio_readahead (bufio) == bufio->timeout) {
+					// The read-ahead already waited long enough.
+					status = DC_STATUS_TIMEOUT;
+				} else {
+					status = dc_bufio_shorten (bufio, 0);
+					if (status == DC_STATUS_SUCCESS) {
+						size_t n = 0;
+						status = dc_iostream_read (bufio->iostream, bufio->ibuffer + length, remaining - length, &n);
+						length += n;
+					}
+				}
+			}
+
+			// Copy the requested amount. Keep the remainder.
+			size_t n = length < remaining ? length : remaining;
+			memcpy ((unsigned char *) data + nbytes, bufio->ibuffer, n);
+			bufio->available = length - n;
+			bufio->offset = n;
+
+			nbytes += n;
+		}
+	}
+
+out:
+	if (actual)
+		*actual = nbytes;
+
+	return status;
+}
+
+static dc_status_t
+dc_bufio_write (dc_iostream_t *abstract, const void *data, size_t size, size_t *actual)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_bufio_t *bufio = (dc_bufio_t *) abstract;
+	size_t nbytes = 0;
+
+	while (nbytes < size) {
+		// Get the remaining size.
+		size_t length = size - nbytes;
+
+		// Large writes bypass the output buffer.
+		if (bufio->pending == 0 && length >= bufio->osize) {
+			status = dc_bufio_shorten (bufio, 0);
+			if (status != DC_STATUS_SUCCESS)
+				break;
+			status = dc_iostream_write (bufio->iostream, (const unsigned char *) data + nbytes, length, &length);
+			nbytes += length;
+			break;
+		}
+
+		// Append to the output buffer.
+		if (length > bufio->osize - bufio->pending)
+			length = bufio->osize - bufio->pending;
+
+		memcpy (bufio->obuffer + bufio->pending, (const unsigned char *) data + nbytes, length);
+		bufio->pending += length;
+		nbytes += length;
+
+		// Send the data once the buffer is full.
+		if (bufio->pending == bufio->osize) {
+			status = dc_bufio_drain (bufio);
+			if (status != DC_STATUS_SUCCESS)
+				break;
+		}
+	}
+
+	if (actual)
+		*actual = nbytes;
+
+	return status;
+}
+
+static dc_status_t
+dc_bufio_ioctl (dc_iostream_t *abstract, unsigned int request, void *data, size_t size)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_bufio_t *bufio = (dc_bufio_t *) abstract;
+
+	status = dc_bufio_drain (bufio);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	return dc_iostream_ioctl (bufio->iostream, request, data, size);
+}
+
+static dc_status_t
+dc_bufio_flush (dc_iostream_t *abstract)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_bufio_t *bufio = (dc_bufio_t *) abstract;
+
+	status = dc_bufio_drain (bufio);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	return dc_iostream_flush (bufio->iostream);
+}
+
+static dc_status_t
+dc_bufio_purge (dc_iostream_t *abstract, dc_direction_t direction)
+{
+	dc_bufio_t *bufio = (dc_bufio_t *) abstract;
+
+	if (direction & DC_DIRECTION_INPUT) {
+		bufio->available = 0;
+		bufio->offset = 0;
+	}
+
+	if (direction & DC_DIRECTION_OUTPUT) {
+		bufio->pending = 0;
+	}
+
+	return dc_iostream_purge (bufio->iostream, direction);
+}
+
+static dc_status_t
+dc_bufio_sleep (dc_iostream_t *abstract, unsigned int milliseconds)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_bufio_t *bufio = (dc_bufio_t *) abstract;
+
+	status = dc_bufio_drain (bufio);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	return dc_iostream_sleep (bufio->iostream, milliseconds);
+}
+
+static dc_status_t
+dc_bufio_close (dc_iostream_t *abstract)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_bufio_t *bufio = (dc_bufio_t *) abstract;
+
+	status = dc_bufio_drain (bufio);
+
+	free (bufio->ibuffer);
+
+	return status;
+}
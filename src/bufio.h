@@ -0,0 +1,65 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_BUFIO_H
+#define DC_BUFIO_H
+
+#include <libdivecomputer/common.h>
+#include <libdivecomputer/context.h>
+#include <libdivecomputer/iostream.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Create a buffered I/O stream layered on top of another base I/O stream.
+ *
+ * This layered I/O reduces the number of calls into the base transport.
+ * When the input buffer runs empty, the base transport is read ahead to
+ * fill the entire input buffer, waiting at most a millisecond for more
+ * data. Only the bytes that were actually requested are waited for with
+ * the normal timeout. The read-ahead is enabled once a timeout has been
+ * set through the buffered stream, because the base transport has to be
+ * switched between the two timeouts.
+ *
+ * Written data is collected in the output buffer and only sent when the
+ * buffer is full, or when any other operation (read, poll, sleep,
+ * flush, configure, etc) is performed. Write errors are therefore
+ * reported by the next operation that sends the data.
+ *
+ * @param[out]  iostream    A location to store the buffered I/O stream.
+ * @param[in]   context     A valid context.
+ * @param[in]   base        A valid I/O stream.
+ * @param[in]   isize       The input buffer size in bytes (zero to
+ *                          disable the read buffering).
+ * @param[in]   osize       The output buffer size in bytes (zero to
+ *                          disable the write buffering).
+ * @returns #DC_STATUS_SUCCESS on success, or another #dc_status_t code
+ * on failure.
+ */
+dc_status_t
+dc_bufio_open (dc_iostream_t **iostream, dc_context_t *context, dc_iostream_t *base, size_t isize, size_t osize);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_BUFIO_H */
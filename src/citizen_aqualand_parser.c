@@ -46,9 +46,12 @@ static const dc_parser_vtable_t citizen_aqualand_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	NULL, /* reset */
 	citizen_aqualand_parser_get_datetime, /* datetime */
 	citizen_aqualand_parser_get_field, /* fields */
 	citizen_aqualand_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
@@ -29,8 +29,23 @@
 #include "array.h"
 #include "ringbuffer.h"
 #include "rbstream.h"
+#include "timer.h"
 
-#define MAXRETRIES 2
+#define MAXRETRIES  2
+#define MAXFAILURES 8
+
+#define MINBLOCKSIZE 0x4000
+#define MAXBLOCKSIZE 0x100000
+#define NBLOCKS      4
+
+/*
+ * Every read command has a fixed cost of about 750 ms (the initial
+ * delay, the wakeup sequence, sending the command one byte at a time and
+ * switching the baudrate). The blocks should be large enough to keep
+ * that overhead below 1/NOVERHEAD of the transfer time.
+ */
+#define OVERHEAD  750
+#define NOVERHEAD 4
 
 #define COCHRAN_MODEL_COMMANDER_TM 0
 #define COCHRAN_MODEL_COMMANDER_PRE21000 1
@@ -97,6 +112,9 @@ typedef struct cochran_commander_device_t {
 	const cochran_device_layout_t *layout;
 	unsigned char id[67];
 	unsigned char fingerprint[6];
+	unsigned int blocksize;
+	unsigned int nblocks;
+	unsigned int overhead;
 } cochran_commander_device_t;
 
 static dc_status_t cochran_commander_device_set_fingerprint (dc_device_t *device, const unsigned char data[], unsigned int size);
@@ -537,33 +555,118 @@ cochran_commander_read (cochran_commander_device_t *device, dc_event_progress_t
 }
 
 
+/*
+ * Number of bytes per second at the line rate (8N2 is 11 bits per byte).
+ */
+static unsigned int
+cochran_commander_rate (cochran_commander_device_t *device)
+{
+	return device->layout->baudrate / 11;
+}
+
 static dc_status_t
 cochran_commander_read_retry (cochran_commander_device_t *device, dc_event_progress_t *progress, unsigned int address, unsigned char data[], unsigned int size)
 {
-	// Save the state of the progress events.
-	unsigned int saved = 0;
-	if (progress) {
-		saved = progress->current;
-	}
-
-	unsigned int nretries = 0;
+	dc_device_t *abstract = (dc_device_t *) device;
 	dc_status_t rc = DC_STATUS_SUCCESS;
-	while ((rc = cochran_commander_read (device, progress, address, data, size)) != DC_STATUS_SUCCESS) {
-		// Automatically discard a corrupted packet,
-		// and request a new one.
-		if (rc != DC_STATUS_PROTOCOL && rc != DC_STATUS_TIMEOUT)
-			return rc;
 
-		// Abort if the maximum number of retries is reached.
-		if (nretries++ >= MAXRETRIES)
-			return rc;
+	// The low-speed read command has a 16 bit size field.
+	unsigned int maxblocksize = MAXBLOCKSIZE;
+	if (device->layout->address_bits == 24 && device->layout->baudrate == 9600)
+		maxblocksize = 0x8000;
 
-		// Restore the state of the progress events.
+	// The timer is used for measuring the overhead of the read command.
+	dc_timer_t *timer = NULL;
+	dc_timer_new (&timer);
+
+	// Large transfers are split into blocks, such that a failure only
+	// requires the current block to be downloaded again. The block size
+	// adapts to the error rate: it's halved after each failed block, and
+	// doubled again after several successful blocks. The retry limit
+	// applies to each block, and to the entire transfer.
+	unsigned int nbytes = 0;
+	unsigned int nretries = 0;
+	unsigned int nfailures = 0;
+	while (nbytes < size) {
+		// For smaller blocks than the minimum, the overhead of the
+		// read command becomes a significant part of the time.
+		unsigned long long minblocksize = (unsigned long long) cochran_commander_rate (device) * device->overhead * NOVERHEAD / 1000;
+		if (minblocksize < MINBLOCKSIZE)
+			minblocksize = MINBLOCKSIZE;
+		if (minblocksize > maxblocksize)
+			minblocksize = maxblocksize;
+
+		if (device->blocksize < minblocksize)
+			device->blocksize = minblocksize;
+		if (device->blocksize > maxblocksize)
+			device->blocksize = maxblocksize;
+
+		// Calculate the block size.
+		unsigned int len = size - nbytes;
+		if (len > device->blocksize)
+			len = device->blocksize;
+
+		// Save the state of the progress events.
+		unsigned int saved = 0;
 		if (progress) {
-			progress->current = saved;
+			saved = progress->current;
+		}
+
+		dc_usecs_t begin = 0, end = 0;
+		dc_timer_now (timer, &begin);
+
+		rc = cochran_commander_read (device, progress, address + nbytes, data + nbytes, len);
+		if (rc != DC_STATUS_SUCCESS) {
+			// Automatically discard a corrupted block,
+			// and request a new one.
+			if (rc != DC_STATUS_PROTOCOL && rc != DC_STATUS_TIMEOUT)
+				break;
+
+			// Abort if the maximum number of retries is reached.
+			if (nretries++ >= MAXRETRIES || nfailures++ >= MAXFAILURES)
+				break;
+
+			// Restore the state of the progress events.
+			if (progress) {
+				progress->current = saved;
+			}
+
+			// Use smaller blocks.
+			device->blocksize /= 2;
+			if (device->blocksize < minblocksize)
+				device->blocksize = minblocksize;
+			device->nblocks = 0;
+
+			WARNING (abstract->context, "Failed to read the block at 0x%08x. Retrying with a block size of %u bytes.",
+				address + nbytes, device->blocksize);
+			continue;
 		}
+
+		dc_timer_now (timer, &end);
+		unsigned int ms = (end - begin) / 1000;
+		INFO (abstract->context, "Read %u bytes at 0x%08x in %u ms (%u bytes/s).",
+			len, address + nbytes, ms, ms ? (unsigned int) (len * 1000ULL / ms) : 0);
+
+		// Update the estimate of the overhead, with the part of the
+		// time that isn't needed for the transfer at the line rate.
+		unsigned int transfer = (unsigned long long) len * 1000 / cochran_commander_rate (device);
+		if (ms > transfer) {
+			device->overhead = (device->overhead + (ms - transfer)) / 2;
+		}
+
+		// Use larger blocks again.
+		device->nblocks++;
+		if (device->nblocks >= NBLOCKS && device->blocksize < maxblocksize) {
+			device->blocksize *= 2;
+			device->nblocks = 0;
+		}
+
+		nbytes += len;
+		nretries = 0;
 	}
 
+	dc_timer_free (timer);
+
 	return rc;
 }
 
@@ -730,6 +833,9 @@ cochran_commander_device_open (dc_device_t **out, dc_context_t *context, dc_iost
 
 	// Set the default values.
 	device->iostream = iostream;
+	device->blocksize = MAXBLOCKSIZE;
+	device->nblocks = 0;
+	device->overhead = OVERHEAD;
 	cochran_commander_device_set_fingerprint((dc_device_t *) device, NULL, 0);
 
 	status = cochran_commander_serial_setup(device);
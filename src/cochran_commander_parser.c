@@ -109,9 +109,12 @@ static const dc_parser_vtable_t cochran_commander_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	NULL, /* reset */
 	cochran_commander_parser_get_datetime, /* datetime */
 	cochran_commander_parser_get_field, /* fields */
 	cochran_commander_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
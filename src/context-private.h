@@ -58,6 +58,46 @@ extern "C" {
 #define DEBUG(context, ...) UNUSED(context)
 #endif
 
+/*
+ * Create a new context with the same log settings. Because a context
+ * can't be shared between threads, every thread that runs library code
+ * on behalf of another thread should use its own clone. The log
+ * function will then be called from multiple threads.
+ */
+dc_status_t
+dc_context_clone (dc_context_t **out, dc_context_t *context);
+
+typedef void (*dc_context_cleanup_t) (void *data);
+
+/*
+ * Lock and unlock the caches attached to the context. Objects created
+ * with the same context can be used from different threads, so the
+ * caches, and the shared state stored in them, must only be accessed
+ * while holding the lock.
+ */
+void
+dc_context_lock (dc_context_t *context);
+
+void
+dc_context_unlock (dc_context_t *context);
+
+/*
+ * Get the backend specific cache attached to the context, or NULL if
+ * there is none. Backends can use the cache to share decoded state
+ * between all the objects created with the same context. The caller
+ * must hold the lock. A clone of the context starts without any caches.
+ */
+void *
+dc_context_get_cache (dc_context_t *context, dc_family_t family);
+
+/*
+ * Attach a backend specific cache to the context. The cleanup function
+ * is called when the cache is replaced or the context is freed. The
+ * caller must hold the lock.
+ */
+dc_status_t
+dc_context_set_cache (dc_context_t *context, dc_family_t family, void *data, dc_context_cleanup_t cleanup);
+
 dc_status_t
 dc_context_log (dc_context_t *context, dc_loglevel_t loglevel, const char *file, unsigned int line, const char *function, const char *format, ...) DC_ATTR_FORMAT_PRINTF(6, 7);
 
@@ -36,12 +36,22 @@
 
 #include "context-private.h"
 #include "platform.h"
+#include "thread.h"
 #include "timer.h"
 
+typedef struct dc_context_cache_t {
+	struct dc_context_cache_t *next;
+	dc_family_t family;
+	void *data;
+	dc_context_cleanup_t cleanup;
+} dc_context_cache_t;
+
 struct dc_context_t {
 	dc_loglevel_t loglevel;
 	dc_logfunc_t logfunc;
 	void *userdata;
+	dc_context_cache_t *cache;
+	dc_mutex_t *mutex;
 #ifdef ENABLE_LOGGING
 	char msg[16384 + 32];
 	dc_timer_t *timer;
@@ -124,6 +134,16 @@ dc_context_new (dc_context_t **out)
 	context->logfunc = NULL;
 #endif
 	context->userdata = NULL;
+	context->cache = NULL;
+
+	// Without thread support, there is nothing to protect the caches
+	// against, and the lock is a no-op.
+	context->mutex = NULL;
+	dc_status_t status = dc_mutex_new (&context->mutex);
+	if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
+		free (context);
+		return status;
+	}
 
 #ifdef ENABLE_LOGGING
 	memset (context->msg, 0, sizeof (context->msg));
@@ -136,12 +156,52 @@ dc_context_new (dc_context_t **out)
 	return DC_STATUS_SUCCESS;
 }
 
+dc_status_t
+dc_context_clone (dc_context_t **out, dc_context_t *context)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_context_t *clone = NULL;
+
+	if (out == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	if (context == NULL) {
+		*out = NULL;
+		return DC_STATUS_SUCCESS;
+	}
+
+	status = dc_context_new (&clone);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+#ifdef ENABLE_LOGGING
+	clone->loglevel = context->loglevel;
+	clone->logfunc = context->logfunc;
+	clone->userdata = context->userdata;
+#endif
+
+	*out = clone;
+
+	return DC_STATUS_SUCCESS;
+}
+
 dc_status_t
 dc_context_free (dc_context_t *context)
 {
 	if (context == NULL)
 		return DC_STATUS_SUCCESS;
 
+	dc_context_cache_t *cache = context->cache;
+	while (cache) {
+		dc_context_cache_t *next = cache->next;
+		if (cache->cleanup)
+			cache->cleanup (cache->data);
+		free (cache);
+		cache = next;
+	}
+
+	dc_mutex_free (context->mutex);
+
 #ifdef ENABLE_LOGGING
 	dc_timer_free (context->timer);
 #endif
@@ -150,6 +210,69 @@ dc_context_free (dc_context_t *context)
 	return DC_STATUS_SUCCESS;
 }
 
+void
+dc_context_lock (dc_context_t *context)
+{
+	if (context == NULL || context->mutex == NULL)
+		return;
+
+	dc_mutex_lock (context->mutex);
+}
+
+void
+dc_context_unlock (dc_context_t *context)
+{
+	if (context == NULL || context->mutex == NULL)
+		return;
+
+	dc_mutex_unlock (context->mutex);
+}
+
+void *
+dc_context_get_cache (dc_context_t *context, dc_family_t family)
+{
+	if (context == NULL)
+		return NULL;
+
+	for (dc_context_cache_t *cache = context->cache; cache; cache = cache->next) {
+		if (cache->family == family)
+			return cache->data;
+	}
+
+	return NULL;
+}
+
+dc_status_t
+dc_context_set_cache (dc_context_t *context, dc_family_t family, void *data, dc_context_cleanup_t cleanup)
+{
+	dc_context_cache_t *cache = NULL;
+
+	if (context == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	for (cache = context->cache; cache; cache = cache->next) {
+		if (cache->family == family)
+			break;
+	}
+
+	if (cache == NULL) {
+		cache = (dc_context_cache_t *) malloc (sizeof (dc_context_cache_t));
+		if (cache == NULL)
+			return DC_STATUS_NOMEMORY;
+
+		cache->family = family;
+		cache->next = context->cache;
+		context->cache = cache;
+	} else if (cache->cleanup) {
+		cache->cleanup (cache->data);
+	}
+
+	cache->data = data;
+	cache->cleanup = cleanup;
+
+	return DC_STATUS_SUCCESS;
+}
+
 dc_status_t
 dc_context_set_loglevel (dc_context_t *context, dc_loglevel_t loglevel)
 {
@@ -50,9 +50,12 @@ static const dc_parser_vtable_t cressi_edy_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	NULL, /* reset */
 	cressi_edy_parser_get_datetime, /* datetime */
 	cressi_edy_parser_get_field, /* fields */
 	cressi_edy_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
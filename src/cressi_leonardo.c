@@ -288,7 +288,7 @@ cressi_leonardo_device_read (dc_device_t *abstract, unsigned int address, unsign
 }
 
 static dc_status_t
-cressi_leonardo_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
+cressi_leonardo_device_readall (dc_device_t *abstract, dc_buffer_t *buffer)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 	cressi_leonardo_device_t *device = (cressi_leonardo_device_t *) abstract;
@@ -378,7 +378,18 @@ cressi_leonardo_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 		return DC_STATUS_PROTOCOL;
 	}
 
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+cressi_leonardo_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
+{
+	dc_status_t status = cressi_leonardo_device_readall (abstract, buffer);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
 	// Emit a device info event.
+	unsigned char *data = dc_buffer_get_data (buffer);
 	dc_event_devinfo_t devinfo;
 	devinfo.model = data[0];
 	devinfo.firmware = 0;
@@ -388,6 +399,101 @@ cressi_leonardo_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 	return DC_STATUS_SUCCESS;
 }
 
+static int
+cressi_leonardo_device_isvalid (const unsigned char data[])
+{
+	unsigned int last = array_uint16_le (data + 0x64);
+	unsigned int eop = array_uint16_le (data + 0x66);
+
+	return last >= RB_LOGBOOK_BEGIN && last <= RB_LOGBOOK_END &&
+		((last - RB_LOGBOOK_BEGIN) % RB_LOGBOOK_SIZE) == 0 &&
+		eop >= RB_PROFILE_BEGIN && eop < RB_PROFILE_END;
+}
+
+static dc_status_t
+cressi_leonardo_device_download (dc_device_t *abstract, dc_buffer_t *buffer)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	// Allocate the required amount of memory.
+	if (!dc_buffer_resize (buffer, SZ_MEMORY)) {
+		ERROR (abstract->context, "Insufficient buffer space available.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	unsigned char *data = dc_buffer_get_data (buffer);
+
+	// Read the header.
+	status = cressi_leonardo_device_read (abstract, 0, data, RB_LOGBOOK_BEGIN);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (abstract->context, "Failed to read the header.");
+		return status;
+	}
+
+	// Emit a device info event.
+	dc_event_devinfo_t devinfo;
+	devinfo.model = data[0];
+	devinfo.firmware = 0;
+	devinfo.serial = array_uint24_le (data + 1);
+	device_event_emit (abstract, DC_EVENT_DEVINFO, &devinfo);
+
+	// The cached memory image can only be used if it belongs to the same
+	// device, and the ringbuffer pointers are valid.
+	const unsigned char *cache = device_image_lookup (abstract, SZ_MEMORY);
+	if (cache && (memcmp (cache, data, 4) != 0 ||
+		!cressi_leonardo_device_isvalid (cache) ||
+		!cressi_leonardo_device_isvalid (data))) {
+		WARNING (abstract->context, "The cached memory image doesn't match the device.");
+		cache = NULL;
+	}
+
+	status = DC_STATUS_DATAFORMAT;
+	if (cache) {
+		// Get the ringbuffer pointers.
+		unsigned int latest = (array_uint16_le (data + 0x64) - RB_LOGBOOK_BEGIN) / RB_LOGBOOK_SIZE % RB_LOGBOOK_COUNT;
+		unsigned int eop = array_uint16_le (data + 0x66);
+		unsigned int cache_latest = (array_uint16_le (cache + 0x64) - RB_LOGBOOK_BEGIN) / RB_LOGBOOK_SIZE % RB_LOGBOOK_COUNT;
+		unsigned int cache_eop = array_uint16_le (cache + 0x66);
+
+		device_range_t ranges[7];
+		unsigned int n = 0;
+
+		// Read the most recent logbook entry and the end of its profile
+		// again. If they have changed, the ringbuffers have been
+		// overwritten completely since the image was made.
+		unsigned int offset = RB_LOGBOOK_BEGIN + cache_latest * RB_LOGBOOK_SIZE;
+		n += device_image_ringbuffer (ranges + n, offset, RB_LOGBOOK_SIZE,
+			RB_LOGBOOK_BEGIN, RB_LOGBOOK_END, 1);
+		n += device_image_ringbuffer (ranges + n,
+			ringbuffer_decrement (cache_eop, PACKETSIZE, RB_PROFILE_BEGIN, RB_PROFILE_END),
+			PACKETSIZE, RB_PROFILE_BEGIN, RB_PROFILE_END, 1);
+
+		// Read the new logbook entries and profiles.
+		unsigned int count = (latest + RB_LOGBOOK_COUNT - cache_latest) % RB_LOGBOOK_COUNT;
+		n += device_image_ringbuffer (ranges + n,
+			ringbuffer_increment (offset, RB_LOGBOOK_SIZE, RB_LOGBOOK_BEGIN, RB_LOGBOOK_END),
+			count * RB_LOGBOOK_SIZE, RB_LOGBOOK_BEGIN, RB_LOGBOOK_END, 0);
+		n += device_image_ringbuffer (ranges + n, cache_eop,
+			RB_PROFILE_DISTANCE (cache_eop, eop),
+			RB_PROFILE_BEGIN, RB_PROFILE_END, 0);
+
+		// Take everything else from the cache.
+		memcpy (data + RB_LOGBOOK_BEGIN, cache + RB_LOGBOOK_BEGIN, SZ_MEMORY - RB_LOGBOOK_BEGIN);
+
+		status = device_image_read (abstract, cache, data, ranges, n, PACKETSIZE);
+	}
+
+	// Download the full memory.
+	if (status == DC_STATUS_DATAFORMAT) {
+		status = cressi_leonardo_device_readall (abstract, buffer);
+	}
+	if (status != DC_STATUS_SUCCESS) {
+		return status;
+	}
+
+	return device_image_update (abstract, dc_buffer_get_data (buffer), SZ_MEMORY);
+}
+
 static dc_status_t
 cressi_leonardo_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata)
 {
@@ -395,7 +501,12 @@ cressi_leonardo_device_foreach (dc_device_t *abstract, dc_dive_callback_t callba
 	if (buffer == NULL)
 		return DC_STATUS_NOMEMORY;
 
-	dc_status_t rc = cressi_leonardo_device_dump (abstract, buffer);
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	if (abstract->image) {
+		rc = cressi_leonardo_device_download (abstract, buffer);
+	} else {
+		rc = cressi_leonardo_device_dump (abstract, buffer);
+	}
 	if (rc != DC_STATUS_SUCCESS) {
 		dc_buffer_free (buffer);
 		return rc;
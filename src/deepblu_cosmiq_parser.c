@@ -52,9 +52,12 @@ static const dc_parser_vtable_t deepblu_cosmiq_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	deepblu_cosmiq_parser_set_density, /* set_density */
+	NULL, /* reset */
 	deepblu_cosmiq_parser_get_datetime, /* datetime */
 	deepblu_cosmiq_parser_get_field, /* fields */
 	deepblu_cosmiq_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
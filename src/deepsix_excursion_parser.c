@@ -112,6 +112,7 @@ typedef struct deepsix_excursion_parser_t {
 	deepsix_excursion_gasmix_t gasmix[MAX_GASMIXES];
 } deepsix_excursion_parser_t;
 
+static dc_status_t deepsix_excursion_parser_reset (dc_parser_t *abstract);
 static dc_status_t deepsix_excursion_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t deepsix_excursion_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t deepsix_excursion_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -124,9 +125,12 @@ static const dc_parser_vtable_t deepsix_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	deepsix_excursion_parser_reset, /* reset */
 	deepsix_excursion_parser_get_datetime, /* datetime */
 	deepsix_excursion_parser_get_field, /* fields */
 	deepsix_excursion_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
@@ -182,6 +186,23 @@ deepsix_excursion_find_gasmix(deepsix_excursion_parser_t *parser, unsigned int o
 	return i;
 }
 
+static dc_status_t
+deepsix_excursion_parser_reset (dc_parser_t *abstract)
+{
+	deepsix_excursion_parser_t *parser = (deepsix_excursion_parser_t *) abstract;
+
+	// Reset the cached fields.
+	parser->cached = 0;
+	parser->ngasmixes = 0;
+	for (unsigned int i = 0; i < MAX_GASMIXES; ++i) {
+		parser->gasmix[i].id = 0;
+		parser->gasmix[i].oxygen = 0;
+		parser->gasmix[i].helium = 0;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
 dc_status_t
 deepsix_excursion_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size)
 {
@@ -198,13 +219,7 @@ deepsix_excursion_parser_create (dc_parser_t **out, dc_context_t *context, const
 	}
 
 	// Set the default values.
-	parser->cached = 0;
-	parser->ngasmixes = 0;
-	for (unsigned int i = 0; i < MAX_GASMIXES; ++i) {
-		parser->gasmix[i].id = 0;
-		parser->gasmix[i].oxygen = 0;
-		parser->gasmix[i].helium = 0;
-	}
+	deepsix_excursion_parser_reset ((dc_parser_t *) parser);
 
 	*out = (dc_parser_t *) parser;
 
@@ -51,11 +51,21 @@ struct dc_device_t {
 	// Cancellation support.
 	dc_cancel_callback_t cancel_callback;
 	void *cancel_userdata;
+	// The I/O stream passed to dc_device_open.
+	dc_iostream_t *iostream;
 	// Cached events for the parsers.
 	dc_event_devinfo_t devinfo;
 	dc_event_clock_t clock;
+	// Cached memory image.
+	dc_buffer_t *image;
 };
 
+typedef struct device_range_t {
+	unsigned int address;
+	unsigned int size;
+	unsigned int verify;
+} device_range_t;
+
 struct dc_device_vtable_t {
 	size_t size;
 
@@ -94,6 +104,37 @@ device_is_cancelled (dc_device_t *device);
 dc_status_t
 device_dump_read (dc_device_t *device, unsigned int address, unsigned char data[], unsigned int size, unsigned int blocksize);
 
+/*
+ * Get the cached memory image, or NULL if no image of the expected size
+ * is available.
+ */
+const unsigned char *
+device_image_lookup (dc_device_t *device, unsigned int size);
+
+/*
+ * Store the new memory image in the cache.
+ */
+dc_status_t
+device_image_update (dc_device_t *device, const unsigned char data[], unsigned int size);
+
+/*
+ * Append the part of the ringbuffer starting at the address to the list
+ * of ranges. The part is split in two ranges at the end of the
+ * ringbuffer. The number of ranges that were appended is returned.
+ */
+unsigned int
+device_image_ringbuffer (device_range_t ranges[], unsigned int address, unsigned int size, unsigned int begin, unsigned int end, unsigned int verify);
+
+/*
+ * Download the ranges of memory that may have changed since the cached
+ * image was made. All other memory should already be copied from the
+ * cache. If the data of a range marked for verification doesn't match
+ * the cache, the cached image is out of date, and DC_STATUS_DATAFORMAT
+ * is returned. The caller should then download the full memory instead.
+ */
+dc_status_t
+device_image_read (dc_device_t *device, const unsigned char cache[], unsigned char data[], const device_range_t ranges[], unsigned int count, unsigned int blocksize);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
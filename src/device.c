@@ -96,9 +96,13 @@ dc_device_allocate (dc_context_t *context, const dc_device_vtable_t *vtable)
 	device->cancel_callback = NULL;
 	device->cancel_userdata = NULL;
 
+	device->iostream = NULL;
+
 	memset (&device->devinfo, 0, sizeof (device->devinfo));
 	memset (&device->clock, 0, sizeof (device->clock));
 
+	device->image = NULL;
+
 	return device;
 }
 
@@ -251,6 +255,10 @@ dc_device_open (dc_device_t **out, dc_context_t *context, dc_descriptor_t *descr
 		return DC_STATUS_INVALIDARGS;
 	}
 
+	if (rc == DC_STATUS_SUCCESS) {
+		device->iostream = iostream;
+	}
+
 	*out = device;
 
 	return rc;
@@ -317,6 +325,18 @@ dc_device_set_fingerprint (dc_device_t *device, const unsigned char data[], unsi
 }
 
 
+dc_status_t
+dc_device_set_image (dc_device_t *device, dc_buffer_t *image)
+{
+	if (device == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	device->image = image;
+
+	return DC_STATUS_SUCCESS;
+}
+
+
 dc_status_t
 dc_device_read (dc_device_t *device, unsigned int address, unsigned char data[], unsigned int size)
 {
@@ -398,6 +418,112 @@ device_dump_read (dc_device_t *device, unsigned int address, unsigned char data[
 }
 
 
+const unsigned char *
+device_image_lookup (dc_device_t *device, unsigned int size)
+{
+	if (device == NULL || device->image == NULL)
+		return NULL;
+
+	if (dc_buffer_get_size (device->image) != size)
+		return NULL;
+
+	return dc_buffer_get_data (device->image);
+}
+
+
+dc_status_t
+device_image_update (dc_device_t *device, const unsigned char data[], unsigned int size)
+{
+	if (device == NULL || device->image == NULL)
+		return DC_STATUS_SUCCESS;
+
+	if (!dc_buffer_clear (device->image) ||
+		!dc_buffer_append (device->image, data, size)) {
+		ERROR (device->context, "Insufficient buffer space available.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+
+unsigned int
+device_image_ringbuffer (device_range_t ranges[], unsigned int address, unsigned int size, unsigned int begin, unsigned int end, unsigned int verify)
+{
+	assert (address >= begin && address < end);
+	assert (size <= end - begin);
+
+	if (size == 0)
+		return 0;
+
+	if (address + size <= end) {
+		ranges[0].address = address;
+		ranges[0].size = size;
+		ranges[0].verify = verify;
+		return 1;
+	}
+
+	ranges[0].address = address;
+	ranges[0].size = end - address;
+	ranges[0].verify = verify;
+	ranges[1].address = begin;
+	ranges[1].size = size - (end - address);
+	ranges[1].verify = verify;
+
+	return 2;
+}
+
+
+dc_status_t
+device_image_read (dc_device_t *device, const unsigned char cache[], unsigned char data[], const device_range_t ranges[], unsigned int count, unsigned int blocksize)
+{
+	if (device == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (device->vtable->read == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	// Enable progress notifications.
+	dc_event_progress_t progress = EVENT_PROGRESS_INITIALIZER;
+	progress.maximum = 0;
+	for (unsigned int i = 0; i < count; ++i)
+		progress.maximum += ranges[i].size;
+	device_event_emit (device, DC_EVENT_PROGRESS, &progress);
+
+	for (unsigned int i = 0; i < count; ++i) {
+		unsigned int address = ranges[i].address;
+		unsigned int size = ranges[i].size;
+
+		unsigned int nbytes = 0;
+		while (nbytes < size) {
+			// Calculate the packet size.
+			unsigned int len = size - nbytes;
+			if (len > blocksize)
+				len = blocksize;
+
+			// Read the packet.
+			dc_status_t rc = device->vtable->read (device, address + nbytes, data + address + nbytes, len);
+			if (rc != DC_STATUS_SUCCESS)
+				return rc;
+
+			// Update and emit a progress event.
+			progress.current += len;
+			device_event_emit (device, DC_EVENT_PROGRESS, &progress);
+
+			nbytes += len;
+		}
+
+		// Verify the data against the cache.
+		if (ranges[i].verify && memcmp (data + address, cache + address, size) != 0) {
+			WARNING (device->context, "The cached memory image is out of date.");
+			return DC_STATUS_DATAFORMAT;
+		}
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+
 dc_status_t
 dc_device_foreach (dc_device_t *device, dc_dive_callback_t callback, void *userdata)
 {
@@ -407,7 +533,17 @@ dc_device_foreach (dc_device_t *device, dc_dive_callback_t callback, void *userd
 	if (device->vtable->foreach == NULL)
 		return DC_STATUS_UNSUPPORTED;
 
-	return device->vtable->foreach (device, callback, userdata);
+	dc_status_t status = device->vtable->foreach (device, callback, userdata);
+
+	// Report the transfer statistics, also after a failed download.
+	if (device->iostream) {
+		dc_iostream_stats_t stats;
+		if (dc_iostream_get_stats (device->iostream, &stats) == DC_STATUS_SUCCESS) {
+			device_event_emit (device, DC_EVENT_STATS, &stats);
+		}
+	}
+
+	return status;
 }
 
 
@@ -470,6 +606,12 @@ device_event_emit (dc_device_t *device, dc_event_type_t event, const void *data)
 	case DC_EVENT_CLOCK:
 		assert (data != NULL);
 		break;
+	case DC_EVENT_STATS:
+		assert (data != NULL);
+		break;
+	case DC_EVENT_CACHE:
+		assert (data != NULL);
+		break;
 	default:
 		break;
 	}
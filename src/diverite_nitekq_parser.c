@@ -49,6 +49,7 @@ struct diverite_nitekq_parser_t {
 	double maxdepth;
 };
 
+static dc_status_t diverite_nitekq_parser_reset (dc_parser_t *abstract);
 static dc_status_t diverite_nitekq_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t diverite_nitekq_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t diverite_nitekq_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -59,13 +60,36 @@ static const dc_parser_vtable_t diverite_nitekq_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	diverite_nitekq_parser_reset, /* reset */
 	diverite_nitekq_parser_get_datetime, /* datetime */
 	diverite_nitekq_parser_get_field, /* fields */
 	diverite_nitekq_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
 
+static dc_status_t
+diverite_nitekq_parser_reset (dc_parser_t *abstract)
+{
+	diverite_nitekq_parser_t *parser = (diverite_nitekq_parser_t *) abstract;
+
+	// Reset the cached fields.
+	parser->cached = 0;
+	parser->divemode = DC_DIVEMODE_OC;
+	parser->metric = 0;
+	parser->divetime = 0;
+	parser->maxdepth = 0.0;
+	parser->ngasmixes = 0;
+	for (unsigned int i = 0; i < NGASMIXES; ++i) {
+		parser->o2[i] = 0;
+		parser->he[i] = 0;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
 dc_status_t
 diverite_nitekq_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size)
 {
@@ -82,16 +106,7 @@ diverite_nitekq_parser_create (dc_parser_t **out, dc_context_t *context, const u
 	}
 
 	// Set the default values.
-	parser->cached = 0;
-	parser->divemode = DC_DIVEMODE_OC;
-	parser->metric = 0;
-	parser->divetime = 0;
-	parser->maxdepth = 0.0;
-	parser->ngasmixes = 0;
-	for (unsigned int i = 0; i < NGASMIXES; ++i) {
-		parser->o2[i] = 0;
-		parser->he[i] = 0;
-	}
+	diverite_nitekq_parser_reset ((dc_parser_t *) parser);
 
 	*out = (dc_parser_t*) parser;
 
@@ -254,6 +254,7 @@ typedef struct divesoft_freedom_parser_t {
 	unsigned int calibrated;
 } divesoft_freedom_parser_t;
 
+static dc_status_t divesoft_freedom_parser_reset (dc_parser_t *abstract);
 static dc_status_t divesoft_freedom_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t divesoft_freedom_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t divesoft_freedom_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -264,9 +265,12 @@ static const dc_parser_vtable_t divesoft_freedom_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	divesoft_freedom_parser_reset, /* reset */
 	divesoft_freedom_parser_get_datetime, /* datetime */
 	divesoft_freedom_parser_get_field, /* fields */
 	divesoft_freedom_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
@@ -640,22 +644,12 @@ divesoft_freedom_cache (divesoft_freedom_parser_t *parser)
 	return DC_STATUS_SUCCESS;
 }
 
-dc_status_t
-divesoft_freedom_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size)
+static dc_status_t
+divesoft_freedom_parser_reset (dc_parser_t *abstract)
 {
-	divesoft_freedom_parser_t *parser = NULL;
-
-	if (out == NULL)
-		return DC_STATUS_INVALIDARGS;
-
-	// Allocate memory.
-	parser = (divesoft_freedom_parser_t *) dc_parser_allocate (context, &divesoft_freedom_parser_vtable, data, size);
-	if (parser == NULL) {
-		ERROR (context, "Failed to allocate memory.");
-		return DC_STATUS_NOMEMORY;
-	}
+	divesoft_freedom_parser_t *parser = (divesoft_freedom_parser_t *) abstract;
 
-	// Set the default values.
+	// Reset the cached fields.
 	parser->cached = 0;
 	parser->version = 0;
 	parser->headersize = 0;
@@ -691,6 +685,27 @@ divesoft_freedom_parser_create (dc_parser_t **out, dc_context_t *context, const
 	}
 	parser->calibrated = 0;
 
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+divesoft_freedom_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size)
+{
+	divesoft_freedom_parser_t *parser = NULL;
+
+	if (out == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	// Allocate memory.
+	parser = (divesoft_freedom_parser_t *) dc_parser_allocate (context, &divesoft_freedom_parser_vtable, data, size);
+	if (parser == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	// Set the default values.
+	divesoft_freedom_parser_reset ((dc_parser_t *) parser);
+
 	*out = (dc_parser_t *) parser;
 
 	return DC_STATUS_SUCCESS;
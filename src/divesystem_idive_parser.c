@@ -92,6 +92,7 @@ struct divesystem_idive_parser_t {
 	unsigned int gf_high;
 };
 
+static dc_status_t divesystem_idive_parser_reset (dc_parser_t *abstract);
 static dc_status_t divesystem_idive_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t divesystem_idive_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t divesystem_idive_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -102,13 +103,44 @@ static const dc_parser_vtable_t divesystem_idive_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	divesystem_idive_parser_reset, /* reset */
 	divesystem_idive_parser_get_datetime, /* datetime */
 	divesystem_idive_parser_get_field, /* fields */
 	divesystem_idive_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
 
+static dc_status_t
+divesystem_idive_parser_reset (dc_parser_t *abstract)
+{
+	divesystem_idive_parser_t *parser = (divesystem_idive_parser_t *) abstract;
+
+	// Reset the cached fields.
+	parser->cached = 0;
+	parser->divemode = INVALID;
+	parser->divetime = 0;
+	parser->maxdepth = 0;
+	parser->ngasmixes = 0;
+	parser->ntanks = 0;
+	for (unsigned int i = 0; i < NGASMIXES; ++i) {
+		parser->gasmix[i].oxygen = 0;
+		parser->gasmix[i].helium = 0;
+	}
+	for (unsigned int i = 0; i < NTANKS; ++i) {
+		parser->tank[i].id = 0;
+		parser->tank[i].beginpressure = 0;
+		parser->tank[i].endpressure = 0;
+	}
+	parser->algorithm = INVALID;
+	parser->gf_low = INVALID;
+	parser->gf_high = INVALID;
+
+	return DC_STATUS_SUCCESS;
+}
+
 dc_status_t
 divesystem_idive_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size, unsigned int model)
 {
@@ -131,25 +163,7 @@ divesystem_idive_parser_create (dc_parser_t **out, dc_context_t *context, const
 	} else {
 		parser->headersize = SZ_HEADER_IDIVE;
 	}
-	parser->cached = 0;
-	parser->divemode = INVALID;
-	parser->divetime = 0;
-	parser->maxdepth = 0;
-	parser->ngasmixes = 0;
-	parser->ntanks = 0;
-	for (unsigned int i = 0; i < NGASMIXES; ++i) {
-		parser->gasmix[i].oxygen = 0;
-		parser->gasmix[i].helium = 0;
-	}
-	for (unsigned int i = 0; i < NTANKS; ++i) {
-		parser->tank[i].id = 0;
-		parser->tank[i].beginpressure = 0;
-		parser->tank[i].endpressure = 0;
-	}
-	parser->algorithm = INVALID;
-	parser->gf_low = INVALID;
-	parser->gf_high = INVALID;
-
+	divesystem_idive_parser_reset ((dc_parser_t *) parser);
 
 	*out = (dc_parser_t*) parser;
 
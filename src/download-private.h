@@ -0,0 +1,50 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_DOWNLOAD_PRIVATE_H
+#define DC_DOWNLOAD_PRIVATE_H
+
+#include <libdivecomputer/context.h>
+#include <libdivecomputer/download.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+typedef dc_status_t (*dc_download_open_t) (dc_device_t **device, dc_context_t *context, void *userdata);
+
+typedef void (*dc_download_close_t) (dc_device_t *device, void *userdata);
+
+/*
+ * Create a download for a device that isn't opened yet. The open and
+ * close functions are called from the worker thread, before and after
+ * the download. The close function is only called if the device was
+ * opened successfully. The context is used for opening the device, and
+ * should not be used from any other thread while the download is
+ * running.
+ */
+dc_status_t
+dc_download_new_deferred (dc_download_t **download, dc_context_t *context, dc_download_open_t open, dc_download_close_t close, void *userdata);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_DOWNLOAD_PRIVATE_H */
@@ -0,0 +1,588 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <libdivecomputer/download.h>
+#include <libdivecomputer/iostream.h>
+
+#include "download-private.h"
+#include "device-private.h"
+#include "context-private.h"
+#include "thread.h"
+
+#define IDLE     0
+#define RUNNING  1
+#define FINISHED 2
+
+typedef enum dc_download_kind_t {
+	ITEM_EVENT,
+	ITEM_DIVE
+} dc_download_kind_t;
+
+typedef struct dc_download_item_t {
+	struct dc_download_item_t *next;
+	dc_download_kind_t kind;
+	dc_event_type_t event;
+	union {
+		dc_event_progress_t progress;
+		dc_event_devinfo_t devinfo;
+		dc_event_clock_t clock;
+		dc_event_vendor_t vendor;
+		dc_iostream_stats_t stats;
+		dc_event_cache_t cache;
+	} value;
+	/* Dive data (or vendor data), followed by the fingerprint. */
+	unsigned int size;
+	unsigned int fsize;
+	unsigned char data[];
+} dc_download_item_t;
+
+struct dc_download_t {
+	dc_context_t *context;
+	dc_device_t *device;
+	/* Deferred opening of the device. */
+	dc_download_open_t open;
+	dc_download_close_t close;
+	void *open_userdata;
+	/* Callbacks */
+	unsigned int events;
+	dc_event_callback_t event_callback;
+	void *event_userdata;
+	dc_download_notify_t notify;
+	void *notify_userdata;
+	dc_dive_callback_t dive_callback;
+	dc_download_finish_t finish;
+	void *userdata;
+	/* Worker thread */
+	dc_thread_t *thread;
+	dc_mutex_t *mutex;
+	dc_cond_t *cond;
+	/* Shared state, protected by the mutex. */
+	unsigned int state;
+	dc_download_item_t *head;
+	dc_download_item_t *tail;
+	unsigned int cancelled;
+	unsigned int stopped;
+	unsigned int aborted;
+	dc_status_t error;
+	dc_status_t status;
+	/* Only used by the dispatching thread. */
+	unsigned int delivered;
+};
+
+static void
+dc_download_lock (dc_download_t *download)
+{
+	if (download->mutex)
+		dc_mutex_lock (download->mutex);
+}
+
+static void
+dc_download_unlock (dc_download_t *download)
+{
+	if (download->mutex)
+		dc_mutex_unlock (download->mutex);
+}
+
+static dc_download_t *
+dc_download_allocate (dc_context_t *context, dc_device_t *device)
+{
+	dc_download_t *download = NULL;
+
+	// Allocate memory.
+	download = (dc_download_t *) malloc (sizeof (dc_download_t));
+	if (download == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return NULL;
+	}
+
+	download->context = context;
+	download->device = device;
+	download->open = NULL;
+	download->close = NULL;
+	download->open_userdata = NULL;
+	download->events = 0;
+	download->event_callback = NULL;
+	download->event_userdata = NULL;
+	download->notify = NULL;
+	download->notify_userdata = NULL;
+	download->dive_callback = NULL;
+	download->finish = NULL;
+	download->userdata = NULL;
+	download->thread = NULL;
+	download->mutex = NULL;
+	download->cond = NULL;
+	download->state = IDLE;
+	download->head = NULL;
+	download->tail = NULL;
+	download->cancelled = 0;
+	download->stopped = 0;
+	download->aborted = 0;
+	download->error = DC_STATUS_SUCCESS;
+	download->status = DC_STATUS_SUCCESS;
+	download->delivered = 0;
+
+	return download;
+}
+
+dc_status_t
+dc_download_new (dc_download_t **out, dc_device_t *device)
+{
+	dc_download_t *download = NULL;
+
+	if (out == NULL || device == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	download = dc_download_allocate (device->context, device);
+	if (download == NULL)
+		return DC_STATUS_NOMEMORY;
+
+	*out = download;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_download_new_deferred (dc_download_t **out, dc_context_t *context, dc_download_open_t open, dc_download_close_t close, void *userdata)
+{
+	dc_download_t *download = NULL;
+
+	if (out == NULL || open == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	download = dc_download_allocate (context, NULL);
+	if (download == NULL)
+		return DC_STATUS_NOMEMORY;
+
+	download->open = open;
+	download->close = close;
+	download->open_userdata = userdata;
+
+	*out = download;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_download_set_events (dc_download_t *download, unsigned int events, dc_event_callback_t callback, void *userdata)
+{
+	if (download == NULL || download->state != IDLE)
+		return DC_STATUS_INVALIDARGS;
+
+	download->events = events;
+	download->event_callback = callback;
+	download->event_userdata = userdata;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_download_set_notify (dc_download_t *download, dc_download_notify_t callback, void *userdata)
+{
+	if (download == NULL || download->state != IDLE)
+		return DC_STATUS_INVALIDARGS;
+
+	download->notify = callback;
+	download->notify_userdata = userdata;
+
+	return DC_STATUS_SUCCESS;
+}
+
+/*
+ * Append an item to the queue, and wake up the dispatching thread. The
+ * item is freed if the download has been stopped in the meantime.
+ */
+static void
+dc_download_enqueue (dc_download_t *download, dc_download_item_t *item)
+{
+	int empty = 0;
+
+	dc_download_lock (download);
+	if (item->kind == ITEM_DIVE && download->stopped) {
+		free (item);
+		item = NULL;
+	} else {
+		empty = (download->head == NULL);
+		if (download->tail) {
+			download->tail->next = item;
+		} else {
+			download->head = item;
+		}
+		download->tail = item;
+		if (download->cond)
+			dc_cond_signal (download->cond);
+	}
+	dc_download_unlock (download);
+
+	if (empty) {
+		download->notify (download, download->notify_userdata);
+	}
+}
+
+static dc_download_item_t *
+dc_download_item_new (dc_download_t *download, dc_download_kind_t kind, const unsigned char data[], unsigned int size, const unsigned char fingerprint[], unsigned int fsize)
+{
+	dc_download_item_t *item = (dc_download_item_t *) malloc (sizeof (dc_download_item_t) + size + fsize);
+	if (item == NULL) {
+		ERROR (download->context, "Failed to allocate memory.");
+		dc_download_lock (download);
+		download->error = DC_STATUS_NOMEMORY;
+		dc_download_unlock (download);
+		return NULL;
+	}
+
+	item->next = NULL;
+	item->kind = kind;
+	item->event = (dc_event_type_t) 0;
+	item->size = size;
+	item->fsize = fsize;
+	if (size)
+		memcpy (item->data, data, size);
+	if (fsize)
+		memcpy (item->data + size, fingerprint, fsize);
+
+	return item;
+}
+
+static int
+dc_download_cancel_cb (void *userdata)
+{
+	dc_download_t *download = (dc_download_t *) userdata;
+
+	dc_download_lock (download);
+	int cancelled = download->cancelled || download->error != DC_STATUS_SUCCESS;
+	dc_download_unlock (download);
+
+	return cancelled;
+}
+
+static void
+dc_download_event_cb (dc_device_t *device, dc_event_type_t event, const void *data, void *userdata)
+{
+	dc_download_t *download = (dc_download_t *) userdata;
+
+	if (download->notify == NULL) {
+		download->event_callback (device, event, data, download->event_userdata);
+		return;
+	}
+
+	// Merge with a progress event that is still waiting in the queue.
+	if (event == DC_EVENT_PROGRESS) {
+		int merged = 0;
+		dc_download_lock (download);
+		if (download->tail && download->tail->kind == ITEM_EVENT &&
+			download->tail->event == DC_EVENT_PROGRESS) {
+			download->tail->value.progress = *(const dc_event_progress_t *) data;
+			merged = 1;
+		}
+		dc_download_unlock (download);
+		if (merged)
+			return;
+	}
+
+	const dc_event_vendor_t *vendor = (const dc_event_vendor_t *) data;
+	dc_download_item_t *item = NULL;
+	if (event == DC_EVENT_VENDOR) {
+		item = dc_download_item_new (download, ITEM_EVENT, vendor->data, vendor->size, NULL, 0);
+	} else {
+		item = dc_download_item_new (download, ITEM_EVENT, NULL, 0, NULL, 0);
+	}
+	if (item == NULL)
+		return;
+
+	item->event = event;
+	switch (event) {
+	case DC_EVENT_PROGRESS:
+		item->value.progress = *(const dc_event_progress_t *) data;
+		break;
+	case DC_EVENT_DEVINFO:
+		item->value.devinfo = *(const dc_event_devinfo_t *) data;
+		break;
+	case DC_EVENT_CLOCK:
+		item->value.clock = *(const dc_event_clock_t *) data;
+		break;
+	case DC_EVENT_STATS:
+		item->value.stats = *(const dc_iostream_stats_t *) data;
+		break;
+	case DC_EVENT_CACHE:
+		item->value.cache = *(const dc_event_cache_t *) data;
+		break;
+	default:
+		break;
+	}
+
+	dc_download_enqueue (download, item);
+}
+
+static int
+dc_download_dive_cb (const unsigned char *data, unsigned int size, const unsigned char *fingerprint, unsigned int fsize, void *userdata)
+{
+	dc_download_t *download = (dc_download_t *) userdata;
+
+	// Stop the download if it has been cancelled, even if the backend
+	// doesn't check for cancellation itself.
+	dc_download_lock (download);
+	int stop = download->cancelled || download->error != DC_STATUS_SUCCESS;
+	if (download->cancelled)
+		download->aborted = 1;
+	if (download->stopped)
+		stop = 1;
+	dc_download_unlock (download);
+	if (stop)
+		return 0;
+
+	if (download->notify == NULL) {
+		if (download->dive_callback)
+			return download->dive_callback (data, size, fingerprint, fsize, download->userdata);
+		return 1;
+	}
+
+	dc_download_item_t *item = dc_download_item_new (download, ITEM_DIVE, data, size, fingerprint, fsize);
+	if (item == NULL)
+		return 0;
+
+	dc_download_enqueue (download, item);
+
+	return 1;
+}
+
+static dc_status_t
+dc_download_foreach (dc_download_t *download, dc_device_t *device)
+{
+	dc_device_set_cancel (device, dc_download_cancel_cb, download);
+	if (download->event_callback) {
+		dc_device_set_events (device, download->events, dc_download_event_cb, download);
+	} else {
+		dc_device_set_events (device, 0, NULL, NULL);
+	}
+
+	dc_status_t status = dc_device_foreach (device, dc_download_dive_cb, download);
+
+	dc_device_set_events (device, 0, NULL, NULL);
+	dc_device_set_cancel (device, NULL, NULL);
+
+	return status;
+}
+
+static void
+dc_download_run (void *userdata)
+{
+	dc_download_t *download = (dc_download_t *) userdata;
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (download->open == NULL) {
+		status = dc_download_foreach (download, download->device);
+	} else if (dc_download_cancel_cb (download)) {
+		status = DC_STATUS_CANCELLED;
+	} else {
+		dc_device_t *device = NULL;
+		status = download->open (&device, download->context, download->open_userdata);
+		if (status == DC_STATUS_SUCCESS) {
+			dc_download_lock (download);
+			download->device = device;
+			dc_download_unlock (download);
+
+			status = dc_download_foreach (download, device);
+
+			if (download->close)
+				download->close (device, download->open_userdata);
+		}
+	}
+
+	dc_download_lock (download);
+	if (download->error != DC_STATUS_SUCCESS) {
+		status = download->error;
+	} else if (status == DC_STATUS_SUCCESS && download->aborted) {
+		status = DC_STATUS_CANCELLED;
+	}
+	download->status = status;
+	if (download->notify == NULL) {
+		dc_download_unlock (download);
+		if (download->finish)
+			download->finish (download, status, download->userdata);
+		dc_download_lock (download);
+	}
+	download->state = FINISHED;
+	if (download->cond)
+		dc_cond_broadcast (download->cond);
+	dc_download_unlock (download);
+
+	if (download->notify) {
+		download->notify (download, download->notify_userdata);
+	}
+}
+
+dc_status_t
+dc_download_start (dc_download_t *download, dc_dive_callback_t callback, dc_download_finish_t finish, void *userdata)
+{
+	if (download == NULL || download->state != IDLE)
+		return DC_STATUS_INVALIDARGS;
+
+	download->dive_callback = callback;
+	download->finish = finish;
+	download->userdata = userdata;
+	download->state = RUNNING;
+
+	// Start the worker thread. Without thread support, fall back to
+	// running the download from the calling thread.
+	if (dc_mutex_new (&download->mutex) == DC_STATUS_SUCCESS &&
+		dc_cond_new (&download->cond) == DC_STATUS_SUCCESS &&
+		dc_thread_new (&download->thread, dc_download_run, download) == DC_STATUS_SUCCESS) {
+		return DC_STATUS_SUCCESS;
+	}
+
+	dc_cond_free (download->cond);
+	dc_mutex_free (download->mutex);
+	download->cond = NULL;
+	download->mutex = NULL;
+
+	dc_download_run (download);
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_download_dispatch (dc_download_t *download)
+{
+	if (download == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	if (download->notify == NULL)
+		return DC_STATUS_SUCCESS;
+
+	// Take all queued items at once. Because the worker thread marks
+	// the download as finished after queueing the last item, the
+	// finish callback is always delivered last.
+	dc_download_lock (download);
+	dc_download_item_t *item = download->head;
+	download->head = NULL;
+	download->tail = NULL;
+	unsigned int finished = (download->state == FINISHED);
+	dc_status_t status = download->status;
+	dc_download_unlock (download);
+
+	while (item) {
+		dc_download_item_t *next = item->next;
+
+		if (item->kind == ITEM_EVENT) {
+			if (item->event == DC_EVENT_VENDOR) {
+				item->value.vendor.data = item->data;
+				item->value.vendor.size = item->size;
+			}
+			// The device may already be closed by the worker thread,
+			// so it's not passed to the application.
+			download->event_callback (NULL, item->event,
+				item->event == DC_EVENT_WAITING ? NULL : &item->value,
+				download->event_userdata);
+		} else if (download->dive_callback) {
+			dc_download_lock (download);
+			unsigned int stopped = download->stopped;
+			dc_download_unlock (download);
+
+			if (!stopped && !download->dive_callback (item->data, item->size,
+				item->data + item->size, item->fsize, download->userdata)) {
+				dc_download_lock (download);
+				download->stopped = 1;
+				dc_download_unlock (download);
+			}
+		}
+
+		free (item);
+		item = next;
+	}
+
+	if (finished && !download->delivered) {
+		download->delivered = 1;
+		if (download->finish)
+			download->finish (download, status, download->userdata);
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_download_cancel (dc_download_t *download)
+{
+	if (download == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	// Any dives that are still waiting in the queue are discarded.
+	dc_download_lock (download);
+	download->cancelled = 1;
+	download->stopped = 1;
+	dc_download_unlock (download);
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_download_wait (dc_download_t *download)
+{
+	if (download == NULL || download->state == IDLE)
+		return DC_STATUS_INVALIDARGS;
+
+	if (download->notify) {
+		while (!download->delivered) {
+			dc_download_lock (download);
+			while (download->head == NULL && download->state != FINISHED) {
+				dc_cond_wait (download->cond, download->mutex);
+			}
+			dc_download_unlock (download);
+
+			dc_download_dispatch (download);
+		}
+	}
+
+	dc_thread_join (download->thread);
+	download->thread = NULL;
+
+	return download->status;
+}
+
+dc_status_t
+dc_download_free (dc_download_t *download)
+{
+	if (download == NULL)
+		return DC_STATUS_SUCCESS;
+
+	dc_download_cancel (download);
+
+	dc_thread_join (download->thread);
+
+	dc_download_item_t *item = download->head;
+	while (item) {
+		dc_download_item_t *next = item->next;
+		free (item);
+		item = next;
+	}
+
+	dc_cond_free (download->cond);
+	dc_mutex_free (download->mutex);
+	free (download);
+
+	return DC_STATUS_SUCCESS;
+}
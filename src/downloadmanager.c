@@ -0,0 +1,593 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include <libdivecomputer/downloadmanager.h>
+#include <libdivecomputer/serial.h>
+#include <libdivecomputer/usb.h>
+#include <libdivecomputer/usbhid.h>
+
+#include "download-private.h"
+#include "context-private.h"
+#include "thread.h"
+#include "array.h"
+
+typedef struct dc_download_job_t {
+	dc_download_manager_t *manager;
+	unsigned int id;
+	dc_descriptor_t *descriptor;
+	/* Device returned by the iterator of the transport, or a custom
+	 * open function for DC_TRANSPORT_NONE. */
+	dc_transport_t transport;
+	void *device;
+	dc_download_manager_open_t open;
+	void *userdata;
+	dc_buffer_t *fingerprint;
+	/* Only used while running. */
+	dc_context_t *context;
+	dc_iostream_t *iostream;
+	dc_download_t *download;
+	unsigned int finished;
+} dc_download_job_t;
+
+struct dc_download_manager_t {
+	dc_context_t *context;
+	unsigned int nthreads;
+	unsigned int events;
+	/* Devices */
+	dc_download_job_t *jobs;
+	unsigned int count;
+	unsigned int capacity;
+	/* Shared state while running. */
+	dc_mutex_t *mutex;
+	dc_cond_t *cond;
+	unsigned int pending;
+	unsigned int cancelled;
+	dc_download_manager_cbs_t callbacks;
+	void *userdata;
+};
+
+static void
+dc_download_manager_lock (dc_download_manager_t *manager)
+{
+	if (manager->mutex)
+		dc_mutex_lock (manager->mutex);
+}
+
+static void
+dc_download_manager_unlock (dc_download_manager_t *manager)
+{
+	if (manager->mutex)
+		dc_mutex_unlock (manager->mutex);
+}
+
+static void
+dc_download_manager_device_free (dc_transport_t transport, void *device)
+{
+	switch (transport) {
+	case DC_TRANSPORT_SERIAL:
+		dc_serial_device_free ((dc_serial_device_t *) device);
+		break;
+	case DC_TRANSPORT_USB:
+		dc_usb_device_free ((dc_usb_device_t *) device);
+		break;
+	case DC_TRANSPORT_USBHID:
+		dc_usbhid_device_free ((dc_usbhid_device_t *) device);
+		break;
+	default:
+		break;
+	}
+}
+
+dc_status_t
+dc_download_manager_new (dc_download_manager_t **out, dc_context_t *context, unsigned int nthreads)
+{
+	dc_download_manager_t *manager = NULL;
+
+	if (out == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	// Allocate memory.
+	manager = (dc_download_manager_t *) malloc (sizeof (dc_download_manager_t));
+	if (manager == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	manager->context = context;
+	manager->nthreads = nthreads ? nthreads : 1;
+	manager->events = 0;
+	manager->jobs = NULL;
+	manager->count = 0;
+	manager->capacity = 0;
+	manager->mutex = NULL;
+	manager->cond = NULL;
+	manager->pending = 0;
+	manager->cancelled = 0;
+	manager->callbacks.event = NULL;
+	manager->callbacks.dive = NULL;
+	manager->callbacks.finish = NULL;
+	manager->userdata = NULL;
+
+	// Create the synchronization primitives. They exist for the entire
+	// lifetime of the manager, because a download can be cancelled from
+	// any thread. Without thread support, every download runs to
+	// completion when it's started, and the devices are processed one
+	// after the other.
+	if (dc_mutex_new (&manager->mutex) != DC_STATUS_SUCCESS ||
+		dc_cond_new (&manager->cond) != DC_STATUS_SUCCESS) {
+		dc_mutex_free (manager->mutex);
+		manager->mutex = NULL;
+		manager->cond = NULL;
+	}
+
+	*out = manager;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_download_manager_free (dc_download_manager_t *manager)
+{
+	if (manager == NULL)
+		return DC_STATUS_SUCCESS;
+
+	for (unsigned int i = 0; i < manager->count; ++i) {
+		dc_download_manager_device_free (manager->jobs[i].transport, manager->jobs[i].device);
+		dc_buffer_free (manager->jobs[i].fingerprint);
+	}
+
+	dc_cond_free (manager->cond);
+	dc_mutex_free (manager->mutex);
+	free (manager->jobs);
+	free (manager);
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_download_manager_append (dc_download_manager_t *manager, dc_descriptor_t *descriptor, dc_transport_t transport, void *device, dc_download_manager_open_t open, void *userdata, unsigned int *id)
+{
+	if (manager->count == manager->capacity) {
+		unsigned int capacity = manager->capacity ? manager->capacity * 2 : 16;
+		dc_download_job_t *jobs = (dc_download_job_t *) realloc (manager->jobs, capacity * sizeof (dc_download_job_t));
+		if (jobs == NULL) {
+			ERROR (manager->context, "Failed to allocate memory.");
+			return DC_STATUS_NOMEMORY;
+		}
+
+		manager->jobs = jobs;
+		manager->capacity = capacity;
+	}
+
+	dc_download_job_t *job = manager->jobs + manager->count;
+	job->manager = manager;
+	job->id = manager->count;
+	job->descriptor = descriptor;
+	job->transport = transport;
+	job->device = device;
+	job->open = open;
+	job->userdata = userdata;
+	job->fingerprint = NULL;
+	job->context = NULL;
+	job->iostream = NULL;
+	job->download = NULL;
+	job->finished = 0;
+
+	if (id)
+		*id = job->id;
+
+	manager->count++;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_download_manager_add (dc_download_manager_t *manager, dc_descriptor_t *descriptor, dc_download_manager_open_t open, void *userdata, unsigned int *id)
+{
+	if (manager == NULL || descriptor == NULL || open == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	return dc_download_manager_append (manager, descriptor, DC_TRANSPORT_NONE, NULL, open, userdata, id);
+}
+
+dc_status_t
+dc_download_manager_scan (dc_download_manager_t *manager, dc_descriptor_t *descriptor, unsigned int transports, unsigned int *count)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	unsigned int n = 0;
+
+	static const dc_transport_t list[] = {
+		DC_TRANSPORT_USBHID,
+		DC_TRANSPORT_USB,
+		DC_TRANSPORT_SERIAL,
+	};
+
+	if (manager == NULL || descriptor == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	transports &= dc_descriptor_get_transports (descriptor);
+
+	for (unsigned int i = 0; i < C_ARRAY_SIZE (list); ++i) {
+		dc_iterator_t *iterator = NULL;
+
+		if ((transports & list[i]) == 0)
+			continue;
+
+		switch (list[i]) {
+		case DC_TRANSPORT_SERIAL:
+			status = dc_serial_iterator_new (&iterator, manager->context, descriptor);
+			break;
+		case DC_TRANSPORT_USB:
+			status = dc_usb_iterator_new (&iterator, manager->context, descriptor);
+			break;
+		case DC_TRANSPORT_USBHID:
+			status = dc_usbhid_iterator_new (&iterator, manager->context, descriptor);
+			break;
+		default:
+			status = DC_STATUS_UNSUPPORTED;
+			break;
+		}
+		if (status == DC_STATUS_UNSUPPORTED) {
+			// Transport not available on this platform.
+			status = DC_STATUS_SUCCESS;
+			continue;
+		} else if (status != DC_STATUS_SUCCESS) {
+			ERROR (manager->context, "Failed to create the device iterator.");
+			break;
+		}
+
+		void *device = NULL;
+		while ((status = dc_iterator_next (iterator, &device)) == DC_STATUS_SUCCESS) {
+			status = dc_download_manager_append (manager, descriptor, list[i], device, NULL, NULL, NULL);
+			if (status != DC_STATUS_SUCCESS) {
+				dc_download_manager_device_free (list[i], device);
+				break;
+			}
+			n++;
+		}
+
+		dc_iterator_free (iterator);
+
+		if (status != DC_STATUS_DONE)
+			break;
+
+		status = DC_STATUS_SUCCESS;
+	}
+
+	if (count)
+		*count = n;
+
+	return status;
+}
+
+unsigned int
+dc_download_manager_get_count (dc_download_manager_t *manager)
+{
+	if (manager == NULL)
+		return 0;
+
+	return manager->count;
+}
+
+dc_status_t
+dc_download_manager_set_fingerprint (dc_download_manager_t *manager, unsigned int id, const unsigned char data[], unsigned int size)
+{
+	if (manager == NULL || id >= manager->count || (data == NULL && size))
+		return DC_STATUS_INVALIDARGS;
+
+	dc_download_job_t *job = manager->jobs + id;
+
+	if (job->fingerprint == NULL) {
+		job->fingerprint = dc_buffer_new (size);
+		if (job->fingerprint == NULL) {
+			ERROR (manager->context, "Failed to allocate memory.");
+			return DC_STATUS_NOMEMORY;
+		}
+	}
+
+	if (!dc_buffer_clear (job->fingerprint) ||
+		!dc_buffer_append (job->fingerprint, data, size)) {
+		ERROR (manager->context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_download_manager_set_events (dc_download_manager_t *manager, unsigned int events)
+{
+	if (manager == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	manager->events = events;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_download_manager_open (dc_device_t **device, dc_context_t *context, void *userdata)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_download_job_t *job = (dc_download_job_t *) userdata;
+
+	// Open the I/O stream.
+	switch (job->transport) {
+	case DC_TRANSPORT_SERIAL:
+		status = dc_serial_open (&job->iostream, context, dc_serial_device_get_name ((dc_serial_device_t *) job->device));
+		break;
+	case DC_TRANSPORT_USB:
+		status = dc_usb_open (&job->iostream, context, (dc_usb_device_t *) job->device);
+		break;
+	case DC_TRANSPORT_USBHID:
+		status = dc_usbhid_open (&job->iostream, context, (dc_usbhid_device_t *) job->device);
+		break;
+	default:
+		status = job->open (&job->iostream, context, job->descriptor, job->userdata);
+		break;
+	}
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (context, "Failed to open the I/O stream.");
+		job->iostream = NULL;
+		return status;
+	}
+
+	// Open the device.
+	status = dc_device_open (device, context, job->descriptor, job->iostream);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (context, "Failed to open the device.");
+		goto error_iostream_close;
+	}
+
+	if (job->fingerprint) {
+		status = dc_device_set_fingerprint (*device,
+			dc_buffer_get_data (job->fingerprint),
+			dc_buffer_get_size (job->fingerprint));
+		if (status != DC_STATUS_SUCCESS) {
+			ERROR (context, "Failed to set the fingerprint.");
+			goto error_device_close;
+		}
+	}
+
+	return DC_STATUS_SUCCESS;
+
+error_device_close:
+	dc_device_close (*device);
+	*device = NULL;
+error_iostream_close:
+	dc_iostream_close (job->iostream);
+	job->iostream = NULL;
+	return status;
+}
+
+static void
+dc_download_manager_close (dc_device_t *device, void *userdata)
+{
+	dc_download_job_t *job = (dc_download_job_t *) userdata;
+
+	dc_device_close (device);
+	dc_iostream_close (job->iostream);
+	job->iostream = NULL;
+}
+
+static void
+dc_download_manager_notify (dc_download_t *download, void *userdata)
+{
+	dc_download_manager_t *manager = (dc_download_manager_t *) userdata;
+
+	dc_download_manager_lock (manager);
+	manager->pending = 1;
+	if (manager->cond)
+		dc_cond_signal (manager->cond);
+	dc_download_manager_unlock (manager);
+}
+
+static void
+dc_download_manager_event (dc_device_t *device, dc_event_type_t event, const void *data, void *userdata)
+{
+	dc_download_job_t *job = (dc_download_job_t *) userdata;
+	dc_download_manager_t *manager = job->manager;
+
+	if (manager->callbacks.event)
+		manager->callbacks.event (job->id, event, data, manager->userdata);
+}
+
+static int
+dc_download_manager_dive (const unsigned char *data, unsigned int size, const unsigned char *fingerprint, unsigned int fsize, void *userdata)
+{
+	dc_download_job_t *job = (dc_download_job_t *) userdata;
+	dc_download_manager_t *manager = job->manager;
+
+	if (manager->callbacks.dive)
+		return manager->callbacks.dive (job->id, data, size, fingerprint, fsize, manager->userdata);
+
+	return 1;
+}
+
+static void
+dc_download_manager_finish (dc_download_t *download, dc_status_t status, void *userdata)
+{
+	dc_download_job_t *job = (dc_download_job_t *) userdata;
+	dc_download_manager_t *manager = job->manager;
+
+	job->finished = 1;
+
+	if (manager->callbacks.finish)
+		manager->callbacks.finish (job->id, status, manager->userdata);
+}
+
+static dc_status_t
+dc_download_manager_start (dc_download_manager_t *manager, dc_download_job_t *job)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_download_t *download = NULL;
+
+	// Every device uses its own context, because the downloads run
+	// on different threads.
+	status = dc_context_clone (&job->context, manager->context);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (manager->context, "Failed to create the device context.");
+		return status;
+	}
+
+	status = dc_download_new_deferred (&download, job->context,
+		dc_download_manager_open, dc_download_manager_close, job);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (manager->context, "Failed to create the download.");
+		goto error_context_free;
+	}
+
+	dc_download_set_events (download, manager->events, dc_download_manager_event, job);
+	dc_download_set_notify (download, dc_download_manager_notify, manager);
+
+	dc_download_manager_lock (manager);
+	if (manager->cancelled) {
+		status = DC_STATUS_CANCELLED;
+	} else {
+		job->download = download;
+	}
+	dc_download_manager_unlock (manager);
+	if (status != DC_STATUS_SUCCESS) {
+		goto error_download_free;
+	}
+
+	status = dc_download_start (download, dc_download_manager_dive, dc_download_manager_finish, job);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (manager->context, "Failed to start the download.");
+		dc_download_manager_lock (manager);
+		job->download = NULL;
+		dc_download_manager_unlock (manager);
+		goto error_download_free;
+	}
+
+	return DC_STATUS_SUCCESS;
+
+error_download_free:
+	dc_download_free (download);
+error_context_free:
+	dc_context_free (job->context);
+	job->context = NULL;
+	return status;
+}
+
+static void
+dc_download_manager_cleanup (dc_download_manager_t *manager, dc_download_job_t *job)
+{
+	dc_download_t *download = job->download;
+
+	dc_download_manager_lock (manager);
+	job->download = NULL;
+	dc_download_manager_unlock (manager);
+
+	dc_download_wait (download);
+	dc_download_free (download);
+	dc_context_free (job->context);
+	job->context = NULL;
+}
+
+dc_status_t
+dc_download_manager_run (dc_download_manager_t *manager, const dc_download_manager_cbs_t *callbacks, void *userdata)
+{
+	if (manager == NULL || callbacks == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	manager->callbacks = *callbacks;
+	manager->userdata = userdata;
+
+	dc_download_manager_lock (manager);
+	manager->pending = 0;
+	dc_download_manager_unlock (manager);
+
+	unsigned int first = 0, next = 0, active = 0;
+	while (next < manager->count || active) {
+		// Start downloading more devices.
+		while (next < manager->count && active < manager->nthreads) {
+			dc_download_job_t *job = manager->jobs + next++;
+			job->finished = 0;
+			dc_status_t rc = dc_download_manager_start (manager, job);
+			if (rc != DC_STATUS_SUCCESS) {
+				job->finished = 1;
+				if (manager->callbacks.finish)
+					manager->callbacks.finish (job->id, rc, manager->userdata);
+				continue;
+			}
+			active++;
+		}
+
+		if (active == 0)
+			continue;
+
+		// Wait for any of the downloads.
+		dc_download_manager_lock (manager);
+		while (!manager->pending) {
+			dc_cond_wait (manager->cond, manager->mutex);
+		}
+		manager->pending = 0;
+		dc_download_manager_unlock (manager);
+
+		// Deliver the callbacks of all running downloads.
+		for (unsigned int i = first; i < next; ++i) {
+			dc_download_job_t *job = manager->jobs + i;
+			if (job->download == NULL)
+				continue;
+
+			dc_download_dispatch (job->download);
+
+			if (job->finished) {
+				dc_download_manager_cleanup (manager, job);
+				active--;
+			}
+		}
+
+		while (first < next && manager->jobs[first].download == NULL) {
+			first++;
+		}
+	}
+
+	dc_download_manager_lock (manager);
+	dc_status_t status = manager->cancelled ? DC_STATUS_CANCELLED : DC_STATUS_SUCCESS;
+	dc_download_manager_unlock (manager);
+
+	return status;
+}
+
+dc_status_t
+dc_download_manager_cancel (dc_download_manager_t *manager)
+{
+	if (manager == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	dc_download_manager_lock (manager);
+	manager->cancelled = 1;
+	for (unsigned int i = 0; i < manager->count; ++i) {
+		if (manager->jobs[i].download)
+			dc_download_cancel (manager->jobs[i].download);
+	}
+	dc_download_manager_unlock (manager);
+
+	return DC_STATUS_SUCCESS;
+}
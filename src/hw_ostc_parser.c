@@ -131,6 +131,7 @@ typedef struct hw_ostc_parser_t {
 	hw_ostc_gasmix_t gasmix[NGASMIXES];
 } hw_ostc_parser_t;
 
+static dc_status_t hw_ostc_parser_reset (dc_parser_t *abstract);
 static dc_status_t hw_ostc_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t hw_ostc_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -143,9 +144,12 @@ static const dc_parser_vtable_t hw_ostc_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	hw_ostc_parser_reset, /* reset */
 	hw_ostc_parser_get_datetime, /* datetime */
 	hw_ostc_parser_get_field, /* fields */
 	hw_ostc_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
@@ -383,23 +387,11 @@ hw_ostc_parser_cache (hw_ostc_parser_t *parser)
 }
 
 static dc_status_t
-hw_ostc_parser_create_internal (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size, unsigned int hwos, unsigned int model)
+hw_ostc_parser_reset (dc_parser_t *abstract)
 {
-	hw_ostc_parser_t *parser = NULL;
-
-	if (out == NULL)
-		return DC_STATUS_INVALIDARGS;
-
-	// Allocate memory.
-	parser = (hw_ostc_parser_t *) dc_parser_allocate (context, &hw_ostc_parser_vtable, data, size);
-	if (parser == NULL) {
-		ERROR (context, "Failed to allocate memory.");
-		return DC_STATUS_NOMEMORY;
-	}
+	hw_ostc_parser_t *parser = (hw_ostc_parser_t *) abstract;
 
-	// Set the default values.
-	parser->hwos = hwos;
-	parser->model = model;
+	// Reset the cached fields.
 	parser->cached = 0;
 	parser->version = 0;
 	parser->header = 0;
@@ -420,6 +412,29 @@ hw_ostc_parser_create_internal (dc_parser_t **out, dc_context_t *context, const
 		parser->gasmix[i].diluent = 0;
 	}
 
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+hw_ostc_parser_create_internal (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size, unsigned int hwos, unsigned int model)
+{
+	hw_ostc_parser_t *parser = NULL;
+
+	if (out == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	// Allocate memory.
+	parser = (hw_ostc_parser_t *) dc_parser_allocate (context, &hw_ostc_parser_vtable, data, size);
+	if (parser == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	// Set the default values.
+	parser->hwos = hwos;
+	parser->model = model;
+	hw_ostc_parser_reset ((dc_parser_t *) parser);
+
 	*out = (dc_parser_t *) parser;
 
 	return DC_STATUS_SUCCESS;
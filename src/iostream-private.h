@@ -26,6 +26,8 @@
 #include <libdivecomputer/context.h>
 #include <libdivecomputer/iostream.h>
 
+#include "timer.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -36,6 +38,8 @@ struct dc_iostream_t {
 	const dc_iostream_vtable_t *vtable;
 	dc_context_t *context;
 	dc_transport_t transport;
+	dc_timer_t *timer;
+	dc_iostream_stats_t stats;
 };
 
 struct dc_iostream_vtable_t {
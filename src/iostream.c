@@ -21,6 +21,7 @@
 
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 #include <libdivecomputer/ioctl.h>
@@ -48,6 +49,14 @@ dc_iostream_allocate (dc_context_t *context, const dc_iostream_vtable_t *vtable,
 	iostream->vtable = vtable;
 	iostream->context = context;
 	iostream->transport = transport;
+	memset (&iostream->stats, 0, sizeof (iostream->stats));
+
+	// The statistics are still collected without a timer, only the
+	// latencies are missing.
+	if (dc_timer_new (&iostream->timer) != DC_STATUS_SUCCESS) {
+		WARNING (context, "Failed to create a timer.");
+		iostream->timer = NULL;
+	}
 
 	return iostream;
 }
@@ -55,9 +64,53 @@ dc_iostream_allocate (dc_context_t *context, const dc_iostream_vtable_t *vtable,
 void
 dc_iostream_deallocate (dc_iostream_t *iostream)
 {
+	if (iostream == NULL)
+		return;
+
+	dc_timer_free (iostream->timer);
 	free (iostream);
 }
 
+static dc_usecs_t
+dc_iostream_stats_begin (dc_iostream_t *iostream)
+{
+	dc_usecs_t now = 0;
+
+	if (iostream->timer) {
+		dc_timer_now (iostream->timer, &now);
+	}
+
+	return now;
+}
+
+static void
+dc_iostream_stats_end (dc_iostream_t *iostream, dc_iostream_opstats_t *stats, dc_usecs_t begin, dc_status_t status, size_t nbytes)
+{
+	dc_usecs_t elapsed = 0;
+
+	if (iostream->timer) {
+		dc_usecs_t now = 0;
+		dc_timer_now (iostream->timer, &now);
+		elapsed = now - begin;
+	}
+
+	// Logarithmic histogram bucket.
+	unsigned int bucket = 0;
+	while (bucket < DC_IOSTREAM_HISTOGRAM_SIZE - 1 && (elapsed >> bucket) != 0) {
+		bucket++;
+	}
+
+	stats->count++;
+	if (status == DC_STATUS_TIMEOUT) {
+		stats->timeouts++;
+	} else if (status != DC_STATUS_SUCCESS) {
+		stats->errors++;
+	}
+	stats->bytes += nbytes;
+	stats->elapsed += elapsed;
+	stats->histogram[bucket]++;
+}
+
 int
 dc_iostream_isinstance (dc_iostream_t *iostream, const dc_iostream_vtable_t *vtable)
 {
@@ -76,6 +129,17 @@ dc_iostream_get_transport (dc_iostream_t *iostream)
 	return iostream->transport;
 }
 
+dc_status_t
+dc_iostream_get_stats (dc_iostream_t *iostream, dc_iostream_stats_t *stats)
+{
+	if (iostream == NULL || stats == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	*stats = iostream->stats;
+
+	return DC_STATUS_SUCCESS;
+}
+
 dc_status_t
 dc_iostream_set_timeout (dc_iostream_t *iostream, int timeout)
 {
@@ -182,7 +246,13 @@ dc_iostream_poll (dc_iostream_t *iostream, int timeout)
 
 	INFO (iostream->context, "Poll: value=%i", timeout);
 
-	return iostream->vtable->poll (iostream, timeout);
+	dc_usecs_t begin = dc_iostream_stats_begin (iostream);
+
+	dc_status_t status = iostream->vtable->poll (iostream, timeout);
+
+	dc_iostream_stats_end (iostream, &iostream->stats.poll, begin, status, 0);
+
+	return status;
 }
 
 dc_status_t
@@ -195,8 +265,12 @@ dc_iostream_read (dc_iostream_t *iostream, void *data, size_t size, size_t *actu
 		goto out;
 	}
 
+	dc_usecs_t begin = dc_iostream_stats_begin (iostream);
+
 	status = iostream->vtable->read (iostream, data, size, &nbytes);
 
+	dc_iostream_stats_end (iostream, &iostream->stats.read, begin, status, nbytes);
+
 	HEXDUMP (iostream->context, DC_LOGLEVEL_INFO, "Read", (unsigned char *) data, nbytes);
 
 out:
@@ -216,8 +290,12 @@ dc_iostream_write (dc_iostream_t *iostream, const void *data, size_t size, size_
 		goto out;
 	}
 
+	dc_usecs_t begin = dc_iostream_stats_begin (iostream);
+
 	status = iostream->vtable->write (iostream, data, size, &nbytes);
 
+	dc_iostream_stats_end (iostream, &iostream->stats.write, begin, status, nbytes);
+
 	HEXDUMP (iostream->context, DC_LOGLEVEL_INFO, "Write", (const unsigned char *) data, nbytes);
 
 out:
@@ -291,7 +369,13 @@ dc_iostream_sleep (dc_iostream_t *iostream, unsigned int milliseconds)
 
 	INFO (iostream->context, "Sleep: value=%u", milliseconds);
 
-	return iostream->vtable->sleep (iostream, milliseconds);
+	dc_usecs_t begin = dc_iostream_stats_begin (iostream);
+
+	dc_status_t status = iostream->vtable->sleep (iostream, milliseconds);
+
+	dc_iostream_stats_end (iostream, &iostream->stats.sleep, begin, status, 0);
+
+	return status;
 }
 
 dc_status_t
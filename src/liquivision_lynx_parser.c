@@ -117,6 +117,7 @@ struct liquivision_lynx_parser_t {
 	liquivision_lynx_tank_t tank[NTANKS];
 };
 
+static dc_status_t liquivision_lynx_parser_reset (dc_parser_t *abstract);
 static dc_status_t liquivision_lynx_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t liquivision_lynx_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t liquivision_lynx_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -127,13 +128,38 @@ static const dc_parser_vtable_t liquivision_lynx_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	liquivision_lynx_parser_reset, /* reset */
 	liquivision_lynx_parser_get_datetime, /* datetime */
 	liquivision_lynx_parser_get_field, /* fields */
 	liquivision_lynx_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
 
+static dc_status_t
+liquivision_lynx_parser_reset (dc_parser_t *abstract)
+{
+	liquivision_lynx_parser_t *parser = (liquivision_lynx_parser_t *) abstract;
+
+	// Reset the cached fields.
+	parser->cached = 0;
+	parser->ngasmixes = 0;
+	parser->ntanks = 0;
+	for (unsigned int i = 0; i < NGASMIXES; ++i) {
+		parser->gasmix[i].oxygen = 0;
+		parser->gasmix[i].helium = 0;
+	}
+	for (unsigned int i = 0; i < NTANKS; ++i) {
+		parser->tank[i].id = 0;
+		parser->tank[i].beginpressure = 0;
+		parser->tank[i].endpressure = 0;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
 dc_status_t
 liquivision_lynx_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size, unsigned int model)
 {
@@ -152,18 +178,7 @@ liquivision_lynx_parser_create (dc_parser_t **out, dc_context_t *context, const
 	// Set the default values.
 	parser->model = model;
 	parser->headersize = (model == XEN) ? SZ_HEADER_XEN : SZ_HEADER_OTHER;
-	parser->cached = 0;
-	parser->ngasmixes = 0;
-	parser->ntanks = 0;
-	for (unsigned int i = 0; i < NGASMIXES; ++i) {
-		parser->gasmix[i].oxygen = 0;
-		parser->gasmix[i].helium = 0;
-	}
-	for (unsigned int i = 0; i < NTANKS; ++i) {
-		parser->tank[i].id = 0;
-		parser->tank[i].beginpressure = 0;
-		parser->tank[i].endpressure = 0;
-	}
+	liquivision_lynx_parser_reset ((dc_parser_t *) parser);
 
 	*out = (dc_parser_t *) parser;
 
@@ -29,6 +29,7 @@
 #include "mares_common.h"
 #include "context-private.h"
 #include "device-private.h"
+#include "ringbuffer.h"
 #include "array.h"
 
 #define ISINSTANCE(device) dc_device_isinstance((device), &mares_darwin_device_vtable)
@@ -219,6 +220,112 @@ mares_darwin_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 }
 
 
+static int
+mares_darwin_device_isvalid (const mares_darwin_layout_t *layout, const unsigned char data[])
+{
+	unsigned int eop = array_uint16_be (data + 0x8A);
+	unsigned int last = data[0x8C];
+
+	return eop >= layout->rb_profile_begin && eop < layout->rb_profile_end &&
+		last < layout->rb_logbook_count;
+}
+
+
+static dc_status_t
+mares_darwin_device_download (dc_device_t *abstract, dc_buffer_t *buffer)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	mares_darwin_device_t *device = (mares_darwin_device_t *) abstract;
+
+	assert (device->layout != NULL);
+
+	const mares_darwin_layout_t *layout = device->layout;
+
+	// Allocate the required amount of memory.
+	if (!dc_buffer_resize (buffer, layout->memsize)) {
+		ERROR (abstract->context, "Insufficient buffer space available.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	unsigned char *data = dc_buffer_get_data (buffer);
+
+	// Read the header.
+	unsigned int hsize = layout->rb_logbook_offset;
+	status = mares_common_device_read (abstract, 0, data, hsize);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (abstract->context, "Failed to read the header.");
+		return status;
+	}
+
+	// Emit a device info event.
+	dc_event_devinfo_t devinfo;
+	devinfo.model = device->model;
+	devinfo.firmware = 0;
+	devinfo.serial = array_uint16_be (data + 8);
+	device_event_emit (abstract, DC_EVENT_DEVINFO, &devinfo);
+
+	// The cached memory image can only be used if it belongs to the same
+	// device, and the ringbuffer pointers are valid.
+	const unsigned char *cache = device_image_lookup (abstract, layout->memsize);
+	if (cache && (memcmp (cache + 8, data + 8, 2) != 0 ||
+		!mares_darwin_device_isvalid (layout, cache) ||
+		!mares_darwin_device_isvalid (layout, data))) {
+		WARNING (abstract->context, "The cached memory image doesn't match the device.");
+		cache = NULL;
+	}
+
+	status = DC_STATUS_DATAFORMAT;
+	if (cache) {
+		unsigned int rb_logbook_begin = layout->rb_logbook_offset;
+		unsigned int rb_logbook_end = layout->rb_logbook_offset + layout->rb_logbook_count * layout->rb_logbook_size;
+
+		// Get the ringbuffer pointers.
+		unsigned int eop = array_uint16_be (data + 0x8A);
+		unsigned int last = data[0x8C];
+		unsigned int cache_eop = array_uint16_be (cache + 0x8A);
+		unsigned int cache_last = cache[0x8C];
+
+		device_range_t ranges[7];
+		unsigned int n = 0;
+
+		// Read the most recent logbook entry and the end of its profile
+		// again. If they have changed, the ringbuffers have been
+		// overwritten completely since the image was made.
+		unsigned int offset = rb_logbook_begin + cache_last * layout->rb_logbook_size;
+		n += device_image_ringbuffer (ranges + n, offset, layout->rb_logbook_size,
+			rb_logbook_begin, rb_logbook_end, 1);
+		n += device_image_ringbuffer (ranges + n,
+			ringbuffer_decrement (cache_eop, PACKETSIZE, layout->rb_profile_begin, layout->rb_profile_end),
+			PACKETSIZE, layout->rb_profile_begin, layout->rb_profile_end, 1);
+
+		// Read the new logbook entries and profiles.
+		unsigned int count = (last + layout->rb_logbook_count - cache_last) % layout->rb_logbook_count;
+		n += device_image_ringbuffer (ranges + n,
+			ringbuffer_increment (offset, layout->rb_logbook_size, rb_logbook_begin, rb_logbook_end),
+			count * layout->rb_logbook_size, rb_logbook_begin, rb_logbook_end, 0);
+		n += device_image_ringbuffer (ranges + n, cache_eop,
+			ringbuffer_distance (cache_eop, eop, DC_RINGBUFFER_EMPTY, layout->rb_profile_begin, layout->rb_profile_end),
+			layout->rb_profile_begin, layout->rb_profile_end, 0);
+
+		// Take everything else from the cache.
+		memcpy (data + hsize, cache + hsize, layout->memsize - hsize);
+
+		status = device_image_read (abstract, cache, data, ranges, n, PACKETSIZE);
+	}
+
+	// Download the full memory.
+	if (status == DC_STATUS_DATAFORMAT) {
+		status = device_dump_read (abstract, hsize, data + hsize,
+			layout->memsize - hsize, PACKETSIZE);
+	}
+	if (status != DC_STATUS_SUCCESS) {
+		return status;
+	}
+
+	return device_image_update (abstract, data, layout->memsize);
+}
+
+
 static dc_status_t
 mares_darwin_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata)
 {
@@ -230,7 +337,12 @@ mares_darwin_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback,
 	if (buffer == NULL)
 		return DC_STATUS_NOMEMORY;
 
-	dc_status_t rc = mares_darwin_device_dump (abstract, buffer);
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	if (abstract->image) {
+		rc = mares_darwin_device_download (abstract, buffer);
+	} else {
+		rc = mares_darwin_device_dump (abstract, buffer);
+	}
 	if (rc != DC_STATUS_SUCCESS) {
 		dc_buffer_free (buffer);
 		return rc;
@@ -50,6 +50,7 @@
 #define HORIZON   0x2C
 
 #define MAXRETRIES 4
+#define PIPELINE   4
 
 #define ACK 0xAA
 #define END 0xEA
@@ -93,6 +94,9 @@ typedef struct mares_iconhd_device_t {
 	unsigned char version[140];
 	unsigned int model;
 	unsigned int packetsize;
+	unsigned int pipeline;
+	unsigned int prefetched;
+	unsigned char prefetch[16];
 } mares_iconhd_device_t;
 
 static dc_status_t mares_iconhd_device_set_fingerprint (dc_device_t *abstract, const unsigned char data[], unsigned int size);
@@ -176,18 +180,14 @@ mares_iconhd_get_model (mares_iconhd_device_t *device)
 }
 
 static dc_status_t
-mares_iconhd_packet (mares_iconhd_device_t *device,
+mares_iconhd_send (mares_iconhd_device_t *device,
 	unsigned char cmd,
-	const unsigned char data[], unsigned int size,
-	unsigned char answer[], unsigned int asize)
+	const unsigned char data[], unsigned int size)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 	dc_device_t *abstract = (dc_device_t *) device;
 	dc_transport_t transport = dc_iostream_get_transport (device->iostream);
 
-	if (device_is_cancelled (abstract))
-		return DC_STATUS_CANCELLED;
-
 	// Send the command header to the dive computer.
 	const unsigned char command[2] = {
 		cmd, cmd ^ XOR,
@@ -207,6 +207,18 @@ mares_iconhd_packet (mares_iconhd_device_t *device,
 		}
 	}
 
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+mares_iconhd_receive (mares_iconhd_device_t *device,
+	const unsigned char data[], unsigned int size,
+	unsigned char answer[], unsigned int asize)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_device_t *abstract = (dc_device_t *) device;
+	dc_transport_t transport = dc_iostream_get_transport (device->iostream);
+
 	// Receive the header byte.
 	unsigned char header[1] = {0};
 	status = dc_iostream_read (device->iostream, header, sizeof (header), NULL);
@@ -254,6 +266,25 @@ mares_iconhd_packet (mares_iconhd_device_t *device,
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+mares_iconhd_packet (mares_iconhd_device_t *device,
+	unsigned char cmd,
+	const unsigned char data[], unsigned int size,
+	unsigned char answer[], unsigned int asize)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_device_t *abstract = (dc_device_t *) device;
+
+	if (device_is_cancelled (abstract))
+		return DC_STATUS_CANCELLED;
+
+	status = mares_iconhd_send (device, cmd, data, size);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	return mares_iconhd_receive (device, data, size, answer, asize);
+}
+
 static dc_status_t
 mares_iconhd_transfer (mares_iconhd_device_t *device, unsigned char cmd, const unsigned char data[], unsigned int size, unsigned char answer[], unsigned int asize)
 {
@@ -277,8 +308,50 @@ mares_iconhd_transfer (mares_iconhd_device_t *device, unsigned char cmd, const u
 	return DC_STATUS_SUCCESS;
 }
 
+static void
+mares_iconhd_init_command (unsigned char command[16], unsigned int index, unsigned int subindex)
+{
+	memset (command, 0x00, 16);
+	command[0] = 0x40;
+	command[1] = (index >> 0) & 0xFF;
+	command[2] = (index >> 8) & 0xFF;
+	command[3] = subindex & 0xFF;
+}
+
+static dc_status_t
+mares_iconhd_prefetch (mares_iconhd_device_t *device, unsigned int index, unsigned int subindex)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_device_t *abstract = (dc_device_t *) device;
+
+	mares_iconhd_init_command (device->prefetch, index, subindex);
+	status = mares_iconhd_send (device, CMD_OBJ_INIT, device->prefetch, sizeof (device->prefetch));
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (abstract->context, "Failed to send the init packet.");
+		return status;
+	}
+
+	device->prefetched = 1;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static void
+mares_iconhd_discard (mares_iconhd_device_t *device)
+{
+	if (!device->prefetched)
+		return;
+
+	// Receive and ignore the answer to an init packet that was sent
+	// ahead of time, but is no longer needed.
+	unsigned char answer[16];
+	mares_iconhd_receive (device, device->prefetch, sizeof (device->prefetch), answer, sizeof (answer));
+
+	device->prefetched = 0;
+}
+
 static dc_status_t
-mares_iconhd_read_object(mares_iconhd_device_t *device, dc_event_progress_t *progress, dc_buffer_t *buffer, unsigned int index, unsigned int subindex)
+mares_iconhd_read_object_window (mares_iconhd_device_t *device, dc_event_progress_t *progress, dc_buffer_t *buffer, unsigned int index, unsigned int subindex, unsigned int window, unsigned int next_index, unsigned int next_subindex)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 	dc_device_t *abstract = (dc_device_t *) device;
@@ -292,16 +365,18 @@ mares_iconhd_read_object(mares_iconhd_device_t *device, dc_event_progress_t *pro
 		device_event_emit (abstract, DC_EVENT_PROGRESS, progress);
 	}
 
-	// Transfer the init packet.
+	// Transfer the init packet. If the init packet was already sent
+	// ahead of time, only the answer needs to be received.
 	unsigned char rsp_init[16];
-	unsigned char cmd_init[16] = {
-		0x40,
-		(index >> 0) & 0xFF,
-		(index >> 8) & 0xFF,
-		subindex & 0xFF
-	};
-	memset (cmd_init + 6, 0x00, sizeof(cmd_init) - 6);
-	status = mares_iconhd_transfer (device, CMD_OBJ_INIT, cmd_init, sizeof (cmd_init), rsp_init, sizeof (rsp_init));
+	unsigned char cmd_init[16];
+	mares_iconhd_init_command (cmd_init, index, subindex);
+	if (device->prefetched && memcmp (device->prefetch, cmd_init, sizeof (cmd_init)) == 0) {
+		device->prefetched = 0;
+		status = mares_iconhd_receive (device, cmd_init, sizeof (cmd_init), rsp_init, sizeof (rsp_init));
+	} else {
+		mares_iconhd_discard (device);
+		status = mares_iconhd_transfer (device, CMD_OBJ_INIT, cmd_init, sizeof (cmd_init), rsp_init, sizeof (rsp_init));
+	}
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (abstract->context, "Failed to transfer the init packet.");
 		return status;
@@ -342,10 +417,24 @@ mares_iconhd_read_object(mares_iconhd_device_t *device, dc_event_progress_t *pro
 		device_event_emit (abstract, DC_EVENT_PROGRESS, progress);
 	}
 
-	unsigned int npackets = 0;
-	while (nbytes < size) {
+	// Get the number of segment packets.
+	unsigned int npackets = (size - nbytes + maxpacket - 1) / maxpacket;
+
+	// The init packet of the next object can be sent as soon as the last
+	// segment packet of this object has been requested. The payload of
+	// the init packet is only sent together with the command header for
+	// BLE.
+	unsigned int prefetch = window > 1 && next_index && transport == DC_TRANSPORT_BLE;
+	if (prefetch && npackets == 0) {
+		status = mares_iconhd_prefetch (device, next_index, next_subindex);
+		if (status != DC_STATUS_SUCCESS)
+			return status;
+	}
+
+	unsigned int nsent = 0, nreceived = 0;
+	while (nreceived < npackets) {
 		// Get the command byte.
-		unsigned char toggle = npackets % 2;
+		unsigned char toggle = nreceived % 2;
 		unsigned char cmd = toggle == 0 ? CMD_OBJ_EVEN : CMD_OBJ_ODD;
 
 		// Get the packet size.
@@ -354,9 +443,32 @@ mares_iconhd_read_object(mares_iconhd_device_t *device, dc_event_progress_t *pro
 			len = maxpacket;
 		}
 
-		// Transfer the segment packet.
+		// Transfer the segment packet. With pipelining, several segment
+		// packets are kept in flight, to hide the round-trip latency of
+		// the transport.
 		unsigned char rsp_segment[1 + 504];
-		status = mares_iconhd_transfer (device, cmd, NULL, 0, rsp_segment, len + 1);
+		if (window > 1) {
+			while (nsent < npackets && nsent - nreceived < window) {
+				if (device_is_cancelled (abstract))
+					return DC_STATUS_CANCELLED;
+
+				status = mares_iconhd_send (device, nsent % 2 == 0 ? CMD_OBJ_EVEN : CMD_OBJ_ODD, NULL, 0);
+				if (status != DC_STATUS_SUCCESS)
+					return status;
+
+				nsent++;
+
+				if (prefetch && nsent == npackets) {
+					status = mares_iconhd_prefetch (device, next_index, next_subindex);
+					if (status != DC_STATUS_SUCCESS)
+						return status;
+				}
+			}
+
+			status = mares_iconhd_receive (device, NULL, 0, rsp_segment, len + 1);
+		} else {
+			status = mares_iconhd_transfer (device, cmd, NULL, 0, rsp_segment, len + 1);
+		}
 		if (status != DC_STATUS_SUCCESS) {
 			ERROR (abstract->context, "Failed to transfer the segment packet.");
 			return status;
@@ -375,7 +487,7 @@ mares_iconhd_read_object(mares_iconhd_device_t *device, dc_event_progress_t *pro
 		}
 
 		nbytes += len;
-		npackets++;
+		nreceived++;
 
 		// Update and emit the progress events.
 		if (progress) {
@@ -387,6 +499,49 @@ mares_iconhd_read_object(mares_iconhd_device_t *device, dc_event_progress_t *pro
 	return status;
 }
 
+/*
+ * Read an object. If the index of the next object is non-zero, the
+ * init packet of the next object is already sent while the segment
+ * packets of this object are still on their way.
+ */
+static dc_status_t
+mares_iconhd_read_object (mares_iconhd_device_t *device, dc_event_progress_t *progress, dc_buffer_t *buffer, unsigned int index, unsigned int subindex, unsigned int next_index, unsigned int next_subindex)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_device_t *abstract = (dc_device_t *) device;
+
+	size_t offset = dc_buffer_get_size (buffer);
+	unsigned int initial = progress ? progress->current : 0;
+
+	status = mares_iconhd_read_object_window (device, progress, buffer, index, subindex, device->pipeline, next_index, next_subindex);
+	if (status == DC_STATUS_SUCCESS)
+		return status;
+
+	device->prefetched = 0;
+
+	if (device->pipeline == 1 || (status != DC_STATUS_TIMEOUT && status != DC_STATUS_PROTOCOL))
+		return status;
+
+	// Some devices may not cope with multiple outstanding packets.
+	// Disable pipelining, discard the answers that are still on their
+	// way, and read the object again from the start.
+	WARNING (abstract->context, "Pipelined object read failed. Falling back to single packet reads.");
+	device->pipeline = 1;
+	dc_iostream_sleep (device->iostream, 100);
+	dc_iostream_purge (device->iostream, DC_DIRECTION_INPUT);
+
+	if (!dc_buffer_resize (buffer, offset)) {
+		ERROR (abstract->context, "Insufficient buffer space available.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	if (progress) {
+		progress->current = initial;
+	}
+
+	return mares_iconhd_read_object_window (device, progress, buffer, index, subindex, 1, 0, 0);
+}
+
 dc_status_t
 mares_iconhd_device_open (dc_device_t **out, dc_context_t *context, dc_iostream_t *iostream)
 {
@@ -411,6 +566,9 @@ mares_iconhd_device_open (dc_device_t **out, dc_context_t *context, dc_iostream_
 	memset (device->version, 0, sizeof (device->version));
 	device->model = 0;
 	device->packetsize = 0;
+	device->pipeline = 1;
+	device->prefetched = 0;
+	memset (device->prefetch, 0, sizeof (device->prefetch));
 
 	// Create the packet stream.
 	if (transport == DC_TRANSPORT_BLE) {
@@ -521,6 +679,12 @@ mares_iconhd_device_open (dc_device_t **out, dc_context_t *context, dc_iostream_
 		break;
 	}
 
+	// Pipeline the object reads over BLE, where the round-trip latency
+	// dominates the download time.
+	if (transport == DC_TRANSPORT_BLE) {
+		device->pipeline = PIPELINE;
+	}
+
 	*out = (dc_device_t *) device;
 
 	return DC_STATUS_SUCCESS;
@@ -853,7 +1017,7 @@ mares_iconhd_device_foreach_object (dc_device_t *abstract, dc_dive_callback_t ca
 	}
 
 	// Read the number of dives.
-	rc = mares_iconhd_read_object (device, NULL, buffer, OBJ_LOGBOOK, OBJ_LOGBOOK_COUNT);
+	rc = mares_iconhd_read_object (device, NULL, buffer, OBJ_LOGBOOK, OBJ_LOGBOOK_COUNT, 0, 0);
 	if (rc != DC_STATUS_SUCCESS) {
 		ERROR (abstract->context, "Failed to read the number of dives.");
 		dc_buffer_free (buffer);
@@ -880,8 +1044,9 @@ mares_iconhd_device_foreach_object (dc_device_t *abstract, dc_dive_callback_t ca
 		// Erase the buffer.
 		dc_buffer_clear (buffer);
 
-		// Read the dive header.
-		rc = mares_iconhd_read_object (device, &progress, buffer, OBJ_DIVE + i, OBJ_DIVE_HEADER);
+		// Read the dive header. The dive data is requested ahead of
+		// time, because it's only skipped for the last dive.
+		rc = mares_iconhd_read_object (device, &progress, buffer, OBJ_DIVE + i, OBJ_DIVE_HEADER, OBJ_DIVE + i, OBJ_DIVE_DATA);
 		if (rc != DC_STATUS_SUCCESS) {
 			ERROR (abstract->context, "Failed to read the dive header.");
 			break;
@@ -893,8 +1058,9 @@ mares_iconhd_device_foreach_object (dc_device_t *abstract, dc_dive_callback_t ca
 			break;
 		}
 
-		// Read the dive data.
-		rc = mares_iconhd_read_object (device, &progress, buffer, OBJ_DIVE + i, OBJ_DIVE_DATA);
+		// Read the dive data, and request the header of the next dive.
+		unsigned int next = i + 1 < ndives ? OBJ_DIVE + i + 1 : 0;
+		rc = mares_iconhd_read_object (device, &progress, buffer, OBJ_DIVE + i, OBJ_DIVE_DATA, next, OBJ_DIVE_HEADER);
 		if (rc != DC_STATUS_SUCCESS) {
 			ERROR (abstract->context, "Failed to read the dive data.");
 			break;
@@ -906,6 +1072,9 @@ mares_iconhd_device_foreach_object (dc_device_t *abstract, dc_dive_callback_t ca
 		}
 	}
 
+	// Discard the answer to an init packet that is still on its way.
+	mares_iconhd_discard (device);
+
 	dc_buffer_free(buffer);
 
 	return rc;
@@ -264,6 +264,7 @@ static const mares_iconhd_layout_t horizon = {
 	0x54 + 8, /* tanks */
 };
 
+static dc_status_t mares_iconhd_parser_reset (dc_parser_t *abstract);
 static dc_status_t mares_iconhd_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t mares_iconhd_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t mares_iconhd_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -274,9 +275,12 @@ static const dc_parser_vtable_t mares_iconhd_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	mares_iconhd_parser_reset, /* reset */
 	mares_iconhd_parser_get_datetime, /* datetime */
 	mares_iconhd_parser_get_field, /* fields */
 	mares_iconhd_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
@@ -653,26 +657,15 @@ mares_iconhd_parser_cache (mares_iconhd_parser_t *parser)
 	}
 }
 
-dc_status_t
-mares_iconhd_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size, unsigned int model)
+static dc_status_t
+mares_iconhd_parser_reset (dc_parser_t *abstract)
 {
-	mares_iconhd_parser_t *parser = NULL;
-
-	if (out == NULL)
-		return DC_STATUS_INVALIDARGS;
-
-	// Allocate memory.
-	parser = (mares_iconhd_parser_t *) dc_parser_allocate (context, &mares_iconhd_parser_vtable, data, size);
-	if (parser == NULL) {
-		ERROR (context, "Failed to allocate memory.");
-		return DC_STATUS_NOMEMORY;
-	}
+	mares_iconhd_parser_t *parser = (mares_iconhd_parser_t *) abstract;
 
-	// Set the default values.
-	parser->model = model;
+	// Reset the cached fields.
 	parser->cached = 0;
 	parser->logformat = 0;
-	parser->mode = (model == GENIUS || model == HORIZON) ? GENIUS_AIR : ICONHD_AIR;
+	parser->mode = (parser->model == GENIUS || parser->model == HORIZON) ? GENIUS_AIR : ICONHD_AIR;
 	parser->nsamples = 0;
 	parser->samplesize = 0;
 	parser->headersize = 0;
@@ -694,6 +687,28 @@ mares_iconhd_parser_create (dc_parser_t **out, dc_context_t *context, const unsi
 	}
 	parser->layout = NULL;
 
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+mares_iconhd_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size, unsigned int model)
+{
+	mares_iconhd_parser_t *parser = NULL;
+
+	if (out == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	// Allocate memory.
+	parser = (mares_iconhd_parser_t *) dc_parser_allocate (context, &mares_iconhd_parser_vtable, data, size);
+	if (parser == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	// Set the default values.
+	parser->model = model;
+	mares_iconhd_parser_reset ((dc_parser_t *) parser);
+
 	*out = (dc_parser_t*) parser;
 
 	return DC_STATUS_SUCCESS;
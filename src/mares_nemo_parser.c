@@ -59,6 +59,7 @@ struct mares_nemo_parser_t {
 	unsigned int extra;
 };
 
+static dc_status_t mares_nemo_parser_reset (dc_parser_t *abstract);
 static dc_status_t mares_nemo_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t mares_nemo_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t mares_nemo_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -69,57 +70,43 @@ static const dc_parser_vtable_t mares_nemo_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	mares_nemo_parser_reset, /* reset */
 	mares_nemo_parser_get_datetime, /* datetime */
 	mares_nemo_parser_get_field, /* fields */
 	mares_nemo_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
 
-dc_status_t
-mares_nemo_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size, unsigned int model)
+static dc_status_t
+mares_nemo_parser_reset (dc_parser_t *abstract)
 {
-	dc_status_t status = DC_STATUS_SUCCESS;
-	mares_nemo_parser_t *parser = NULL;
-
-	if (out == NULL)
-		return DC_STATUS_INVALIDARGS;
-
-	// Allocate memory.
-	parser = (mares_nemo_parser_t *) dc_parser_allocate (context, &mares_nemo_parser_vtable, data, size);
-	if (parser == NULL) {
-		ERROR (context, "Failed to allocate memory.");
-		return DC_STATUS_NOMEMORY;
-	}
-
-	// Get the freedive mode for this model.
-	unsigned int freedive = FREEDIVE;
-	if (model == NEMOWIDE || model == NEMOAIR || model == PUCK || model == PUCKAIR)
-		freedive = GAUGE;
+	mares_nemo_parser_t *parser = (mares_nemo_parser_t *) abstract;
+	const unsigned char *data = abstract->data;
+	unsigned int size = abstract->size;
 
 	if (size < 2 + 3) {
-		status = DC_STATUS_DATAFORMAT;
-		goto error_free;
+		return DC_STATUS_DATAFORMAT;
 	}
 
 	unsigned int length = array_uint16_le (data);
 	if (length > size) {
-		status = DC_STATUS_DATAFORMAT;
-		goto error_free;
+		return DC_STATUS_DATAFORMAT;
 	}
 
 	unsigned int extra = 0;
 	const unsigned char marker[3] = {0xAA, 0xBB, 0xCC};
 	if (memcmp (data + length - 3, marker, sizeof (marker)) == 0) {
-		if (model == PUCKAIR)
+		if (parser->model == PUCKAIR)
 			extra = 7;
 		else
 			extra = 12;
 	}
 
 	if (length < 2 + extra + 3) {
-		status = DC_STATUS_DATAFORMAT;
-		goto error_free;
+		return DC_STATUS_DATAFORMAT;
 	}
 
 	unsigned int mode = data[length - extra - 1];
@@ -127,12 +114,12 @@ mares_nemo_parser_create (dc_parser_t **out, dc_context_t *context, const unsign
 	unsigned int header_size = 53;
 	unsigned int sample_size = 2;
 	if (extra) {
-		if (model == PUCKAIR)
+		if (parser->model == PUCKAIR)
 			sample_size = 3;
 		else
 			sample_size = 5;
 	}
-	if (mode == freedive) {
+	if (mode == parser->freedive) {
 		header_size = 28;
 		sample_size = 6;
 	}
@@ -141,13 +128,9 @@ mares_nemo_parser_create (dc_parser_t **out, dc_context_t *context, const unsign
 
 	unsigned int nbytes = 2 + nsamples * sample_size + header_size + extra;
 	if (length != nbytes) {
-		status = DC_STATUS_DATAFORMAT;
-		goto error_free;
+		return DC_STATUS_DATAFORMAT;
 	}
 
-	// Set the default values.
-	parser->model = model;
-	parser->freedive = freedive;
 	parser->mode = mode;
 	parser->length = length;
 	parser->sample_count = nsamples;
@@ -155,6 +138,39 @@ mares_nemo_parser_create (dc_parser_t **out, dc_context_t *context, const unsign
 	parser->header = header_size;
 	parser->extra = extra;
 
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+mares_nemo_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size, unsigned int model)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	mares_nemo_parser_t *parser = NULL;
+
+	if (out == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	// Allocate memory.
+	parser = (mares_nemo_parser_t *) dc_parser_allocate (context, &mares_nemo_parser_vtable, data, size);
+	if (parser == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	// Get the freedive mode for this model.
+	unsigned int freedive = FREEDIVE;
+	if (model == NEMOWIDE || model == NEMOAIR || model == PUCK || model == PUCKAIR)
+		freedive = GAUGE;
+
+	// Set the default values.
+	parser->model = model;
+	parser->freedive = freedive;
+
+	// Process the dive data.
+	status = mares_nemo_parser_reset ((dc_parser_t *) parser);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
 	*out = (dc_parser_t*) parser;
 
 	return DC_STATUS_SUCCESS;
@@ -28,6 +28,7 @@
 #include "context-private.h"
 #include "device-private.h"
 #include "checksum.h"
+#include "ringbuffer.h"
 #include "array.h"
 
 #define ISINSTANCE(device) dc_device_isinstance((device), &mares_puck_device_vtable)
@@ -222,6 +223,100 @@ mares_puck_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 }
 
 
+static dc_status_t
+mares_puck_device_download (dc_device_t *abstract, dc_buffer_t *buffer)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	mares_puck_device_t *device = (mares_puck_device_t *) abstract;
+
+	assert (device->layout != NULL);
+
+	const mares_common_layout_t *layout = device->layout;
+
+	// Allocate the required amount of memory.
+	if (!dc_buffer_resize (buffer, layout->memsize)) {
+		ERROR (abstract->context, "Insufficient buffer space available.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	unsigned char *data = dc_buffer_get_data (buffer);
+
+	// Read the header.
+	unsigned int hsize = layout->rb_profile_begin;
+	status = mares_common_device_read (abstract, 0, data, hsize);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (abstract->context, "Failed to read the header.");
+		return status;
+	}
+
+	// Emit a device info event.
+	dc_event_devinfo_t devinfo;
+	devinfo.model = data[1];
+	devinfo.firmware = 0;
+	devinfo.serial = array_uint16_be (data + 8);
+	device_event_emit (abstract, DC_EVENT_DEVINFO, &devinfo);
+
+	// The cached memory image can only be used if it belongs to the same
+	// device, and the ringbuffer pointers are valid.
+	unsigned int eop = array_uint16_le (data + 0x6B);
+	const unsigned char *cache = device_image_lookup (abstract, layout->memsize);
+	if (cache) {
+		unsigned int cache_eop = array_uint16_le (cache + 0x6B);
+		if (cache[1] != data[1] || memcmp (cache + 8, data + 8, 2) != 0 ||
+			cache_eop < layout->rb_profile_begin || cache_eop >= layout->rb_profile_end ||
+			eop < layout->rb_profile_begin || eop >= layout->rb_profile_end) {
+			WARNING (abstract->context, "The cached memory image doesn't match the device.");
+			cache = NULL;
+		}
+	}
+
+	status = DC_STATUS_DATAFORMAT;
+	if (cache) {
+		unsigned int cache_eop = array_uint16_le (cache + 0x6B);
+
+		device_range_t ranges[5];
+		unsigned int n = 0;
+
+		// Read the end of the most recent dive again. If it has changed,
+		// the ringbuffer has been overwritten completely since the image
+		// was made.
+		n += device_image_ringbuffer (ranges + n,
+			ringbuffer_decrement (cache_eop, PACKETSIZE, layout->rb_profile_begin, layout->rb_profile_end),
+			PACKETSIZE, layout->rb_profile_begin, layout->rb_profile_end, 1);
+
+		// Read the new dives.
+		n += device_image_ringbuffer (ranges + n, cache_eop,
+			ringbuffer_distance (cache_eop, eop, DC_RINGBUFFER_EMPTY, layout->rb_profile_begin, layout->rb_profile_end),
+			layout->rb_profile_begin, layout->rb_profile_end, 0);
+
+		// Read the freedive profiles, which are overwritten for every
+		// new freedive session.
+		if (layout->rb_freedives_end > layout->rb_freedives_begin) {
+			ranges[n].address = layout->rb_freedives_begin;
+			ranges[n].size = layout->rb_freedives_end - layout->rb_freedives_begin;
+			ranges[n].verify = 0;
+			n++;
+		}
+
+		// Take everything else from the cache.
+		memcpy (data + hsize, cache + hsize, layout->memsize - hsize);
+
+		status = device_image_read (abstract, cache, data, ranges, n, PACKETSIZE);
+	}
+
+	// Download the full memory.
+	if (status == DC_STATUS_DATAFORMAT) {
+		status = device_dump_read (abstract, hsize, data + hsize,
+			layout->memsize - hsize, PACKETSIZE);
+	}
+	if (status != DC_STATUS_SUCCESS) {
+		return status;
+	}
+
+	return device_image_update (abstract, data, layout->memsize);
+}
+
+
 static dc_status_t
 mares_puck_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata)
 {
@@ -233,7 +328,12 @@ mares_puck_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, v
 	if (buffer == NULL)
 		return DC_STATUS_NOMEMORY;
 
-	dc_status_t rc = mares_puck_device_dump (abstract, buffer);
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	if (abstract->image) {
+		rc = mares_puck_device_download (abstract, buffer);
+	} else {
+		rc = mares_puck_device_dump (abstract, buffer);
+	}
 	if (rc != DC_STATUS_SUCCESS) {
 		dc_buffer_free (buffer);
 		return rc;
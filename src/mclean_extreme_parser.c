@@ -58,6 +58,7 @@ struct mclean_extreme_parser_t {
 	unsigned int gasmix[NGASMIXES];
 };
 
+static dc_status_t mclean_extreme_parser_reset(dc_parser_t *abstract);
 static dc_status_t mclean_extreme_parser_get_datetime(dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t mclean_extreme_parser_get_field(dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t mclean_extreme_parser_samples_foreach(dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -68,12 +69,30 @@ static const dc_parser_vtable_t mclean_extreme_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	mclean_extreme_parser_reset, /* reset */
 	mclean_extreme_parser_get_datetime, /* datetime */
 	mclean_extreme_parser_get_field, /* fields */
 	mclean_extreme_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
+static dc_status_t
+mclean_extreme_parser_reset(dc_parser_t *abstract)
+{
+	mclean_extreme_parser_t *parser = (mclean_extreme_parser_t *) abstract;
+
+	// Reset the cached fields.
+	parser->cached = 0;
+	parser->ngasmixes = 0;
+	for (unsigned int i = 0; i < NGASMIXES; ++i) {
+		parser->gasmix[i] = INVALID;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
 dc_status_t
 mclean_extreme_parser_create(dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size)
 {
@@ -91,11 +110,7 @@ mclean_extreme_parser_create(dc_parser_t **out, dc_context_t *context, const uns
 	}
 
 	// Set the default values.
-	parser->cached = 0;
-	parser->ngasmixes = 0;
-	for (unsigned int i = 0; i < NGASMIXES; ++i) {
-		parser->gasmix[i] = INVALID;
-	}
+	mclean_extreme_parser_reset((dc_parser_t *) parser);
 
 	*out = (dc_parser_t *)parser;
 
@@ -38,6 +38,9 @@
 #define MAXPACKET  256
 #define MAXRETRIES 2
 #define MAXDELAY   16
+#define PIPELINE   4
+#define NCACHE     8
+#define MAXCACHE   32
 #define INVALID    0xFFFFFFFF
 
 #define CMD_INIT      0xA8
@@ -56,22 +59,34 @@
 
 #define REPEAT 50
 
+typedef struct oceanic_atom2_page_t {
+	unsigned int page;
+	unsigned int highmem;
+	unsigned int stamp;
+	unsigned char data[MAXPACKET];
+} oceanic_atom2_page_t;
+
 typedef struct oceanic_atom2_device_t {
 	oceanic_common_device_t base;
 	dc_iostream_t *iostream;
 	unsigned int handshake_repeat;
 	unsigned int handshake_counter;
 	unsigned int sequence;
+	unsigned int pending;
+	unsigned int pipeline;
 	unsigned int delay;
 	unsigned int extra;
 	unsigned int bigpage;
-	unsigned char cache[256];
-	unsigned int cached_page;
-	unsigned int cached_highmem;
+	oceanic_atom2_page_t cache[MAXCACHE];
+	unsigned int ncache;
+	unsigned int stamp;
+	unsigned int hits;
+	unsigned int misses;
 } oceanic_atom2_device_t;
 
 static dc_status_t oceanic_atom2_device_read (dc_device_t *abstract, unsigned int address, unsigned char data[], unsigned int size);
 static dc_status_t oceanic_atom2_device_write (dc_device_t *abstract, unsigned int address, const unsigned char data[], unsigned int size);
+static dc_status_t oceanic_atom2_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata);
 static dc_status_t oceanic_atom2_device_close (dc_device_t *abstract);
 
 static const oceanic_common_device_vtable_t oceanic_atom2_device_vtable = {
@@ -82,7 +97,7 @@ static const oceanic_common_device_vtable_t oceanic_atom2_device_vtable = {
 		oceanic_atom2_device_read, /* read */
 		oceanic_atom2_device_write, /* write */
 		oceanic_common_device_dump, /* dump */
-		oceanic_common_device_foreach, /* foreach */
+		oceanic_atom2_device_foreach, /* foreach */
 		NULL, /* timesync */
 		oceanic_atom2_device_close /* close */
 	},
@@ -550,7 +565,7 @@ oceanic_atom2_ble_write (oceanic_atom2_device_t *device, const unsigned char dat
 {
 	dc_status_t rc = DC_STATUS_SUCCESS;
 	unsigned char buf[20];
-	unsigned char cmd_seq = device->sequence;
+	unsigned char cmd_seq = device->sequence + device->pending;
 	unsigned char pkt_seq = 0;
 
 	unsigned int nbytes = 0;
@@ -658,27 +673,12 @@ oceanic_atom2_ble_read (oceanic_atom2_device_t *device, unsigned char data[], un
 }
 
 static dc_status_t
-oceanic_atom2_packet (oceanic_atom2_device_t *device, const unsigned char command[], unsigned int csize, unsigned char ack, unsigned char answer[], unsigned int asize, unsigned int crc_size)
+oceanic_atom2_send (oceanic_atom2_device_t *device, const unsigned char command[], unsigned int csize)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 	dc_device_t *abstract = (dc_device_t *) device;
 	dc_transport_t transport = dc_iostream_get_transport (device->iostream);
 
-	if (asize > MAXPACKET) {
-		return DC_STATUS_INVALIDARGS;
-	}
-
-	if (crc_size > 2 || (crc_size != 0 && asize == 0)) {
-		return DC_STATUS_INVALIDARGS;
-	}
-
-	if (device_is_cancelled (abstract))
-		return DC_STATUS_CANCELLED;
-
-	if (device->delay) {
-		dc_iostream_sleep (device->iostream, device->delay);
-	}
-
 	// Send the command to the dive computer.
 	if (transport == DC_TRANSPORT_BLE) {
 		status = oceanic_atom2_ble_write (device, command, csize);
@@ -690,6 +690,18 @@ oceanic_atom2_packet (oceanic_atom2_device_t *device, const unsigned char comman
 		return status;
 	}
 
+	device->pending++;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+oceanic_atom2_receive (oceanic_atom2_device_t *device, unsigned char ack, unsigned char answer[], unsigned int asize, unsigned int crc_size)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_device_t *abstract = (dc_device_t *) device;
+	dc_transport_t transport = dc_iostream_get_transport (device->iostream);
+
 	// Receive the answer of the dive computer.
 	unsigned char packet[1 + MAXPACKET + 2];
 	unsigned int nbytes = 1 + asize + crc_size;
@@ -754,10 +766,42 @@ oceanic_atom2_packet (oceanic_atom2_device_t *device, const unsigned char comman
 	}
 
 	device->sequence++;
+	device->pending--;
 
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+oceanic_atom2_packet (oceanic_atom2_device_t *device, const unsigned char command[], unsigned int csize, unsigned char ack, unsigned char answer[], unsigned int asize, unsigned int crc_size)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_device_t *abstract = (dc_device_t *) device;
+
+	if (asize > MAXPACKET) {
+		return DC_STATUS_INVALIDARGS;
+	}
+
+	if (crc_size > 2 || (crc_size != 0 && asize == 0)) {
+		return DC_STATUS_INVALIDARGS;
+	}
+
+	if (device_is_cancelled (abstract))
+		return DC_STATUS_CANCELLED;
+
+	if (device->delay) {
+		dc_iostream_sleep (device->iostream, device->delay);
+	}
+
+	// Discard any unanswered commands.
+	device->pending = 0;
+
+	status = oceanic_atom2_send (device, command, csize);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	return oceanic_atom2_receive (device, ack, answer, asize, crc_size);
+}
+
 
 static dc_status_t
 oceanic_atom2_transfer (oceanic_atom2_device_t *device, const unsigned char command[], unsigned int csize, unsigned char ack, unsigned char answer[], unsigned int asize, unsigned int crc_size)
@@ -856,6 +900,52 @@ oceanic_atom2_ble_handshake(oceanic_atom2_device_t *device)
 	return DC_STATUS_SUCCESS;
 }
 
+static void
+oceanic_atom2_cache_invalidate (oceanic_atom2_device_t *device)
+{
+	for (unsigned int i = 0; i < MAXCACHE; ++i) {
+		device->cache[i].page = INVALID;
+		device->cache[i].highmem = INVALID;
+		device->cache[i].stamp = 0;
+	}
+}
+
+/*
+ * Find a page in the cache. Pages are identified by their page number
+ * and the high memory state, because the page number and page size are
+ * different inside the high memory area.
+ */
+static oceanic_atom2_page_t *
+oceanic_atom2_cache_lookup (oceanic_atom2_device_t *device, unsigned int page, unsigned int highmem)
+{
+	for (unsigned int i = 0; i < device->ncache; ++i) {
+		if (device->cache[i].page == page && device->cache[i].highmem == highmem)
+			return device->cache + i;
+	}
+
+	return NULL;
+}
+
+/*
+ * Get the least recently used entry of the cache, and assign it to the
+ * page. The caller is responsible for filling in the data.
+ */
+static oceanic_atom2_page_t *
+oceanic_atom2_cache_insert (oceanic_atom2_device_t *device, unsigned int page, unsigned int highmem)
+{
+	oceanic_atom2_page_t *entry = device->cache;
+	for (unsigned int i = 1; i < device->ncache; ++i) {
+		if (device->cache[i].stamp < entry->stamp)
+			entry = device->cache + i;
+	}
+
+	entry->page = page;
+	entry->highmem = highmem;
+	entry->stamp = ++device->stamp;
+
+	return entry;
+}
+
 dc_status_t
 oceanic_atom2_device_open (dc_device_t **out, dc_context_t *context, dc_iostream_t *iostream, unsigned int model)
 {
@@ -880,10 +970,14 @@ oceanic_atom2_device_open (dc_device_t **out, dc_context_t *context, dc_iostream
 	device->delay = 0;
 	device->extra = model == PROPLUSX || model == I770R;
 	device->sequence = 0;
+	device->pending = 0;
+	device->pipeline = 1;
 	device->bigpage = 1; // no big pages
-	device->cached_page = INVALID;
-	device->cached_highmem = INVALID;
-	memset(device->cache, 0, sizeof(device->cache));
+	device->ncache = NCACHE;
+	device->stamp = 0;
+	device->hits = 0;
+	device->misses = 0;
+	oceanic_atom2_cache_invalidate (device);
 
 	// Get the correct baudrate.
 	unsigned int baudrate = 38400;
@@ -990,6 +1084,17 @@ oceanic_atom2_device_open (dc_device_t **out, dc_context_t *context, dc_iostream
 		device->base.model == PROPLUS4;
 	device->handshake_counter = 0;
 
+	// Pipeline the page reads over BLE, where the round-trip latency
+	// dominates the download time, except when the handshaking needs to
+	// be repeated in between.
+	if (dc_iostream_get_transport (device->iostream) == DC_TRANSPORT_BLE &&
+		!device->handshake_repeat) {
+		device->pipeline = PIPELINE;
+	}
+	if (device->pipeline > 1) {
+		device->base.readahead = device->pipeline * device->bigpage;
+	}
+
 	*out = (dc_device_t*) device;
 
 	return DC_STATUS_SUCCESS;
@@ -1036,6 +1141,24 @@ oceanic_atom2_device_keepalive (dc_device_t *abstract)
 }
 
 
+dc_status_t
+oceanic_atom2_device_set_cache (dc_device_t *abstract, unsigned int npages)
+{
+	oceanic_atom2_device_t *device = (oceanic_atom2_device_t*) abstract;
+
+	if (!ISINSTANCE (abstract))
+		return DC_STATUS_INVALIDARGS;
+
+	if (npages == 0 || npages > MAXCACHE)
+		return DC_STATUS_INVALIDARGS;
+
+	device->ncache = npages;
+	oceanic_atom2_cache_invalidate (device);
+
+	return DC_STATUS_SUCCESS;
+}
+
+
 dc_status_t
 oceanic_atom2_device_version (dc_device_t *abstract, unsigned char data[], unsigned int size)
 {
@@ -1056,6 +1179,75 @@ oceanic_atom2_device_version (dc_device_t *abstract, unsigned char data[], unsig
 }
 
 
+static dc_status_t
+oceanic_atom2_device_read_pages (oceanic_atom2_device_t *device, unsigned char read_cmd, unsigned int crc_size, unsigned int highmem, unsigned int page, unsigned int npages, unsigned char data[])
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_device_t *abstract = (dc_device_t *) device;
+	unsigned int pagesize = highmem ? 16 * PAGESIZE : device->bigpage * PAGESIZE;
+
+	if (device_is_cancelled (abstract))
+		return DC_STATUS_CANCELLED;
+
+	// Keep several read commands in flight. The next command is sent as
+	// soon as an answer arrives, which hides the round-trip latency of
+	// the transport.
+	unsigned int nsent = 0, nreceived = 0;
+	device->pending = 0;
+	while (nreceived < npages) {
+		while (nsent < npages && nsent - nreceived < device->pipeline) {
+			unsigned int number = highmem ? page + nsent : (page + nsent) * device->bigpage;
+			unsigned char command[] = {read_cmd,
+					(number >> 8) & 0xFF, // high
+					(number     ) & 0xFF, // low
+				};
+			status = oceanic_atom2_send (device, command, sizeof (command));
+			if (status != DC_STATUS_SUCCESS)
+				goto error;
+			nsent++;
+		}
+
+		status = oceanic_atom2_receive (device, ACK, data + nreceived * pagesize, pagesize, crc_size);
+		if (status != DC_STATUS_SUCCESS)
+			goto error;
+		nreceived++;
+	}
+
+	return DC_STATUS_SUCCESS;
+
+error:
+	if (status != DC_STATUS_TIMEOUT && status != DC_STATUS_PROTOCOL)
+		return status;
+
+	// Some devices or interfaces may not cope with multiple outstanding
+	// commands. Disable pipelining, discard the answers that are still
+	// on their way (until the read timeout of the device expires), and
+	// retry the remaining pages one by one.
+	WARNING (abstract->context, "Pipelined read failed. Falling back to single page reads.");
+	device->pipeline = 1;
+	device->pending = 0;
+	while (1) {
+		unsigned char buffer[1 + MAXPACKET + 2];
+		size_t transferred = 0;
+		dc_iostream_read (device->iostream, buffer, sizeof (buffer), &transferred);
+		if (transferred == 0)
+			break;
+	}
+
+	for (unsigned int i = nreceived; i < npages; ++i) {
+		unsigned int number = highmem ? page + i : (page + i) * device->bigpage;
+		unsigned char command[] = {read_cmd,
+				(number >> 8) & 0xFF, // high
+				(number     ) & 0xFF, // low
+			};
+		status = oceanic_atom2_transfer (device, command, sizeof (command), ACK, data + i * pagesize, pagesize, crc_size);
+		if (status != DC_STATUS_SUCCESS)
+			return status;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
 static dc_status_t
 oceanic_atom2_device_read (dc_device_t *abstract, unsigned int address, unsigned char data[], unsigned int size)
 {
@@ -1106,7 +1298,46 @@ oceanic_atom2_device_read (dc_device_t *abstract, unsigned int address, unsigned
 		// addresses back to their physical address.
 		unsigned int page = (address - highmem) / pagesize;
 
-		if (page != device->cached_page || highmem != device->cached_highmem) {
+		oceanic_atom2_page_t *entry = oceanic_atom2_cache_lookup (device, page, highmem);
+
+		// Number of whole pages, not yet present in the cache, that can be
+		// read directly into the output buffer, without crossing into the
+		// high memory area.
+		unsigned int npages = 0;
+		if (address % pagesize == 0 && entry == NULL) {
+			unsigned int limit = size - nbytes;
+			if (layout->highmem && !highmem && address + limit > layout->highmem)
+				limit = layout->highmem - address;
+			while (npages < limit / pagesize &&
+				oceanic_atom2_cache_lookup (device, page + npages, highmem) == NULL) {
+				npages++;
+			}
+		}
+
+		if (npages > 1 && device->pipeline > 1 && device->delay == 0) {
+			dc_status_t rc = oceanic_atom2_device_read_pages (device, read_cmd, crc_size, highmem, page, npages, data);
+			if (rc != DC_STATUS_SUCCESS)
+				return rc;
+
+			device->misses += npages;
+
+			// Cache the pages. If there are more pages than cache
+			// entries, only the last pages are kept.
+			unsigned int first = npages > device->ncache ? npages - device->ncache : 0;
+			for (unsigned int i = first; i < npages; ++i) {
+				entry = oceanic_atom2_cache_insert (device, page + i, highmem);
+				memcpy (entry->data, data + i * pagesize, pagesize);
+			}
+
+			unsigned int length = npages * pagesize;
+
+			nbytes += length;
+			address += length;
+			data += length;
+			continue;
+		}
+
+		if (entry == NULL) {
 			if (device->handshake_repeat && ++device->handshake_counter % REPEAT == 0) {
 				unsigned char version[PAGESIZE] = {0};
 				oceanic_atom2_device_version (abstract, version, sizeof (version));
@@ -1114,18 +1345,24 @@ oceanic_atom2_device_read (dc_device_t *abstract, unsigned int address, unsigned
 			}
 
 			// Read the package.
+			entry = oceanic_atom2_cache_insert (device, page, highmem);
 			unsigned int number = highmem ? page : page * device->bigpage; // This is always PAGESIZE, even in big page mode.
 			unsigned char command[] = {read_cmd,
 					(number >> 8) & 0xFF, // high
 					(number     ) & 0xFF, // low
 				};
-			dc_status_t rc = oceanic_atom2_transfer (device, command, sizeof (command), ACK, device->cache, pagesize, crc_size);
-			if (rc != DC_STATUS_SUCCESS)
+			dc_status_t rc = oceanic_atom2_transfer (device, command, sizeof (command), ACK, entry->data, pagesize, crc_size);
+			if (rc != DC_STATUS_SUCCESS) {
+				entry->page = INVALID;
+				entry->highmem = INVALID;
+				entry->stamp = 0;
 				return rc;
+			}
 
-			// Cache the page.
-			device->cached_page = page;
-			device->cached_highmem = highmem;
+			device->misses++;
+		} else {
+			entry->stamp = ++device->stamp;
+			device->hits++;
 		}
 
 		unsigned int offset = address % pagesize;
@@ -1133,7 +1370,7 @@ oceanic_atom2_device_read (dc_device_t *abstract, unsigned int address, unsigned
 		if (nbytes + length > size)
 			length = size - nbytes;
 
-		memcpy (data, device->cache + offset, length);
+		memcpy (data, entry->data + offset, length);
 
 		nbytes += length;
 		address += length;
@@ -1144,6 +1381,24 @@ oceanic_atom2_device_read (dc_device_t *abstract, unsigned int address, unsigned
 }
 
 
+static dc_status_t
+oceanic_atom2_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata)
+{
+	oceanic_atom2_device_t *device = (oceanic_atom2_device_t*) abstract;
+
+	device->hits = 0;
+	device->misses = 0;
+
+	dc_status_t status = oceanic_common_device_foreach (abstract, callback, userdata);
+
+	// Report the cache statistics, also after a failed download.
+	dc_event_cache_t cache = {device->hits, device->misses};
+	device_event_emit (abstract, DC_EVENT_CACHE, &cache);
+
+	return status;
+}
+
+
 static dc_status_t
 oceanic_atom2_device_write (dc_device_t *abstract, unsigned int address, const unsigned char data[], unsigned int size)
 {
@@ -1154,8 +1409,7 @@ oceanic_atom2_device_write (dc_device_t *abstract, unsigned int address, const u
 		return DC_STATUS_INVALIDARGS;
 
 	// Invalidate the cache.
-	device->cached_page = INVALID;
-	device->cached_highmem = INVALID;
+	oceanic_atom2_cache_invalidate (device);
 
 	unsigned int nbytes = 0;
 	while (nbytes < size) {
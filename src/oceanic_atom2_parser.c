@@ -20,6 +20,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <libdivecomputer/units.h>
 
@@ -62,13 +63,15 @@ struct oceanic_atom2_parser_t {
 	unsigned int ngasmixes;
 	unsigned int oxygen[NGASMIXES];
 	unsigned int helium[NGASMIXES];
-	unsigned int divetime;
-	double maxdepth;
+	sample_statistics_t statistics;
+	dc_gasmix_t gasmix[NGASMIXES];
 };
 
+static dc_status_t oceanic_atom2_parser_reset (dc_parser_t *abstract);
 static dc_status_t oceanic_atom2_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t oceanic_atom2_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
+static dc_status_t oceanic_atom2_parser_get_summary (dc_parser_t *abstract, dc_summary_t *summary);
 
 static const dc_parser_vtable_t oceanic_atom2_parser_vtable = {
 	sizeof(oceanic_atom2_parser_t),
@@ -76,13 +79,36 @@ static const dc_parser_vtable_t oceanic_atom2_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	oceanic_atom2_parser_reset, /* reset */
 	oceanic_atom2_parser_get_datetime, /* datetime */
 	oceanic_atom2_parser_get_field, /* fields */
 	oceanic_atom2_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	oceanic_atom2_parser_get_summary, /* summary */
 	NULL /* destroy */
 };
 
 
+static dc_status_t
+oceanic_atom2_parser_reset (dc_parser_t *abstract)
+{
+	oceanic_atom2_parser_t *parser = (oceanic_atom2_parser_t *) abstract;
+
+	// Reset the cached fields.
+	parser->cached = 0;
+	parser->header = 0;
+	parser->footer = 0;
+	parser->mode = NORMAL;
+	parser->ngasmixes = 0;
+	for (unsigned int i = 0; i < NGASMIXES; ++i) {
+		parser->oxygen[i] = 0;
+		parser->helium[i] = 0;
+	}
+	memset (&parser->statistics, 0, sizeof (parser->statistics));
+
+	return DC_STATUS_SUCCESS;
+}
+
 dc_status_t
 oceanic_atom2_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size, unsigned int model)
 {
@@ -149,17 +175,7 @@ oceanic_atom2_parser_create (dc_parser_t **out, dc_context_t *context, const uns
 		parser->footersize = 64;
 	}
 
-	parser->cached = 0;
-	parser->header = 0;
-	parser->footer = 0;
-	parser->mode = NORMAL;
-	parser->ngasmixes = 0;
-	for (unsigned int i = 0; i < NGASMIXES; ++i) {
-		parser->oxygen[i] = 0;
-		parser->helium[i] = 0;
-	}
-	parser->divetime = 0;
-	parser->maxdepth = 0.0;
+	oceanic_atom2_parser_reset ((dc_parser_t *) parser);
 
 	*out = (dc_parser_t*) parser;
 
@@ -489,12 +505,13 @@ oceanic_atom2_parser_cache (oceanic_atom2_parser_t *parser)
 }
 
 
+/*
+ * Cache the header data, and the statistics of the profile data.
+ */
 static dc_status_t
-oceanic_atom2_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value)
+oceanic_atom2_parser_cache_profile (oceanic_atom2_parser_t *parser)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
-	oceanic_atom2_parser_t *parser = (oceanic_atom2_parser_t *) abstract;
-	const unsigned char *data = abstract->data;
 
 	// Cache the header data.
 	status = oceanic_atom2_parser_cache (parser);
@@ -505,37 +522,75 @@ oceanic_atom2_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 	if (parser->cached < PROFILE) {
 		sample_statistics_t statistics = SAMPLE_STATISTICS_INITIALIZER;
 		status = oceanic_atom2_parser_samples_foreach (
-			abstract, sample_statistics_cb, &statistics);
+			(dc_parser_t *) parser, sample_statistics_cb, &statistics);
 		if (status != DC_STATUS_SUCCESS)
 			return status;
 
 		parser->cached = PROFILE;
-		parser->divetime = statistics.divetime;
-		parser->maxdepth = statistics.maxdepth;
+		parser->statistics = statistics;
 	}
 
-	dc_gasmix_t *gasmix = (dc_gasmix_t *) value;
+	return DC_STATUS_SUCCESS;
+}
+
+static unsigned int
+oceanic_atom2_parser_divetime (oceanic_atom2_parser_t *parser)
+{
+	const unsigned char *data = parser->base.data;
+
+	if (parser->model == F10A || parser->model == F10B ||
+		parser->model == F11A || parser->model == F11B ||
+		parser->model == MUNDIAL2 || parser->model == MUNDIAL3)
+		return bcd2dec (data[2]) + bcd2dec (data[3]) * 60;
+	else
+		return parser->statistics.divetime;
+}
+
+static double
+oceanic_atom2_parser_maxdepth (oceanic_atom2_parser_t *parser)
+{
+	const unsigned char *data = parser->base.data;
+
+	if (parser->model == F10A || parser->model == F10B ||
+		parser->model == F11A || parser->model == F11B ||
+		parser->model == MUNDIAL2 || parser->model == MUNDIAL3)
+		return array_uint16_le (data + 4) / 16.0 * FEET;
+	else if (parser->model == I330R || parser->model == DSX)
+		return array_uint16_le (data + parser->footer + 10) / 10.0 * FEET;
+	else
+		return (array_uint16_le (data + parser->footer + 4) & 0x0FFF) / 16.0 * FEET;
+}
+
+static void
+oceanic_atom2_parser_gasmix (oceanic_atom2_parser_t *parser, unsigned int idx, dc_gasmix_t *gasmix)
+{
+	gasmix->usage = DC_USAGE_NONE;
+	gasmix->oxygen = parser->oxygen[idx] / 100.0;
+	gasmix->helium = parser->helium[idx] / 100.0;
+	gasmix->nitrogen = 1.0 - gasmix->oxygen - gasmix->helium;
+}
+
+static dc_status_t
+oceanic_atom2_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	oceanic_atom2_parser_t *parser = (oceanic_atom2_parser_t *) abstract;
+	const unsigned char *data = abstract->data;
+
+	// Cache the header and profile data.
+	status = oceanic_atom2_parser_cache_profile (parser);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
 	dc_salinity_t *water = (dc_salinity_t *) value;
 
 	if (value) {
 		switch (type) {
 		case DC_FIELD_DIVETIME:
-			if (parser->model == F10A || parser->model == F10B ||
-				parser->model == F11A || parser->model == F11B ||
-				parser->model == MUNDIAL2 || parser->model == MUNDIAL3)
-				*((unsigned int *) value) = bcd2dec (data[2]) + bcd2dec (data[3]) * 60;
-			else
-				*((unsigned int *) value) = parser->divetime;
+			*((unsigned int *) value) = oceanic_atom2_parser_divetime (parser);
 			break;
 		case DC_FIELD_MAXDEPTH:
-			if (parser->model == F10A || parser->model == F10B ||
-				parser->model == F11A || parser->model == F11B ||
-				parser->model == MUNDIAL2 || parser->model == MUNDIAL3)
-				*((double *) value) = array_uint16_le (data + 4) / 16.0 * FEET;
-			else if (parser->model == I330R || parser->model == DSX)
-				*((double *) value) = array_uint16_le (data + parser->footer + 10) / 10.0 * FEET;
-			else
-				*((double *) value) = (array_uint16_le (data + parser->footer + 4) & 0x0FFF) / 16.0 * FEET;
+			*((double *) value) = oceanic_atom2_parser_maxdepth (parser);
 			break;
 		case DC_FIELD_AVGDEPTH:
 			if (parser->model == I330R || parser->model == DSX) {
@@ -548,10 +603,17 @@ oceanic_atom2_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 			*((unsigned int *) value) = parser->ngasmixes;
 			break;
 		case DC_FIELD_GASMIX:
-			gasmix->usage = DC_USAGE_NONE;
-			gasmix->oxygen = parser->oxygen[flags] / 100.0;
-			gasmix->helium = parser->helium[flags] / 100.0;
-			gasmix->nitrogen = 1.0 - gasmix->oxygen - gasmix->helium;
+			oceanic_atom2_parser_gasmix (parser, flags, (dc_gasmix_t *) value);
+			break;
+		case DC_FIELD_TEMPERATURE_MINIMUM:
+			if (parser->statistics.ntemperatures == 0)
+				return DC_STATUS_UNSUPPORTED;
+			*((double *) value) = parser->statistics.temperature_minimum;
+			break;
+		case DC_FIELD_TEMPERATURE_MAXIMUM:
+			if (parser->statistics.ntemperatures == 0)
+				return DC_STATUS_UNSUPPORTED;
+			*((double *) value) = parser->statistics.temperature_maximum;
 			break;
 		case DC_FIELD_SALINITY:
 			if (parser->model == A300CS || parser->model == VTX ||
@@ -615,6 +677,60 @@ oceanic_atom2_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 	return DC_STATUS_SUCCESS;
 }
 
+/*
+ * A single pass over the profile data provides the divetime, the depth
+ * and the temperatures. The remaining fields are decoded from the
+ * header only.
+ */
+static dc_status_t
+oceanic_atom2_parser_get_summary (dc_parser_t *abstract, dc_summary_t *summary)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	oceanic_atom2_parser_t *parser = (oceanic_atom2_parser_t *) abstract;
+
+	status = oceanic_atom2_parser_cache_profile (parser);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	summary->fields = (1u << DC_FIELD_DIVETIME) | (1u << DC_FIELD_MAXDEPTH) | (1u << DC_FIELD_GASMIX_COUNT);
+	summary->divetime = oceanic_atom2_parser_divetime (parser);
+	summary->maxdepth = oceanic_atom2_parser_maxdepth (parser);
+
+	if (parser->statistics.ntemperatures) {
+		summary->fields |= (1u << DC_FIELD_TEMPERATURE_MINIMUM) | (1u << DC_FIELD_TEMPERATURE_MAXIMUM);
+		summary->temperature_minimum = parser->statistics.temperature_minimum;
+		summary->temperature_maximum = parser->statistics.temperature_maximum;
+	}
+
+	summary->ngasmixes = parser->ngasmixes;
+	if (parser->ngasmixes) {
+		for (unsigned int i = 0; i < parser->ngasmixes; ++i) {
+			oceanic_atom2_parser_gasmix (parser, i, parser->gasmix + i);
+		}
+		summary->fields |= (1u << DC_FIELD_GASMIX);
+		summary->gasmix = parser->gasmix;
+	}
+
+	const struct {
+		dc_field_type_t type;
+		void *value;
+	} fields[] = {
+		{DC_FIELD_AVGDEPTH, &summary->avgdepth},
+		{DC_FIELD_SALINITY, &summary->salinity},
+		{DC_FIELD_DIVEMODE, &summary->divemode},
+	};
+
+	for (size_t i = 0; i < C_ARRAY_SIZE (fields); ++i) {
+		status = oceanic_atom2_parser_get_field (abstract, fields[i].type, 0, fields[i].value);
+		if (status == DC_STATUS_SUCCESS)
+			summary->fields |= (1u << fields[i].type);
+		else if (status != DC_STATUS_UNSUPPORTED)
+			return status;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
 static void
 oceanic_atom2_parser_vendor (oceanic_atom2_parser_t *parser, const unsigned char *data, unsigned int size, unsigned int samplesize, dc_sample_callback_t callback, void *userdata)
 {
@@ -153,6 +153,7 @@ oceanic_common_device_init (oceanic_common_device_t *device)
 	device->model = 0;
 	device->layout = NULL;
 	device->multipage = 1;
+	device->readahead = 0;
 }
 
 
@@ -552,6 +553,17 @@ oceanic_common_device_profile (dc_device_t *abstract, dc_event_progress_t *progr
 		return rc;
 	}
 
+	// Enable read-ahead for backends that can pipeline their reads. The
+	// exact amount of profile data is known, so there is no risk of
+	// reading more data than necessary.
+	if (device->readahead > device->multipage) {
+		rc = dc_rbstream_set_readahead (rbstream, PAGESIZE * device->readahead, rb_profile_size);
+		if (rc != DC_STATUS_SUCCESS) {
+			dc_rbstream_free (rbstream);
+			return rc;
+		}
+	}
+
 	// Memory buffer for the profile data.
 	unsigned char *profiles = (unsigned char *) malloc (rb_profile_size + rb_logbook_size);
 	if (profiles == NULL) {
@@ -169,6 +169,7 @@ typedef struct oceanic_common_device_t {
 	unsigned int model;
 	const oceanic_common_layout_t *layout;
 	unsigned int multipage;
+	unsigned int readahead;
 } oceanic_common_device_t;
 
 typedef struct oceanic_common_device_vtable_t {
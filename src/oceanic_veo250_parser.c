@@ -20,6 +20,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <libdivecomputer/units.h>
 
@@ -38,13 +39,15 @@ struct oceanic_veo250_parser_t {
 	unsigned int model;
 	// Cached fields.
 	unsigned int cached;
-	unsigned int divetime;
-	double maxdepth;
+	sample_statistics_t statistics;
+	dc_gasmix_t gasmix;
 };
 
+static dc_status_t oceanic_veo250_parser_reset (dc_parser_t *abstract);
 static dc_status_t oceanic_veo250_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t oceanic_veo250_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t oceanic_veo250_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
+static dc_status_t oceanic_veo250_parser_get_summary (dc_parser_t *abstract, dc_summary_t *summary);
 
 static const dc_parser_vtable_t oceanic_veo250_parser_vtable = {
 	sizeof(oceanic_veo250_parser_t),
@@ -52,13 +55,28 @@ static const dc_parser_vtable_t oceanic_veo250_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	oceanic_veo250_parser_reset, /* reset */
 	oceanic_veo250_parser_get_datetime, /* datetime */
 	oceanic_veo250_parser_get_field, /* fields */
 	oceanic_veo250_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	oceanic_veo250_parser_get_summary, /* summary */
 	NULL /* destroy */
 };
 
 
+static dc_status_t
+oceanic_veo250_parser_reset (dc_parser_t *abstract)
+{
+	oceanic_veo250_parser_t *parser = (oceanic_veo250_parser_t *) abstract;
+
+	// Reset the cached fields.
+	parser->cached = 0;
+	memset (&parser->statistics, 0, sizeof (parser->statistics));
+
+	return DC_STATUS_SUCCESS;
+}
+
 dc_status_t
 oceanic_veo250_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size, unsigned int model)
 {
@@ -76,9 +94,7 @@ oceanic_veo250_parser_create (dc_parser_t **out, dc_context_t *context, const un
 
 	// Set the default values.
 	parser->model = model;
-	parser->cached = 0;
-	parser->divetime = 0;
-	parser->maxdepth = 0.0;
+	oceanic_veo250_parser_reset ((dc_parser_t *) parser);
 
 	*out = (dc_parser_t*) parser;
 
@@ -115,6 +131,27 @@ oceanic_veo250_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *dateti
 }
 
 
+/*
+ * Cache the statistics of the profile data.
+ */
+static dc_status_t
+oceanic_veo250_parser_cache (oceanic_veo250_parser_t *parser)
+{
+	if (parser->cached)
+		return DC_STATUS_SUCCESS;
+
+	sample_statistics_t statistics = SAMPLE_STATISTICS_INITIALIZER;
+	dc_status_t rc = oceanic_veo250_parser_samples_foreach (
+		(dc_parser_t *) parser, sample_statistics_cb, &statistics);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	parser->cached = 1;
+	parser->statistics = statistics;
+
+	return DC_STATUS_SUCCESS;
+}
+
 static dc_status_t
 oceanic_veo250_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value)
 {
@@ -126,17 +163,9 @@ oceanic_veo250_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, un
 	if (size < 7 * PAGESIZE / 2)
 		return DC_STATUS_DATAFORMAT;
 
-	if (!parser->cached) {
-		sample_statistics_t statistics = SAMPLE_STATISTICS_INITIALIZER;
-		dc_status_t rc = oceanic_veo250_parser_samples_foreach (
-			abstract, sample_statistics_cb, &statistics);
-		if (rc != DC_STATUS_SUCCESS)
-			return rc;
-
-		parser->cached = 1;
-		parser->divetime = statistics.divetime;
-		parser->maxdepth = statistics.maxdepth;
-	}
+	dc_status_t rc = oceanic_veo250_parser_cache (parser);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
 
 	unsigned int footer = size - PAGESIZE;
 
@@ -148,7 +177,7 @@ oceanic_veo250_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, un
 			*((unsigned int *) value) = data[footer + 3] * 60 + data[footer + 4] * 3600;
 			break;
 		case DC_FIELD_MAXDEPTH:
-			*((double *) value) = parser->maxdepth;
+			*((double *) value) = parser->statistics.maxdepth;
 			break;
 		case DC_FIELD_GASMIX_COUNT:
 				*((unsigned int *) value) = 1;
@@ -162,6 +191,16 @@ oceanic_veo250_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, un
 				gasmix->oxygen = 0.21;
 			gasmix->nitrogen = 1.0 - gasmix->oxygen - gasmix->helium;
 			break;
+		case DC_FIELD_TEMPERATURE_MINIMUM:
+			if (parser->statistics.ntemperatures == 0)
+				return DC_STATUS_UNSUPPORTED;
+			*((double *) value) = parser->statistics.temperature_minimum;
+			break;
+		case DC_FIELD_TEMPERATURE_MAXIMUM:
+			if (parser->statistics.ntemperatures == 0)
+				return DC_STATUS_UNSUPPORTED;
+			*((double *) value) = parser->statistics.temperature_maximum;
+			break;
 		default:
 			return DC_STATUS_UNSUPPORTED;
 		}
@@ -170,6 +209,58 @@ oceanic_veo250_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, un
 	return DC_STATUS_SUCCESS;
 }
 
+/*
+ * A single pass over the profile data provides the depth and the
+ * temperatures. The remaining fields are decoded from the header only.
+ */
+static dc_status_t
+oceanic_veo250_parser_get_summary (dc_parser_t *abstract, dc_summary_t *summary)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	oceanic_veo250_parser_t *parser = (oceanic_veo250_parser_t *) abstract;
+
+	if (abstract->size < 7 * PAGESIZE / 2)
+		return DC_STATUS_DATAFORMAT;
+
+	status = oceanic_veo250_parser_cache (parser);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	summary->fields = (1u << DC_FIELD_MAXDEPTH);
+	summary->maxdepth = parser->statistics.maxdepth;
+
+	if (parser->statistics.ntemperatures) {
+		summary->fields |= (1u << DC_FIELD_TEMPERATURE_MINIMUM) | (1u << DC_FIELD_TEMPERATURE_MAXIMUM);
+		summary->temperature_minimum = parser->statistics.temperature_minimum;
+		summary->temperature_maximum = parser->statistics.temperature_maximum;
+	}
+
+	const struct {
+		dc_field_type_t type;
+		void *value;
+	} fields[] = {
+		{DC_FIELD_DIVETIME, &summary->divetime},
+		{DC_FIELD_GASMIX_COUNT, &summary->ngasmixes},
+	};
+
+	for (size_t i = 0; i < C_ARRAY_SIZE (fields); ++i) {
+		status = oceanic_veo250_parser_get_field (abstract, fields[i].type, 0, fields[i].value);
+		if (status != DC_STATUS_SUCCESS)
+			return status;
+		summary->fields |= (1u << fields[i].type);
+	}
+
+	if (summary->ngasmixes) {
+		status = oceanic_veo250_parser_get_field (abstract, DC_FIELD_GASMIX, 0, &parser->gasmix);
+		if (status != DC_STATUS_SUCCESS)
+			return status;
+		summary->fields |= (1u << DC_FIELD_GASMIX);
+		summary->gasmix = &parser->gasmix;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
 
 static dc_status_t
 oceanic_veo250_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
@@ -20,6 +20,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <libdivecomputer/units.h>
 
@@ -38,13 +39,16 @@ struct oceanic_vtpro_parser_t {
 	unsigned int model;
 	// Cached fields.
 	unsigned int cached;
-	unsigned int divetime;
-	double maxdepth;
+	sample_statistics_t statistics;
+	dc_gasmix_t gasmix;
+	dc_tank_t tank;
 };
 
+static dc_status_t oceanic_vtpro_parser_reset (dc_parser_t *abstract);
 static dc_status_t oceanic_vtpro_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t oceanic_vtpro_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t oceanic_vtpro_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
+static dc_status_t oceanic_vtpro_parser_get_summary (dc_parser_t *abstract, dc_summary_t *summary);
 
 static const dc_parser_vtable_t oceanic_vtpro_parser_vtable = {
 	sizeof(oceanic_vtpro_parser_t),
@@ -52,13 +56,28 @@ static const dc_parser_vtable_t oceanic_vtpro_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	oceanic_vtpro_parser_reset, /* reset */
 	oceanic_vtpro_parser_get_datetime, /* datetime */
 	oceanic_vtpro_parser_get_field, /* fields */
 	oceanic_vtpro_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	oceanic_vtpro_parser_get_summary, /* summary */
 	NULL /* destroy */
 };
 
 
+static dc_status_t
+oceanic_vtpro_parser_reset (dc_parser_t *abstract)
+{
+	oceanic_vtpro_parser_t *parser = (oceanic_vtpro_parser_t *) abstract;
+
+	// Reset the cached fields.
+	parser->cached = 0;
+	memset (&parser->statistics, 0, sizeof (parser->statistics));
+
+	return DC_STATUS_SUCCESS;
+}
+
 dc_status_t
 oceanic_vtpro_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size, unsigned int model)
 {
@@ -76,9 +95,7 @@ oceanic_vtpro_parser_create (dc_parser_t **out, dc_context_t *context, const uns
 
 	// Set the default values.
 	parser->model = model;
-	parser->cached = 0;
-	parser->divetime = 0;
-	parser->maxdepth = 0.0;
+	oceanic_vtpro_parser_reset ((dc_parser_t *) parser);
 
 	*out = (dc_parser_t*) parser;
 
@@ -132,6 +149,27 @@ oceanic_vtpro_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetim
 }
 
 
+/*
+ * Cache the statistics of the profile data.
+ */
+static dc_status_t
+oceanic_vtpro_parser_cache (oceanic_vtpro_parser_t *parser)
+{
+	if (parser->cached)
+		return DC_STATUS_SUCCESS;
+
+	sample_statistics_t statistics = SAMPLE_STATISTICS_INITIALIZER;
+	dc_status_t rc = oceanic_vtpro_parser_samples_foreach (
+		(dc_parser_t *) parser, sample_statistics_cb, &statistics);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	parser->cached = 1;
+	parser->statistics = statistics;
+
+	return DC_STATUS_SUCCESS;
+}
+
 static dc_status_t
 oceanic_vtpro_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value)
 {
@@ -143,17 +181,9 @@ oceanic_vtpro_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 	if (size < 7 * PAGESIZE / 2)
 		return DC_STATUS_DATAFORMAT;
 
-	if (!parser->cached) {
-		sample_statistics_t statistics = SAMPLE_STATISTICS_INITIALIZER;
-		dc_status_t rc = oceanic_vtpro_parser_samples_foreach (
-			abstract, sample_statistics_cb, &statistics);
-		if (rc != DC_STATUS_SUCCESS)
-			return rc;
-
-		parser->cached = 1;
-		parser->divetime = statistics.divetime;
-		parser->maxdepth = statistics.maxdepth;
-	}
+	dc_status_t rc = oceanic_vtpro_parser_cache (parser);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
 
 	unsigned int footer = size - PAGESIZE;
 
@@ -175,7 +205,7 @@ oceanic_vtpro_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 	if (value) {
 		switch (type) {
 		case DC_FIELD_DIVETIME:
-			*((unsigned int *) value) = parser->divetime;
+			*((unsigned int *) value) = parser->statistics.divetime;
 			break;
 		case DC_FIELD_MAXDEPTH:
 			*((double *) value) = maxdepth * FEET;
@@ -207,6 +237,16 @@ oceanic_vtpro_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 			tank->endpressure = endpressure * 2 * PSI / BAR;
 			tank->usage = DC_USAGE_NONE;
 			break;
+		case DC_FIELD_TEMPERATURE_MINIMUM:
+			if (parser->statistics.ntemperatures == 0)
+				return DC_STATUS_UNSUPPORTED;
+			*((double *) value) = parser->statistics.temperature_minimum;
+			break;
+		case DC_FIELD_TEMPERATURE_MAXIMUM:
+			if (parser->statistics.ntemperatures == 0)
+				return DC_STATUS_UNSUPPORTED;
+			*((double *) value) = parser->statistics.temperature_maximum;
+			break;
 		default:
 			return DC_STATUS_UNSUPPORTED;
 		}
@@ -215,6 +255,67 @@ oceanic_vtpro_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 	return DC_STATUS_SUCCESS;
 }
 
+/*
+ * A single pass over the profile data provides the divetime and the
+ * temperatures. The remaining fields are decoded from the header only.
+ */
+static dc_status_t
+oceanic_vtpro_parser_get_summary (dc_parser_t *abstract, dc_summary_t *summary)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	oceanic_vtpro_parser_t *parser = (oceanic_vtpro_parser_t *) abstract;
+
+	if (abstract->size < 7 * PAGESIZE / 2)
+		return DC_STATUS_DATAFORMAT;
+
+	status = oceanic_vtpro_parser_cache (parser);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	summary->fields = (1u << DC_FIELD_DIVETIME);
+	summary->divetime = parser->statistics.divetime;
+
+	if (parser->statistics.ntemperatures) {
+		summary->fields |= (1u << DC_FIELD_TEMPERATURE_MINIMUM) | (1u << DC_FIELD_TEMPERATURE_MAXIMUM);
+		summary->temperature_minimum = parser->statistics.temperature_minimum;
+		summary->temperature_maximum = parser->statistics.temperature_maximum;
+	}
+
+	const struct {
+		dc_field_type_t type;
+		void *value;
+	} fields[] = {
+		{DC_FIELD_MAXDEPTH, &summary->maxdepth},
+		{DC_FIELD_GASMIX_COUNT, &summary->ngasmixes},
+		{DC_FIELD_TANK_COUNT, &summary->ntanks},
+	};
+
+	for (size_t i = 0; i < C_ARRAY_SIZE (fields); ++i) {
+		status = oceanic_vtpro_parser_get_field (abstract, fields[i].type, 0, fields[i].value);
+		if (status != DC_STATUS_SUCCESS)
+			return status;
+		summary->fields |= (1u << fields[i].type);
+	}
+
+	if (summary->ngasmixes) {
+		status = oceanic_vtpro_parser_get_field (abstract, DC_FIELD_GASMIX, 0, &parser->gasmix);
+		if (status != DC_STATUS_SUCCESS)
+			return status;
+		summary->fields |= (1u << DC_FIELD_GASMIX);
+		summary->gasmix = &parser->gasmix;
+	}
+
+	if (summary->ntanks) {
+		status = oceanic_vtpro_parser_get_field (abstract, DC_FIELD_TANK, 0, &parser->tank);
+		if (status != DC_STATUS_SUCCESS)
+			return status;
+		summary->fields |= (1u << DC_FIELD_TANK);
+		summary->tank = &parser->tank;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
 
 static dc_status_t
 oceanic_vtpro_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
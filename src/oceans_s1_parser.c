@@ -58,6 +58,7 @@ struct oceans_s1_parser_t {
 	unsigned int divetime;
 };
 
+static dc_status_t oceans_s1_parser_reset (dc_parser_t *abstract);
 static dc_status_t oceans_s1_parser_get_datetime(dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t oceans_s1_parser_get_field(dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t oceans_s1_parser_samples_foreach(dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -68,12 +69,32 @@ static const dc_parser_vtable_t oceans_s1_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	oceans_s1_parser_reset, /* reset */
 	oceans_s1_parser_get_datetime, /* datetime */
 	oceans_s1_parser_get_field, /* fields */
 	oceans_s1_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
+static dc_status_t
+oceans_s1_parser_reset (dc_parser_t *abstract)
+{
+	oceans_s1_parser_t *parser = (oceans_s1_parser_t *) abstract;
+
+	// Reset the cached fields.
+	parser->cached = 0;
+	parser->timestamp = 0;
+	parser->number = 0;
+	parser->divemode = 0;
+	parser->oxygen = 0;
+	parser->maxdepth = 0;
+	parser->divetime = 0;
+
+	return DC_STATUS_SUCCESS;
+}
+
 dc_status_t
 oceans_s1_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size)
 {
@@ -90,13 +111,7 @@ oceans_s1_parser_create (dc_parser_t **out, dc_context_t *context, const unsigne
 	}
 
 	// Set the default values.
-	parser->cached = 0;
-	parser->timestamp = 0;
-	parser->number = 0;
-	parser->divemode = 0;
-	parser->oxygen = 0;
-	parser->maxdepth = 0;
-	parser->divetime = 0;
+	oceans_s1_parser_reset ((dc_parser_t *) parser);
 
 	*out = (dc_parser_t *) parser;
 
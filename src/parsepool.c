@@ -0,0 +1,393 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include <libdivecomputer/parsepool.h>
+
+#include "context-private.h"
+#include "thread.h"
+
+/*
+ * The number of results that can be pending per worker thread. This
+ * limits the amount of memory in use when the deliver function can't
+ * keep up with the workers, or when a single dive takes much longer to
+ * process than the others.
+ */
+#define NSLOTS 4
+
+typedef struct dc_parse_job_t {
+	dc_descriptor_t *descriptor;
+	const unsigned char *data;
+	size_t size;
+} dc_parse_job_t;
+
+typedef struct dc_parse_slot_t {
+	dc_buffer_t *buffer;
+	dc_status_t status;
+	unsigned int done;
+} dc_parse_slot_t;
+
+typedef struct dc_parse_worker_t {
+	dc_parse_pool_t *pool;
+	dc_context_t *context;
+	dc_thread_t *thread;
+	/* Parser of the previous job. */
+	dc_parser_t *parser;
+	dc_descriptor_t *descriptor;
+} dc_parse_worker_t;
+
+struct dc_parse_pool_t {
+	dc_context_t *context;
+	unsigned int nthreads;
+	/* Jobs */
+	dc_parse_job_t *jobs;
+	unsigned int count;
+	unsigned int capacity;
+	/* Shared state while running. */
+	dc_mutex_t *mutex;
+	dc_cond_t *ready;
+	dc_cond_t *available;
+	dc_parse_slot_t *slots;
+	unsigned int nslots;
+	unsigned int next;
+	unsigned int delivered;
+	unsigned int abort;
+	dc_parse_pool_process_t process;
+	void *userdata;
+};
+
+dc_status_t
+dc_parse_pool_new (dc_parse_pool_t **out, dc_context_t *context, unsigned int nthreads)
+{
+	dc_parse_pool_t *pool = NULL;
+
+	if (out == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	// Allocate memory.
+	pool = (dc_parse_pool_t *) malloc (sizeof (dc_parse_pool_t));
+	if (pool == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	pool->context = context;
+	pool->nthreads = nthreads;
+	pool->jobs = NULL;
+	pool->count = 0;
+	pool->capacity = 0;
+	pool->mutex = NULL;
+	pool->ready = NULL;
+	pool->available = NULL;
+	pool->slots = NULL;
+	pool->nslots = 0;
+	pool->next = 0;
+	pool->delivered = 0;
+	pool->abort = 0;
+	pool->process = NULL;
+	pool->userdata = NULL;
+
+	*out = pool;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_parse_pool_free (dc_parse_pool_t *pool)
+{
+	if (pool == NULL)
+		return DC_STATUS_SUCCESS;
+
+	free (pool->jobs);
+	free (pool);
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_parse_pool_add (dc_parse_pool_t *pool, dc_descriptor_t *descriptor, const unsigned char data[], size_t size)
+{
+	if (pool == NULL || descriptor == NULL || (data == NULL && size))
+		return DC_STATUS_INVALIDARGS;
+
+	if (pool->count == pool->capacity) {
+		unsigned int capacity = pool->capacity ? pool->capacity * 2 : 64;
+		dc_parse_job_t *jobs = (dc_parse_job_t *) realloc (pool->jobs, capacity * sizeof (dc_parse_job_t));
+		if (jobs == NULL) {
+			ERROR (pool->context, "Failed to allocate memory.");
+			return DC_STATUS_NOMEMORY;
+		}
+
+		pool->jobs = jobs;
+		pool->capacity = capacity;
+	}
+
+	pool->jobs[pool->count].descriptor = descriptor;
+	pool->jobs[pool->count].data = data;
+	pool->jobs[pool->count].size = size;
+	pool->count++;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_parse_pool_process (dc_parse_pool_t *pool, dc_parse_worker_t *worker, unsigned int index, dc_buffer_t *buffer)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	const dc_parse_job_t *job = pool->jobs + index;
+
+	// Re-use the parser of the previous job for the same device.
+	if (worker->parser && worker->descriptor == job->descriptor) {
+		status = dc_parser_reset (worker->parser, job->data, job->size);
+	} else {
+		dc_parser_destroy (worker->parser);
+		worker->parser = NULL;
+		worker->descriptor = job->descriptor;
+		status = dc_parser_new2 (&worker->parser, worker->context, job->descriptor, job->data, job->size);
+	}
+	if (status != DC_STATUS_SUCCESS) {
+		return status;
+	}
+
+	return pool->process (worker->parser, index, buffer, pool->userdata);
+}
+
+static void
+dc_parse_pool_worker (void *userdata)
+{
+	dc_parse_worker_t *worker = (dc_parse_worker_t *) userdata;
+	dc_parse_pool_t *pool = worker->pool;
+
+	dc_mutex_lock (pool->mutex);
+
+	while (1) {
+		// Wait until there is a free slot.
+		while (!pool->abort && pool->next < pool->count &&
+			pool->next - pool->delivered >= pool->nslots) {
+			dc_cond_wait (pool->available, pool->mutex);
+		}
+
+		if (pool->abort || pool->next >= pool->count)
+			break;
+
+		unsigned int index = pool->next++;
+		dc_parse_slot_t *slot = pool->slots + index % pool->nslots;
+
+		dc_mutex_unlock (pool->mutex);
+
+		dc_status_t status = dc_parse_pool_process (pool, worker, index, slot->buffer);
+
+		dc_mutex_lock (pool->mutex);
+
+		slot->status = status;
+		slot->done = 1;
+		dc_cond_broadcast (pool->ready);
+	}
+
+	dc_mutex_unlock (pool->mutex);
+}
+
+static dc_status_t
+dc_parse_pool_run_sequential (dc_parse_pool_t *pool, dc_parse_pool_deliver_t deliver)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_parse_worker_t worker = {pool, pool->context, NULL, NULL, NULL};
+
+	dc_buffer_t *buffer = dc_buffer_new (0);
+	if (buffer == NULL) {
+		ERROR (pool->context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	for (unsigned int i = 0; i < pool->count; ++i) {
+		dc_status_t rc = dc_parse_pool_process (pool, &worker, i, buffer);
+
+		status = deliver (i, rc, dc_buffer_get_data (buffer), dc_buffer_get_size (buffer), pool->userdata);
+		if (status != DC_STATUS_SUCCESS)
+			break;
+
+		dc_buffer_clear (buffer);
+	}
+
+	dc_parser_destroy (worker.parser);
+	dc_buffer_free (buffer);
+
+	return status;
+}
+
+static dc_status_t
+dc_parse_pool_run_threaded (dc_parse_pool_t *pool, dc_parse_pool_deliver_t deliver)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_parse_worker_t *workers = NULL;
+	unsigned int nworkers = 0;
+	unsigned int sequential = 0;
+
+	pool->nslots = pool->nthreads * NSLOTS;
+	pool->next = 0;
+	pool->delivered = 0;
+	pool->abort = 0;
+
+	// Allocate the result slots.
+	pool->slots = (dc_parse_slot_t *) calloc (pool->nslots, sizeof (dc_parse_slot_t));
+	workers = (dc_parse_worker_t *) calloc (pool->nthreads, sizeof (dc_parse_worker_t));
+	if (pool->slots == NULL || workers == NULL) {
+		ERROR (pool->context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto cleanup;
+	}
+
+	for (unsigned int i = 0; i < pool->nslots; ++i) {
+		pool->slots[i].buffer = dc_buffer_new (0);
+		if (pool->slots[i].buffer == NULL) {
+			ERROR (pool->context, "Failed to allocate memory.");
+			status = DC_STATUS_NOMEMORY;
+			goto cleanup;
+		}
+	}
+
+	// Start the worker threads.
+	for (unsigned int i = 0; i < pool->nthreads; ++i) {
+		dc_parse_worker_t *worker = workers + i;
+
+		worker->pool = pool;
+
+		status = dc_context_clone (&worker->context, pool->context);
+		if (status != DC_STATUS_SUCCESS) {
+			ERROR (pool->context, "Failed to create the worker context.");
+			break;
+		}
+
+		status = dc_thread_new (&worker->thread, dc_parse_pool_worker, worker);
+		if (status != DC_STATUS_SUCCESS) {
+			ERROR (pool->context, "Failed to create the worker thread.");
+			dc_context_free (worker->context);
+			worker->context = NULL;
+			break;
+		}
+
+		nworkers++;
+	}
+
+	// Continue with fewer workers, as long as there is at least one.
+	// Without any worker, fall back to processing the jobs sequentially.
+	if (nworkers == 0) {
+		WARNING (pool->context, "No worker threads available. Falling back to sequential processing.");
+		sequential = 1;
+		goto cleanup;
+	}
+
+	status = DC_STATUS_SUCCESS;
+
+	// Deliver the results in order.
+	for (unsigned int i = 0; i < pool->count && status == DC_STATUS_SUCCESS; ++i) {
+		dc_parse_slot_t *slot = pool->slots + i % pool->nslots;
+
+		dc_mutex_lock (pool->mutex);
+		while (!slot->done) {
+			dc_cond_wait (pool->ready, pool->mutex);
+		}
+		dc_mutex_unlock (pool->mutex);
+
+		status = deliver (i, slot->status,
+			dc_buffer_get_data (slot->buffer), dc_buffer_get_size (slot->buffer),
+			pool->userdata);
+
+		dc_mutex_lock (pool->mutex);
+		dc_buffer_clear (slot->buffer);
+		slot->done = 0;
+		pool->delivered++;
+		dc_cond_broadcast (pool->available);
+		dc_mutex_unlock (pool->mutex);
+	}
+
+cleanup:
+	// Stop the worker threads.
+	if (pool->mutex) {
+		dc_mutex_lock (pool->mutex);
+		pool->abort = 1;
+		dc_cond_broadcast (pool->available);
+		dc_mutex_unlock (pool->mutex);
+	}
+
+	for (unsigned int i = 0; i < nworkers; ++i) {
+		dc_thread_join (workers[i].thread);
+		dc_parser_destroy (workers[i].parser);
+		dc_context_free (workers[i].context);
+	}
+
+	if (pool->slots) {
+		for (unsigned int i = 0; i < pool->nslots; ++i) {
+			dc_buffer_free (pool->slots[i].buffer);
+		}
+	}
+
+	free (pool->slots);
+	free (workers);
+	pool->slots = NULL;
+	pool->nslots = 0;
+
+	if (sequential) {
+		status = dc_parse_pool_run_sequential (pool, deliver);
+	}
+
+	return status;
+}
+
+dc_status_t
+dc_parse_pool_run (dc_parse_pool_t *pool, dc_parse_pool_process_t process, dc_parse_pool_deliver_t deliver, void *userdata)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (pool == NULL || process == NULL || deliver == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	pool->process = process;
+	pool->userdata = userdata;
+
+	// Create the synchronization primitives. Without thread support,
+	// fall back to processing all jobs sequentially.
+	if (pool->nthreads &&
+		dc_mutex_new (&pool->mutex) == DC_STATUS_SUCCESS &&
+		dc_cond_new (&pool->ready) == DC_STATUS_SUCCESS &&
+		dc_cond_new (&pool->available) == DC_STATUS_SUCCESS) {
+		status = dc_parse_pool_run_threaded (pool, deliver);
+	} else {
+		status = dc_parse_pool_run_sequential (pool, deliver);
+	}
+
+	dc_cond_free (pool->available);
+	dc_cond_free (pool->ready);
+	dc_mutex_free (pool->mutex);
+	pool->available = NULL;
+	pool->ready = NULL;
+	pool->mutex = NULL;
+
+	// Remove all jobs.
+	pool->count = 0;
+
+	return status;
+}
@@ -35,6 +35,8 @@ extern "C" {
 
 struct dc_parser_t;
 struct dc_parser_vtable_t;
+struct dc_parser_index_t;
+struct dc_parser_summary_t;
 
 typedef struct dc_parser_vtable_t dc_parser_vtable_t;
 
@@ -43,6 +45,9 @@ struct dc_parser_t {
 	dc_context_t *context;
 	unsigned char *data;
 	unsigned int size;
+	size_t capacity;
+	struct dc_parser_index_t *index;
+	struct dc_parser_summary_t *summary;
 };
 
 struct dc_parser_vtable_t {
@@ -56,12 +61,18 @@ struct dc_parser_vtable_t {
 
 	dc_status_t (*set_density) (dc_parser_t *parser, double density);
 
+	dc_status_t (*reset) (dc_parser_t *parser);
+
 	dc_status_t (*datetime) (dc_parser_t *parser, dc_datetime_t *datetime);
 
 	dc_status_t (*field) (dc_parser_t *parser, dc_field_type_t type, unsigned int flags, void *value);
 
 	dc_status_t (*samples_foreach) (dc_parser_t *parser, dc_sample_callback_t callback, void *userdata);
 
+	dc_status_t (*samples_batch) (dc_parser_t *parser, dc_sample_batch_t *batch, dc_sample_batch_callback_t callback, void *userdata);
+
+	dc_status_t (*summary) (dc_parser_t *parser, dc_summary_t *summary);
+
 	dc_status_t (*destroy) (dc_parser_t *parser);
 };
 
@@ -74,12 +85,28 @@ dc_parser_deallocate (dc_parser_t *parser);
 int
 dc_parser_isinstance (dc_parser_t *parser, const dc_parser_vtable_t *vtable);
 
+/*
+ * Append a new row to the sample batch, and return its index. A full
+ * batch is delivered to the application first. Native samples_batch
+ * implementations use this to fill the batch. The remaining rows are
+ * delivered by dc_parser_samples_batch afterwards.
+ */
+unsigned int
+dc_sample_batch_append (dc_sample_batch_t *batch, dc_sample_batch_callback_t callback, void *userdata);
+
+/*
+ * Statistics collected in a single pass over the samples. The
+ * temperatures are only valid if ntemperatures is non-zero.
+ */
 typedef struct sample_statistics_t {
 	unsigned int divetime;
 	double maxdepth;
+	unsigned int ntemperatures;
+	double temperature_minimum;
+	double temperature_maximum;
 } sample_statistics_t;
 
-#define SAMPLE_STATISTICS_INITIALIZER {0, 0.0}
+#define SAMPLE_STATISTICS_INITIALIZER {0, 0.0, 0, 0.0, 0.0}
 
 void
 sample_statistics_cb (dc_sample_type_t type, const dc_sample_value_t *value, void *userdata);
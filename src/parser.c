@@ -72,6 +72,45 @@
 
 #define REACTPROWHITE 0x4354
 
+typedef struct dc_parser_sample_t {
+	dc_sample_type_t type;
+	dc_sample_value_t value;
+	size_t offset;
+} dc_parser_sample_t;
+
+typedef struct dc_parser_set_t {
+	unsigned int time;
+	size_t offset;
+} dc_parser_set_t;
+
+/*
+ * The decoded samples of the dive, and the start of each sample set.
+ * The vendor data is copied, because the backends don't guarantee the
+ * data remains valid after the callback returns.
+ */
+typedef struct dc_parser_index_t {
+	dc_parser_sample_t *samples;
+	size_t nsamples, maxsamples;
+	dc_parser_set_t *sets;
+	size_t nsets, maxsets;
+	dc_buffer_t *vendor;
+	unsigned int sorted;
+	dc_status_t status;
+} dc_parser_index_t;
+
+/*
+ * The summary of the dive. The gasmix and tank arrays are only used by
+ * the generic implementation.
+ */
+typedef struct dc_parser_summary_t {
+	dc_summary_t summary;
+	dc_gasmix_t *gasmix;
+	dc_tank_t *tank;
+} dc_parser_summary_t;
+
+static void
+dc_parser_invalidate (dc_parser_t *parser);
+
 static dc_status_t
 dc_parser_new_internal (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size, dc_family_t family, unsigned int model)
 {
@@ -267,6 +306,8 @@ dc_parser_allocate (dc_context_t *context, const dc_parser_vtable_t *vtable, con
 	// Initialize the base class.
 	parser->vtable = vtable;
 	parser->context = context;
+	parser->index = NULL;
+	parser->summary = NULL;
 
 	if (size) {
 		// Allocate memory for the data.
@@ -280,11 +321,13 @@ dc_parser_allocate (dc_context_t *context, const dc_parser_vtable_t *vtable, con
 		// Copy the data.
 		memcpy (parser->data, data, size);
 		parser->size = size;
+		parser->capacity = size;
 	} else {
 		parser->data = NULL;
 		parser->size = 0;
-
+		parser->capacity = 0;
 	}
+
 	return parser;
 }
 
@@ -294,6 +337,7 @@ dc_parser_deallocate (dc_parser_t *parser)
 	if (parser == NULL)
 		return;
 
+	dc_parser_invalidate (parser);
 	free (parser->data);
 	free (parser);
 }
@@ -318,6 +362,43 @@ dc_parser_get_type (dc_parser_t *parser)
 }
 
 
+dc_status_t
+dc_parser_reset (dc_parser_t *parser, const unsigned char data[], size_t size)
+{
+	if (parser == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (data == NULL && size != 0)
+		return DC_STATUS_INVALIDARGS;
+
+	// Re-use the existing buffer if it's large enough.
+	if (size > parser->capacity) {
+		unsigned char *buffer = (unsigned char *) malloc (size);
+		if (buffer == NULL) {
+			ERROR (parser->context, "Failed to allocate memory.");
+			return DC_STATUS_NOMEMORY;
+		}
+
+		free (parser->data);
+		parser->data = buffer;
+		parser->capacity = size;
+	}
+
+	if (size) {
+		memcpy (parser->data, data, size);
+	}
+	parser->size = size;
+
+	// Discard the cached information.
+	dc_parser_invalidate (parser);
+
+	if (parser->vtable->reset == NULL)
+		return DC_STATUS_SUCCESS;
+
+	return parser->vtable->reset (parser);
+}
+
+
 dc_status_t
 dc_parser_set_clock (dc_parser_t *parser, unsigned int devtime, dc_ticks_t systime)
 {
@@ -327,6 +408,8 @@ dc_parser_set_clock (dc_parser_t *parser, unsigned int devtime, dc_ticks_t systi
 	if (parser->vtable->set_clock == NULL)
 		return DC_STATUS_UNSUPPORTED;
 
+	dc_parser_invalidate (parser);
+
 	return parser->vtable->set_clock (parser, devtime, systime);
 }
 
@@ -340,6 +423,8 @@ dc_parser_set_atmospheric (dc_parser_t *parser, double atmospheric)
 	if (parser->vtable->set_atmospheric == NULL)
 		return DC_STATUS_UNSUPPORTED;
 
+	dc_parser_invalidate (parser);
+
 	return parser->vtable->set_atmospheric (parser, atmospheric);
 }
 
@@ -353,6 +438,8 @@ dc_parser_set_density (dc_parser_t *parser, double density)
 	if (parser->vtable->set_density == NULL)
 		return DC_STATUS_UNSUPPORTED;
 
+	dc_parser_invalidate (parser);
+
 	return parser->vtable->set_density (parser, density);
 }
 
@@ -382,6 +469,147 @@ dc_parser_get_field (dc_parser_t *parser, dc_field_type_t type, unsigned int fla
 }
 
 
+static dc_status_t
+dc_parser_summary_field (dc_parser_t *parser, dc_summary_t *summary, dc_field_type_t type, unsigned int flags, void *value, size_t size)
+{
+	dc_status_t status = parser->vtable->field (parser, type, flags, value);
+	if (status == DC_STATUS_SUCCESS) {
+		summary->fields |= (1u << type);
+	} else {
+		// Don't leave a partially filled value behind.
+		memset (value, 0, size);
+		if (status == DC_STATUS_UNSUPPORTED)
+			status = DC_STATUS_SUCCESS;
+	}
+
+	return status;
+}
+
+static dc_status_t
+dc_parser_summary_generic (dc_parser_t *parser, dc_parser_summary_t *cache)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_summary_t *summary = &cache->summary;
+
+	const struct {
+		dc_field_type_t type;
+		void *value;
+		size_t size;
+	} fields[] = {
+		{DC_FIELD_DIVETIME, &summary->divetime, sizeof (summary->divetime)},
+		{DC_FIELD_MAXDEPTH, &summary->maxdepth, sizeof (summary->maxdepth)},
+		{DC_FIELD_AVGDEPTH, &summary->avgdepth, sizeof (summary->avgdepth)},
+		{DC_FIELD_GASMIX_COUNT, &summary->ngasmixes, sizeof (summary->ngasmixes)},
+		{DC_FIELD_SALINITY, &summary->salinity, sizeof (summary->salinity)},
+		{DC_FIELD_ATMOSPHERIC, &summary->atmospheric, sizeof (summary->atmospheric)},
+		{DC_FIELD_TEMPERATURE_SURFACE, &summary->temperature_surface, sizeof (summary->temperature_surface)},
+		{DC_FIELD_TEMPERATURE_MINIMUM, &summary->temperature_minimum, sizeof (summary->temperature_minimum)},
+		{DC_FIELD_TEMPERATURE_MAXIMUM, &summary->temperature_maximum, sizeof (summary->temperature_maximum)},
+		{DC_FIELD_TANK_COUNT, &summary->ntanks, sizeof (summary->ntanks)},
+		{DC_FIELD_DIVEMODE, &summary->divemode, sizeof (summary->divemode)},
+		{DC_FIELD_DECOMODEL, &summary->decomodel, sizeof (summary->decomodel)},
+	};
+
+	for (size_t i = 0; i < sizeof (fields) / sizeof (fields[0]); ++i) {
+		status = dc_parser_summary_field (parser, summary, fields[i].type, 0, fields[i].value, fields[i].size);
+		if (status != DC_STATUS_SUCCESS)
+			return status;
+	}
+
+	if (summary->ngasmixes) {
+		cache->gasmix = (dc_gasmix_t *) calloc (summary->ngasmixes, sizeof (dc_gasmix_t));
+		if (cache->gasmix == NULL) {
+			ERROR (parser->context, "Failed to allocate memory.");
+			return DC_STATUS_NOMEMORY;
+		}
+
+		for (unsigned int i = 0; i < summary->ngasmixes; ++i) {
+			status = dc_parser_summary_field (parser, summary, DC_FIELD_GASMIX, i, cache->gasmix + i, sizeof (dc_gasmix_t));
+			if (status != DC_STATUS_SUCCESS)
+				return status;
+		}
+
+		summary->gasmix = cache->gasmix;
+	}
+
+	if (summary->ntanks) {
+		cache->tank = (dc_tank_t *) calloc (summary->ntanks, sizeof (dc_tank_t));
+		if (cache->tank == NULL) {
+			ERROR (parser->context, "Failed to allocate memory.");
+			return DC_STATUS_NOMEMORY;
+		}
+
+		for (unsigned int i = 0; i < summary->ntanks; ++i) {
+			status = dc_parser_summary_field (parser, summary, DC_FIELD_TANK, i, cache->tank + i, sizeof (dc_tank_t));
+			if (status != DC_STATUS_SUCCESS)
+				return status;
+		}
+
+		summary->tank = cache->tank;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+static void
+dc_parser_summary_free (dc_parser_t *parser)
+{
+	dc_parser_summary_t *cache = parser->summary;
+
+	if (cache == NULL)
+		return;
+
+	free (cache->gasmix);
+	free (cache->tank);
+	free (cache);
+
+	parser->summary = NULL;
+}
+
+dc_status_t
+dc_parser_get_summary (dc_parser_t *parser, dc_summary_t *summary)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_parser_summary_t *cache = NULL;
+
+	if (parser == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (summary == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	if (parser->vtable->summary == NULL && parser->vtable->field == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (parser->summary == NULL) {
+		cache = (dc_parser_summary_t *) malloc (sizeof (dc_parser_summary_t));
+		if (cache == NULL) {
+			ERROR (parser->context, "Failed to allocate memory.");
+			return DC_STATUS_NOMEMORY;
+		}
+
+		memset (&cache->summary, 0, sizeof (cache->summary));
+		cache->gasmix = NULL;
+		cache->tank = NULL;
+		parser->summary = cache;
+
+		if (parser->vtable->summary) {
+			status = parser->vtable->summary (parser, &cache->summary);
+		} else {
+			status = dc_parser_summary_generic (parser, cache);
+		}
+		if (status != DC_STATUS_SUCCESS) {
+			dc_parser_summary_free (parser);
+			return status;
+		}
+	}
+
+	*summary = parser->summary->summary;
+
+	return DC_STATUS_SUCCESS;
+}
+
+
 dc_status_t
 dc_parser_samples_foreach (dc_parser_t *parser, dc_sample_callback_t callback, void *userdata)
 {
@@ -395,6 +623,367 @@ dc_parser_samples_foreach (dc_parser_t *parser, dc_sample_callback_t callback, v
 }
 
 
+typedef struct sample_batch_t {
+	dc_sample_batch_t *batch;
+	dc_sample_batch_callback_t callback;
+	void *userdata;
+	unsigned int row;
+	unsigned int ppo2_count;
+	double ppo2_sum;
+} sample_batch_t;
+
+static void
+sample_batch_close (sample_batch_t *state)
+{
+	dc_sample_batch_t *batch = state->batch;
+
+	if (batch->count == 0)
+		return;
+
+	// Store the average ppo2 of the individual sensors, unless a value
+	// without a sensor index was already stored.
+	if (state->ppo2_count &&
+		(batch->types[state->row] & (1u << DC_SAMPLE_PPO2)) == 0) {
+		batch->types[state->row] |= (1u << DC_SAMPLE_PPO2);
+		if (batch->ppo2)
+			batch->ppo2[state->row] = state->ppo2_sum / state->ppo2_count;
+	}
+
+	state->ppo2_count = 0;
+	state->ppo2_sum = 0.0;
+}
+
+unsigned int
+dc_sample_batch_append (dc_sample_batch_t *batch, dc_sample_batch_callback_t callback, void *userdata)
+{
+	// Deliver the rows to the application once the batch is full.
+	if (batch->count == batch->capacity) {
+		callback (batch, userdata);
+		batch->count = 0;
+	}
+
+	unsigned int row = batch->count++;
+	batch->types[row] = 0;
+
+	return row;
+}
+
+static void
+sample_batch_open (sample_batch_t *state)
+{
+	sample_batch_close (state);
+
+	state->row = dc_sample_batch_append (state->batch, state->callback, state->userdata);
+}
+
+static void
+sample_batch_cb (dc_sample_type_t type, const dc_sample_value_t *value, void *userdata)
+{
+	sample_batch_t *state = (sample_batch_t *) userdata;
+	dc_sample_batch_t *batch = state->batch;
+	unsigned int mask = 1u << type;
+	unsigned int row = 0;
+
+	// Events and vendor samples are not stored.
+	if (type == DC_SAMPLE_EVENT || type == DC_SAMPLE_VENDOR)
+		return;
+
+	if (type == DC_SAMPLE_TIME || batch->count == 0)
+		sample_batch_open (state);
+
+	row = state->row;
+
+	switch (type) {
+	case DC_SAMPLE_TIME:
+		if (batch->time)
+			batch->time[row] = value->time;
+		break;
+	case DC_SAMPLE_DEPTH:
+		if (batch->depth)
+			batch->depth[row] = value->depth;
+		break;
+	case DC_SAMPLE_PRESSURE:
+		if (batch->types[row] & mask)
+			return;
+		if (batch->tank)
+			batch->tank[row] = value->pressure.tank;
+		if (batch->pressure)
+			batch->pressure[row] = value->pressure.value;
+		break;
+	case DC_SAMPLE_TEMPERATURE:
+		if (batch->temperature)
+			batch->temperature[row] = value->temperature;
+		break;
+	case DC_SAMPLE_RBT:
+		if (batch->rbt)
+			batch->rbt[row] = value->rbt;
+		break;
+	case DC_SAMPLE_HEARTBEAT:
+		if (batch->heartbeat)
+			batch->heartbeat[row] = value->heartbeat;
+		break;
+	case DC_SAMPLE_BEARING:
+		if (batch->bearing)
+			batch->bearing[row] = value->bearing;
+		break;
+	case DC_SAMPLE_SETPOINT:
+		if (batch->setpoint)
+			batch->setpoint[row] = value->setpoint;
+		break;
+	case DC_SAMPLE_PPO2:
+		if (value->ppo2.sensor != DC_SENSOR_NONE) {
+			state->ppo2_sum += value->ppo2.value;
+			state->ppo2_count++;
+			return;
+		}
+		if (batch->ppo2)
+			batch->ppo2[row] = value->ppo2.value;
+		break;
+	case DC_SAMPLE_CNS:
+		if (batch->cns)
+			batch->cns[row] = value->cns;
+		break;
+	case DC_SAMPLE_DECO:
+		if (batch->deco_type)
+			batch->deco_type[row] = value->deco.type;
+		if (batch->deco_time)
+			batch->deco_time[row] = value->deco.time;
+		if (batch->deco_depth)
+			batch->deco_depth[row] = value->deco.depth;
+		if (batch->deco_tts)
+			batch->deco_tts[row] = value->deco.tts;
+		break;
+	case DC_SAMPLE_GASMIX:
+		if (batch->gasmix)
+			batch->gasmix[row] = value->gasmix;
+		break;
+	default:
+		return;
+	}
+
+	batch->types[row] |= mask;
+}
+
+dc_status_t
+dc_parser_samples_batch (dc_parser_t *parser, dc_sample_batch_t *batch, dc_sample_batch_callback_t callback, void *userdata)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (parser == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (batch == NULL || batch->capacity == 0 || batch->types == NULL || callback == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	batch->count = 0;
+
+	if (parser->vtable->samples_batch) {
+		status = parser->vtable->samples_batch (parser, batch, callback, userdata);
+		if (status != DC_STATUS_SUCCESS)
+			return status;
+	} else {
+		if (parser->vtable->samples_foreach == NULL)
+			return DC_STATUS_UNSUPPORTED;
+
+		// Generic implementation on top of the sample callback.
+		sample_batch_t state = {batch, callback, userdata, 0, 0, 0.0};
+		status = parser->vtable->samples_foreach (parser, sample_batch_cb, &state);
+		if (status != DC_STATUS_SUCCESS)
+			return status;
+
+		sample_batch_close (&state);
+	}
+
+	// Deliver the remaining rows.
+	if (batch->count) {
+		callback (batch, userdata);
+		batch->count = 0;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+
+static void
+dc_parser_index_free (dc_parser_t *parser)
+{
+	dc_parser_index_t *index = parser->index;
+
+	if (index == NULL)
+		return;
+
+	free (index->samples);
+	free (index->sets);
+	dc_buffer_free (index->vendor);
+	free (index);
+
+	parser->index = NULL;
+}
+
+static void
+dc_parser_index_cb (dc_sample_type_t type, const dc_sample_value_t *value, void *userdata)
+{
+	dc_parser_index_t *index = (dc_parser_index_t *) userdata;
+
+	if (index->status != DC_STATUS_SUCCESS)
+		return;
+
+	if (index->nsamples == index->maxsamples) {
+		size_t n = index->maxsamples ? index->maxsamples * 2 : 1024;
+		dc_parser_sample_t *samples = (dc_parser_sample_t *) realloc (index->samples, n * sizeof (dc_parser_sample_t));
+		if (samples == NULL) {
+			index->status = DC_STATUS_NOMEMORY;
+			return;
+		}
+		index->samples = samples;
+		index->maxsamples = n;
+	}
+
+	if (type == DC_SAMPLE_TIME) {
+		if (index->nsets == index->maxsets) {
+			size_t n = index->maxsets ? index->maxsets * 2 : 256;
+			dc_parser_set_t *sets = (dc_parser_set_t *) realloc (index->sets, n * sizeof (dc_parser_set_t));
+			if (sets == NULL) {
+				index->status = DC_STATUS_NOMEMORY;
+				return;
+			}
+			index->sets = sets;
+			index->maxsets = n;
+		}
+
+		if (index->nsets && value->time < index->sets[index->nsets - 1].time)
+			index->sorted = 0;
+
+		// The first sample set also contains the samples that were
+		// reported before the first time sample.
+		index->sets[index->nsets].time = value->time;
+		index->sets[index->nsets].offset = index->nsets ? index->nsamples : 0;
+		index->nsets++;
+	}
+
+	dc_parser_sample_t *sample = index->samples + index->nsamples;
+	sample->type = type;
+	sample->value = *value;
+	sample->offset = 0;
+
+	if (type == DC_SAMPLE_VENDOR) {
+		sample->offset = dc_buffer_get_size (index->vendor);
+		if (!dc_buffer_append (index->vendor, (const unsigned char *) value->vendor.data, value->vendor.size)) {
+			index->status = DC_STATUS_NOMEMORY;
+			return;
+		}
+	}
+
+	index->nsamples++;
+}
+
+static void
+dc_parser_invalidate (dc_parser_t *parser)
+{
+	dc_parser_index_free (parser);
+	dc_parser_summary_free (parser);
+}
+
+static dc_status_t
+dc_parser_index_build (dc_parser_t *parser)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_parser_index_t *index = NULL;
+
+	index = (dc_parser_index_t *) malloc (sizeof (dc_parser_index_t));
+	if (index == NULL) {
+		ERROR (parser->context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	index->samples = NULL;
+	index->nsamples = index->maxsamples = 0;
+	index->sets = NULL;
+	index->nsets = index->maxsets = 0;
+	index->sorted = 1;
+	index->status = DC_STATUS_SUCCESS;
+	index->vendor = dc_buffer_new (0);
+	if (index->vendor == NULL) {
+		ERROR (parser->context, "Failed to allocate memory.");
+		free (index);
+		return DC_STATUS_NOMEMORY;
+	}
+
+	parser->index = index;
+
+	status = parser->vtable->samples_foreach (parser, dc_parser_index_cb, index);
+	if (status == DC_STATUS_SUCCESS)
+		status = index->status;
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (parser->context, "Failed to build the sample index.");
+		dc_parser_index_free (parser);
+		return status;
+	}
+
+	// Point the vendor samples to their copy of the data.
+	const unsigned char *vendor = dc_buffer_get_data (index->vendor);
+	for (size_t i = 0; i < index->nsamples; ++i) {
+		if (index->samples[i].type == DC_SAMPLE_VENDOR)
+			index->samples[i].value.vendor.data = vendor + index->samples[i].offset;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_parser_samples_range (dc_parser_t *parser, unsigned int begin, unsigned int end, dc_sample_callback_t callback, void *userdata)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (parser == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (parser->vtable->samples_foreach == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (parser->index == NULL) {
+		status = dc_parser_index_build (parser);
+		if (status != DC_STATUS_SUCCESS)
+			return status;
+	}
+
+	const dc_parser_index_t *index = parser->index;
+
+	// Locate the first sample set in the range. If the sample times are
+	// not in increasing order, all sample sets need to be checked.
+	size_t first = 0;
+	if (index->sorted) {
+		size_t hi = index->nsets;
+		while (first < hi) {
+			size_t mid = first + (hi - first) / 2;
+			if (index->sets[mid].time < begin)
+				first = mid + 1;
+			else
+				hi = mid;
+		}
+	}
+
+	for (size_t i = first; i < index->nsets; ++i) {
+		unsigned int time = index->sets[i].time;
+		if (time < begin || time >= end) {
+			if (index->sorted)
+				break;
+			continue;
+		}
+
+		if (callback) {
+			size_t offset = index->sets[i].offset;
+			size_t last = i + 1 < index->nsets ? index->sets[i + 1].offset : index->nsamples;
+			for (size_t j = offset; j < last; ++j) {
+				callback (index->samples[j].type, &index->samples[j].value, userdata);
+			}
+		}
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+
 dc_status_t
 dc_parser_destroy (dc_parser_t *parser)
 {
@@ -426,6 +1015,13 @@ sample_statistics_cb (dc_sample_type_t type, const dc_sample_value_t *value, voi
 		if (statistics->maxdepth < value->depth)
 			statistics->maxdepth = value->depth;
 		break;
+	case DC_SAMPLE_TEMPERATURE:
+		if (statistics->ntemperatures == 0 || statistics->temperature_minimum > value->temperature)
+			statistics->temperature_minimum = value->temperature;
+		if (statistics->ntemperatures == 0 || statistics->temperature_maximum < value->temperature)
+			statistics->temperature_maximum = value->temperature;
+		statistics->ntemperatures++;
+		break;
 	default:
 		break;
 	}
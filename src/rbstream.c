@@ -37,7 +37,9 @@ struct dc_rbstream_t {
 	unsigned int offset;
 	unsigned int available;
 	unsigned int skip;
-	unsigned char cache[];
+	unsigned int readahead;
+	unsigned int remaining;
+	unsigned char *cache;
 };
 
 static unsigned int
@@ -99,12 +101,19 @@ dc_rbstream_new (dc_rbstream_t **out, dc_device_t *device, unsigned int pagesize
 	}
 
 	// Allocate memory.
-	rbstream = (dc_rbstream_t *) malloc (sizeof(*rbstream) + packetsize);
+	rbstream = (dc_rbstream_t *) malloc (sizeof(*rbstream));
 	if (rbstream == NULL) {
 		ERROR (device->context, "Failed to allocate memory.");
 		return DC_STATUS_NOMEMORY;
 	}
 
+	rbstream->cache = (unsigned char *) malloc (packetsize);
+	if (rbstream->cache == NULL) {
+		ERROR (device->context, "Failed to allocate memory.");
+		free (rbstream);
+		return DC_STATUS_NOMEMORY;
+	}
+
 	rbstream->device = device;
 	rbstream->direction = direction;
 	rbstream->pagesize = pagesize;
@@ -120,12 +129,56 @@ dc_rbstream_new (dc_rbstream_t **out, dc_device_t *device, unsigned int pagesize
 	}
 	rbstream->offset = 0;
 	rbstream->available = 0;
+	rbstream->readahead = packetsize;
+	rbstream->remaining = 0;
 
 	*out = rbstream;
 
 	return DC_STATUS_SUCCESS;
 }
 
+dc_status_t
+dc_rbstream_set_readahead (dc_rbstream_t *rbstream, unsigned int size, unsigned int total)
+{
+	if (rbstream == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	// Round down to a multiple of the packet size.
+	size = ifloor (size, rbstream->packetsize);
+	if (size < rbstream->packetsize)
+		size = rbstream->packetsize;
+
+	// Grow the cache. Any data that is still available is preserved.
+	if (size > rbstream->readahead) {
+		unsigned char *cache = (unsigned char *) realloc (rbstream->cache, size);
+		if (cache == NULL) {
+			ERROR (rbstream->device->context, "Failed to allocate memory.");
+			return DC_STATUS_NOMEMORY;
+		}
+
+		rbstream->cache = cache;
+	}
+
+	rbstream->readahead = size;
+	rbstream->remaining = total;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static unsigned int
+dc_rbstream_readahead (dc_rbstream_t *rbstream, unsigned int len)
+{
+	// Never read beyond the number of bytes that are still expected.
+	unsigned int expected = iceil (rbstream->remaining + rbstream->skip, rbstream->packetsize);
+	if (len > expected)
+		len = expected;
+
+	if (len < rbstream->packetsize)
+		len = rbstream->packetsize;
+
+	return len;
+}
+
 static dc_status_t
 dc_rbstream_read_backward (dc_rbstream_t *rbstream, dc_event_progress_t *progress, unsigned char data[], unsigned int size)
 {
@@ -139,13 +192,24 @@ dc_rbstream_read_backward (dc_rbstream_t *rbstream, dc_event_progress_t *progres
 			if (rbstream->address == rbstream->begin)
 				rbstream->address = rbstream->end;
 
-			// Calculate the packet size.
+			// Calculate the packet size. With read-ahead enabled, read
+			// multiple packets at once, down to the previous boundary.
 			unsigned int len = rbstream->packetsize;
-			if (rbstream->begin + len > rbstream->address)
+			if (rbstream->readahead > len && rbstream->remaining) {
+				len = rbstream->address % rbstream->readahead;
+				if (len == 0)
+					len = rbstream->readahead;
+				len = dc_rbstream_readahead (rbstream, iceil (len, rbstream->packetsize));
+			}
+			if (rbstream->begin + len > rbstream->address) {
 				len = rbstream->address - rbstream->begin;
+				if (len > rbstream->packetsize)
+					len = ifloor (len, rbstream->packetsize);
+			}
 
-			// Read the packet into the cache.
-			rc = dc_device_read (rbstream->device, rbstream->address - len, rbstream->cache, rbstream->packetsize);
+			// Read the packet(s) into the cache.
+			unsigned int nread = len > rbstream->packetsize ? len : rbstream->packetsize;
+			rc = dc_device_read (rbstream->device, rbstream->address - len, rbstream->cache, nread);
 			if (rc != DC_STATUS_SUCCESS)
 				return rc;
 
@@ -162,6 +226,7 @@ dc_rbstream_read_backward (dc_rbstream_t *rbstream, dc_event_progress_t *progres
 
 		offset -= length;
 		rbstream->available -= length;
+		rbstream->remaining -= length < rbstream->remaining ? length : rbstream->remaining;
 
 		memcpy (data + offset, rbstream->cache + rbstream->available, length);
 
@@ -189,16 +254,24 @@ dc_rbstream_read_forward (dc_rbstream_t *rbstream, dc_event_progress_t *progress
 			if (rbstream->address == rbstream->end)
 				rbstream->address = rbstream->begin;
 
-			// Calculate the packet size.
+			// Calculate the packet size. With read-ahead enabled, read
+			// multiple packets at once, up to the next boundary.
 			unsigned int len = rbstream->packetsize;
-			if (rbstream->address + len > rbstream->end)
+			if (rbstream->readahead > len && rbstream->remaining) {
+				len = rbstream->readahead - rbstream->address % rbstream->readahead;
+				len = dc_rbstream_readahead (rbstream, iceil (len, rbstream->packetsize));
+			}
+			if (rbstream->address + len > rbstream->end) {
 				len = rbstream->end - rbstream->address;
+				if (len > rbstream->packetsize)
+					len = ifloor (len, rbstream->packetsize);
+			}
 
 			// Calculate the excess number of bytes.
-			unsigned int extra = rbstream->packetsize - len;
+			unsigned int extra = len < rbstream->packetsize ? rbstream->packetsize - len : 0;
 
-			// Read the packet into the cache.
-			rc = dc_device_read (rbstream->device, rbstream->address - extra, rbstream->cache, rbstream->packetsize);
+			// Read the packet(s) into the cache.
+			rc = dc_device_read (rbstream->device, rbstream->address - extra, rbstream->cache, len + extra);
 			if (rc != DC_STATUS_SUCCESS)
 				return rc;
 
@@ -218,6 +291,7 @@ dc_rbstream_read_forward (dc_rbstream_t *rbstream, dc_event_progress_t *progress
 
 		rbstream->offset += length;
 		rbstream->available -= length;
+		rbstream->remaining -= length < rbstream->remaining ? length : rbstream->remaining;
 
 		// Update and emit a progress event.
 		if (progress) {
@@ -247,6 +321,10 @@ dc_rbstream_read (dc_rbstream_t *rbstream, dc_event_progress_t *progress, unsign
 dc_status_t
 dc_rbstream_free (dc_rbstream_t *rbstream)
 {
+	if (rbstream == NULL)
+		return DC_STATUS_SUCCESS;
+
+	free (rbstream->cache);
 	free (rbstream);
 
 	return DC_STATUS_SUCCESS;
@@ -58,6 +58,27 @@ typedef enum dc_rbstream_direction_t {
 dc_status_t
 dc_rbstream_new (dc_rbstream_t **rbstream, dc_device_t *device, unsigned int pagesize, unsigned int packetsize, unsigned int begin, unsigned int end, unsigned int address, dc_rbstream_direction_t direction);
 
+/**
+ * Enable read-ahead on the ringbuffer stream.
+ *
+ * By default, the data is requested from the device one packet at a
+ * time. With read-ahead enabled, up to size bytes (rounded down to a
+ * multiple of the packet size) are requested with a single read, such
+ * that backends capable of pipelining their requests can keep several
+ * packets in flight. The reads are aligned to the read-ahead size, and
+ * never extend beyond the total number of bytes that is expected to be
+ * read from the stream. Once that amount is exhausted, the stream falls
+ * back to reading single packets.
+ *
+ * @param[in]  rbstream  A valid ringbuffer stream.
+ * @param[in]  size      The read-ahead size in bytes.
+ * @param[in]  total     The total number of bytes expected to be read.
+ * @returns #DC_STATUS_SUCCESS on success, or another #dc_status_t code
+ * on failure.
+ */
+dc_status_t
+dc_rbstream_set_readahead (dc_rbstream_t *rbstream, unsigned int size, unsigned int total);
+
 /**
  * Read data from the ringbuffer stream.
  *
@@ -47,6 +47,7 @@ struct reefnet_sensusultra_parser_t {
 	unsigned int maxdepth;
 };
 
+static dc_status_t reefnet_sensusultra_parser_reset (dc_parser_t *abstract);
 static dc_status_t reefnet_sensusultra_parser_set_clock (dc_parser_t *abstract, unsigned int devtime, dc_ticks_t systime);
 static dc_status_t reefnet_sensusultra_parser_set_atmospheric (dc_parser_t *abstract, double atmospheric);
 static dc_status_t reefnet_sensusultra_parser_set_density (dc_parser_t *abstract, double density);
@@ -60,13 +61,29 @@ static const dc_parser_vtable_t reefnet_sensusultra_parser_vtable = {
 	reefnet_sensusultra_parser_set_clock, /* set_clock */
 	reefnet_sensusultra_parser_set_atmospheric, /* set_atmospheric */
 	reefnet_sensusultra_parser_set_density, /* set_density */
+	reefnet_sensusultra_parser_reset, /* reset */
 	reefnet_sensusultra_parser_get_datetime, /* datetime */
 	reefnet_sensusultra_parser_get_field, /* fields */
 	reefnet_sensusultra_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
 
+static dc_status_t
+reefnet_sensusultra_parser_reset (dc_parser_t *abstract)
+{
+	reefnet_sensusultra_parser_t *parser = (reefnet_sensusultra_parser_t *) abstract;
+
+	// Reset the cached fields.
+	parser->cached = 0;
+	parser->divetime = 0;
+	parser->maxdepth = 0;
+
+	return DC_STATUS_SUCCESS;
+}
+
 dc_status_t
 reefnet_sensusultra_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size)
 {
@@ -87,9 +104,7 @@ reefnet_sensusultra_parser_create (dc_parser_t **out, dc_context_t *context, con
 	parser->hydrostatic = DEF_DENSITY_SALT * GRAVITY;
 	parser->devtime = 0;
 	parser->systime = 0;
-	parser->cached = 0;
-	parser->divetime = 0;
-	parser->maxdepth = 0;
+	reefnet_sensusultra_parser_reset ((dc_parser_t *) parser);
 
 	*out = (dc_parser_t*) parser;
 
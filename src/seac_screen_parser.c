@@ -48,6 +48,7 @@ struct seac_screen_parser_t {
 	unsigned int gf_high;
 };
 
+static dc_status_t seac_screen_parser_reset (dc_parser_t *abstract);
 static dc_status_t seac_screen_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t seac_screen_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t seac_screen_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -58,12 +59,32 @@ static const dc_parser_vtable_t seac_screen_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	seac_screen_parser_reset, /* reset */
 	seac_screen_parser_get_datetime, /* datetime */
 	seac_screen_parser_get_field, /* fields */
 	seac_screen_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
+static dc_status_t
+seac_screen_parser_reset (dc_parser_t *abstract)
+{
+	seac_screen_parser_t *parser = (seac_screen_parser_t *) abstract;
+
+	// Reset the cached fields.
+	parser->cached = 0;
+	parser->ngasmixes = 0;
+	for (unsigned int i = 0; i < NGASMIXES; ++i) {
+		parser->oxygen[i] = 0;
+	}
+	parser->gf_low = 0;
+	parser->gf_high = 0;
+
+	return DC_STATUS_SUCCESS;
+}
+
 dc_status_t
 seac_screen_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size)
 {
@@ -80,13 +101,7 @@ seac_screen_parser_create (dc_parser_t **out, dc_context_t *context, const unsig
 	}
 
 	// Set the default values.
-	parser->cached = 0;
-	parser->ngasmixes = 0;
-	for (unsigned int i = 0; i < NGASMIXES; ++i) {
-		parser->oxygen[i] = 0;
-	}
-	parser->gf_low = 0;
-	parser->gf_high = 0;
+	seac_screen_parser_reset ((dc_parser_t *) parser);
 
 	*out = (dc_parser_t *) parser;
 
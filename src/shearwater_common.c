@@ -27,6 +27,7 @@
 #include "context-private.h"
 #include "platform.h"
 #include "array.h"
+#include "bufio.h"
 
 #define SZ_PACKET  254
 
@@ -44,25 +45,46 @@
 
 #define NAK 0x7F
 
+#define SZ_IBUFFER 1024
+#define SZ_OBUFFER 256
+
+#define SZ_HISTORY 32
+#define SZ_OUTPUT  4096
+
+typedef struct shearwater_common_decompress_t {
+	unsigned char history[SZ_HISTORY];
+	unsigned int done;
+} shearwater_common_decompress_t;
+
 dc_status_t
 shearwater_common_setup (shearwater_common_device_t *device, dc_context_t *context, dc_iostream_t *iostream)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 
-	device->iostream = iostream;
+	// Create the buffered stream. The SLIP frames are received byte by
+	// byte, which is very inefficient without buffering.
+	if (dc_iostream_get_transport (iostream) != DC_TRANSPORT_BLE) {
+		status = dc_bufio_open (&device->iostream, context, iostream, SZ_IBUFFER, SZ_OBUFFER);
+		if (status != DC_STATUS_SUCCESS) {
+			ERROR (context, "Failed to create the buffered stream.");
+			return status;
+		}
+	} else {
+		device->iostream = iostream;
+	}
 
 	// Set the serial communication protocol (115200 8N1).
 	status = dc_iostream_configure (device->iostream, 115200, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to set the terminal attributes.");
-		return status;
+		goto error_close;
 	}
 
 	// Set the timeout for receiving data (3000ms).
 	status = dc_iostream_set_timeout (device->iostream, 3000);
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to set the timeout.");
-		return status;
+		goto error_close;
 	}
 
 	// Make sure everything is in a sane state.
@@ -70,65 +92,115 @@ shearwater_common_setup (shearwater_common_device_t *device, dc_context_t *conte
 	dc_iostream_purge (device->iostream, DC_DIRECTION_ALL);
 
 	return DC_STATUS_SUCCESS;
+
+error_close:
+	shearwater_common_close (device);
+	return status;
+}
+
+dc_status_t
+shearwater_common_close (shearwater_common_device_t *device)
+{
+	// Close the buffered stream.
+	if (dc_iostream_get_transport (device->iostream) != DC_TRANSPORT_BLE) {
+		return dc_iostream_close (device->iostream);
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+
+static void
+shearwater_common_decompress_init (shearwater_common_decompress_t *state)
+{
+	memset (state->history, 0, sizeof (state->history));
+	state->done = 0;
 }
 
 
 static int
-shearwater_common_decompress_lre (unsigned char *data, unsigned int size, dc_buffer_t *buffer, unsigned int *isfinal)
+shearwater_common_decompress_flush (shearwater_common_decompress_t *state, unsigned char output[], unsigned int size, dc_buffer_t *buffer)
 {
-	// The RLE decompression algorithm does interpret the binary data as a
-	// stream of 9 bit values. Therefore, the total number of bits needs to be
-	// a multiple of 9 bits.
-	unsigned int nbits = size * 8;
-	if (nbits % 9 != 0)
+	// Each block of 32 bytes is XOR'ed (in-place) with the previous block,
+	// except for the first block, which is passed through unchanged. The
+	// output is preceded by the last 32 bytes of the previous call (zero
+	// initially), so the XOR can be applied incrementally. The distance
+	// of 32 bytes allows processing 8 bytes at a time.
+	unsigned int i = SZ_HISTORY;
+	while (i + 8 <= size) {
+		unsigned long long a, b;
+		memcpy (&a, output + i, sizeof (a));
+		memcpy (&b, output + i - SZ_HISTORY, sizeof (b));
+		a ^= b;
+		memcpy (output + i, &a, sizeof (a));
+		i += 8;
+	}
+	while (i < size) {
+		output[i] ^= output[i - SZ_HISTORY];
+		i++;
+	}
+
+	if (!dc_buffer_append (buffer, output + SZ_HISTORY, size - SZ_HISTORY))
 		return -1;
 
-	unsigned int offset = 0;
-	while (offset + 9 <= nbits) {
-		// Extract the 9 bit value.
-		unsigned int byte = offset / 8;
-		unsigned int bit  = offset % 8;
-		unsigned int shift = 16 - (bit + 9);
-		unsigned int value = (array_uint16_be (data + byte) >> shift) & 0x1FF;
-
-		// The 9th bit indicates whether the remaining 8 bits represent
-		// a run of zero bytes or not. If the bit is set, the value is
-		// not a run and doesn't need expansion. If the bit is not set,
-		// the value contains the number of zero bytes in the run. A
-		// zero-length run indicates the end of the compressed stream.
-		if (value & 0x100) {
-			// Append the data byte directly.
-			unsigned char c = value & 0xFF;
-			if (!dc_buffer_append (buffer, &c, 1))
-				return -1;
-		} else if (value == 0) {
-			// Reached the end of the compressed stream.
-			if (isfinal)
-				*isfinal = 1;
-			break;
-		} else {
-			// Expand the run with zero bytes.
-			if (!dc_buffer_resize (buffer, dc_buffer_get_size (buffer) + value))
-				return -1;
-		}
-
-		offset += 9;
-	}
+	memcpy (state->history, output + size - SZ_HISTORY, SZ_HISTORY);
 
 	return 0;
 }
 
 
 static int
-shearwater_common_decompress_xor (unsigned char *data, unsigned int size)
+shearwater_common_decompress (shearwater_common_decompress_t *state, const unsigned char data[], unsigned int size, dc_buffer_t *buffer)
 {
-	// Each block of 32 bytes is XOR'ed (in-place) with the previous block,
-	// except for the first block, which is passed through unchanged.
-	for (unsigned int i = 32; i < size; ++i) {
-		data[i] ^= data[i - 32];
+	unsigned char output[SZ_HISTORY + SZ_OUTPUT];
+	unsigned int n = SZ_HISTORY;
+
+	// The RLE decompression algorithm does interpret the binary data as a
+	// stream of 9 bit values. Therefore, the total number of bits needs to be
+	// a multiple of 9 bits. Every 9 bytes contain exactly 8 values, which
+	// are extracted from a single 64 bit word and the next byte.
+	if (size % 9 != 0)
+		return -1;
+
+	memcpy (output, state->history, SZ_HISTORY);
+
+	for (unsigned int i = 0; i < size && !state->done; i += 9) {
+		// Make room for the worst case expansion of 8 runs.
+		if (n + 8 * 255 > sizeof (output)) {
+			if (shearwater_common_decompress_flush (state, output, n, buffer) != 0)
+				return -1;
+			memcpy (output, state->history, SZ_HISTORY);
+			n = SZ_HISTORY;
+		}
+
+		unsigned long long word = array_uint64_be (data + i);
+		for (unsigned int j = 0; j < 8; ++j) {
+			// Extract the 9 bit value.
+			unsigned int value = 0;
+			if (j < 7) {
+				value = (word >> (55 - 9 * j)) & 0x1FF;
+			} else {
+				value = ((word & 0x01) << 8) | data[i + 8];
+			}
+
+			// The 9th bit indicates whether the remaining 8 bits represent
+			// a run of zero bytes or not. If the bit is set, the value is
+			// not a run and doesn't need expansion. If the bit is not set,
+			// the value contains the number of zero bytes in the run. A
+			// zero-length run indicates the end of the compressed stream.
+			if (value & 0x100) {
+				output[n++] = value & 0xFF;
+			} else if (value == 0) {
+				state->done = 1;
+				break;
+			} else {
+				memset (output + n, 0, value);
+				n += value;
+			}
+		}
 	}
 
-	return 0;
+	return shearwater_common_decompress_flush (state, output, n, buffer);
 }
 
 static dc_status_t
@@ -389,7 +461,7 @@ shearwater_common_transfer (shearwater_common_device_t *device, const unsigned c
 
 
 dc_status_t
-shearwater_common_download (shearwater_common_device_t *device, dc_buffer_t *buffer, unsigned int address, unsigned int size, unsigned int compression, dc_event_progress_t *progress)
+shearwater_common_download (shearwater_common_device_t *device, dc_buffer_t *buffer, unsigned int address, unsigned int size, unsigned int compression, dc_event_progress_t *progress, shearwater_common_sink_t sink, void *userdata)
 {
 	dc_device_t *abstract = (dc_device_t *) device;
 	dc_status_t rc = DC_STATUS_SUCCESS;
@@ -442,10 +514,12 @@ shearwater_common_download (shearwater_common_device_t *device, dc_buffer_t *buf
 		device_event_emit (abstract, DC_EVENT_PROGRESS, progress);
 	}
 
-	unsigned int done = 0;
+	shearwater_common_decompress_t state;
+	shearwater_common_decompress_init (&state);
+
 	unsigned char block = 1;
 	unsigned int nbytes = 0;
-	while (nbytes < size && !done) {
+	while (nbytes < size && !state.done) {
 		// Transfer the block request.
 		req_block[1] = block;
 		rc = shearwater_common_transfer (device, req_block, sizeof (req_block), response, sizeof (response), &n);
@@ -474,8 +548,8 @@ shearwater_common_download (shearwater_common_device_t *device, dc_buffer_t *buf
 		}
 
 		if (compression) {
-			if (shearwater_common_decompress_lre (response + 2, length, buffer, &done) != 0) {
-				ERROR (abstract->context, "Decompression error (LRE phase).");
+			if (shearwater_common_decompress (&state, response + 2, length, buffer) != 0) {
+				ERROR (abstract->context, "Decompression error.");
 				return DC_STATUS_PROTOCOL;
 			}
 		} else {
@@ -489,13 +563,6 @@ shearwater_common_download (shearwater_common_device_t *device, dc_buffer_t *buf
 		block++;
 	}
 
-	if (compression) {
-		if (shearwater_common_decompress_xor (dc_buffer_get_data (buffer), dc_buffer_get_size (buffer)) != 0) {
-			ERROR (abstract->context, "Decompression error (XOR phase).");
-			return DC_STATUS_PROTOCOL;
-		}
-	}
-
 	// Transfer the quit request.
 	rc = shearwater_common_transfer (device, req_quit, sizeof (req_quit), response, 2, &n);
 	if (rc != DC_STATUS_SUCCESS) {
@@ -515,6 +582,13 @@ shearwater_common_download (shearwater_common_device_t *device, dc_buffer_t *buf
 		device_event_emit (abstract, DC_EVENT_PROGRESS, progress);
 	}
 
+	// The blocks are decompressed as soon as they arrive, so the data is
+	// complete now. The sink runs after the quit request, such that a slow
+	// sink can't cause the device to time out the transfer.
+	if (sink) {
+		sink (dc_buffer_get_data (buffer), dc_buffer_get_size (buffer), userdata);
+	}
+
 	return DC_STATUS_SUCCESS;
 }
 
@@ -56,6 +56,13 @@ extern "C" {
 #define NSTEPS    10000
 #define STEP(i,n) ((NSTEPS * (i) + (n) / 2) / (n))
 
+/*
+ * Callback function to receive the downloaded data as soon as the
+ * transfer is complete. It runs after the device is released, so it may
+ * take its time. The data remains valid until the download returns.
+ */
+typedef void (*shearwater_common_sink_t) (const unsigned char data[], unsigned int size, void *userdata);
+
 typedef struct shearwater_common_device_t {
 	dc_device_t base;
 	dc_iostream_t *iostream;
@@ -64,11 +71,14 @@ typedef struct shearwater_common_device_t {
 dc_status_t
 shearwater_common_setup (shearwater_common_device_t *device, dc_context_t *context, dc_iostream_t *iostream);
 
+dc_status_t
+shearwater_common_close (shearwater_common_device_t *device);
+
 dc_status_t
 shearwater_common_transfer (shearwater_common_device_t *device, const unsigned char input[], unsigned int isize, unsigned char output[], unsigned int osize, unsigned int *actual);
 
 dc_status_t
-shearwater_common_download (shearwater_common_device_t *device, dc_buffer_t *buffer, unsigned int address, unsigned int size, unsigned int compression, dc_event_progress_t *progress);
+shearwater_common_download (shearwater_common_device_t *device, dc_buffer_t *buffer, unsigned int address, unsigned int size, unsigned int compression, dc_event_progress_t *progress, shearwater_common_sink_t sink, void *userdata);
 
 dc_status_t
 shearwater_common_rdbi (shearwater_common_device_t *device, unsigned int id, unsigned char data[], unsigned int size);
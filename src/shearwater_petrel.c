@@ -44,6 +44,12 @@ typedef struct shearwater_petrel_device_t {
 	unsigned char fingerprint[4];
 } shearwater_petrel_device_t;
 
+typedef struct shearwater_petrel_dive_t {
+	dc_dive_callback_t callback;
+	void *userdata;
+	unsigned int stop;
+} shearwater_petrel_dive_t;
+
 static dc_status_t shearwater_petrel_device_set_fingerprint (dc_device_t *abstract, const unsigned char data[], unsigned int size);
 static dc_status_t shearwater_petrel_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata);
 static dc_status_t shearwater_petrel_device_timesync (dc_device_t *abstract, const dc_datetime_t *datetime);
@@ -126,6 +132,11 @@ shearwater_petrel_device_close (dc_device_t *abstract)
 		dc_status_set_error(&status, rc);
 	}
 
+	rc = shearwater_common_close (device);
+	if (rc != DC_STATUS_SUCCESS) {
+		dc_status_set_error(&status, rc);
+	}
+
 	return status;
 }
 
@@ -147,6 +158,16 @@ shearwater_petrel_device_set_fingerprint (dc_device_t *abstract, const unsigned
 }
 
 
+static void
+shearwater_petrel_dive_sink (const unsigned char data[], unsigned int size, void *userdata)
+{
+	shearwater_petrel_dive_t *dive = (shearwater_petrel_dive_t *) userdata;
+
+	if (dive->callback && !dive->callback (data, size, data + 12, 4, dive->userdata))
+		dive->stop = 1;
+}
+
+
 static dc_status_t
 shearwater_petrel_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata)
 {
@@ -248,7 +269,7 @@ shearwater_petrel_device_foreach (dc_device_t *abstract, dc_dive_callback_t call
 		// Download a manifest.
 		progress.current = NSTEPS * current;
 		progress.maximum = NSTEPS * maximum;
-		rc = shearwater_common_download (&device->base, buffer, MANIFEST_ADDR, MANIFEST_SIZE, 0, &progress);
+		rc = shearwater_common_download (&device->base, buffer, MANIFEST_ADDR, MANIFEST_SIZE, 0, &progress, NULL, NULL);
 		if (rc != DC_STATUS_SUCCESS) {
 			ERROR (abstract->context, "Failed to download the manifest.");
 			dc_buffer_free (buffer);
@@ -309,6 +330,11 @@ shearwater_petrel_device_foreach (dc_device_t *abstract, dc_dive_callback_t call
 	unsigned char *data = dc_buffer_get_data (manifests);
 	unsigned int size = dc_buffer_get_size (manifests);
 
+	shearwater_petrel_dive_t dive;
+	dive.callback = callback;
+	dive.userdata = userdata;
+	dive.stop = 0;
+
 	unsigned int offset = 0;
 	while (offset < size) {
 		// skip deleted dives
@@ -322,7 +348,7 @@ shearwater_petrel_device_foreach (dc_device_t *abstract, dc_dive_callback_t call
 		// Download the dive.
 		progress.current = NSTEPS * current;
 		progress.maximum = NSTEPS * maximum;
-		rc = shearwater_common_download (&device->base, buffer, base_addr + address, DIVE_SIZE, 1, &progress);
+		rc = shearwater_common_download (&device->base, buffer, base_addr + address, DIVE_SIZE, 1, &progress, shearwater_petrel_dive_sink, &dive);
 		if (rc != DC_STATUS_SUCCESS) {
 			ERROR (abstract->context, "Failed to download the dive.");
 			dc_buffer_free (buffer);
@@ -333,9 +359,7 @@ shearwater_petrel_device_foreach (dc_device_t *abstract, dc_dive_callback_t call
 		// Update the progress state.
 		current += 1;
 
-		unsigned char *buf = dc_buffer_get_data (buffer);
-		unsigned int len = dc_buffer_get_size (buffer);
-		if (callback && !callback (buf, len, buf + 12, sizeof (device->fingerprint), userdata))
+		if (dive.stop)
 			break;
 
 		offset += RECORD_SIZE;
@@ -45,6 +45,7 @@ static dc_status_t shearwater_predator_device_set_fingerprint (dc_device_t *abst
 static dc_status_t shearwater_predator_device_dump (dc_device_t *abstract, dc_buffer_t *buffer);
 static dc_status_t shearwater_predator_device_foreach (dc_device_t *abstract, dc_dive_callback_t callback, void *userdata);
 static dc_status_t shearwater_predator_device_timesync (dc_device_t *abstract, const dc_datetime_t *datetime);
+static dc_status_t shearwater_predator_device_close (dc_device_t *abstract);
 
 static const dc_device_vtable_t shearwater_predator_device_vtable = {
 	sizeof(shearwater_predator_device_t),
@@ -55,7 +56,7 @@ static const dc_device_vtable_t shearwater_predator_device_vtable = {
 	shearwater_predator_device_dump, /* dump */
 	shearwater_predator_device_foreach, /* foreach */
 	shearwater_predator_device_timesync,
-	NULL /* close */
+	shearwater_predator_device_close /* close */
 };
 
 static dc_status_t
@@ -96,6 +97,15 @@ error_free:
 }
 
 
+static dc_status_t
+shearwater_predator_device_close (dc_device_t *abstract)
+{
+	shearwater_common_device_t *device = (shearwater_common_device_t *) abstract;
+
+	return shearwater_common_close (device);
+}
+
+
 static dc_status_t
 shearwater_predator_device_set_fingerprint (dc_device_t *abstract, const unsigned char data[], unsigned int size)
 {
@@ -131,7 +141,7 @@ shearwater_predator_device_dump (dc_device_t *abstract, dc_buffer_t *buffer)
 	progress.maximum = NSTEPS;
 
 	// Download the memory dump.
-	status = shearwater_common_download (device, buffer, 0xDD000000, SZ_MEMORY, 0, &progress);
+	status = shearwater_common_download (device, buffer, 0xDD000000, SZ_MEMORY, 0, &progress, NULL, NULL);
 	if (status != DC_STATUS_SUCCESS) {
 		return status;
 	}
@@ -152,9 +152,11 @@ struct shearwater_predator_parser_t {
 	unsigned int density;
 };
 
+static dc_status_t shearwater_predator_parser_reset (dc_parser_t *abstract);
 static dc_status_t shearwater_predator_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t shearwater_predator_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
+static dc_status_t shearwater_predator_parser_samples_batch (dc_parser_t *abstract, dc_sample_batch_t *batch, dc_sample_batch_callback_t callback, void *userdata);
 
 static dc_status_t shearwater_predator_parser_cache (shearwater_predator_parser_t *parser);
 
@@ -164,9 +166,12 @@ static const dc_parser_vtable_t shearwater_predator_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	shearwater_predator_parser_reset, /* reset */
 	shearwater_predator_parser_get_datetime, /* datetime */
 	shearwater_predator_parser_get_field, /* fields */
 	shearwater_predator_parser_samples_foreach, /* samples_foreach */
+	shearwater_predator_parser_samples_batch, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
@@ -176,9 +181,12 @@ static const dc_parser_vtable_t shearwater_petrel_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	shearwater_predator_parser_reset, /* reset */
 	shearwater_predator_parser_get_datetime, /* datetime */
 	shearwater_predator_parser_get_field, /* fields */
 	shearwater_predator_parser_samples_foreach, /* samples_foreach */
+	shearwater_predator_parser_samples_batch, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
@@ -204,34 +212,11 @@ shearwater_predator_find_gasmix (shearwater_predator_parser_t *parser, unsigned
 
 
 static dc_status_t
-shearwater_common_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size, unsigned int model, unsigned int petrel)
+shearwater_predator_parser_reset (dc_parser_t *abstract)
 {
-	shearwater_predator_parser_t *parser = NULL;
-	const dc_parser_vtable_t *vtable = NULL;
-	unsigned int samplesize = 0;
-
-	if (out == NULL)
-		return DC_STATUS_INVALIDARGS;
-
-	if (petrel) {
-		vtable = &shearwater_petrel_parser_vtable;
-		samplesize = SZ_SAMPLE_PETREL;
-	} else {
-		vtable = &shearwater_predator_parser_vtable;
-		samplesize = SZ_SAMPLE_PREDATOR;
-	}
-
-	// Allocate memory.
-	parser = (shearwater_predator_parser_t *) dc_parser_allocate (context, vtable, data, size);
-	if (parser == NULL) {
-		ERROR (context, "Failed to allocate memory.");
-		return DC_STATUS_NOMEMORY;
-	}
+	shearwater_predator_parser_t *parser = (shearwater_predator_parser_t *) abstract;
 
-	// Set the default values.
-	parser->model = model;
-	parser->petrel = petrel;
-	parser->samplesize = samplesize;
+	// Reset the cached fields.
 	parser->cached = 0;
 	parser->pnf = 0;
 	parser->logversion = 0;
@@ -274,6 +259,40 @@ shearwater_common_parser_create (dc_parser_t **out, dc_context_t *context, const
 	parser->density = DEF_DENSITY_SALT;
 	parser->atmospheric = DEF_ATMOSPHERIC / (BAR / 1000);
 
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+shearwater_common_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size, unsigned int model, unsigned int petrel)
+{
+	shearwater_predator_parser_t *parser = NULL;
+	const dc_parser_vtable_t *vtable = NULL;
+	unsigned int samplesize = 0;
+
+	if (out == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	if (petrel) {
+		vtable = &shearwater_petrel_parser_vtable;
+		samplesize = SZ_SAMPLE_PETREL;
+	} else {
+		vtable = &shearwater_predator_parser_vtable;
+		samplesize = SZ_SAMPLE_PREDATOR;
+	}
+
+	// Allocate memory.
+	parser = (shearwater_predator_parser_t *) dc_parser_allocate (context, vtable, data, size);
+	if (parser == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	// Set the default values.
+	parser->model = model;
+	parser->petrel = petrel;
+	parser->samplesize = samplesize;
+	shearwater_predator_parser_reset ((dc_parser_t *) parser);
+
 	*out = (dc_parser_t *) parser;
 
 	return DC_STATUS_SUCCESS;
@@ -856,6 +875,56 @@ shearwater_predator_parser_get_field (dc_parser_t *abstract, dc_field_type_t typ
 }
 
 
+/*
+ * Decoding of the dive sample records. The record pointer is located
+ * after the optional PNF record type byte.
+ */
+static double
+shearwater_predator_sample_depth (shearwater_predator_parser_t *parser, const unsigned char record[])
+{
+	// Depth (1/10 m or ft).
+	unsigned int depth = array_uint16_be (record);
+	if (parser->units == IMPERIAL)
+		return depth * FEET / 10.0;
+	else
+		return depth / 10.0;
+}
+
+static double
+shearwater_predator_sample_temperature (shearwater_predator_parser_t *parser, const unsigned char record[])
+{
+	// Temperature (°C or °F).
+	int temperature = (signed char) record[13];
+	if (temperature < 0) {
+		// Fix negative temperatures.
+		temperature += 102;
+		if (temperature > 0) {
+			temperature = 0;
+		}
+	}
+	if (parser->units == IMPERIAL)
+		return (temperature - 32.0) * (5.0 / 9.0);
+	else
+		return temperature;
+}
+
+static double
+shearwater_predator_sample_setpoint (shearwater_predator_parser_t *parser, const unsigned char record[], unsigned int status)
+{
+	const unsigned char *data = parser->base.data;
+
+	if (parser->petrel) {
+		return record[18] / 100.0;
+	} else {
+		// this will only ever be called for the actual Predator, so no adjustment needed for PNF
+		if (status & SETPOINT_HIGH) {
+			return data[18] / 100.0;
+		} else {
+			return data[17] / 100.0;
+		}
+	}
+}
+
 static dc_status_t
 shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
 {
@@ -884,6 +953,7 @@ shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_cal
 	unsigned int length = size - parser->footersize;
 	while (offset + parser->samplesize <= length) {
 		dc_sample_value_t sample = {0};
+		const unsigned char *record = data + offset + pnf;
 
 		// Ignore empty samples.
 		if (array_isequal (data + offset, parser->samplesize, 0x00)) {
@@ -900,27 +970,12 @@ shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_cal
 			sample.time = time;
 			if (callback) callback (DC_SAMPLE_TIME, &sample, userdata);
 
-			// Depth (1/10 m or ft).
-			unsigned int depth = array_uint16_be (data + pnf + offset);
-			if (parser->units == IMPERIAL)
-				sample.depth = depth * FEET / 10.0;
-			else
-				sample.depth = depth / 10.0;
+			// Depth.
+			sample.depth = shearwater_predator_sample_depth (parser, record);
 			if (callback) callback (DC_SAMPLE_DEPTH, &sample, userdata);
 
-			// Temperature (°C or °F).
-			int temperature = (signed char) data[offset + pnf + 13];
-			if (temperature < 0) {
-				// Fix negative temperatures.
-				temperature += 102;
-				if (temperature > 0) {
-					temperature = 0;
-				}
-			}
-			if (parser->units == IMPERIAL)
-				sample.temperature = (temperature - 32.0) * (5.0 / 9.0);
-			else
-				sample.temperature = temperature;
+			// Temperature.
+			sample.temperature = shearwater_predator_sample_temperature (parser, record);
 			if (callback) callback (DC_SAMPLE_TEMPERATURE, &sample, userdata);
 
 			// Status flags.
@@ -948,16 +1003,7 @@ shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_cal
 				}
 
 				// Setpoint
-				if (parser->petrel) {
-					sample.setpoint = data[offset + pnf + 18] / 100.0;
-				} else {
-					// this will only ever be called for the actual Predator, so no adjustment needed for PNF
-					if (status & SETPOINT_HIGH) {
-						sample.setpoint = data[18] / 100.0;
-					} else {
-						sample.setpoint = data[17] / 100.0;
-					}
-				}
+				sample.setpoint = shearwater_predator_sample_setpoint (parser, record, status);
 				if (callback) callback (DC_SAMPLE_SETPOINT, &sample, userdata);
 			}
 
@@ -1117,3 +1163,217 @@ shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_cal
 
 	return DC_STATUS_SUCCESS;
 }
+
+/*
+ * Native implementation of the sample batch. Every dive or freedive
+ * sample is a row. The tank pressures of the extended sample record,
+ * and the compass heading of a log tag, are added to the last row.
+ */
+static dc_status_t
+shearwater_predator_parser_samples_batch (dc_parser_t *abstract, dc_sample_batch_t *batch, dc_sample_batch_callback_t callback, void *userdata)
+{
+	shearwater_predator_parser_t *parser = (shearwater_predator_parser_t *) abstract;
+
+	const unsigned char *data = abstract->data;
+	unsigned int size = abstract->size;
+
+	// Cache the parser data.
+	dc_status_t rc = shearwater_predator_parser_cache (parser);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	// Previous gas mix.
+	unsigned int o2_previous = UNDEFINED, he_previous = UNDEFINED, dil_previous = UNDEFINED;
+
+	// Sample interval.
+	unsigned int time = 0;
+	unsigned int interval = 10000;
+	if (parser->pnf && parser->logversion >= 9 && parser->opening[5] != UNDEFINED) {
+		interval = array_uint16_be (data + parser->opening[5] + 23);
+	}
+
+	const unsigned int pressure = 1u << DC_SAMPLE_PRESSURE;
+
+	unsigned int row = 0;
+	unsigned int pnf = parser->pnf;
+	unsigned int offset = parser->headersize;
+	unsigned int length = size - parser->footersize;
+	while (offset + parser->samplesize <= length) {
+		const unsigned char *record = data + offset + pnf;
+
+		// Ignore empty samples.
+		if (array_isequal (data + offset, parser->samplesize, 0x00)) {
+			offset += parser->samplesize;
+			continue;
+		}
+
+		// Get the record type.
+		unsigned int type = pnf ? data[offset] : LOG_RECORD_DIVE_SAMPLE;
+
+		if (type == LOG_RECORD_DIVE_SAMPLE) {
+			unsigned int status = record[11];
+			unsigned int ccr = (status & OC) == 0;
+			unsigned int types =
+				(1u << DC_SAMPLE_TIME) |
+				(1u << DC_SAMPLE_DEPTH) |
+				(1u << DC_SAMPLE_TEMPERATURE) |
+				(1u << DC_SAMPLE_DECO);
+
+			row = dc_sample_batch_append (batch, callback, userdata);
+
+			time += interval;
+			if (batch->time)
+				batch->time[row] = time;
+			if (batch->depth)
+				batch->depth[row] = shearwater_predator_sample_depth (parser, record);
+			if (batch->temperature)
+				batch->temperature[row] = shearwater_predator_sample_temperature (parser, record);
+
+			if (ccr) {
+				// Only the ppo2 value without a sensor index is stored.
+				if ((status & PPO2_EXTERNAL) == 0) {
+					types |= 1u << DC_SAMPLE_PPO2;
+					if (batch->ppo2)
+						batch->ppo2[row] = record[6] / 100.0;
+				}
+
+				types |= 1u << DC_SAMPLE_SETPOINT;
+				if (batch->setpoint)
+					batch->setpoint[row] = shearwater_predator_sample_setpoint (parser, record, status);
+			}
+
+			if (parser->petrel) {
+				types |= 1u << DC_SAMPLE_CNS;
+				if (batch->cns)
+					batch->cns[row] = record[22] / 100.0;
+			}
+
+			unsigned int o2 = record[7];
+			unsigned int he = record[8];
+			if ((o2 != o2_previous || he != he_previous || ccr != dil_previous) &&
+				(o2 != 0 || he != 0)) {
+				unsigned int idx = shearwater_predator_find_gasmix (parser, o2, he, ccr);
+				if (idx >= parser->ngasmixes) {
+					ERROR (abstract->context, "Invalid gas mix.");
+					return DC_STATUS_DATAFORMAT;
+				}
+
+				types |= 1u << DC_SAMPLE_GASMIX;
+				if (batch->gasmix)
+					batch->gasmix[row] = idx;
+				o2_previous = o2;
+				he_previous = he;
+				dil_previous = ccr;
+			}
+
+			unsigned int decostop = array_uint16_be (record + 2);
+			if (batch->deco_type)
+				batch->deco_type[row] = decostop ? DC_DECO_DECOSTOP : DC_DECO_NDL;
+			if (batch->deco_time)
+				batch->deco_time[row] = record[9] * 60;
+			if (batch->deco_depth)
+				batch->deco_depth[row] = parser->units == IMPERIAL ? decostop * FEET : decostop;
+			if (batch->deco_tts)
+				batch->deco_tts[row] = array_uint16_be (record + 4) * 60;
+
+			if (parser->logversion >= 7) {
+				// Only the first valid tank pressure is stored.
+				const unsigned int index[2] = {27, 19};
+				for (unsigned int i = 0; i < 2 && (types & pressure) == 0; ++i) {
+					unsigned int value = array_uint16_be (record + index[i]);
+					unsigned int id = (parser->aimode == AI_HPCCR ? 4 : 0) + i;
+					if (value < 0xFFF0) {
+						types |= pressure;
+						if (batch->tank)
+							batch->tank[row] = parser->tankidx[id];
+						if (batch->pressure)
+							batch->pressure[row] = (value & 0x0FFF) * 2 * PSI / BAR;
+					}
+				}
+
+				if (record[21] < 0xF0) {
+					types |= 1u << DC_SAMPLE_RBT;
+					if (batch->rbt)
+						batch->rbt[row] = record[21];
+				}
+			}
+
+			batch->types[row] = types;
+		} else if (type == LOG_RECORD_DIVE_SAMPLE_EXT) {
+			for (unsigned int i = 0; i < 4; ++i) {
+				unsigned int value = 0;
+				if (i < 2 && parser->logversion >= 13) {
+					value = array_uint16_be (record + i * 2);
+					if (value >= 0xFFF0)
+						continue;
+					value &= 0x0FFF;
+				} else if (i >= 2 && parser->logversion >= 14) {
+					value = array_uint16_be (record + i * 2);
+					if (value == 0)
+						continue;
+				} else {
+					continue;
+				}
+
+				if (batch->count == 0)
+					row = dc_sample_batch_append (batch, callback, userdata);
+
+				if (batch->types[row] & pressure)
+					break;
+
+				batch->types[row] |= pressure;
+				if (batch->tank)
+					batch->tank[row] = parser->tankidx[2 + i];
+				if (batch->pressure)
+					batch->pressure[row] = value * 2 * PSI / BAR;
+			}
+		} else if (type == LOG_RECORD_FREEDIVE_SAMPLE) {
+			for (unsigned int i = 0; i < 4; ++i) {
+				unsigned int idx = offset + i * SZ_SAMPLE_FREEDIVE;
+
+				// Ignore empty samples.
+				if (array_isequal (data + idx, SZ_SAMPLE_FREEDIVE, 0x00)) {
+					break;
+				}
+
+				row = dc_sample_batch_append (batch, callback, userdata);
+				batch->types[row] =
+					(1u << DC_SAMPLE_TIME) |
+					(1u << DC_SAMPLE_DEPTH) |
+					(1u << DC_SAMPLE_TEMPERATURE);
+
+				// Time (seconds).
+				time += interval;
+				if (batch->time)
+					batch->time[row] = time;
+
+				// Depth (absolute pressure in millibar)
+				unsigned int depth = array_uint16_be (data + idx + 1);
+				if (batch->depth)
+					batch->depth[row] = (signed int)(depth - parser->atmospheric) * (BAR / 1000.0) / (parser->density * GRAVITY);
+
+				// Temperature (1/10 °C).
+				int temperature = (signed short) array_uint16_be (data + idx + 3);
+				if (batch->temperature)
+					batch->temperature[row] = temperature / 10.0;
+			}
+		} else if (type == LOG_RECORD_INFO_EVENT) {
+			unsigned int event = data[offset + 1];
+			unsigned int w1 = array_uint32_be (data + offset + 8);
+
+			// Compass heading
+			if (event == INFO_EVENT_TAG_LOG && w1 != 0xFFFFFFFF) {
+				if (batch->count == 0)
+					row = dc_sample_batch_append (batch, callback, userdata);
+
+				batch->types[row] |= 1u << DC_SAMPLE_BEARING;
+				if (batch->bearing)
+					batch->bearing[row] = w1;
+			}
+		}
+
+		offset += parser->samplesize;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
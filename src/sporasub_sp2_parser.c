@@ -47,9 +47,12 @@ static const dc_parser_vtable_t sporasub_sp2_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	NULL, /* reset */
 	sporasub_sp2_parser_get_datetime, /* datetime */
 	sporasub_sp2_parser_get_field, /* fields */
 	sporasub_sp2_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
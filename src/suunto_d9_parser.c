@@ -92,6 +92,7 @@ typedef struct sample_info_t {
 	unsigned int divisor;
 } sample_info_t;
 
+static dc_status_t suunto_d9_parser_reset (dc_parser_t *abstract);
 static dc_status_t suunto_d9_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t suunto_d9_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t suunto_d9_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -102,9 +103,12 @@ static const dc_parser_vtable_t suunto_d9_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	suunto_d9_parser_reset, /* reset */
 	suunto_d9_parser_get_datetime, /* datetime */
 	suunto_d9_parser_get_field, /* fields */
 	suunto_d9_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
@@ -248,6 +252,27 @@ suunto_d9_parser_cache (suunto_d9_parser_t *parser)
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+suunto_d9_parser_reset (dc_parser_t *abstract)
+{
+	suunto_d9_parser_t *parser = (suunto_d9_parser_t *) abstract;
+
+	// Reset the cached fields.
+	parser->cached = 0;
+	parser->id = 0;
+	parser->mode = AIR;
+	parser->ngasmixes = 0;
+	parser->nccr = 0;
+	for (unsigned int i = 0; i < NGASMIXES; ++i) {
+		parser->oxygen[i] = 0;
+		parser->helium[i] = 0;
+	}
+	parser->gasmix = 0;
+	parser->config = 0;
+
+	return DC_STATUS_SUCCESS;
+}
+
 dc_status_t
 suunto_d9_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size, unsigned int model)
 {
@@ -265,17 +290,7 @@ suunto_d9_parser_create (dc_parser_t **out, dc_context_t *context, const unsigne
 
 	// Set the default values.
 	parser->model = model;
-	parser->cached = 0;
-	parser->id = 0;
-	parser->mode = AIR;
-	parser->ngasmixes = 0;
-	parser->nccr = 0;
-	for (unsigned int i = 0; i < NGASMIXES; ++i) {
-		parser->oxygen[i] = 0;
-		parser->helium[i] = 0;
-	}
-	parser->gasmix = 0;
-	parser->config = 0;
+	suunto_d9_parser_reset ((dc_parser_t *) parser);
 
 	*out = (dc_parser_t*) parser;
 
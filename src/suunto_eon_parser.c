@@ -43,6 +43,7 @@ struct suunto_eon_parser_t {
 	unsigned int nitrox;
 };
 
+static dc_status_t suunto_eon_parser_reset (dc_parser_t *abstract);
 static dc_status_t suunto_eon_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t suunto_eon_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t suunto_eon_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -53,9 +54,12 @@ static const dc_parser_vtable_t suunto_eon_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	suunto_eon_parser_reset, /* reset */
 	suunto_eon_parser_get_datetime, /* datetime */
 	suunto_eon_parser_get_field, /* fields */
 	suunto_eon_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
@@ -109,6 +113,21 @@ suunto_eon_parser_cache (suunto_eon_parser_t *parser)
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+suunto_eon_parser_reset (dc_parser_t *abstract)
+{
+	suunto_eon_parser_t *parser = (suunto_eon_parser_t *) abstract;
+
+	// Reset the cached fields.
+	parser->cached = 0;
+	parser->divetime = 0;
+	parser->maxdepth = 0;
+	parser->marker = 0;
+	parser->nitrox = 0;
+
+	return DC_STATUS_SUCCESS;
+}
+
 dc_status_t
 suunto_eon_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size, int spyder)
 {
@@ -126,11 +145,7 @@ suunto_eon_parser_create (dc_parser_t **out, dc_context_t *context, const unsign
 
 	// Set the default values.
 	parser->spyder = spyder;
-	parser->cached = 0;
-	parser->divetime = 0;
-	parser->maxdepth = 0;
-	parser->marker = 0;
-	parser->nitrox = 0;
+	suunto_eon_parser_reset ((dc_parser_t *) parser);
 
 	*out = (dc_parser_t*) parser;
 
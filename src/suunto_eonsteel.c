@@ -40,6 +40,8 @@ typedef struct suunto_eonsteel_device_t {
 	unsigned int model;
 	unsigned int magic;
 	unsigned short seq;
+	unsigned int pipeline;
+	unsigned int readsize;
 	unsigned char version[0x30];
 	unsigned char fingerprint[4];
 } suunto_eonsteel_device_t;
@@ -81,6 +83,14 @@ struct directory_entry {
 #define MAXDATA_SIZE 2048
 #define CRC_SIZE    4
 
+// The largest file read that fits in a single reply, and the maximum
+// number of outstanding read requests.
+#define READ_SIZE   (MAXDATA_SIZE - 8)
+#define PIPELINE    4
+
+// The size of the reads after a failed pipelined read.
+#define FALLBACK_SIZE 1024
+
 static dc_status_t suunto_eonsteel_device_set_fingerprint (dc_device_t *abstract, const unsigned char data[], unsigned int size);
 static dc_status_t suunto_eonsteel_device_foreach(dc_device_t *abstract, dc_dive_callback_t callback, void *userdata);
 static dc_status_t suunto_eonsteel_device_timesync(dc_device_t *abstract, const dc_datetime_t *datetime);
@@ -277,11 +287,11 @@ suunto_eonsteel_send(suunto_eonsteel_device_t *device,
 }
 
 /*
- * Send a command, receive a reply
+ * Receive the reply to a command
  *
  * This carefully checks the data fields in the reply for a match
- * against the command, and then only returns the actual reply
- * data itself.
+ * against the command and its sequence number, and then only returns
+ * the actual reply data itself.
  *
  * Also note that receive() function itself will have removed the
  * per-packet handshake bytes, so unlike the send() function, this
@@ -290,9 +300,8 @@ suunto_eonsteel_send(suunto_eonsteel_device_t *device,
  * send() side. The offsets are the same in the actual raw packet.
  */
 static dc_status_t
-suunto_eonsteel_transfer(suunto_eonsteel_device_t *device,
-	unsigned short cmd,
-	const unsigned char data[], unsigned int size,
+suunto_eonsteel_receive(suunto_eonsteel_device_t *device,
+	unsigned short cmd, unsigned short sequence,
 	unsigned char answer[], unsigned int asize,
 	unsigned int *actual)
 {
@@ -300,11 +309,6 @@ suunto_eonsteel_transfer(suunto_eonsteel_device_t *device,
 	unsigned char header[HEADER_SIZE + MAXDATA_SIZE];
 	unsigned int len = 0;
 
-	// Send the command.
-	rc = suunto_eonsteel_send(device, cmd, data, size);
-	if (rc != DC_STATUS_SUCCESS)
-		return rc;
-
 	if (dc_iostream_get_transport(device->iostream) == DC_TRANSPORT_BLE) {
 		// Receive the entire data packet.
 		rc = suunto_eonsteel_receive_ble(device, header, sizeof(header), &len);
@@ -342,8 +346,8 @@ suunto_eonsteel_transfer(suunto_eonsteel_device_t *device,
 	}
 
 	// Verify the sequence number.
-	if (seq != device->seq) {
-		ERROR(device->base.context, "Unexpected sequence number (received %04x, expected %04x).", seq, device->seq);
+	if (seq != sequence) {
+		ERROR(device->base.context, "Unexpected sequence number (received %04x, expected %04x).", seq, sequence);
 		return DC_STATUS_PROTOCOL;
 	}
 
@@ -388,22 +392,47 @@ suunto_eonsteel_transfer(suunto_eonsteel_device_t *device,
 		device->magic = (magic & 0xffff0000) | 0x0005;
 	}
 
-	// Increment the sequence number.
-	device->seq++;
-
 	if (actual)
 		*actual = nbytes;
 
 	return DC_STATUS_SUCCESS;
 }
 
+/*
+ * Send a command, receive a reply
+ */
 static dc_status_t
-read_file(suunto_eonsteel_device_t *eon, const char *filename, dc_buffer_t *buf)
+suunto_eonsteel_transfer(suunto_eonsteel_device_t *device,
+	unsigned short cmd,
+	const unsigned char data[], unsigned int size,
+	unsigned char answer[], unsigned int asize,
+	unsigned int *actual)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+
+	// Send the command.
+	rc = suunto_eonsteel_send(device, cmd, data, size);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	// Receive the reply.
+	rc = suunto_eonsteel_receive(device, cmd, device->seq, answer, asize, actual);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	// Increment the sequence number.
+	device->seq++;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+open_file(suunto_eonsteel_device_t *eon, const char *filename, unsigned int *size)
 {
 	dc_status_t rc = DC_STATUS_SUCCESS;
 	unsigned char result[2560];
 	unsigned char cmdbuf[64];
-	unsigned int size, offset, len;
+	unsigned int len;
 	unsigned int n = 0;
 
 	memset(cmdbuf, 0, sizeof(cmdbuf));
@@ -429,63 +458,186 @@ read_file(suunto_eonsteel_device_t *eon, const char *filename, dc_buffer_t *buf)
 	}
 	HEXDUMP (eon->base.context, DC_LOGLEVEL_DEBUG, "stat", result, n);
 
-	size = array_uint32_le(result+4);
-	offset = 0;
+	*size = array_uint32_le(result+4);
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+close_file(suunto_eonsteel_device_t *eon)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	unsigned char result[2560];
+	unsigned int n = 0;
+
+	rc = suunto_eonsteel_transfer(eon, CMD_FILE_CLOSE,
+		NULL, 0, result, sizeof(result), &n);
+	if (rc != DC_STATUS_SUCCESS) {
+		ERROR(eon->base.context, "cmd CMD_FILE_CLOSE failed");
+		return rc;
+	}
+	HEXDUMP(eon->base.context, DC_LOGLEVEL_DEBUG, "close", result, n);
+
+	return DC_STATUS_SUCCESS;
+}
+
+/*
+ * Read the contents of an open file, and append them to the buffer,
+ * except for the first few bytes that are already in the buffer.
+ */
+static dc_status_t
+read_file_data(suunto_eonsteel_device_t *eon, const char *filename, dc_buffer_t *buf, unsigned int size, unsigned int skip)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	unsigned char result[2560];
+	unsigned char cmdbuf[8];
+	unsigned int offset = 0;
+	unsigned int n = 0;
 
-	while (size > 0) {
+	/*
+	 * The file is read sequentially, because the device ignores the
+	 * offset field. Therefore multiple read requests can be sent
+	 * without waiting for the replies, and the replies are returned in
+	 * the same order. The reads start with the largest size that fits
+	 * in a reply. A device that returns less data than requested sets
+	 * the size for the remaining requests.
+	 */
+	unsigned int chunk = eon->readsize;
+	unsigned int asks[PIPELINE];
+	unsigned int first = 0, pending = 0, outstanding = 0;
+	unsigned short seq = eon->seq;
+	int eof = 0;
+
+	while (pending || (!eof && size > 0)) {
 		unsigned int ask, got, at;
 
-		ask = size;
-		if (ask > 1024)
-			ask = 1024;
-		array_uint32_le_set(cmdbuf + 0, 1234);	// Not file offset, after all
-		array_uint32_le_set(cmdbuf + 4, ask);	// Size of read
-		rc = suunto_eonsteel_transfer(eon, CMD_FILE_READ,
-			cmdbuf, 8, result, sizeof(result), &n);
+		// Keep the pipeline filled with read requests.
+		while (!eof && pending < eon->pipeline && outstanding < size) {
+			ask = size - outstanding;
+			if (ask > chunk)
+				ask = chunk;
+			array_uint32_le_set(cmdbuf + 0, 1234);	// Not file offset, after all
+			array_uint32_le_set(cmdbuf + 4, ask);	// Size of read
+			rc = suunto_eonsteel_send(eon, CMD_FILE_READ, cmdbuf, 8);
+			if (rc != DC_STATUS_SUCCESS) {
+				ERROR(eon->base.context, "unable to read %s", filename);
+				goto error_purge;
+			}
+			asks[(first + pending) % PIPELINE] = ask;
+			outstanding += ask;
+			pending++;
+			eon->seq++;
+		}
+
+		rc = suunto_eonsteel_receive(eon, CMD_FILE_READ, seq,
+			result, sizeof(result), &n);
 		if (rc != DC_STATUS_SUCCESS) {
 			ERROR(eon->base.context, "unable to read %s", filename);
-			return rc;
+			goto error_purge;
 		}
+
+		ask = asks[first];
+		first = (first + 1) % PIPELINE;
+		outstanding -= ask;
+		pending--;
+		seq++;
+
 		if (n < 8) {
 			ERROR(eon->base.context, "got short read reply for %s", filename);
-			return DC_STATUS_PROTOCOL;
+			rc = DC_STATUS_PROTOCOL;
+			goto error_purge;
 		}
 
 		// Not file offset, just stays unmodified.
 		at = array_uint32_le(result);
 		if (at != 1234) {
 			ERROR(eon->base.context, "read of %s returned different offset than asked for (%d vs %d)", filename, at, offset);
-			return DC_STATUS_PROTOCOL;
+			rc = DC_STATUS_PROTOCOL;
+			goto error_purge;
 		}
 
 		// Number of bytes actually read
 		got = array_uint32_le(result+4);
-		if (!got)
-			break;
+		if (!got) {
+			// Only the outstanding replies remain.
+			eof = 1;
+			continue;
+		}
 		if (n < 8 + got) {
 			ERROR(eon->base.context, "odd read size reply for offset %d of file %s", offset, filename);
-			return DC_STATUS_PROTOCOL;
+			rc = DC_STATUS_PROTOCOL;
+			goto error_purge;
 		}
 
+		if (got < ask && got < chunk)
+			chunk = got;
+
 		if (got > size)
 			got = size;
-		if (!dc_buffer_append (buf, result + 8, got)) {
-			ERROR (eon->base.context, "Insufficient buffer space available.");
-			return DC_STATUS_NOMEMORY;
-		}
 		offset += got;
 		size -= got;
+
+		// Drop the data that was received before.
+		unsigned int drop = got < skip ? got : skip;
+		skip -= drop;
+		if (!dc_buffer_append (buf, result + 8 + drop, got - drop)) {
+			ERROR (eon->base.context, "Insufficient buffer space available.");
+			rc = DC_STATUS_NOMEMORY;
+			goto error_purge;
+		}
 	}
 
-	rc = suunto_eonsteel_transfer(eon, CMD_FILE_CLOSE,
-		NULL, 0, result, sizeof(result), &n);
-	if (rc != DC_STATUS_SUCCESS) {
-		ERROR(eon->base.context, "cmd CMD_FILE_CLOSE failed");
+	return DC_STATUS_SUCCESS;
+
+error_purge:
+	// Discard the replies to the outstanding requests.
+	if (pending)
+		dc_iostream_purge (eon->iostream, DC_DIRECTION_INPUT);
+	return rc;
+}
+
+static dc_status_t
+read_file(suunto_eonsteel_device_t *eon, const char *filename, dc_buffer_t *buf)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	size_t start = dc_buffer_get_size(buf);
+	unsigned int size = 0;
+
+	rc = open_file(eon, filename, &size);
+	if (rc != DC_STATUS_SUCCESS)
 		return rc;
+
+	rc = read_file_data(eon, filename, buf, size, 0);
+	if (rc != DC_STATUS_SUCCESS) {
+		if (eon->pipeline == 1 || (rc != DC_STATUS_TIMEOUT && rc != DC_STATUS_PROTOCOL))
+			return rc;
+
+		// Some devices or interfaces may not cope with multiple
+		// outstanding or large reads. Disable pipelining, and discard
+		// the replies that are still on their way. Because the device
+		// ignores the offset of a read, and the discarded replies have
+		// already moved its file position, the file is opened again,
+		// and the data that was received before is skipped.
+		WARNING(eon->base.context, "Pipelined read failed. Falling back to single %u byte reads.", FALLBACK_SIZE);
+		eon->pipeline = 1;
+		eon->readsize = FALLBACK_SIZE;
+		dc_iostream_sleep (eon->iostream, 100);
+		dc_iostream_purge (eon->iostream, DC_DIRECTION_INPUT);
+
+		rc = close_file(eon);
+		if (rc != DC_STATUS_SUCCESS)
+			return rc;
+
+		rc = open_file(eon, filename, &size);
+		if (rc != DC_STATUS_SUCCESS)
+			return rc;
+
+		rc = read_file_data(eon, filename, buf, size, dc_buffer_get_size(buf) - start);
+		if (rc != DC_STATUS_SUCCESS)
+			return rc;
 	}
-	HEXDUMP(eon->base.context, DC_LOGLEVEL_DEBUG, "close", result, n);
 
-	return DC_STATUS_SUCCESS;
+	return close_file(eon);
 }
 
 /*
@@ -631,6 +783,8 @@ suunto_eonsteel_device_open(dc_device_t **out, dc_context_t *context, dc_iostrea
 	eon->model = model;
 	eon->magic = INIT_MAGIC;
 	eon->seq = INIT_SEQ;
+	eon->pipeline = PIPELINE;
+	eon->readsize = READ_SIZE;
 	memset (eon->version, 0, sizeof (eon->version));
 	memset (eon->fingerprint, 0, sizeof (eon->fingerprint));
 
@@ -28,6 +28,7 @@
 #include "context-private.h"
 #include "parser-private.h"
 #include "array.h"
+#include "checksum.h"
 #include "platform.h"
 
 enum eon_sample {
@@ -70,9 +71,56 @@ struct type_desc {
 #define MAXTYPE 512
 #define MAXGASES 16
 
+#define MAXCACHE 8
+
+#define SZ_ARENA 4096
+
+/*
+ * The descriptor strings are allocated from a chain of arena chunks,
+ * instead of individually. The chunks are released together with the
+ * descriptor table.
+ */
+struct eon_arena {
+	struct eon_arena *next;
+	unsigned int size, used;
+	char data[];
+};
+
+/*
+ * The decoded type descriptors of a dive. All dives recorded with the
+ * same firmware declare exactly the same descriptors. Therefore the
+ * decoded tables are kept in a cache attached to the context, and
+ * shared between all parsers created with that context. A table is
+ * never modified after it has been decoded, and is reference counted.
+ * The parsers can live in different threads, so the cache and the
+ * reference counts are only accessed with the context locked.
+ *
+ * The key contains all the descriptors of the dive (the type, length
+ * and text of each entry). It's used to decode the table, and to
+ * verify a match of the hash. The parser collects the key of each dive
+ * in its own buffer, which is only copied for a new table.
+ */
+typedef struct eon_descriptors_t {
+	struct eon_descriptors_t *next;
+	unsigned int refcount;
+	unsigned int hash;
+	dc_buffer_t *key;
+	struct type_desc type_desc[MAXTYPE];
+	struct eon_arena *arena, *current;
+} eon_descriptors_t;
+
+/*
+ * The most recently used descriptor tables.
+ */
+typedef struct eon_cache_t {
+	eon_descriptors_t *head;
+	unsigned int count;
+} eon_cache_t;
+
 typedef struct suunto_eonsteel_parser_t {
 	dc_parser_t base;
-	struct type_desc type_desc[MAXTYPE];
+	eon_descriptors_t *types;
+	dc_buffer_t *key;
 	// field cache
 	struct {
 		unsigned int initialized;
@@ -93,6 +141,7 @@ typedef struct suunto_eonsteel_parser_t {
 		double tankworkingpressure[MAXGASES];
 		dc_decomodel_t decomodel;
 	} cache;
+	dc_tank_t tank[MAXGASES];
 } suunto_eonsteel_parser_t;
 
 typedef int (*eon_data_cb_t)(unsigned short type, const struct type_desc *desc, const unsigned char *data, unsigned int len, void *user);
@@ -102,37 +151,42 @@ typedef struct eon_event_t {
 	parser_sample_event_t type;
 } eon_event_t;
 
+/*
+ * The known sample types, without the common "sml.DeviceLog.Samples.Sample."
+ * prefix. The table is sorted by name (in strcmp order), because the
+ * lookup is a binary search.
+ */
 static const struct {
 	const char *name;
 	enum eon_sample type;
 } type_translation[] = {
 	{ "+Time",				ES_dtime },
-	{ "Depth",				ES_depth },
-	{ "Temperature",			ES_temp },
-	{ "NoDecTime",				ES_ndl },
 	{ "Ceiling",				ES_ceiling },
-	{ "TimeToSurface",			ES_tts },
-	{ "Heading",				ES_heading },
-	{ "DeviceInternalAbsPressure",		ES_abspressure },
-	{ "GasTime",				ES_gastime },
-	{ "Ventilation",			ES_ventilation },
 	{ "Cylinders+Cylinder.GasNumber",	ES_gasnr },
 	{ "Cylinders.Cylinder.Pressure",	ES_pressure },
-	{ "Events+State.Type",			ES_state },
-	{ "Events.State.Active",		ES_state_active },
+	{ "Depth",				ES_depth },
+	{ "DeviceInternalAbsPressure",		ES_abspressure },
+	{ "Events+Alarm.Type",			ES_alarm },
 	{ "Events+Notify.Type",			ES_notify },
-	{ "Events.Notify.Active",		ES_notify_active },
+	{ "Events+State.Type",			ES_state },
 	{ "Events+Warning.Type",		ES_warning },
-	{ "Events.Warning.Active",		ES_warning_active },
-	{ "Events+Alarm.Type",			ES_alarm },
 	{ "Events.Alarm.Active",		ES_alarm_active },
 	{ "Events.Bookmark.Name",		ES_bookmark },
-	{ "Events.GasSwitch.GasNumber",		ES_gasswitch },
-	{ "Events.SetPoint.Type",		ES_setpoint_type },
-	{ "Events.Events.SetPoint.PO2",		ES_setpoint_po2 },
-	{ "Events.SetPoint.Automatic",		ES_setpoint_automatic },
 	{ "Events.DiveTimer.Active",		ES_none },
 	{ "Events.DiveTimer.Time",		ES_none },
+	{ "Events.Events.SetPoint.PO2",		ES_setpoint_po2 },
+	{ "Events.GasSwitch.GasNumber",		ES_gasswitch },
+	{ "Events.Notify.Active",		ES_notify_active },
+	{ "Events.SetPoint.Automatic",		ES_setpoint_automatic },
+	{ "Events.SetPoint.Type",		ES_setpoint_type },
+	{ "Events.State.Active",		ES_state_active },
+	{ "Events.Warning.Active",		ES_warning_active },
+	{ "GasTime",				ES_gastime },
+	{ "Heading",				ES_heading },
+	{ "NoDecTime",				ES_ndl },
+	{ "Temperature",			ES_temp },
+	{ "TimeToSurface",			ES_tts },
+	{ "Ventilation",			ES_ventilation },
 };
 
 static enum eon_sample lookup_descriptor_type(suunto_eonsteel_parser_t *eon, struct type_desc *desc)
@@ -159,9 +213,16 @@ static enum eon_sample lookup_descriptor_type(suunto_eonsteel_parser_t *eon, str
 	name += 8;
 
 	// .. and look it up in the table of sample type strings
-	for (size_t i = 0; i < C_ARRAY_SIZE(type_translation); i++) {
-		if (!strcmp(name, type_translation[i].name))
-			return type_translation[i].type;
+	size_t lo = 0, hi = C_ARRAY_SIZE(type_translation);
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		int cmp = strcmp(name, type_translation[mid].name);
+		if (cmp == 0)
+			return type_translation[mid].type;
+		if (cmp < 0)
+			hi = mid;
+		else
+			lo = mid + 1;
 	}
 	return ES_none;
 }
@@ -224,7 +285,7 @@ static int fill_in_group_details(suunto_eonsteel_parser_t *eon, struct type_desc
 			ERROR(eon->base.context, "Group type descriptor '%s' does not parse", desc->desc);
 			break;
 		}
-		base = eon->type_desc + index;
+		base = eon->types->type_desc + index;
 		if (!base->desc) {
 			ERROR(eon->base.context, "Group type descriptor '%s' has undescribed index %ld", desc->desc, index);
 			break;
@@ -284,14 +345,78 @@ static int fill_in_desc_details(suunto_eonsteel_parser_t *eon, struct type_desc
 	return 0;
 }
 
+static char *
+arena_strndup (eon_descriptors_t *types, const char *str, unsigned int len)
+{
+	struct eon_arena *chunk = types->current;
+
+	// Find the first chunk with enough free space, starting from the
+	// current one. A new chunk is appended when none is available.
+	while (chunk == NULL || chunk->size - chunk->used <= len) {
+		struct eon_arena **next = chunk ? &chunk->next : &types->arena;
+		if (*next == NULL) {
+			unsigned int size = len < SZ_ARENA ? SZ_ARENA : len + 1;
+			struct eon_arena *arena = (struct eon_arena *) malloc (sizeof(struct eon_arena) + size);
+			if (arena == NULL)
+				return NULL;
+			arena->next = NULL;
+			arena->size = size;
+			arena->used = 0;
+			*next = arena;
+		}
+		chunk = *next;
+	}
+
+	char *p = chunk->data + chunk->used;
+	memcpy(p, str, len);
+	p[len] = 0;
+
+	chunk->used += len + 1;
+	types->current = chunk;
+
+	return p;
+}
+
+static void
+descriptors_unref (eon_descriptors_t *types)
+{
+	if (types == NULL || --types->refcount)
+		return;
+
+	struct eon_arena *chunk = types->arena;
+	while (chunk) {
+		struct eon_arena *next = chunk->next;
+		free(chunk);
+		chunk = next;
+	}
+
+	dc_buffer_free(types->key);
+	free(types);
+}
+
 static void
-desc_free (struct type_desc desc[], unsigned int count)
+descriptors_release (suunto_eonsteel_parser_t *eon)
 {
-	for (unsigned int i = 0; i < count; ++i) {
-		free(desc[i].desc);
-		free(desc[i].format);
-		free(desc[i].mod);
+	dc_context_lock(eon->base.context);
+	descriptors_unref(eon->types);
+	dc_context_unlock(eon->base.context);
+
+	eon->types = NULL;
+}
+
+static void
+eon_cache_free (void *data)
+{
+	eon_cache_t *cache = (eon_cache_t *) data;
+
+	eon_descriptors_t *types = cache->head;
+	while (types) {
+		eon_descriptors_t *next = types->next;
+		descriptors_unref(types);
+		types = next;
 	}
+
+	free(cache);
 }
 
 static int record_type(suunto_eonsteel_parser_t *eon, unsigned short type, const char *name, int namelen)
@@ -318,14 +443,11 @@ static int record_type(suunto_eonsteel_parser_t *eon, unsigned short type, const
 			ERROR(eon->base.context, "Unexpected type description: %.*s", len, name);
 			return -1;
 		}
-		p = (char *) malloc(len-4);
+		p = arena_strndup(eon->types, name+5, len-5);
 		if (!p) {
 			ERROR(eon->base.context, "out of memory");
-			desc_free(&desc, 1);
 			return -1;
 		}
-		memcpy(p, name+5, len-5);
-		p[len-5] = 0;
 
 		// PTH, GRP, FRM, MOD
 		switch (name[1]) {
@@ -341,8 +463,6 @@ static int record_type(suunto_eonsteel_parser_t *eon, unsigned short type, const
 			break;
 		default:
 			ERROR(eon->base.context, "Unknown type descriptor: %.*s", len, name);
-			desc_free(&desc, 1);
-			free(p);
 			return -1;
 		}
 	} while ((name = next) != NULL);
@@ -353,18 +473,16 @@ static int record_type(suunto_eonsteel_parser_t *eon, unsigned short type, const
 			desc.desc ? desc.desc : "",
 			desc.format ? desc.format : "",
 			desc.mod ? desc.mod : "");
-		desc_free(&desc, 1);
 		return -1;
 	}
 
 	fill_in_desc_details(eon, &desc);
 
-	desc_free(eon->type_desc + type, 1);
-	eon->type_desc[type] = desc;
+	eon->types->type_desc[type] = desc;
 	return 0;
 }
 
-static int traverse_entry(suunto_eonsteel_parser_t *eon, const unsigned char *p, int size, eon_data_cb_t callback, void *user)
+static int traverse_entry(suunto_eonsteel_parser_t *eon, const unsigned char *p, int size, dc_buffer_t *key, eon_data_cb_t callback, void *user)
 {
 	const unsigned char *name, *data, *end, *last, *one_past_end = p + size;
 	int textlen, id;
@@ -385,6 +503,10 @@ static int traverse_entry(suunto_eonsteel_parser_t *eon, const unsigned char *p,
 	}
 
 	// Two bytes of 'type' followed by the name/descriptor, followed by the data
+	if (textlen < 3 || textlen > one_past_end - name) {
+		ERROR(eon->base.context, "Bad dive entry length (%d)", textlen);
+		return -1;
+	}
 	data = name + textlen;
 	id = array_uint16_le(name);
 	name += 2;
@@ -394,7 +516,19 @@ static int traverse_entry(suunto_eonsteel_parser_t *eon, const unsigned char *p,
 		return -1;
 	}
 
-	record_type(eon, id, (const char *) name, textlen-3);
+	// Collect the descriptor. The text is terminated here, because
+	// the last byte isn't guaranteed to be a NUL character.
+	if (key) {
+		unsigned char header[6], nul = 0;
+		array_uint16_le_set(header, id);
+		array_uint32_le_set(header + 2, textlen - 3);
+		if (!dc_buffer_append(key, header, sizeof(header)) ||
+			!dc_buffer_append(key, name, textlen - 3) ||
+			!dc_buffer_append(key, &nul, 1)) {
+			ERROR(eon->base.context, "out of memory");
+			return -1;
+		}
+	}
 
 	end = data;
 	last = data;
@@ -416,11 +550,13 @@ static int traverse_entry(suunto_eonsteel_parser_t *eon, const unsigned char *p,
 			end += 4;
 		}
 
-		if (type >= MAXTYPE || !eon->type_desc[type].desc) {
+		if (callback == NULL) {
+			// Only collecting the descriptors
+		} else if (type >= MAXTYPE || !eon->types->type_desc[type].desc) {
 			HEXDUMP(eon->base.context, DC_LOGLEVEL_DEBUG, "last", last, 16);
 			HEXDUMP(eon->base.context, DC_LOGLEVEL_DEBUG, "this", begin, 16);
 		} else {
-			rc = callback(type, eon->type_desc+type, end, len, user);
+			rc = callback(type, eon->types->type_desc+type, end, len, user);
 			if (rc < 0)
 				return rc;
 		}
@@ -432,6 +568,125 @@ static int traverse_entry(suunto_eonsteel_parser_t *eon, const unsigned char *p,
 	return end - p;
 }
 
+/*
+ * Get the descriptor table for the dive, either from the cache or by
+ * decoding all the descriptors of the dive.
+ */
+static dc_status_t
+descriptors_get (suunto_eonsteel_parser_t *eon, const unsigned char *data, int len)
+{
+	eon_descriptors_t *types = NULL;
+	dc_buffer_t *key = eon->key;
+
+	dc_buffer_clear(key);
+
+	// Collect the descriptors. Like the other passes over the data,
+	// stop at the first bad entry and keep everything before it.
+	while (len > 4) {
+		int i = traverse_entry(eon, data, len, key, NULL, NULL);
+		if (i < 0)
+			break;
+		len -= i;
+		data += i;
+	}
+
+	const unsigned char *k = dc_buffer_get_data(key);
+	size_t ksize = dc_buffer_get_size(key);
+	unsigned int hash = checksum_crc32(k, ksize);
+
+	dc_context_lock(eon->base.context);
+
+	eon_cache_t *cache = (eon_cache_t *) dc_context_get_cache(eon->base.context, DC_FAMILY_SUUNTO_EONSTEEL);
+	if (cache) {
+		eon_descriptors_t **prev = &cache->head;
+		for (types = cache->head; types; prev = &types->next, types = types->next) {
+			if (types->hash == hash &&
+				dc_buffer_get_size(types->key) == ksize &&
+				memcmp(dc_buffer_get_data(types->key), k, ksize) == 0) {
+				// Move to the front of the list.
+				*prev = types->next;
+				types->next = cache->head;
+				cache->head = types;
+
+				types->refcount++;
+				dc_context_unlock(eon->base.context);
+				eon->types = types;
+				return DC_STATUS_SUCCESS;
+			}
+		}
+	}
+
+	// The table is decoded without holding the lock. If another parser
+	// decodes the same table meanwhile, both end up in the cache, and
+	// the extra one is eventually dropped.
+	dc_context_unlock(eon->base.context);
+
+	types = (eon_descriptors_t *) calloc(1, sizeof(eon_descriptors_t));
+	if (types == NULL) {
+		ERROR(eon->base.context, "out of memory");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	types->key = dc_buffer_new(ksize);
+	if (types->key == NULL || !dc_buffer_append(types->key, k, ksize)) {
+		ERROR(eon->base.context, "out of memory");
+		dc_buffer_free(types->key);
+		free(types);
+		return DC_STATUS_NOMEMORY;
+	}
+
+	types->refcount = 1;
+	types->hash = hash;
+	eon->types = types;
+	k = dc_buffer_get_data(types->key);
+
+	// Decode the descriptors in the order of appearance, because a
+	// group descriptor refers to the previously declared types.
+	size_t offset = 0;
+	while (offset + 6 < ksize) {
+		unsigned int id = array_uint16_le(k + offset);
+		unsigned int length = array_uint32_le(k + offset + 2);
+		record_type(eon, id, (const char *) k + offset + 6, length);
+		offset += 6 + length + 1;
+	}
+
+	// Without a context there is nothing to share the table with.
+	if (eon->base.context == NULL)
+		return DC_STATUS_SUCCESS;
+
+	dc_context_lock(eon->base.context);
+
+	cache = (eon_cache_t *) dc_context_get_cache(eon->base.context, DC_FAMILY_SUUNTO_EONSTEEL);
+	if (cache == NULL) {
+		cache = (eon_cache_t *) calloc(1, sizeof(eon_cache_t));
+		if (cache == NULL)
+			goto unlock;
+
+		if (dc_context_set_cache(eon->base.context, DC_FAMILY_SUUNTO_EONSTEEL, cache, eon_cache_free) != DC_STATUS_SUCCESS) {
+			free(cache);
+			goto unlock;
+		}
+	}
+
+	types->refcount++;
+	types->next = cache->head;
+	cache->head = types;
+
+	// Drop the least recently used table.
+	if (++cache->count > MAXCACHE) {
+		eon_descriptors_t **tail = &cache->head;
+		while ((*tail)->next)
+			tail = &(*tail)->next;
+		descriptors_unref(*tail);
+		*tail = NULL;
+		cache->count--;
+	}
+
+unlock:
+	dc_context_unlock(eon->base.context);
+	return DC_STATUS_SUCCESS;
+}
+
 static int traverse_data(suunto_eonsteel_parser_t *eon, eon_data_cb_t callback, void *user)
 {
 	const unsigned char *data = eon->base.data;
@@ -446,8 +701,11 @@ static int traverse_data(suunto_eonsteel_parser_t *eon, eon_data_cb_t callback,
 	data += 12;
 	len -= 12;
 
+	if (eon->types == NULL && descriptors_get(eon, data, len) != DC_STATUS_SUCCESS)
+		return 1;
+
 	while (len > 4) {
-		int i = traverse_entry(eon, data, len, callback, user);
+		int i = traverse_entry(eon, data, len, NULL, callback, user);
 		if (i < 0)
 			return 1;
 		len -= i;
@@ -1109,6 +1367,51 @@ suunto_eonsteel_parser_get_field(dc_parser_t *parser, dc_field_type_t type, unsi
 	return DC_STATUS_SUCCESS;
 }
 
+/*
+ * All the fields are already collected in a single pass over the data
+ * when the parser is created or reset, so the summary is a copy of the
+ * field cache.
+ */
+static dc_status_t
+suunto_eonsteel_parser_get_summary(dc_parser_t *parser, dc_summary_t *summary)
+{
+	suunto_eonsteel_parser_t *eon = (suunto_eonsteel_parser_t *)parser;
+	unsigned int initialized = eon->cache.initialized;
+
+	summary->fields = initialized;
+
+	if (initialized & (1 << DC_FIELD_DIVETIME))
+		summary->divetime = eon->cache.divetime;
+	if (initialized & (1 << DC_FIELD_MAXDEPTH))
+		summary->maxdepth = eon->cache.maxdepth;
+	if (initialized & (1 << DC_FIELD_AVGDEPTH))
+		summary->avgdepth = eon->cache.avgdepth;
+	if (initialized & (1 << DC_FIELD_SALINITY))
+		summary->salinity = eon->cache.salinity;
+	if (initialized & (1 << DC_FIELD_ATMOSPHERIC))
+		summary->atmospheric = eon->cache.surface_pressure;
+	if (initialized & (1 << DC_FIELD_DIVEMODE))
+		summary->divemode = eon->cache.divemode;
+	if (initialized & (1 << DC_FIELD_DECOMODEL))
+		summary->decomodel = eon->cache.decomodel;
+
+	if (initialized & (1 << DC_FIELD_GASMIX_COUNT) && eon->cache.ngases) {
+		summary->ngasmixes = eon->cache.ngases;
+		summary->gasmix = eon->cache.gasmix;
+	}
+
+	if (initialized & (1 << DC_FIELD_TANK_COUNT) && eon->cache.ngases) {
+		for (unsigned int i = 0; i < eon->cache.ngases; ++i) {
+			memset(eon->tank + i, 0, sizeof(dc_tank_t));
+			suunto_eonsteel_parser_get_field(parser, DC_FIELD_TANK, i, eon->tank + i);
+		}
+		summary->ntanks = eon->cache.ngases;
+		summary->tank = eon->tank;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
 /*
  * The time of the dive is encoded in the filename,
  * and we've saved it off as the four first bytes
@@ -1505,8 +1808,11 @@ static void show_descriptor(suunto_eonsteel_parser_t *eon, int nr, struct type_d
 
 static void show_all_descriptors(suunto_eonsteel_parser_t *eon)
 {
+	if (eon->types == NULL)
+		return;
+
 	for (unsigned int i = 0; i < MAXTYPE; ++i)
-		show_descriptor(eon, i, eon->type_desc+i);
+		show_descriptor(eon, i, eon->types->type_desc+i);
 }
 
 static dc_status_t
@@ -1514,7 +1820,21 @@ suunto_eonsteel_parser_destroy(dc_parser_t *parser)
 {
 	suunto_eonsteel_parser_t *eon = (suunto_eonsteel_parser_t *) parser;
 
-	desc_free(eon->type_desc, MAXTYPE);
+	descriptors_release(eon);
+	dc_buffer_free(eon->key);
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+suunto_eonsteel_parser_reset(dc_parser_t *parser)
+{
+	suunto_eonsteel_parser_t *eon = (suunto_eonsteel_parser_t *) parser;
+
+	descriptors_release(eon);
+
+	initialize_field_caches(eon);
+	show_all_descriptors(eon);
 
 	return DC_STATUS_SUCCESS;
 }
@@ -1525,9 +1845,12 @@ static const dc_parser_vtable_t suunto_eonsteel_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	suunto_eonsteel_parser_reset, /* reset */
 	suunto_eonsteel_parser_get_datetime, /* datetime */
 	suunto_eonsteel_parser_get_field, /* fields */
 	suunto_eonsteel_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	suunto_eonsteel_parser_get_summary, /* summary */
 	suunto_eonsteel_parser_destroy /* destroy */
 };
 
@@ -1535,6 +1858,7 @@ dc_status_t
 suunto_eonsteel_parser_create(dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size, unsigned int model)
 {
 	suunto_eonsteel_parser_t *parser = NULL;
+	dc_status_t status = DC_STATUS_SUCCESS;
 
 	if (out == NULL)
 		return DC_STATUS_INVALIDARGS;
@@ -1545,13 +1869,24 @@ suunto_eonsteel_parser_create(dc_parser_t **out, dc_context_t *context, const un
 		return DC_STATUS_NOMEMORY;
 	}
 
-	memset(&parser->type_desc, 0, sizeof(parser->type_desc));
+	parser->types = NULL;
 	memset(&parser->cache, 0, sizeof(parser->cache));
 
+	parser->key = dc_buffer_new(0);
+	if (parser->key == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+
 	initialize_field_caches(parser);
 	show_all_descriptors(parser);
 
 	*out = (dc_parser_t *) parser;
 
 	return DC_STATUS_SUCCESS;
+
+error_free:
+	dc_parser_deallocate ((dc_parser_t *) parser);
+	return status;
 }
@@ -39,6 +39,7 @@ struct suunto_solution_parser_t {
 	unsigned int maxdepth;
 };
 
+static dc_status_t suunto_solution_parser_reset (dc_parser_t *abstract);
 static dc_status_t suunto_solution_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t suunto_solution_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
 
@@ -48,13 +49,29 @@ static const dc_parser_vtable_t suunto_solution_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	suunto_solution_parser_reset, /* reset */
 	NULL, /* datetime */
 	suunto_solution_parser_get_field, /* fields */
 	suunto_solution_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
 
+static dc_status_t
+suunto_solution_parser_reset (dc_parser_t *abstract)
+{
+	suunto_solution_parser_t *parser = (suunto_solution_parser_t *) abstract;
+
+	// Reset the cached fields.
+	parser->cached = 0;
+	parser->divetime = 0;
+	parser->maxdepth = 0;
+
+	return DC_STATUS_SUCCESS;
+}
+
 dc_status_t
 suunto_solution_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size)
 {
@@ -71,9 +88,7 @@ suunto_solution_parser_create (dc_parser_t **out, dc_context_t *context, const u
 	}
 
 	// Set the default values.
-	parser->cached = 0;
-	parser->divetime = 0;
-	parser->maxdepth = 0;
+	suunto_solution_parser_reset ((dc_parser_t *) parser);
 
 	*out = (dc_parser_t*) parser;
 
@@ -44,6 +44,7 @@ struct suunto_vyper_parser_t {
 	unsigned int oxygen[NGASMIXES];
 };
 
+static dc_status_t suunto_vyper_parser_reset (dc_parser_t *abstract);
 static dc_status_t suunto_vyper_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t suunto_vyper_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t suunto_vyper_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -54,9 +55,12 @@ static const dc_parser_vtable_t suunto_vyper_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	suunto_vyper_parser_reset, /* reset */
 	suunto_vyper_parser_get_datetime, /* datetime */
 	suunto_vyper_parser_get_field, /* fields */
 	suunto_vyper_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
@@ -159,6 +163,24 @@ suunto_vyper_parser_cache (suunto_vyper_parser_t *parser)
 }
 
 
+static dc_status_t
+suunto_vyper_parser_reset (dc_parser_t *abstract)
+{
+	suunto_vyper_parser_t *parser = (suunto_vyper_parser_t *) abstract;
+
+	// Reset the cached fields.
+	parser->cached = 0;
+	parser->divetime = 0;
+	parser->maxdepth = 0;
+	parser->marker = 0;
+	parser->ngasmixes = 0;
+	for (unsigned int i = 0; i < NGASMIXES; ++i) {
+		parser->oxygen[i] = 0;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
 dc_status_t
 suunto_vyper_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size)
 {
@@ -175,14 +197,7 @@ suunto_vyper_parser_create (dc_parser_t **out, dc_context_t *context, const unsi
 	}
 
 	// Set the default values.
-	parser->cached = 0;
-	parser->divetime = 0;
-	parser->maxdepth = 0;
-	parser->marker = 0;
-	parser->ngasmixes = 0;
-	for (unsigned int i = 0; i < NGASMIXES; ++i) {
-		parser->oxygen[i] = 0;
-	}
+	suunto_vyper_parser_reset ((dc_parser_t *) parser);
 
 	*out = (dc_parser_t*) parser;
 
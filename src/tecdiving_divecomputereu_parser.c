@@ -46,9 +46,12 @@ static const dc_parser_vtable_t tecdiving_divecomputereu_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	NULL, /* reset */
 	tecdiving_divecomputereu_parser_get_datetime, /* datetime */
 	tecdiving_divecomputereu_parser_get_field, /* fields */
 	tecdiving_divecomputereu_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
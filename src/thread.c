@@ -0,0 +1,284 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Jef Driesen
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOGDI
+#include <windows.h>
+#include <process.h>
+#define USE_WIN32
+#elif defined(HAVE_PTHREAD_H)
+#include <pthread.h>
+#define USE_PTHREAD
+#endif
+
+#include "thread.h"
+
+struct dc_thread_t {
+	dc_thread_func_t func;
+	void *userdata;
+#if defined(USE_WIN32)
+	HANDLE handle;
+#elif defined(USE_PTHREAD)
+	pthread_t handle;
+#endif
+};
+
+struct dc_mutex_t {
+#if defined(USE_WIN32)
+	CRITICAL_SECTION handle;
+#elif defined(USE_PTHREAD)
+	pthread_mutex_t handle;
+#endif
+};
+
+struct dc_cond_t {
+#if defined(USE_WIN32)
+	CONDITION_VARIABLE handle;
+#elif defined(USE_PTHREAD)
+	pthread_cond_t handle;
+#endif
+};
+
+#if defined(USE_WIN32)
+static unsigned int __stdcall
+dc_thread_main (void *arg)
+{
+	dc_thread_t *thread = (dc_thread_t *) arg;
+
+	thread->func (thread->userdata);
+
+	return 0;
+}
+#elif defined(USE_PTHREAD)
+static void *
+dc_thread_main (void *arg)
+{
+	dc_thread_t *thread = (dc_thread_t *) arg;
+
+	thread->func (thread->userdata);
+
+	return NULL;
+}
+#endif
+
+dc_status_t
+dc_thread_new (dc_thread_t **out, dc_thread_func_t func, void *userdata)
+{
+#if defined(USE_WIN32) || defined(USE_PTHREAD)
+	dc_thread_t *thread = NULL;
+
+	if (out == NULL || func == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	thread = (dc_thread_t *) malloc (sizeof (dc_thread_t));
+	if (thread == NULL)
+		return DC_STATUS_NOMEMORY;
+
+	thread->func = func;
+	thread->userdata = userdata;
+
+#if defined(USE_WIN32)
+	thread->handle = (HANDLE) _beginthreadex (NULL, 0, dc_thread_main, thread, 0, NULL);
+	if (thread->handle == 0) {
+		free (thread);
+		return DC_STATUS_NOMEMORY;
+	}
+#else
+	if (pthread_create (&thread->handle, NULL, dc_thread_main, thread) != 0) {
+		free (thread);
+		return DC_STATUS_NOMEMORY;
+	}
+#endif
+
+	*out = thread;
+
+	return DC_STATUS_SUCCESS;
+#else
+	return DC_STATUS_UNSUPPORTED;
+#endif
+}
+
+dc_status_t
+dc_thread_join (dc_thread_t *thread)
+{
+	if (thread == NULL)
+		return DC_STATUS_SUCCESS;
+
+#if defined(USE_WIN32)
+	WaitForSingleObject (thread->handle, INFINITE);
+	CloseHandle (thread->handle);
+#elif defined(USE_PTHREAD)
+	pthread_join (thread->handle, NULL);
+#endif
+
+	free (thread);
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_mutex_new (dc_mutex_t **out)
+{
+#if defined(USE_WIN32) || defined(USE_PTHREAD)
+	dc_mutex_t *mutex = NULL;
+
+	if (out == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	mutex = (dc_mutex_t *) malloc (sizeof (dc_mutex_t));
+	if (mutex == NULL)
+		return DC_STATUS_NOMEMORY;
+
+#if defined(USE_WIN32)
+	InitializeCriticalSection (&mutex->handle);
+#else
+	if (pthread_mutex_init (&mutex->handle, NULL) != 0) {
+		free (mutex);
+		return DC_STATUS_NOMEMORY;
+	}
+#endif
+
+	*out = mutex;
+
+	return DC_STATUS_SUCCESS;
+#else
+	return DC_STATUS_UNSUPPORTED;
+#endif
+}
+
+void
+dc_mutex_lock (dc_mutex_t *mutex)
+{
+#if defined(USE_WIN32)
+	EnterCriticalSection (&mutex->handle);
+#elif defined(USE_PTHREAD)
+	pthread_mutex_lock (&mutex->handle);
+#endif
+}
+
+void
+dc_mutex_unlock (dc_mutex_t *mutex)
+{
+#if defined(USE_WIN32)
+	LeaveCriticalSection (&mutex->handle);
+#elif defined(USE_PTHREAD)
+	pthread_mutex_unlock (&mutex->handle);
+#endif
+}
+
+dc_status_t
+dc_mutex_free (dc_mutex_t *mutex)
+{
+	if (mutex == NULL)
+		return DC_STATUS_SUCCESS;
+
+#if defined(USE_WIN32)
+	DeleteCriticalSection (&mutex->handle);
+#elif defined(USE_PTHREAD)
+	pthread_mutex_destroy (&mutex->handle);
+#endif
+
+	free (mutex);
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_cond_new (dc_cond_t **out)
+{
+#if defined(USE_WIN32) || defined(USE_PTHREAD)
+	dc_cond_t *cond = NULL;
+
+	if (out == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	cond = (dc_cond_t *) malloc (sizeof (dc_cond_t));
+	if (cond == NULL)
+		return DC_STATUS_NOMEMORY;
+
+#if defined(USE_WIN32)
+	InitializeConditionVariable (&cond->handle);
+#else
+	if (pthread_cond_init (&cond->handle, NULL) != 0) {
+		free (cond);
+		return DC_STATUS_NOMEMORY;
+	}
+#endif
+
+	*out = cond;
+
+	return DC_STATUS_SUCCESS;
+#else
+	return DC_STATUS_UNSUPPORTED;
+#endif
+}
+
+void
+dc_cond_wait (dc_cond_t *cond, dc_mutex_t *mutex)
+{
+#if defined(USE_WIN32)
+	SleepConditionVariableCS (&cond->handle, &mutex->handle, INFINITE);
+#elif defined(USE_PTHREAD)
+	pthread_cond_wait (&cond->handle, &mutex->handle);
+#endif
+}
+
+void
+dc_cond_signal (dc_cond_t *cond)
+{
+#if defined(USE_WIN32)
+	WakeConditionVariable (&cond->handle);
+#elif defined(USE_PTHREAD)
+	pthread_cond_signal (&cond->handle);
+#endif
+}
+
+void
+dc_cond_broadcast (dc_cond_t *cond)
+{
+#if defined(USE_WIN32)
+	WakeAllConditionVariable (&cond->handle);
+#elif defined(USE_PTHREAD)
+	pthread_cond_broadcast (&cond->handle);
+#endif
+}
+
+dc_status_t
+dc_cond_free (dc_cond_t *cond)
+{
+	if (cond == NULL)
+		return DC_STATUS_SUCCESS;
+
+#if defined(USE_PTHREAD)
+	pthread_cond_destroy (&cond->handle);
+#endif
+
+	free (cond);
+
+	return DC_STATUS_SUCCESS;
+}
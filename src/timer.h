@@ -28,12 +28,6 @@
 extern "C" {
 #endif /* __cplusplus */
 
-#if defined (_WIN32) && !defined (__GNUC__)
-typedef unsigned __int64 dc_usecs_t;
-#else
-typedef unsigned long long dc_usecs_t;
-#endif
-
 typedef struct dc_timer_t dc_timer_t;
 
 dc_status_t
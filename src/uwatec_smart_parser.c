@@ -147,6 +147,7 @@ struct uwatec_smart_parser_t {
 	const uwatec_smart_header_info_t *header;
 	unsigned int headersize;
 	unsigned int nsamples;
+	const unsigned char *identify;
 	const uwatec_smart_event_info_t *events[NEVENTS];
 	unsigned int nevents[NEVENTS];
 	unsigned int trimix;
@@ -160,6 +161,7 @@ struct uwatec_smart_parser_t {
 	dc_divemode_t divemode;
 };
 
+static dc_status_t uwatec_smart_parser_reset (dc_parser_t *abstract);
 static dc_status_t uwatec_smart_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t uwatec_smart_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t uwatec_smart_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -172,9 +174,12 @@ static const dc_parser_vtable_t uwatec_smart_parser_vtable = {
 	NULL, /* set_clock */
 	NULL, /* set_atmospheric */
 	NULL, /* set_density */
+	uwatec_smart_parser_reset, /* reset */
 	uwatec_smart_parser_get_datetime, /* datetime */
 	uwatec_smart_parser_get_field, /* fields */
 	uwatec_smart_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
+	NULL, /* summary */
 	NULL /* destroy */
 };
 
@@ -352,6 +357,61 @@ uwatec_smart_sample_info_t uwatec_smart_tec_samples[] = {
 	{RBT,            1, 0, 14, 1, 1}, // 11111111 111110dd dddddddd
 };
 
+/*
+ * The sample type for every possible value of the first type byte, such
+ * that the type bits can be decoded with a single table lookup.
+ *
+ * In the Uwatec Smart bitstream, the sample type is the number of leading
+ * one bits. The value 0xFF means the type bits continue in the next byte,
+ * and the type is the sum of both lookups.
+ */
+static const unsigned char uwatec_smart_identify[256] = {
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,
+	 1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,
+	 1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,
+	 1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,
+	 2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,
+	 2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,
+	 3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+	 4,  4,  4,  4,  4,  4,  4,  4,  5,  5,  5,  5,  6,  6,  7,  8,
+};
+
+/*
+ * In the Uwatec Galileo bitstream, the type bits never run into the next
+ * byte:
+ *
+ *   0ddd dddd: type 0
+ *   100d dddd: type 1
+ *   1XXX dddd: type XXX (2 to 6)
+ *   1111 XXXX: type XXXX + 7
+ */
+static const unsigned char uwatec_galileo_identify[256] = {
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,
+	 1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,
+	 2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,
+	 3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+	 4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,
+	 5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,  5,
+	 6,  6,  6,  6,  6,  6,  6,  6,  6,  6,  6,  6,  6,  6,  6,  6,
+	 7,  8,  9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22,
+};
+
 static const
 uwatec_smart_event_info_t uwatec_smart_tec_events_0[] = {
 	{EV_WARNING,          0x01, 0},
@@ -574,6 +634,30 @@ uwatec_smart_parser_cache (uwatec_smart_parser_t *parser)
 }
 
 
+static dc_status_t
+uwatec_smart_parser_reset (dc_parser_t *abstract)
+{
+	uwatec_smart_parser_t *parser = (uwatec_smart_parser_t *) abstract;
+
+	// Reset the cached fields.
+	parser->cached = 0;
+	parser->ngasmixes = 0;
+	parser->ntanks = 0;
+	for (unsigned int i = 0; i < NGASMIXES; ++i) {
+		parser->gasmix[i].id = 0;
+		parser->gasmix[i].oxygen = 0;
+		parser->gasmix[i].helium = 0;
+		parser->tank[i].id = 0;
+		parser->tank[i].beginpressure = 0;
+		parser->tank[i].endpressure = 0;
+		parser->tank[i].gasmix = 0;
+	}
+	parser->watertype = DC_WATER_FRESH;
+	parser->divemode = DC_DIVEMODE_OC;
+
+	return DC_STATUS_SUCCESS;
+}
+
 dc_status_t
 uwatec_smart_parser_create (dc_parser_t **out, dc_context_t *context, const unsigned char data[], size_t size, unsigned int model)
 {
@@ -687,20 +771,13 @@ uwatec_smart_parser_create (dc_parser_t **out, dc_context_t *context, const unsi
 		goto error_free;
 	}
 
-	parser->cached = 0;
-	parser->ngasmixes = 0;
-	parser->ntanks = 0;
-	for (unsigned int i = 0; i < NGASMIXES; ++i) {
-		parser->gasmix[i].id = 0;
-		parser->gasmix[i].oxygen = 0;
-		parser->gasmix[i].helium = 0;
-		parser->tank[i].id = 0;
-		parser->tank[i].beginpressure = 0;
-		parser->tank[i].endpressure = 0;
-		parser->tank[i].gasmix = 0;
+	if (parser->samples == uwatec_smart_galileo_samples) {
+		parser->identify = uwatec_galileo_identify;
+	} else {
+		parser->identify = uwatec_smart_identify;
 	}
-	parser->watertype = DC_WATER_FRESH;
-	parser->divemode = DC_DIVEMODE_OC;
+
+	uwatec_smart_parser_reset ((dc_parser_t *) parser);
 
 	*out = (dc_parser_t*) parser;
 
@@ -838,40 +915,21 @@ uwatec_smart_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsi
 
 
 static unsigned int
-uwatec_smart_identify (const unsigned char data[], unsigned int size)
+uwatec_smart_append (unsigned int value, const unsigned char data[], unsigned int n)
 {
-	unsigned int count = 0;
-	for (unsigned int i = 0; i < size; ++i) {
-		unsigned char value = data[i];
-		for (unsigned int j = 0; j < NBITS; ++j) {
-			unsigned char mask = 1 << (NBITS - 1 - j);
-			if ((value & mask) == 0)
-				return count;
-			count++;
+	switch (n) {
+	case 0:
+		return value;
+	case 1:
+		return (value << NBITS) | data[0];
+	case 2:
+		return (value << 2 * NBITS) | array_uint16_be (data);
+	default:
+		for (unsigned int i = 0; i < n; ++i) {
+			value = (value << NBITS) | data[i];
 		}
+		return value;
 	}
-
-	return (unsigned int) -1;
-}
-
-
-static unsigned int
-uwatec_galileo_identify (unsigned char value)
-{
-	// Bits: 0ddd dddd
-	if ((value & 0x80) == 0)
-		return 0;
-
-	// Bits: 100d dddd
-	if ((value & 0xE0) == 0x80)
-		return 1;
-
-	// Bits: 1XXX dddd
-	if ((value & 0xF0) != 0xF0)
-		return (value & 0x70) >> 4;
-
-	// Bits: 1111 XXXX
-	return (value & 0x0F) + 7;
 }
 
 
@@ -884,6 +942,7 @@ uwatec_smart_parse (uwatec_smart_parser_t *parser, dc_sample_callback_t callback
 	unsigned int size = abstract->size;
 
 	const uwatec_smart_sample_info_t *table = parser->samples;
+	const unsigned char *identify = parser->identify;
 	unsigned int entries = parser->nsamples;
 
 	// Get the maximum number of alarm bytes.
@@ -928,20 +987,13 @@ uwatec_smart_parse (uwatec_smart_parser_t *parser, dc_sample_callback_t callback
 		dc_sample_value_t sample = {0};
 
 		// Process the type bits in the bitstream.
-		unsigned int id = 0;
-		if (parser->model == GALILEO || parser->model == GALILEOTRIMIX ||
-			parser->model == ALADIN2G || parser->model == MERIDIAN ||
-			parser->model == CHROMIS || parser->model == MANTIS2 ||
-			parser->model == G2 || parser->model == ALADINSPORTMATRIX ||
-			parser->model == ALADINSQUARE || parser->model == G2HUD ||
-			parser->model == ALADINA1 || parser->model == ALADINA2 ||
-			parser->model == G2TEK || parser->model == G3 ||
-			parser->model == LUNA2AI || parser->model == LUNA2) {
-			// Uwatec Galileo
-			id = uwatec_galileo_identify (data[offset]);
-		} else {
-			// Uwatec Smart
-			id = uwatec_smart_identify (data + offset, size - offset);
+		unsigned int id = identify[data[offset]];
+		if (identify == uwatec_smart_identify && id == NBITS) {
+			// Uwatec Smart type bits continue in the next byte.
+			if (offset + 1 < size)
+				id += identify[data[offset + 1]];
+			else
+				id = (unsigned int) -1;
 		}
 		if (id >= entries) {
 			ERROR (abstract->context, "Invalid type bits.");
@@ -974,12 +1026,9 @@ uwatec_smart_parse (uwatec_smart_parser_t *parser, dc_sample_callback_t callback
 		}
 
 		// Process the extra data bytes.
-		for (unsigned int i = 0; i < table[id].extrabytes; ++i) {
-			nbits += NBITS;
-			value <<= NBITS;
-			value += data[offset];
-			offset++;
-		}
+		value = uwatec_smart_append (value, data + offset, table[id].extrabytes);
+		nbits += table[id].extrabytes * NBITS;
+		offset += table[id].extrabytes;
 
 		// Fix the sign bit.
 		signed int svalue = signextend (value, nbits);